@@ -47,7 +47,12 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
-DEFINE_bool(use_clock_cache, false, "");
+DEFINE_bool(use_clock_cache, false, "Same as -cache_type=clock");
+
+DEFINE_string(cache_type, "lru", "Type of the cache: lru, clock or lirs");
+
+DEFINE_double(lirs_irr_ratio, 0.9,
+              "Ratio of the LIRS cache capacity held by LIR entries");
 
 namespace TERARKDB_NAMESPACE {
 
@@ -114,14 +119,25 @@ struct ThreadState {
 class CacheBench {
  public:
   CacheBench() : num_threads_(FLAGS_threads) {
-    if (FLAGS_use_clock_cache) {
+    if (FLAGS_use_clock_cache || FLAGS_cache_type == "clock") {
       cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
       if (!cache_) {
         fprintf(stderr, "Clock cache not supported.\n");
         exit(1);
       }
-    } else {
+    } else if (FLAGS_cache_type == "lirs") {
+      cache_ = NewLIRSCache(FLAGS_cache_size, FLAGS_num_shard_bits,
+                            false /* strict_capacity_limit */,
+                            FLAGS_lirs_irr_ratio);
+      if (!cache_) {
+        fprintf(stderr, "Invalid LIRS cache options.\n");
+        exit(1);
+      }
+    } else if (FLAGS_cache_type == "lru") {
       cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+    } else {
+      fprintf(stderr, "Unknown cache type: %s\n", FLAGS_cache_type.c_str());
+      exit(1);
     }
   }
 
@@ -230,6 +246,7 @@ class CacheBench {
 
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
+    printf("Cache type          : %s\n", cache_->Name());
     printf("Number of threads   : %d\n", FLAGS_threads);
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
@@ -9,6 +9,7 @@
 
 #include "rocksdb/cache.h"
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <iostream>
@@ -17,6 +18,7 @@
 
 #include "cache/clock_cache.h"
 #include "cache/lru_cache.h"
+#include "port/port.h"
 #include "rocksdb/terark_namespace.h"
 #include "util/coding.h"
 #include "util/string_util.h"
@@ -41,6 +43,7 @@ static int DecodeValue(void* v) {
 
 const std::string kLRU = "lru";
 const std::string kClock = "clock";
+const std::string kLIRS = "lirs";
 
 void dumbDeleter(const Slice& /*key*/, void* /*value*/) {}
 
@@ -85,6 +88,9 @@ class CacheTest : public testing::TestWithParam<std::string> {
     if (type == kClock) {
       return NewClockCache(capacity);
     }
+    if (type == kLIRS) {
+      return NewLIRSCache(capacity);
+    }
     return nullptr;
   }
 
@@ -97,6 +103,9 @@ class CacheTest : public testing::TestWithParam<std::string> {
     if (type == kClock) {
       return NewClockCache(capacity, num_shard_bits, strict_capacity_limit);
     }
+    if (type == kLIRS) {
+      return NewLIRSCache(capacity, num_shard_bits, strict_capacity_limit);
+    }
     return nullptr;
   }
 
@@ -296,6 +305,11 @@ TEST_P(CacheTest, EntriesArePinned) {
 }
 
 TEST_P(CacheTest, EvictionPolicy) {
+  if (GetParam() == kLIRS) {
+    // LIRS keeps the entries inserted first as LIR entries, see
+    // LIRSCacheTest.ScanResistance
+    return;
+  }
   Insert(100, 101);
   Insert(200, 201);
 
@@ -309,6 +323,11 @@ TEST_P(CacheTest, EvictionPolicy) {
 }
 
 TEST_P(CacheTest, ExternalRefPinsEntries) {
+  if (GetParam() == kLIRS) {
+    // LIRS keeps the entries inserted first as LIR entries, see
+    // LIRSCacheTest.ScanResistance
+    return;
+  }
   Insert(100, 101);
   Cache::Handle* h = cache_->Lookup(EncodeKey(100));
   ASSERT_TRUE(cache_->Ref(h));
@@ -335,6 +354,11 @@ TEST_P(CacheTest, ExternalRefPinsEntries) {
 }
 
 TEST_P(CacheTest, EvictionPolicyRef) {
+  if (GetParam() == kLIRS) {
+    // LIRS keeps the entries inserted first as LIR entries, see
+    // LIRSCacheTest.ScanResistance
+    return;
+  }
   Insert(100, 101);
   Insert(101, 102);
   Insert(102, 103);
@@ -679,12 +703,85 @@ TEST_P(CacheTest, DefaultShardBits) {
   ASSERT_EQ(6, sc->GetNumShardBits());
 }
 
+TEST(LIRSCacheTest, ScanResistance) {
+  std::shared_ptr<Cache> cache = NewLIRSCache(100, 0, false, 0.9);
+  auto insert = [&cache](int key) {
+    ASSERT_OK(cache->Insert(EncodeKey(key), EncodeValue(key), 1, dumbDeleter));
+  };
+  auto lookup = [&cache](int key) {
+    Cache::Handle* handle = cache->Lookup(EncodeKey(key));
+    if (handle == nullptr) {
+      return -1;
+    }
+    int value = DecodeValue(cache->Value(handle));
+    cache->Release(handle);
+    return value;
+  };
+  for (int i = 0; i < 90; i++) {
+    insert(i);
+  }
+  for (int i = 0; i < 90; i++) {
+    ASSERT_EQ(i, lookup(i));
+  }
+  // A scan larger than the cache only cycles through the HIR entries
+  for (int i = 1000; i < 3000; i++) {
+    insert(i);
+  }
+  for (int i = 0; i < 90; i++) {
+    ASSERT_EQ(i, lookup(i));
+  }
+  ASSERT_EQ(-1, lookup(1000));
+  ASSERT_EQ(2999, lookup(2999));
+  ASSERT_LE(cache->GetUsage(), 100U);
+}
+
+TEST(LIRSCacheTest, ConcurrentLookup) {
+  static std::atomic<int> num_deleted;
+  num_deleted = 0;
+  auto deleter = [](const Slice& /*key*/, void* /*value*/) { ++num_deleted; };
+  std::shared_ptr<Cache> cache = NewLIRSCache(1000, 2, false, 0.9);
+  const int kNumKeys = 1500;
+  const int kNumThreads = 8;
+  std::atomic<int> num_inserted(0);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 20000; i++) {
+        int key = (i * 7 + t) % kNumKeys;
+        if (i % 10 < 7) {
+          Cache::Handle* handle = cache->Lookup(EncodeKey(key));
+          if (handle != nullptr) {
+            ASSERT_EQ(key, DecodeValue(cache->Value(handle)));
+            cache->Release(handle);
+          }
+        } else if (i % 10 < 9) {
+          Cache::Handle* handle = nullptr;
+          ++num_inserted;
+          ASSERT_OK(cache->Insert(EncodeKey(key), EncodeValue(key), 1, deleter,
+                                  &handle));
+          cache->Release(handle, i % 50 == 0 /* force_erase */);
+        } else {
+          cache->Erase(EncodeKey(key));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_LE(cache->GetUsage(), 1000U);
+  cache->EraseUnRefEntries();
+  ASSERT_EQ(0U, cache->GetUsage());
+  ASSERT_EQ(num_inserted.load(), num_deleted.load());
+}
+
 #ifdef SUPPORT_CLOCK_CACHE
 shared_ptr<Cache> (*new_clock_cache_func)(size_t, int, bool) = NewClockCache;
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
-                        testing::Values(kLRU, kClock));
+                        testing::Values(kLRU, kClock, kLIRS));
 #else
-INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest, testing::Values(kLRU));
+INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
+                        testing::Values(kLRU, kLIRS));
 #endif  // SUPPORT_CLOCK_CACHE
 
 }  // namespace TERARKDB_NAMESPACE
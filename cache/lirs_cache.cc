@@ -88,17 +88,28 @@ void LIRSHandleTable::Resize() {
 
 LIRSCacheShard::LIRSCacheShard(size_t capacity, bool strict_capacity_limit,
                                double irr_ratio)
-    : capacity_(capacity),
+    : capacity_(0),
+      stack_capacity_(0),
       usage_(0),
       stack_usage_(0),
       irr_ratio_(irr_ratio),
       strict_capacity_limit_(strict_capacity_limit) {
   cache_.next_stack = cache_.prev_stack = cache_.next_queue =
       cache_.prev_queue = &cache_;
+  for (auto& buffer : access_buffers_) {
+    buffer.size.store(0, std::memory_order_relaxed);
+  }
   SetCapacity(capacity);
 }
 
-LIRSCacheShard::~LIRSCacheShard() {}
+LIRSCacheShard::~LIRSCacheShard() {
+  // Drop the references held by pending accesses, the table frees the rest
+  autovector<LIRSHandle*> last_reference_list;
+  DrainAccessBuffers(&last_reference_list);
+  for (auto entry : last_reference_list) {
+    entry->Free();
+  }
+}
 
 void LIRSCacheShard::PushToQueue(LIRSHandle* h) {
   cache_.next_queue->prev_queue = h;
@@ -123,19 +134,6 @@ void LIRSCacheShard::AdjustToQueueTail(LIRSHandle* h) {
   h->prev_queue = &cache_;
 }
 
-void LIRSCacheShard::ShiftQueueHead() {
-  if (cache_.prev_queue == &cache_) {
-    return;
-  }
-  auto head = cache_.prev_queue;
-  RemoveFromQueue(head);
-  if (head->next_stack != nullptr) {
-    head->SetNHIR();
-  } else {
-    LIRS_Remove(head);
-  }
-}
-
 void LIRSCacheShard::PushToStack(LIRSHandle* h) {
   cache_.next_stack->prev_stack = h;
   h->next_stack = cache_.next_stack;
@@ -159,46 +157,82 @@ void LIRSCacheShard::AdjustToStackTop(LIRSHandle* h) {
   h->prev_stack = &cache_;
 }
 
-void LIRSCacheShard::AdjustStackBottom() {
+LIRSHandle* LIRSCacheShard::DemoteStackBottom() {
   if (cache_.prev_stack == &cache_) {
-    return;
+    return nullptr;
   }
   auto bottom = cache_.prev_stack;
-  if (bottom->LIR()) {
-    bottom->SetHIR();
-    if (bottom->next_queue != nullptr) {
-      RemoveFromQueue(bottom);
-    }
-    PushToQueue(bottom);
-  }
+  assert(bottom->LIR());
+  RemoveFromStack(bottom);
+  stack_usage_ -= bottom->charge;
+  bottom->SetHIR();
+  PushToQueue(bottom);
+  StackPruning();
+  return bottom;
 }
 
 void LIRSCacheShard::StackPruning() {
+  // The bottom of the stack is always a LIR handle
   while (cache_.prev_stack != &cache_ && !cache_.prev_stack->LIR()) {
-    auto bottom = cache_.prev_stack;
-    RemoveFromStack(bottom);
-    PushToQueue(bottom);
+    RemoveFromStack(cache_.prev_stack);
   }
 }
 
 bool LIRSCacheShard::Unref(LIRSHandle* h) {
-  assert(h->refs > 0);
-  h->refs--;
-  return h->refs == 0;
+  assert(h->refs.load(std::memory_order_relaxed) > 0);
+  return h->refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+bool LIRSCacheShard::RecordAccess(LIRSHandle* h) {
+  int cpu = port::PhysicalCoreID();
+  auto& buffer = access_buffers_[(cpu < 0 ? h->hash : uint32_t(cpu)) %
+                                 kNumAccessBuffers];
+  uint32_t pos = buffer.size.fetch_add(1, std::memory_order_relaxed);
+  if (pos >= AccessBuffer::kCapacity) {
+    return false;
+  }
+  // Drained under the write lock, which also orders this store
+  buffer.handles[pos].store(h, std::memory_order_relaxed);
+  return true;
+}
+
+void LIRSCacheShard::ApplyAccess(LIRSHandle* h,
+                                 autovector<LIRSHandle*>* deleted) {
+  if (h->InCache()) {
+    LIRS_Access(h);
+  }
+  if (Unref(h)) {
+    usage_ -= h->charge;
+    deleted->push_back(h);
+  }
+}
+
+void LIRSCacheShard::DrainAccessBuffers(autovector<LIRSHandle*>* deleted) {
+  for (auto& buffer : access_buffers_) {
+    uint32_t size = buffer.size.load(std::memory_order_relaxed);
+    if (size > AccessBuffer::kCapacity) {
+      size = AccessBuffer::kCapacity;
+    }
+    for (uint32_t i = 0; i < size; ++i) {
+      ApplyAccess(buffer.handles[i].load(std::memory_order_relaxed), deleted);
+    }
+    buffer.size.store(0, std::memory_order_relaxed);
+  }
 }
 
 void LIRSCacheShard::EraseUnRefEntries() {
   autovector<LIRSHandle*> last_reference_list;
   {
-    MutexLock l(&mutex_);
-    while (cache_.prev_queue != &cache_) {
-      LIRSHandle* old = cache_.prev_queue;
-      LIRS_Remove(old);
-      table_.Remove(old->key(), old->hash);
-      old->SetInvalid();
-      Unref(old);
-      usage_ -= old->charge;
-      last_reference_list.push_back(old);
+    WriteLock l(&mutex_);
+    DrainAccessBuffers(&last_reference_list);
+    autovector<LIRSHandle*> unref_list;
+    table_.ApplyToAllCacheEntries([&unref_list](LIRSHandle* h) {
+      if (h->refs.load(std::memory_order_relaxed) == 1) {
+        unref_list.push_back(h);
+      }
+    });
+    for (auto entry : unref_list) {
+      EvictEntry(entry, &last_reference_list);
     }
   }
 
@@ -210,111 +244,146 @@ void LIRSCacheShard::EraseUnRefEntries() {
 void LIRSCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                             bool thread_safe) {
   if (thread_safe) {
-    mutex_.Lock();
+    mutex_.ReadLock();
   }
   table_.ApplyToAllCacheEntries(
       [callback](LIRSHandle* h) { callback(h->value, h->charge); });
   if (thread_safe) {
-    mutex_.Unlock();
+    mutex_.ReadUnlock();
   }
 }
 
 void LIRSCacheShard::LIRS_Remove(LIRSHandle* e) {
-  if (e->next_queue != nullptr) {
+  if (e->InQueue()) {
     RemoveFromQueue(e);
   }
-  if (e->next_stack != nullptr) {
+  if (e->InStack()) {
     RemoveFromStack(e);
+  }
+  if (e->LIR()) {
     stack_usage_ -= e->charge;
+    StackPruning();
   }
 }
 
 void LIRSCacheShard::LIRS_Insert(LIRSHandle* e) {
+  PushToStack(e);
   if (stack_usage_ + e->charge <= stack_capacity_) {
-    PushToStack(e);
     e->SetLIR();
     stack_usage_ += e->charge;
   } else {
     PushToQueue(e);
     e->SetHIR();
+    StackPruning();
+  }
+}
+
+void LIRSCacheShard::LIRS_Access(LIRSHandle* e) {
+  if (e->LIR()) {
+    AdjustToStackTop(e);
+    StackPruning();
+  } else if (e->InStack()) {
+    // Accessed again while still in the stack, the reuse distance is smaller
+    // than the one of the stack bottom
+    RemoveFromQueue(e);
+    AdjustToStackTop(e);
+    e->SetLIR();
+    stack_usage_ += e->charge;
+    while (stack_usage_ > stack_capacity_ && cache_.prev_stack != e) {
+      DemoteStackBottom();
+    }
+  } else {
+    PushToStack(e);
+    AdjustToQueueTail(e);
+    StackPruning();
+  }
+}
+
+void LIRSCacheShard::EvictEntry(LIRSHandle* e,
+                                autovector<LIRSHandle*>* deleted) {
+  LIRS_Remove(e);
+  table_.Remove(e->key(), e->hash);
+  e->SetInvalid();
+  if (Unref(e)) {
+    usage_ -= e->charge;
+    deleted->push_back(e);
   }
 }
 
 void LIRSCacheShard::EvictFromLIRS(size_t charge,
                                    autovector<LIRSHandle*>* deleted) {
-  while (usage_ - stack_usage_ + charge > capacity_ - stack_capacity_ &&
-         cache_.prev_queue != &cache_) {
+  // Pinned handles are moved to the queue tail, stop at the first one seen
+  // twice
+  LIRSHandle* first_pinned = nullptr;
+  while (usage_ + charge > capacity_) {
     LIRSHandle* old = cache_.prev_queue;
-    assert(old->refs == 1);
-    LIRS_Remove(old);
-    table_.Remove(old->key(), old->hash);
-    old->SetInvalid();
-    Unref(old);
-    usage_ -= old->charge;
-    deleted->push_back(old);
-  }
-  while (stack_usage_ + charge > stack_capacity_ &&
-         cache_.prev_stack != &cache_) {
-    LIRSHandle* old = cache_.prev_stack;
-    stack_usage_ -= old->charge;
-    RemoveFromStack(old);
-    PushToQueue(old);
+    if (old == &cache_ || old == first_pinned) {
+      // Every HIR handle is pinned, fall back to the coldest LIR handle
+      old = DemoteStackBottom();
+      if (old == nullptr) {
+        break;
+      }
+    }
+    if (old->refs.load(std::memory_order_relaxed) > 1) {
+      if (first_pinned == nullptr) {
+        first_pinned = old;
+      }
+      AdjustToQueueTail(old);
+      continue;
+    }
+    EvictEntry(old, deleted);
   }
 }
 
 void LIRSCacheShard::SetCapacity(size_t capacity) {
-  MutexLock l(&mutex_);
-  capacity_ = capacity;
-  stack_capacity_ = capacity_ * irr_ratio_;
+  autovector<LIRSHandle*> last_reference_list;
+  {
+    WriteLock l(&mutex_);
+    DrainAccessBuffers(&last_reference_list);
+    capacity_ = capacity;
+    stack_capacity_ = capacity * irr_ratio_;
+    while (stack_usage_ > stack_capacity_) {
+      DemoteStackBottom();
+    }
+    EvictFromLIRS(0, &last_reference_list);
+  }
+
+  for (auto entry : last_reference_list) {
+    entry->Free();
+  }
 }
 
 Cache::Handle* LIRSCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  MutexLock l(&mutex_);
-  LIRSHandle* h = table_.Lookup(key, hash);
-  if (h != nullptr) {
-    if (!h->Remote()) {
-      if (h->refs == 1) {
-        LIRS_Remove(h);
-      } else {
-        if (h->LIR()) {
-          AdjustToStackTop(h);
-        } else if (h->HIR()) {
-          if (h->next_stack != nullptr) {
-            h->SetLIR();
-            AdjustToStackTop(h);
-            RemoveFromQueue(h);
-            AdjustStackBottom();
-          } else {
-            PushToStack(h);
-            AdjustToQueueTail(h);
-          }
-        } else {
-          ShiftQueueHead();
-          if (h->next_stack != nullptr) {
-            h->SetLIR();
-            AdjustToStackTop(h);
-            AdjustStackBottom();
-          } else {
-            h->SetHIR();
-            PushToStack(h);
-            PushToQueue(h);
-          }
-        }
-        StackPruning();
-      }
+  LIRSHandle* h;
+  {
+    ReadLock l(&mutex_);
+    h = table_.Lookup(key, hash);
+    if (h == nullptr) {
+      return nullptr;
     }
-    h->refs++;
+    // One reference for the caller, one for the access buffer
+    h->refs.fetch_add(2, std::memory_order_relaxed);
+    if (RecordAccess(h)) {
+      return reinterpret_cast<Cache::Handle*>(h);
+    }
+  }
+  autovector<LIRSHandle*> last_reference_list;
+  {
+    WriteLock l(&mutex_);
+    DrainAccessBuffers(&last_reference_list);
+    ApplyAccess(h, &last_reference_list);
+  }
+
+  for (auto entry : last_reference_list) {
+    entry->Free();
   }
   return reinterpret_cast<Cache::Handle*>(h);
 }
 
 bool LIRSCacheShard::Ref(Cache::Handle* h) {
   LIRSHandle* handle = reinterpret_cast<LIRSHandle*>(h);
-  MutexLock l(&mutex_);
-  if (handle->InCache() && handle->refs == 1) {
-    LIRS_Remove(handle);
-  }
-  handle->refs++;
+  // The caller holds a reference already
+  handle->refs.fetch_add(1, std::memory_order_relaxed);
   return true;
 }
 
@@ -323,30 +392,41 @@ bool LIRSCacheShard::Release(Cache::Handle* handle, bool force_erase) {
     return false;
   }
   LIRSHandle* e = reinterpret_cast<LIRSHandle*>(handle);
-  bool last_reference = false;
-  {
-    MutexLock l(&mutex_);
-    last_reference = Unref(e);
-    if (last_reference) {
+  if (!force_erase) {
+    if (Unref(e)) {
+      // Already out of the table, nobody else can reach it
       usage_ -= e->charge;
+      e->Free();
+      return true;
+    }
+    if (usage_ <= capacity_) {
+      return false;
     }
-    if (e->refs == 1 && e->InCache()) {
-      // The item is still in cache, and nobody else holds a reference to it
-      if (usage_ > capacity_ || force_erase) {
-        // the cache is full
-        // take this opportunity and remove the item
-        table_.Remove(e->key(), e->hash);
-        e->SetInvalid();
-        Unref(e);
+  }
+  bool last_reference = false;
+  autovector<LIRSHandle*> last_reference_list;
+  {
+    WriteLock l(&mutex_);
+    DrainAccessBuffers(&last_reference_list);
+    if (force_erase) {
+      if (e->refs.load(std::memory_order_relaxed) == 2 && e->InCache()) {
+        // Nobody else holds a reference to it
+        EvictEntry(e, &last_reference_list);
+      }
+      last_reference = Unref(e);
+      if (last_reference) {
         usage_ -= e->charge;
-        last_reference = true;
+        last_reference_list.push_back(e);
       }
+    } else {
+      // The cache is full, take this opportunity to shrink it
+      EvictFromLIRS(0, &last_reference_list);
     }
   }
 
   // free outside of mutex
-  if (last_reference) {
-    e->Free();
+  for (auto entry : last_reference_list) {
+    entry->Free();
   }
   return last_reference;
 }
@@ -365,16 +445,18 @@ Status LIRSCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   e->charge = charge;
   e->key_length = key.size();
   e->hash = hash;
-  e->refs = (handle == nullptr ? 1 : 2);
+  e->refs.store(handle == nullptr ? 1 : 2, std::memory_order_relaxed);
   e->next_stack = e->prev_stack = e->next_queue = e->prev_queue = nullptr;
+  e->SetInvalid();
   memcpy(e->key_data, key.data(), key.size());
 
   autovector<LIRSHandle*> last_reference_list;
   {
-    MutexLock l(&mutex_);
+    WriteLock l(&mutex_);
+    DrainAccessBuffers(&last_reference_list);
     EvictFromLIRS(charge, &last_reference_list);
     if (usage_ + charge > capacity_ && strict_capacity_limit_) {
-      e->refs = 0;
+      e->refs.store(0, std::memory_order_relaxed);
       last_reference_list.push_back(e);
       if (handle != nullptr) {
         *handle = nullptr;
@@ -384,16 +466,15 @@ Status LIRSCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       LIRSHandle* old = table_.Insert(e);
       usage_ += e->charge;
       if (old != nullptr) {
+        LIRS_Remove(old);
         old->SetInvalid();
         if (Unref(old)) {
           usage_ -= old->charge;
-          LIRS_Remove(old);
+          last_reference_list.push_back(old);
         }
       }
-      if (handle == nullptr) {
-        LIRS_Insert(e);
-      } else {
-        e->SetRemote();
+      LIRS_Insert(e);
+      if (handle != nullptr) {
         *handle = reinterpret_cast<Cache::Handle*>(e);
       }
       s = Status::OK();
@@ -408,53 +489,48 @@ Status LIRSCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 }
 
 void LIRSCacheShard::Erase(const Slice& key, uint32_t hash) {
-  LIRSHandle* e;
-  bool last_reference = false;
+  autovector<LIRSHandle*> last_reference_list;
   {
-    MutexLock l(&mutex_);
-    e = table_.Remove(key, hash);
+    WriteLock l(&mutex_);
+    DrainAccessBuffers(&last_reference_list);
+    LIRSHandle* e = table_.Lookup(key, hash);
     if (e != nullptr) {
-      last_reference = Unref(e);
-      if (last_reference) {
-        usage_ -= e->charge;
-      }
-      if (last_reference && e->InCache()) {
-        LIRS_Remove(e);
-      }
-      e->SetInvalid();
+      EvictEntry(e, &last_reference_list);
     }
   }
 
   // mutex not held here
-  // last_reference will only be true if e != nullptr
-  if (last_reference) {
-    e->Free();
+  for (auto entry : last_reference_list) {
+    entry->Free();
   }
 }
 
-size_t LIRSCacheShard::GetUsage() const {
-  MutexLock l(&mutex_);
-  return usage_;
-}
+size_t LIRSCacheShard::GetUsage() const { return usage_; }
 
 size_t LIRSCacheShard::GetPinnedUsage() const {
-  MutexLock l(&mutex_);
-  assert(usage_ >= stack_usage_);
-  return usage_ - stack_usage_;
+  size_t pinned_usage = 0;
+  ReadLock l(&mutex_);
+  // Pending accesses are counted as pinned until they are drained
+  table_.ApplyToAllCacheEntries([&pinned_usage](LIRSHandle* h) {
+    if (h->refs.load(std::memory_order_relaxed) > 1) {
+      pinned_usage += h->charge;
+    }
+  });
+  return pinned_usage;
 }
 
 std::string LIRSCacheShard::GetPrintableOptions() const {
   const int kBufferSize = 200;
   char buffer[kBufferSize];
   {
-    MutexLock l(&mutex_);
+    ReadLock l(&mutex_);
     snprintf(buffer, kBufferSize, "    irr_ratio : %.3lf\n", irr_ratio_);
   }
   return std::string(buffer);
 }
 
 void LIRSCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
-  MutexLock l(&mutex_);
+  WriteLock l(&mutex_);
   strict_capacity_limit_ = strict_capacity_limit;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 
 #include "cache/sharded_cache.h"
@@ -19,26 +20,29 @@ struct LIRSHandle {
   LIRSHandle* prev_queue;
   size_t charge;
   size_t key_length;
-  uint32_t refs;
+  // One reference is held by the cache while the handle is in the table, one
+  // by each pending access in an access buffer, the rest by the users.
+  // Increased without the write lock, so the LIRS structures must not depend
+  // on it.
+  std::atomic<uint32_t> refs;
   uint32_t hash;  // Hash of key(); used for fast sharding and comparisons
 
-  enum State { kRemote = 0, kLIR, kHIR, kNHIR, kInvalid } state;
+  // kLIR handles are in the stack, kHIR handles are in the queue and may be
+  // in the stack as well
+  enum State { kLIR = 0, kHIR, kInvalid } state;
 
   char key_data[1];  // Beginning of key
 
   Slice key() const { return Slice(key_data, key_length); }
 
-  bool Remote() { return state == kRemote; }
   bool LIR() { return state == kLIR; }
   bool HIR() { return state == kHIR; }
-  bool InCache() { return state == kLIR || state == kHIR || state == kNHIR; }
-  bool NHIR() { return state == kNHIR; }
-  bool Valid() { return state != kInvalid; }
+  bool InCache() { return state == kLIR || state == kHIR; }
+  bool InStack() { return next_stack != nullptr; }
+  bool InQueue() { return next_queue != nullptr; }
 
-  void SetRemote() { state = kRemote; }
   void SetLIR() { state = kLIR; }
   void SetHIR() { state = kHIR; }
-  void SetNHIR() { state = kNHIR; }
   void SetInvalid() { state = kInvalid; }
 
   void Free() {
@@ -60,7 +64,7 @@ class LIRSHandleTable {
   LIRSHandle* Remove(const Slice& key, uint32_t hash);
 
   template <typename T>
-  void ApplyToAllCacheEntries(T func) {
+  void ApplyToAllCacheEntries(T func) const {
     for (uint32_t i = 0; i < length_; i++) {
       LIRSHandle* h = list_[i];
       while (h != nullptr) {
@@ -87,6 +91,13 @@ class LIRSHandleTable {
   uint32_t elems_;
 };
 
+// Lookup only takes the shard lock in read mode: the hash probe and the ref
+// increment don't modify the table, and the recency update a hit implies is
+// recorded in an access buffer instead of being applied to the LIRS stack and
+// queue right away. The buffers are drained under the write lock, before any
+// other modification of the shard, or by the Lookup which finds its buffer
+// full. Each pending access holds a reference, so buffered handles stay valid
+// until they are drained.
 class ALIGN_AS(CACHE_LINE_SIZE) LIRSCacheShard : public CacheShard {
  public:
   LIRSCacheShard(size_t capacity, bool strict_capacity_limit,
@@ -119,29 +130,50 @@ class ALIGN_AS(CACHE_LINE_SIZE) LIRSCacheShard : public CacheShard {
   virtual std::string GetPrintableOptions() const override;
 
  private:
+  // Lookup hits not yet applied to the LIRS structures. Lookups pick a
+  // buffer by the CPU they run on, so concurrent hits rarely share one.
+  struct ALIGN_AS(CACHE_LINE_SIZE) AccessBuffer {
+    static const uint32_t kCapacity = 32;
+
+    // May exceed kCapacity while the buffer is full
+    std::atomic<uint32_t> size;
+    std::atomic<LIRSHandle*> handles[kCapacity];
+  };
+  static const size_t kNumAccessBuffers = 8;
+
   void PushToQueue(LIRSHandle* h);
   void RemoveFromQueue(LIRSHandle* h);
   void AdjustToQueueTail(LIRSHandle* h);
-  void ShiftQueueHead();
   void PushToStack(LIRSHandle* h);
   void RemoveFromStack(LIRSHandle* h);
   void AdjustToStackTop(LIRSHandle* h);
-  void AdjustStackBottom();
+  LIRSHandle* DemoteStackBottom();
   void StackPruning();
   void LIRS_Remove(LIRSHandle* h);
   void LIRS_Insert(LIRSHandle* h);
+  void LIRS_Access(LIRSHandle* h);
   bool Unref(LIRSHandle* h);
+  void EvictEntry(LIRSHandle* h, autovector<LIRSHandle*>* deleted);
   void EvictFromLIRS(size_t charge, autovector<LIRSHandle*>* deleted);
 
-  size_t capacity_;
+  // Called with the read lock held, return false if the buffer is full
+  bool RecordAccess(LIRSHandle* h);
+  // Apply an access recorded in a buffer and drop its reference
+  void ApplyAccess(LIRSHandle* h, autovector<LIRSHandle*>* deleted);
+  // Called with the write lock held
+  void DrainAccessBuffers(autovector<LIRSHandle*>* deleted);
+
+  std::atomic<size_t> capacity_;
   size_t stack_capacity_;
-  size_t usage_;
+  std::atomic<size_t> usage_;
+  // Total charge of the kLIR handles
   size_t stack_usage_;
   double irr_ratio_;
   LIRSHandle cache_;
   LIRSHandleTable table_;
   bool strict_capacity_limit_;
-  mutable port::Mutex mutex_;
+  AccessBuffer access_buffers_[kNumAccessBuffers];
+  mutable port::RWMutex mutex_;
 };
 
 class LIRSCache : public ShardedCache {
@@ -166,16 +166,18 @@ Status BuildTable(
       FileMetaData* current_output = nullptr;
       TableProperties* current_prop = nullptr;
       std::unique_ptr<ValueExtractor> value_meta_extractor;
+      bool keep_value_location = false;
       Status (*trans_to_separate_callback)(void* args, const Slice& key,
                                            LazyBuffer& value) = nullptr;
       void* trans_to_separate_callback_args = nullptr;
 
       Status TransToSeparate(const Slice& internal_key, LazyBuffer& value,
                              const Slice& meta, bool is_merge,
-                             bool is_index) override {
+                             bool is_index, uint64_t location) override {
         return SeparateHelper::TransToSeparate(
             internal_key, value, value.file_number(), meta, is_merge, is_index,
-            value_meta_extractor.get());
+            value_meta_extractor.get(),
+            keep_value_location ? location : kNoLocation);
       }
 
       Status TransToSeparate(const Slice& internal_key,
@@ -199,6 +201,14 @@ Status BuildTable(
       separate_helper.value_meta_extractor =
           ioptions.value_meta_extractor_factory->CreateValueExtractor(context);
     }
+    separate_helper.keep_value_location =
+        mutable_cf_options.enable_blob_value_location;
+
+    // Log ssts are built in a single pass, so values can be separated on flush
+    // even if the table builder needs a second pass.
+    const bool use_log_sst = mutable_cf_options.enable_log_sst_flush &&
+                             ioptions.table_factory->IsLogSstSupported();
+    const SstPurpose blob_purpose = use_log_sst ? kLogSst : kEssenceSst;
 
     auto finish_output_blob_sst = [&] {
       Status status;
@@ -206,7 +216,7 @@ Status BuildTable(
       FileMetaData* blob_meta = separate_helper.current_output;
       blob_meta->prop.num_entries = blob_builder->NumEntries();
       blob_meta->prop.num_deletions = 0;
-      blob_meta->prop.purpose = kEssenceSst;
+      blob_meta->prop.purpose = blob_purpose;
       blob_meta->prop.flags |= TablePropertyCache::kNoRangeDeletions;
       status = blob_builder->Finish(&blob_meta->prop, nullptr);
       TableProperties& tp = *separate_helper.current_prop;
@@ -234,6 +244,17 @@ Status BuildTable(
     size_t target_blob_file_size = MaxBlobSize(
         mutable_cf_options, ioptions.num_levels, ioptions.compaction_style);
 
+    // Where first pass put each separated value, in iteration order, so that
+    // second pass can write the same value index
+    struct WrittenValue {
+      uint64_t file_number;
+      SequenceNumber sequence;
+      uint64_t location;
+    };
+    const bool need_second_pass =
+        ioptions.table_factory->IsBuilderNeedSecondPass();
+    std::vector<WrittenValue> written_values;
+
     auto trans_to_separate = [&](const Slice& key, LazyBuffer& value) {
       assert(value.file_number() == uint64_t(-1));
       Status status;
@@ -283,26 +304,71 @@ Status BuildTable(
             int_tbl_prop_collector_factories_for_blob, column_family_id,
             column_family_name, separate_helper.file_writer.get(), compression,
             compression_opts, -1 /* level */, 0 /* compaction_load */, nullptr,
-            true));
+            true, 0 /* creation_time */, 0 /* oldest_key_time */,
+            blob_purpose));
         blob_builder = separate_helper.builder.get();
       }
       if (status.ok()) {
         status = blob_builder->Add(key, value);
       }
       if (status.ok()) {
-        blob_meta->UpdateBoundaries(key, GetInternalKeySeqno(key));
+        SequenceNumber sequence = GetInternalKeySeqno(key);
+        uint64_t location = separate_helper.keep_value_location
+                                ? blob_builder->LastEntryLocation()
+                                : SeparateHelper::kNoLocation;
+        blob_meta->UpdateBoundaries(key, sequence);
+        if (need_second_pass) {
+          written_values.emplace_back(
+              WrittenValue{blob_meta->fd.GetNumber(), sequence, location});
+        }
         status = SeparateHelper::TransToSeparate(
             key, value, blob_meta->fd.GetNumber(), Slice(),
             GetInternalKeyType(key) == kTypeMerge, false,
-            separate_helper.value_meta_extractor.get());
+            separate_helper.value_meta_extractor.get(), location);
       }
       return status;
     };
 
+    // Second pass sees the same values again, they are already in the blob
+    // ssts written by first pass, find the one holding the key. The values
+    // come in the order of first pass, restarting when the pass restarts.
+    size_t written_cursor = 0;
+    std::string last_written_key;
+    auto trans_to_written_blob = [&](const Slice& key, LazyBuffer& value) {
+      auto blob_begin = meta_vec->begin() + 1;
+      auto it = std::lower_bound(
+          blob_begin, meta_vec->end(), key,
+          [&](const FileMetaData& f, const Slice& k) {
+            return internal_comparator.Compare(f.largest.Encode(), k) < 0;
+          });
+      if (it == meta_vec->end()) {
+        return Status::Corruption("BuildTable: separated value lost");
+      }
+      if (!last_written_key.empty() &&
+          internal_comparator.Compare(key, last_written_key) <= 0) {
+        written_cursor = 0;
+      }
+      last_written_key.assign(key.data(), key.size());
+      // Without a match the value index just goes without the location
+      uint64_t location = SeparateHelper::kNoLocation;
+      if (written_cursor < written_values.size()) {
+        auto& written = written_values[written_cursor];
+        if (written.file_number == it->fd.GetNumber() &&
+            written.sequence == GetInternalKeySeqno(key)) {
+          location = written.location;
+          ++written_cursor;
+        }
+      }
+      return SeparateHelper::TransToSeparate(
+          key, value, it->fd.GetNumber(), Slice(),
+          GetInternalKeyType(key) == kTypeMerge, false,
+          separate_helper.value_meta_extractor.get(), location);
+    };
+
     separate_helper.output = meta_vec;
     separate_helper.prop = table_properties_vec;
     BlobConfig blob_config = mutable_cf_options.get_blob_config();
-    if (ioptions.table_factory->IsBuilderNeedSecondPass()) {
+    if (ioptions.table_factory->IsBuilderNeedSecondPass() && !use_log_sst) {
       blob_config.blob_size = size_t(-1);
     } else {
       separate_helper.trans_to_separate_callback =
@@ -354,7 +420,8 @@ Status BuildTable(
           internal_comparator.user_comparator(), merge_ptr, kMaxSequenceNumber,
           &snapshots, earliest_write_conflict_snapshot, snapshot_checker, env,
           false /* report_detailed_time */,
-          true /* internal key corruption is not ok */, range_del_agg.get());
+          true /* internal key corruption is not ok */, range_del_agg.get(),
+          nullptr /* compaction */, blob_config);
     };
     std::unique_ptr<InternalIterator> second_pass_iter(NewCompactionIterator(
         c_style_callback(make_compaction_iterator), &make_compaction_iterator));
@@ -400,6 +467,11 @@ Status BuildTable(
         s = finish_output_blob_sst();
       }
     }
+    if (separate_helper.trans_to_separate_callback != nullptr) {
+      separate_helper.trans_to_separate_callback =
+          c_style_callback(trans_to_written_blob);
+      separate_helper.trans_to_separate_callback_args = &trans_to_written_blob;
+    }
     if (!s.ok() || empty) {
       builder->Abandon();
     } else {
@@ -175,6 +175,23 @@ Status CheckCFPathsSupported(const DBOptions& db_options,
   return Status::OK();
 }
 
+Status CheckWriteBufferManagerSupported(const DBOptions& db_options,
+                                        const ColumnFamilyOptions& cf_options) {
+  if (cf_options.cf_write_buffer_manager == nullptr) {
+    return Status::OK();
+  }
+  // The write path only checks the DB budget, which sees its descendants
+  for (auto node = cf_options.cf_write_buffer_manager.get(); node != nullptr;
+       node = node->parent()) {
+    if (node == db_options.write_buffer_manager.get()) {
+      return Status::OK();
+    }
+  }
+  return Status::InvalidArgument(
+      "cf_write_buffer_manager must descend from "
+      "DBOptions::write_buffer_manager");
+}
+
 ColumnFamilyOptions SanitizeOptions(const ImmutableDBOptions& db_options,
                                     const ColumnFamilyOptions& src) {
   ColumnFamilyOptions result = src;
@@ -343,6 +360,12 @@ ColumnFamilyOptions SanitizeOptions(const ImmutableDBOptions& db_options,
   if (result.maintainer_job_ratio > 1) {
     result.maintainer_job_ratio = 1;
   }
+  if (result.adaptive_blob_size_write_weight < 0) {
+    result.adaptive_blob_size_write_weight = 0;
+  }
+  if (result.adaptive_blob_size_write_weight > 1) {
+    result.adaptive_blob_size_write_weight = 1;
+  }
 
   return result;
 }
@@ -429,7 +452,9 @@ ColumnFamilyData::ColumnFamilyData(
       mutable_cf_options_(initial_cf_options_, db_options.env),
       is_delete_range_supported_(
           cf_options.table_factory->IsDeleteRangeSupported()),
-      write_buffer_manager_(write_buffer_manager),
+      write_buffer_manager_(ioptions_.cf_write_buffer_manager != nullptr
+                                ? ioptions_.cf_write_buffer_manager
+                                : write_buffer_manager),
       mem_(nullptr),
       imm_(ioptions_.min_write_buffer_number_to_merge,
            ioptions_.max_write_buffer_number_to_maintain),
@@ -444,6 +469,7 @@ ColumnFamilyData::ColumnFamilyData(
       queued_for_flush_(0),
       queued_for_compaction_(false),
       queued_for_garbage_collection_(false),
+      ttl_gc_queue_initialized_(false),
       prev_compaction_needed_bytes_(0),
       allow_2pc_(db_options.allow_2pc),
       last_memtable_id_(0) {
@@ -453,7 +479,9 @@ ColumnFamilyData::ColumnFamilyData(
   if (_dummy_versions != nullptr) {
     internal_stats_.reset(
         new InternalStats(ioptions_.num_levels, db_options.env, this));
-    table_cache_.reset(new TableCache(ioptions_, env_options, _table_cache));
+    table_cache_.reset(new TableCache(ioptions_, env_options, _table_cache,
+                                      column_family_set->block_cache_tracer_,
+                                      column_family_set->db_id_));
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(new LevelCompactionPicker(
           table_cache_.get(), env_options, ioptions_, &internal_comparator_));
@@ -927,6 +955,118 @@ void ColumnFamilyData::SetCurrent(Version* current_version) {
   current_ = current_version;
 }
 
+void ColumnFamilyData::ResetTtlGCQueue() {
+  std::vector<TtlGCEntry> entries;
+  auto* vstorage = current_->storage_info();
+  for (int level = 0; level < vstorage->num_non_empty_levels(); ++level) {
+    for (auto f : vstorage->LevelFiles(level)) {
+      uint64_t due_time = std::min(f->prop.earliest_time_begin_compact,
+                                   f->prop.latest_time_end_compact);
+      if (due_time != port::kMaxUint64) {
+        entries.emplace_back(TtlGCEntry{due_time, f->fd.GetNumber(), level});
+      }
+    }
+  }
+  // Heapify at once instead of pushing one by one
+  ttl_gc_queue_ = decltype(ttl_gc_queue_)(std::greater<TtlGCEntry>(),
+                                          std::move(entries));
+  ttl_gc_queue_initialized_ = true;
+}
+
+void ColumnFamilyData::AddToTtlGCQueue(int level, const FileMetaData& f) {
+  if (!ttl_gc_queue_initialized_ || level < 0) {
+    return;
+  }
+  uint64_t due_time = std::min(f.prop.earliest_time_begin_compact,
+                               f.prop.latest_time_end_compact);
+  if (due_time != port::kMaxUint64) {
+    ttl_gc_queue_.push(TtlGCEntry{due_time, f.fd.GetNumber(), level});
+  }
+}
+
+bool ColumnFamilyData::PopDueTtlGCEntry(uint64_t now, TtlGCEntry* entry) {
+  if (ttl_gc_queue_.empty() || ttl_gc_queue_.top().due_time > now) {
+    return false;
+  }
+  *entry = ttl_gc_queue_.top();
+  ttl_gc_queue_.pop();
+  return true;
+}
+
+namespace {
+// Halve the value size histogram once it holds more values than this, so
+// the picked blob size follows the recent value size distribution.
+const uint64_t kValueSizeHistogramDecayValues = 1ull << 22;
+}  // anonymous namespace
+
+void ColumnFamilyData::UpdateValueSizeHistogram(const TableProperties& props) {
+  auto it = props.user_collected_properties.find(
+      TablePropertiesNames::kValueSizeHistogram);
+  if (it == props.user_collected_properties.end()) {
+    return;
+  }
+  ValueSizeHistogram histogram;
+  if (!histogram.Decode(it->second)) {
+    ROCKS_LOG_WARN(ioptions_.info_log,
+                   "[%s] Skip corrupted value size histogram", name_.c_str());
+    return;
+  }
+  std::lock_guard<std::mutex> lock(value_size_histogram_mutex_);
+  value_size_histogram_.Merge(histogram);
+  while (value_size_histogram_.num_values() > kValueSizeHistogramDecayValues) {
+    value_size_histogram_.Decay();
+  }
+}
+
+void ColumnFamilyData::InitValueSizeHistogram(Version* version) {
+  TablePropertiesCollection props;
+  Status s = version->GetPropertiesOfAllTables(&props);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(ioptions_.info_log,
+                   "[%s] Skip value size histograms of live ssts: %s",
+                   name_.c_str(), s.ToString().c_str());
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(value_size_histogram_mutex_);
+    value_size_histogram_.Clear();
+  }
+  for (auto& pair : props) {
+    UpdateValueSizeHistogram(*pair.second);
+  }
+}
+
+BlobConfig ColumnFamilyData::GetBlobConfig(
+    const MutableCFOptions& mutable_cf_options, int level) const {
+  BlobConfig blob_config = mutable_cf_options.get_blob_config();
+  if (!mutable_cf_options.enable_adaptive_blob_size || level < 0 ||
+      blob_config.blob_size == size_t(-1)) {
+    return blob_config;
+  }
+  int num_levels = ioptions_.num_levels;
+  double rewrite_ratio =
+      static_cast<double>(std::max(num_levels - level, 1)) / num_levels;
+  std::lock_guard<std::mutex> lock(value_size_histogram_mutex_);
+  blob_config.blob_size = value_size_histogram_.PickBlobSize(
+      mutable_cf_options.adaptive_blob_size_write_weight, rewrite_ratio,
+      blob_config.blob_size);
+  return blob_config;
+}
+
+std::string ColumnFamilyData::GetAdaptiveBlobSizeString(
+    const MutableCFOptions& mutable_cf_options) const {
+  std::string result;
+  char buffer[64];
+  for (int level = 0; level < ioptions_.num_levels; ++level) {
+    snprintf(buffer, sizeof(buffer), "L%d: %" ROCKSDB_PRIszt "\n", level,
+             GetBlobConfig(mutable_cf_options, level).blob_size);
+    result.append(buffer);
+  }
+  std::lock_guard<std::mutex> lock(value_size_histogram_mutex_);
+  result.append(value_size_histogram_.ToString());
+  return result;
+}
+
 void ColumnFamilyData::ForEachVersionList(void (*callback)(void*, Version*),
                                           void* arg) {
   for (Version* v = dummy_versions_->Next(); v != dummy_versions_;
@@ -1326,7 +1466,8 @@ ColumnFamilySet::ColumnFamilySet(const std::string& dbname,
                                  const EnvOptions& env_options,
                                  Cache* table_cache,
                                  WriteBufferManager* write_buffer_manager,
-                                 WriteController* write_controller)
+                                 WriteController* write_controller,
+                                 BlockCacheTracer* const block_cache_tracer)
     : max_column_family_(0),
       dummy_cfd_(new ColumnFamilyData(0, "", nullptr, nullptr, nullptr,
                                       ColumnFamilyOptions(), *db_options,
@@ -1337,7 +1478,8 @@ ColumnFamilySet::ColumnFamilySet(const std::string& dbname,
       env_options_(env_options),
       table_cache_(table_cache),
       write_buffer_manager_(write_buffer_manager),
-      write_controller_(write_controller) {
+      write_controller_(write_controller),
+      block_cache_tracer_(block_cache_tracer) {
   // initialize linked list
   dummy_cfd_->prev_ = dummy_cfd_;
   dummy_cfd_->next_ = dummy_cfd_;
@@ -10,6 +10,8 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>
+#include <queue>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -45,6 +47,7 @@ class DBImpl;
 class LogBuffer;
 class InstrumentedMutex;
 class InstrumentedMutexLock;
+class BlockCacheTracer;
 struct SuperVersionContext;
 
 extern const double kIncSlowdownRatio;
@@ -146,6 +149,9 @@ extern Status CheckConcurrentWritesSupported(
 extern Status CheckCFPathsSupported(const DBOptions& db_options,
                                     const ColumnFamilyOptions& cf_options);
 
+extern Status CheckWriteBufferManagerSupported(
+    const DBOptions& db_options, const ColumnFamilyOptions& cf_options);
+
 extern ColumnFamilyOptions SanitizeOptions(const ImmutableDBOptions& db_options,
                                            const ColumnFamilyOptions& src);
 
@@ -214,6 +220,10 @@ class ColumnFamilyData {
   // thread-safe
   const EnvOptions* soptions() const;
   const ImmutableCFOptions* ioptions() const { return &ioptions_; }
+  // Budget node memtables of this column family reserve memory from
+  WriteBufferManager* write_buffer_manager() const {
+    return write_buffer_manager_;
+  }
   // REQUIRES: DB mutex held
   // This returns the MutableCFOptions used by current SuperVersion
   // You should use this API to reference MutableCFOptions most of the time.
@@ -383,6 +393,52 @@ class ColumnFamilyData {
     return queued_for_garbage_collection_;
   }
 
+  // A file of the TTL GC expiry index, due_time is the earlier one of
+  // earliest_time_begin_compact and latest_time_end_compact
+  struct TtlGCEntry {
+    uint64_t due_time;
+    uint64_t file_number;
+    int level;
+
+    bool operator>(const TtlGCEntry& other) const {
+      return due_time > other.due_time;
+    }
+  };
+
+  // The expiry index lets DBImpl::ScheduleTtlGC() visit only the files that
+  // became due instead of every file of the current version. It is seeded
+  // from the current version by ResetTtlGCQueue() and then fed with the
+  // files of every installed VersionEdit. Files removed since they were
+  // pushed stay in the queue until they are popped or the queue is reset.
+  // REQUIRE: DB mutex held
+  bool ttl_gc_queue_initialized() const { return ttl_gc_queue_initialized_; }
+  size_t ttl_gc_queue_size() const { return ttl_gc_queue_.size(); }
+  void ResetTtlGCQueue();
+  void AddToTtlGCQueue(int level, const FileMetaData& f);
+  void AddToTtlGCQueue(const TtlGCEntry& entry) { ttl_gc_queue_.push(entry); }
+  // Pop the first entry if it is due at now
+  bool PopDueTtlGCEntry(uint64_t now, TtlGCEntry* entry);
+
+  // Adaptive blob size, fed with the value size histograms of the ssts
+  // written by flushes only. Compactions and GC rewrite values that were
+  // already counted by the flush that wrote them first. Older samples decay
+  // as newer ones come in.
+  // thread-safe
+  void UpdateValueSizeHistogram(const TableProperties& props);
+  // Rebuild the histogram from the value size histograms of the live ssts of
+  // version, which count every live value once. Called when the recovered
+  // version is installed at open, if enable_adaptive_blob_size is set.
+  void InitValueSizeHistogram(Version* version);
+  // thread-safe
+  // Separation config for compaction outputs at level. The blob size is
+  // picked from the value size histogram if enable_adaptive_blob_size is set,
+  // level -1 always gets the static config.
+  BlobConfig GetBlobConfig(const MutableCFOptions& mutable_cf_options,
+                           int level) const;
+  // thread-safe
+  std::string GetAdaptiveBlobSizeString(
+      const MutableCFOptions& mutable_cf_options) const;
+
   enum class WriteStallCause {
     kNone,
     kMemtableLimit,
@@ -495,6 +551,16 @@ class ColumnFamilyData {
 
   bool queued_for_garbage_collection_;
 
+  // Expiry index for TTL GC, protected by DB mutex
+  std::priority_queue<TtlGCEntry, std::vector<TtlGCEntry>,
+                      std::greater<TtlGCEntry>>
+      ttl_gc_queue_;
+  bool ttl_gc_queue_initialized_;
+
+  // Value size histogram for adaptive blob size
+  mutable std::mutex value_size_histogram_mutex_;
+  ValueSizeHistogram value_size_histogram_;
+
   uint64_t prev_compaction_needed_bytes_;
 
   // if the database was opened with 2pc enabled
@@ -554,7 +620,8 @@ class ColumnFamilySet {
                   const ImmutableDBOptions* db_options,
                   const EnvOptions& env_options, Cache* table_cache,
                   WriteBufferManager* write_buffer_manager,
-                  WriteController* write_controller);
+                  WriteController* write_controller,
+                  BlockCacheTracer* const block_cache_tracer = nullptr);
   ~ColumnFamilySet();
 
   ColumnFamilyData* GetDefault() const;
@@ -583,6 +650,9 @@ class ColumnFamilySet {
 
   Cache* get_table_cache() { return table_cache_; }
 
+  // Must be set before the column families are created
+  void set_db_id(const std::string& db_id) { db_id_ = db_id; }
+
  private:
   friend class ColumnFamilyData;
   // helper function that gets called from cfd destructor
@@ -613,6 +683,8 @@ class ColumnFamilySet {
   Cache* table_cache_;
   WriteBufferManager* write_buffer_manager_;
   WriteController* write_controller_;
+  BlockCacheTracer* const block_cache_tracer_;
+  std::string db_id_;
 };
 
 // We use ColumnFamilyMemTablesImpl to provide WriteBatch a way to access
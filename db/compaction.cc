@@ -23,6 +23,7 @@
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/terark_namespace.h"
 #include "util/c_style_callback.h"
+#include "util/coding.h"
 #include "util/string_util.h"
 #include "util/sync_point.h"
 #include "utilities/util/factory.h"
@@ -672,6 +673,416 @@ int Compaction::GetInputBaseLevel() const {
   return input_vstorage_->base_level();
 }
 
+namespace {
+// "TDCW" in little endian, followed by a varint32 format version
+const uint32_t kCompactionWorkerMagic = 0x57434454;
+const uint32_t kCompactionWorkerFormatVersion = 1;
+
+void PutBool(std::string* dst, bool value) { dst->push_back(value ? 1 : 0); }
+
+bool GetBool(Slice* input, bool* value) {
+  if (input->empty()) {
+    return false;
+  }
+  *value = (*input)[0] != 0;
+  input->remove_prefix(1);
+  return true;
+}
+
+// Every element of a container takes at least min_bytes on the wire. Sizing
+// a container by a count the remaining input can't hold would let a corrupt
+// or truncated message allocate without bound.
+bool CheckCount(const Slice& input, uint64_t count, size_t min_bytes) {
+  return count <= input.size() / min_bytes;
+}
+
+// Smallest encodings of the container elements, every varint, bool and
+// length prefix takes at least one byte
+const size_t kMinDependenceBytes = 2;
+const size_t kMinFileMetaDataBytes = 18;
+const size_t kMinFileMetaDataPairBytes = 1 + kMinFileMetaDataBytes;
+const size_t kMinInputBytes = 2;
+const size_t kMinCollectorBytes = 2;
+const size_t kMinResultFileBytes = 7;
+
+bool GetString(Slice* input, std::string* value) {
+  Slice slice;
+  if (!GetLengthPrefixedSlice(input, &slice)) {
+    return false;
+  }
+  value->assign(slice.data(), slice.size());
+  return true;
+}
+
+void PutStatus(std::string* dst, const Status& s) {
+  dst->push_back(static_cast<char>(s.code()));
+  dst->push_back(static_cast<char>(s.subcode()));
+  dst->push_back(static_cast<char>(s.severity()));
+  PutLengthPrefixedSlice(dst, s.getState() == nullptr ? "" : s.getState());
+}
+
+bool GetStatus(Slice* input, Status* s) {
+  if (input->size() < 3) {
+    return false;
+  }
+  unsigned char code = (*input)[0];
+  unsigned char subcode = (*input)[1];
+  unsigned char sev = (*input)[2];
+  input->remove_prefix(3);
+  std::string state;
+  if (!GetString(input, &state)) {
+    return false;
+  }
+  *s = Status(code, subcode, sev, state.empty() ? nullptr : state.c_str());
+  return true;
+}
+
+void PutFileMetaData(std::string* dst, const FileMetaData& f) {
+  PutVarint64Varint64(dst, f.fd.packed_number_and_path_id, f.fd.file_size);
+  PutVarint64Varint64(dst, f.fd.smallest_seqno, f.fd.largest_seqno);
+  PutLengthPrefixedSlice(dst, *f.smallest.rep());
+  PutLengthPrefixedSlice(dst, *f.largest.rep());
+  PutVarint64Varint64(dst, f.prop.num_entries, f.prop.num_deletions);
+  PutVarint64Varint64(dst, f.prop.raw_key_size, f.prop.raw_value_size);
+  dst->push_back(static_cast<char>(f.prop.flags));
+  dst->push_back(static_cast<char>(f.prop.purpose));
+  PutVarint32Varint64(dst, f.prop.max_read_amp,
+                      DoubleToU64(f.prop.read_amp));
+  PutVarint64(dst, f.prop.dependence.size());
+  for (auto& dependence : f.prop.dependence) {
+    PutVarint64Varint64(dst, dependence.file_number, dependence.entry_count);
+  }
+  PutVarint64(dst, f.prop.inheritance.size());
+  for (auto file_number : f.prop.inheritance) {
+    PutVarint64(dst, file_number);
+  }
+  PutVarint64Varint64(dst, f.prop.earliest_time_begin_compact,
+                      f.prop.latest_time_end_compact);
+}
+
+bool GetFileMetaData(Slice* input, FileMetaData* f) {
+  Slice smallest, largest;
+  uint32_t max_read_amp;
+  uint64_t read_amp, size;
+  if (!GetVarint64(input, &f->fd.packed_number_and_path_id) ||
+      !GetVarint64(input, &f->fd.file_size) ||
+      !GetVarint64(input, &f->fd.smallest_seqno) ||
+      !GetVarint64(input, &f->fd.largest_seqno) ||
+      !GetLengthPrefixedSlice(input, &smallest) ||
+      !GetLengthPrefixedSlice(input, &largest) ||
+      !GetVarint64(input, &f->prop.num_entries) ||
+      !GetVarint64(input, &f->prop.num_deletions) ||
+      !GetVarint64(input, &f->prop.raw_key_size) ||
+      !GetVarint64(input, &f->prop.raw_value_size) || input->size() < 2) {
+    return false;
+  }
+  f->smallest.DecodeFrom(smallest);
+  f->largest.DecodeFrom(largest);
+  f->prop.flags = static_cast<uint8_t>((*input)[0]);
+  f->prop.purpose = static_cast<uint8_t>((*input)[1]);
+  input->remove_prefix(2);
+  if (!GetVarint32(input, &max_read_amp) || !GetVarint64(input, &read_amp) ||
+      !GetVarint64(input, &size)) {
+    return false;
+  }
+  f->prop.max_read_amp = static_cast<uint16_t>(max_read_amp);
+  f->prop.read_amp = static_cast<float>(U64ToDouble(read_amp));
+  if (!CheckCount(*input, size, kMinDependenceBytes)) {
+    return false;
+  }
+  f->prop.dependence.resize(size);
+  for (auto& dependence : f->prop.dependence) {
+    if (!GetVarint64(input, &dependence.file_number) ||
+        !GetVarint64(input, &dependence.entry_count)) {
+      return false;
+    }
+  }
+  if (!GetVarint64(input, &size) || !CheckCount(*input, size, 1)) {
+    return false;
+  }
+  f->prop.inheritance.resize(size);
+  for (auto& file_number : f->prop.inheritance) {
+    if (!GetVarint64(input, &file_number)) {
+      return false;
+    }
+  }
+  return GetVarint64(input, &f->prop.earliest_time_begin_compact) &&
+         GetVarint64(input, &f->prop.latest_time_end_compact);
+}
+
+void PutHeader(std::string* dst) {
+  PutFixed32(dst, kCompactionWorkerMagic);
+  PutVarint32(dst, kCompactionWorkerFormatVersion);
+}
+
+Status GetHeader(Slice* input, const char* what) {
+  uint32_t magic, version;
+  if (!GetFixed32(input, &magic) || magic != kCompactionWorkerMagic) {
+    return Status::Corruption(what, "bad magic number");
+  }
+  if (!GetVarint32(input, &version) ||
+      version != kCompactionWorkerFormatVersion) {
+    return Status::NotSupported(what, "unknown format version");
+  }
+  return Status::OK();
+}
+}  // namespace
+
+void CompactionWorkerContext::EncodeTo(std::string* dst) const {
+  PutHeader(dst);
+  PutLengthPrefixedSlice(dst, user_comparator);
+  PutLengthPrefixedSlice(dst, merge_operator);
+  PutLengthPrefixedSlice(dst, merge_operator_data);
+  PutLengthPrefixedSlice(dst, value_meta_extractor_factory);
+  PutLengthPrefixedSlice(dst, value_meta_extractor_factory_options);
+  PutLengthPrefixedSlice(dst, compaction_filter);
+  PutLengthPrefixedSlice(dst, compaction_filter_factory);
+  PutBool(dst, compaction_filter_context.is_full_compaction);
+  PutBool(dst, compaction_filter_context.is_manual_compaction);
+  PutBool(dst, compaction_filter_context.is_bottommost_level);
+  PutVarint32(dst, compaction_filter_context.column_family_id);
+  PutLengthPrefixedSlice(dst, compaction_filter_data);
+  PutVarint64Varint64(dst, blob_config.blob_size,
+                      DoubleToU64(blob_config.large_key_ratio));
+  PutVarint32(dst, separation_type);
+  PutLengthPrefixedSlice(dst, table_factory);
+  PutLengthPrefixedSlice(dst, table_factory_options);
+  PutVarint32(dst, bloom_locality);
+  PutVarint64(dst, cf_paths.size());
+  for (auto& path : cf_paths) {
+    PutLengthPrefixedSlice(dst, path);
+  }
+  PutLengthPrefixedSlice(dst, prefix_extractor);
+  PutLengthPrefixedSlice(dst, prefix_extractor_options);
+  PutBool(dst, has_start);
+  PutBool(dst, has_end);
+  PutLengthPrefixedSlice(dst, start);
+  PutLengthPrefixedSlice(dst, end);
+  PutVarint64Varint64(dst, last_sequence, earliest_write_conflict_snapshot);
+  PutVarint64(dst, preserve_deletes_seqnum);
+  PutVarint64(dst, file_metadata.size());
+  for (auto& pair : file_metadata) {
+    PutVarint64(dst, pair.first);
+    PutFileMetaData(dst, pair.second);
+  }
+  PutVarint64(dst, inputs.size());
+  for (auto& pair : inputs) {
+    PutVarint32Varint64(dst, static_cast<uint32_t>(pair.first), pair.second);
+  }
+  PutLengthPrefixedSlice(dst, cf_name);
+  PutVarint64(dst, target_file_size);
+  dst->push_back(static_cast<char>(compression));
+  PutFixed32(dst, static_cast<uint32_t>(compression_opts.window_bits));
+  PutFixed32(dst, static_cast<uint32_t>(compression_opts.level));
+  PutFixed32(dst, static_cast<uint32_t>(compression_opts.strategy));
+  PutVarint32Varint32(dst, compression_opts.max_dict_bytes,
+                      compression_opts.zstd_max_train_bytes);
+  PutBool(dst, compression_opts.enabled);
+  PutVarint64(dst, existing_snapshots.size());
+  for (auto snapshot : existing_snapshots) {
+    PutVarint64(dst, snapshot);
+  }
+  PutLengthPrefixedSlice(dst, smallest_user_key);
+  PutLengthPrefixedSlice(dst, largest_user_key);
+  PutFixed32(dst, static_cast<uint32_t>(level));
+  PutFixed32(dst, static_cast<uint32_t>(output_level));
+  PutFixed32(dst, static_cast<uint32_t>(number_levels));
+  PutBool(dst, skip_filters);
+  PutBool(dst, bottommost_level);
+  PutBool(dst, allow_ingest_behind);
+  PutBool(dst, preserve_deletes);
+  PutVarint64(dst, int_tbl_prop_collector_factories.size());
+  for (auto& collector : int_tbl_prop_collector_factories) {
+    PutLengthPrefixedSlice(dst, collector.name);
+    PutLengthPrefixedSlice(dst, collector.param);
+  }
+}
+
+Status CompactionWorkerContext::DecodeFrom(Slice* input) {
+  const char* kWhat = "CompactionWorkerContext";
+  Status s = GetHeader(input, kWhat);
+  if (!s.ok()) {
+    return s;
+  }
+  auto get_int = [input](int* value) {
+    uint32_t u32;
+    if (!GetFixed32(input, &u32)) {
+      return false;
+    }
+    *value = static_cast<int>(u32);
+    return true;
+  };
+  uint64_t size, large_key_ratio;
+  if (!GetString(input, &user_comparator) ||
+      !GetString(input, &merge_operator) ||
+      !GetString(input, &merge_operator_data.data) ||
+      !GetString(input, &value_meta_extractor_factory) ||
+      !GetString(input, &value_meta_extractor_factory_options.data) ||
+      !GetString(input, &compaction_filter) ||
+      !GetString(input, &compaction_filter_factory) ||
+      !GetBool(input, &compaction_filter_context.is_full_compaction) ||
+      !GetBool(input, &compaction_filter_context.is_manual_compaction) ||
+      !GetBool(input, &compaction_filter_context.is_bottommost_level) ||
+      !GetVarint32(input, &compaction_filter_context.column_family_id) ||
+      !GetString(input, &compaction_filter_data.data) ||
+      !GetVarint64(input, &size) || !GetVarint64(input, &large_key_ratio) ||
+      !GetVarint32(input, &separation_type) ||
+      !GetString(input, &table_factory) ||
+      !GetString(input, &table_factory_options) ||
+      !GetVarint32(input, &bloom_locality)) {
+    return Status::Corruption(kWhat, "bad options");
+  }
+  blob_config.blob_size = static_cast<size_t>(size);
+  blob_config.large_key_ratio = U64ToDouble(large_key_ratio);
+  if (!GetVarint64(input, &size) || !CheckCount(*input, size, 1)) {
+    return Status::Corruption(kWhat, "bad cf_paths");
+  }
+  cf_paths.resize(size);
+  for (auto& path : cf_paths) {
+    if (!GetString(input, &path)) {
+      return Status::Corruption(kWhat, "bad cf_paths");
+    }
+  }
+  if (!GetString(input, &prefix_extractor) ||
+      !GetString(input, &prefix_extractor_options) ||
+      !GetBool(input, &has_start) || !GetBool(input, &has_end) ||
+      !GetString(input, &start.data) || !GetString(input, &end.data) ||
+      !GetVarint64(input, &last_sequence) ||
+      !GetVarint64(input, &earliest_write_conflict_snapshot) ||
+      !GetVarint64(input, &preserve_deletes_seqnum) ||
+      !GetVarint64(input, &size)) {
+    return Status::Corruption(kWhat, "bad compaction range");
+  }
+  if (!CheckCount(*input, size, kMinFileMetaDataPairBytes)) {
+    return Status::Corruption(kWhat, "bad file_metadata");
+  }
+  file_metadata.resize(size);
+  for (auto& pair : file_metadata) {
+    if (!GetVarint64(input, &pair.first) ||
+        !GetFileMetaData(input, &pair.second)) {
+      return Status::Corruption(kWhat, "bad file_metadata");
+    }
+  }
+  if (!GetVarint64(input, &size) ||
+      !CheckCount(*input, size, kMinInputBytes)) {
+    return Status::Corruption(kWhat, "bad inputs");
+  }
+  inputs.resize(size);
+  for (auto& pair : inputs) {
+    uint32_t level_u32;
+    if (!GetVarint32(input, &level_u32) || !GetVarint64(input, &pair.second)) {
+      return Status::Corruption(kWhat, "bad inputs");
+    }
+    pair.first = static_cast<int>(level_u32);
+  }
+  if (!GetString(input, &cf_name) || !GetVarint64(input, &target_file_size) ||
+      input->empty()) {
+    return Status::Corruption(kWhat, "bad output options");
+  }
+  compression = static_cast<CompressionType>((*input)[0]);
+  input->remove_prefix(1);
+  if (!get_int(&compression_opts.window_bits) ||
+      !get_int(&compression_opts.level) ||
+      !get_int(&compression_opts.strategy) ||
+      !GetVarint32(input, &compression_opts.max_dict_bytes) ||
+      !GetVarint32(input, &compression_opts.zstd_max_train_bytes) ||
+      !GetBool(input, &compression_opts.enabled) ||
+      !GetVarint64(input, &size)) {
+    return Status::Corruption(kWhat, "bad compression_opts");
+  }
+  if (!CheckCount(*input, size, 1)) {
+    return Status::Corruption(kWhat, "bad existing_snapshots");
+  }
+  existing_snapshots.resize(size);
+  for (auto& snapshot : existing_snapshots) {
+    if (!GetVarint64(input, &snapshot)) {
+      return Status::Corruption(kWhat, "bad existing_snapshots");
+    }
+  }
+  if (!GetString(input, &smallest_user_key.data) ||
+      !GetString(input, &largest_user_key.data) || !get_int(&level) ||
+      !get_int(&output_level) || !get_int(&number_levels) ||
+      !GetBool(input, &skip_filters) || !GetBool(input, &bottommost_level) ||
+      !GetBool(input, &allow_ingest_behind) ||
+      !GetBool(input, &preserve_deletes) || !GetVarint64(input, &size)) {
+    return Status::Corruption(kWhat, "bad level info");
+  }
+  if (!CheckCount(*input, size, kMinCollectorBytes)) {
+    return Status::Corruption(kWhat, "bad int_tbl_prop_collector_factories");
+  }
+  int_tbl_prop_collector_factories.resize(size);
+  for (auto& collector : int_tbl_prop_collector_factories) {
+    if (!GetString(input, &collector.name) ||
+        !GetString(input, &collector.param.data)) {
+      return Status::Corruption(kWhat,
+                                "bad int_tbl_prop_collector_factories");
+    }
+  }
+  return Status::OK();
+}
+
+void CompactionWorkerResult::EncodeTo(std::string* dst) const {
+  PutHeader(dst);
+  PutStatus(dst, status);
+  PutLengthPrefixedSlice(dst, *actual_start.rep());
+  PutLengthPrefixedSlice(dst, *actual_end.rep());
+  PutVarint64(dst, files.size());
+  for (auto& f : files) {
+    PutLengthPrefixedSlice(dst, *f.smallest.rep());
+    PutLengthPrefixedSlice(dst, *f.largest.rep());
+    PutLengthPrefixedSlice(dst, f.file_name);
+    PutVarint64Varint64(dst, f.smallest_seqno, f.largest_seqno);
+    PutVarint64(dst, f.file_size);
+    dst->push_back(static_cast<char>(f.marked_for_compaction));
+  }
+  PutLengthPrefixedSlice(dst, stat_all);
+  PutVarint64(dst, time_us);
+}
+
+Status CompactionWorkerResult::DecodeFrom(Slice* input) {
+  const char* kWhat = "CompactionWorkerResult";
+  Status s = GetHeader(input, kWhat);
+  if (!s.ok()) {
+    return s;
+  }
+  Slice start_slice, end_slice;
+  uint64_t size;
+  if (!GetStatus(input, &status) ||
+      !GetLengthPrefixedSlice(input, &start_slice) ||
+      !GetLengthPrefixedSlice(input, &end_slice) ||
+      !GetVarint64(input, &size)) {
+    return Status::Corruption(kWhat, "bad status");
+  }
+  if (!CheckCount(*input, size, kMinResultFileBytes)) {
+    return Status::Corruption(kWhat, "bad files");
+  }
+  actual_start.DecodeFrom(start_slice);
+  actual_end.DecodeFrom(end_slice);
+  files.resize(size);
+  for (auto& f : files) {
+    Slice smallest, largest;
+    uint64_t file_size;
+    if (!GetLengthPrefixedSlice(input, &smallest) ||
+        !GetLengthPrefixedSlice(input, &largest) ||
+        !GetString(input, &f.file_name) ||
+        !GetVarint64(input, &f.smallest_seqno) ||
+        !GetVarint64(input, &f.largest_seqno) ||
+        !GetVarint64(input, &file_size) || input->empty()) {
+      return Status::Corruption(kWhat, "bad files");
+    }
+    f.smallest.DecodeFrom(smallest);
+    f.largest.DecodeFrom(largest);
+    f.file_size = static_cast<size_t>(file_size);
+    f.marked_for_compaction = static_cast<uint8_t>((*input)[0]);
+    input->remove_prefix(1);
+  }
+  if (!GetString(input, &stat_all) || !GetVarint64(input, &size)) {
+    return Status::Corruption(kWhat, "bad stat");
+  }
+  time_us = static_cast<size_t>(size);
+  return Status::OK();
+}
+
 }  // namespace TERARKDB_NAMESPACE
 
 using namespace TERARKDB_NAMESPACE;
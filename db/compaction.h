@@ -168,6 +168,12 @@ struct CompactionWorkerContext {
   int level, output_level, number_levels;
   bool skip_filters, bottommost_level, allow_ingest_behind, preserve_deletes;
   std::vector<NameParam> int_tbl_prop_collector_factories;
+
+  // Versioned, length-prefixed binary encoding used by
+  // RemoteCompactionDispatcher. DecodeFrom parses *input in place, so input
+  // may point into a mmap'd buffer.
+  void EncodeTo(std::string* dst) const;
+  Status DecodeFrom(Slice* input);
 };
 
 struct CompactionWorkerResult {
@@ -186,6 +192,10 @@ struct CompactionWorkerResult {
   std::vector<FileInfo> files;
   std::string stat_all;
   size_t time_us = 0;
+
+  // Same wire format as CompactionWorkerContext
+  void EncodeTo(std::string* dst) const;
+  Status DecodeFrom(Slice* input);
 };
 
 // A Compaction encapsulates information about a compaction.
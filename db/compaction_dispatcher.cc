@@ -15,9 +15,15 @@
 #define __STDC_FORMAT_MACROS
 #endif
 
+#include <fcntl.h>
 #include <inttypes.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <chrono>
+#include <condition_variable>
 
 #ifdef WITH_TERARK_ZIP
 #include <terark/num_to_str.hpp>
@@ -44,213 +50,10 @@
 #include "table/table_reader.h"
 #include "table/two_level_iterator.h"
 #include "util/c_style_callback.h"
+#include "util/coding.h"
 #include "util/filename.h"
-
-#ifndef WITH_TERARK_ZIP
-#define USE_AJSON 1
-#endif
-
-#ifdef USE_AJSON
-#include "util/ajson_msd.hpp"
-#else
-#include <terark/io/DataIO.hpp>
-#include <terark/io/MemStream.hpp>
-#include <terark/preproc.hpp>
-#define AJSON(Class, ...)             \
-  DATA_IO_LOAD_SAVE_E(                \
-      Class,                          \
-      TERARK_PP_APPLY(TERARK_PP_JOIN, \
-                      TERARK_PP_MAP(TERARK_PP_PREPEND, &, __VA_ARGS__)))
-#endif
-
-struct AJsonStatus {
-  unsigned char code, subcode, sev;
-  std::string state;
-};
-AJSON(AJsonStatus, code, subcode, sev, state);
-
-namespace ajson {
-#ifdef USE_AJSON
-template <>
-struct json_impl<TERARKDB_NAMESPACE::Status, void> {
-  static inline void read(reader& rd, TERARKDB_NAMESPACE::Status& v) {
-    AJsonStatus s;
-    json_impl<AJsonStatus>::read(rd, s);
-    v = TERARKDB_NAMESPACE::Status(s.code, s.subcode, s.sev,
-                                   s.state.empty() ? nullptr : s.state.c_str());
-  }
-  template <typename write_ty>
-  static inline void write(write_ty& wt, TERARKDB_NAMESPACE::Status const& v) {
-    AJsonStatus s = {v.code(), v.subcode(), v.severity(),
-                     v.getState() == nullptr ? std::string() : v.getState()};
-    json_impl<AJsonStatus>::template write<write_ty>(wt, s);
-  }
-};
-
-template <>
-struct json_impl<TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString,
-                 void> {
-  static inline void read(
-      reader& rd,
-      TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString& v) {
-    std::string s;
-    json_impl<std::string>::read(rd, s);
-    v.data.resize(s.size() / 2);
-    for (size_t i = 0; i < s.size(); i += 2) {
-      char x[3] = {s[i], s[i + 1], '\0'};
-      v.data[i / 2] = std::stoi(x, nullptr, 16);
-    }
-  }
-  template <typename write_ty>
-  static inline void write(
-      write_ty& wt,
-      TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString const& v) {
-    json_impl<std::string>::template write<write_ty>(
-        wt, TERARKDB_NAMESPACE::Slice(v.data).ToString(true));
-  }
-};
-
-template <>
-struct json_impl<TERARKDB_NAMESPACE::InternalKey, void> {
-  static inline void read(reader& rd, TERARKDB_NAMESPACE::InternalKey& v) {
-    TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString s;
-    json_impl<TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString>::read(
-        rd, s);
-    *v.rep() = std::move(s.data);
-  }
-  template <typename write_ty>
-  static inline void write(write_ty& wt,
-                           TERARKDB_NAMESPACE::InternalKey const& v) {
-    TERARKDB_NAMESPACE::Slice s(*v.rep());
-    json_impl<std::string>::template write<write_ty>(wt, s.ToString(true));
-  }
-};
-
-template <class T>
-void load_from_buff(T& x, std::string& data) {
-  load_from_buff(x, &data[0], data.size());
-}
-
-template <class T>
-void load_from_buff(T& x, const TERARKDB_NAMESPACE::Slice& data) {
-  load_from_buff(x, &data.ToString()[0], data.size());
-}
-
-#else  // USE_AJSON
-
-template <class T>
-void load_from_buff(T& x, const TERARKDB_NAMESPACE::Slice& data) {
-  using namespace terark;
-  LittleEndianDataInput<MemIO> dio;
-  dio.set((char*)data.data(), data.size());
-  dio >> x;
-}
-
-struct string_stream : terark::LittleEndianDataOutput<terark::AutoGrownMemIO> {
-  std::string str() const { return std::string((char*)m_beg, m_pos - m_beg); }
-};
-
-template <class T>
-void save_to(string_stream& ss, const T& x) {
-  ss.resize(128 * 1024);
-  ss << x;
-}
-
-#endif
-}  // namespace ajson
-
-#ifdef USE_AJSON
-using namespace TERARKDB_NAMESPACE;
-#else
-namespace TERARKDB_NAMESPACE {
-
-template <class DataIO>
-void DataIO_loadObject(DataIO& dio, TERARKDB_NAMESPACE::Status& x) {
-  AJsonStatus s;
-  dio >> s;
-  x = TERARKDB_NAMESPACE::Status(s.code, s.subcode, s.sev,
-                                 s.state.empty() ? nullptr : s.state.c_str());
-}
-
-template <class DataIO>
-void DataIO_saveObject(DataIO& dio, const TERARKDB_NAMESPACE::Status& v) {
-  AJsonStatus s = {v.code(), v.subcode(), v.severity(),
-                   v.getState() == nullptr ? std::string() : v.getState()};
-  dio << s;
-}  // namespace ajson
-
-template <class DataIO>
-void DataIO_loadObject(DataIO& dio, InternalKey& x) {
-  dio >> *x.rep();
-}
-
-template <class DataIO>
-void DataIO_saveObject(DataIO& dio, const InternalKey& x) {
-  dio << *x.rep();
-}
-
-template <class DataIO>
-void DataIO_loadObject(DataIO& dio, CompressionType& x) {
-  static_assert(sizeof(CompressionType) == 1, "sizeof(CompressionType) == 1");
-  dio >> (unsigned char&)x;
-}
-
-template <class DataIO>
-void DataIO_saveObject(DataIO& dio, const CompressionType x) {
-  dio << (unsigned char)x;
-}
-
-using EncodedString = CompactionWorkerContext::EncodedString;
-AJSON(EncodedString, data);
-
-#endif
-
-AJSON(Dependence, file_number, entry_count);
-
-using FileInfo = CompactionWorkerResult::FileInfo;
-AJSON(FileInfo, smallest, largest, file_name, smallest_seqno, largest_seqno,
-      file_size, marked_for_compaction);
-
-AJSON(CompactionWorkerResult, status, actual_start, actual_end, files, stat_all,
-      time_us);
-
-AJSON(FileDescriptor, packed_number_and_path_id, file_size, smallest_seqno,
-      largest_seqno);
-
-AJSON(TablePropertyCache, num_entries, num_deletions, raw_key_size,
-      raw_value_size, flags, purpose, max_read_amp, read_amp, dependence,
-      inheritance);
-
-AJSON(FileMetaData, fd, smallest, largest, prop);
-
-AJSON(CompressionOptions, window_bits, level, strategy, max_dict_bytes,
-      zstd_max_train_bytes, enabled);
-
-AJSON(CompactionFilterContext, is_full_compaction, is_manual_compaction,
-      column_family_id);
-
-using NameParam = CompactionWorkerContext::NameParam;
-AJSON(NameParam, name, param);
-
-AJSON(BlobConfig, blob_size, large_key_ratio);
-
-AJSON(CompactionWorkerContext, user_comparator, merge_operator,
-      merge_operator_data, value_meta_extractor_factory,
-      value_meta_extractor_factory_options, compaction_filter,
-      compaction_filter_factory, compaction_filter_context,
-      compaction_filter_data, blob_config, separation_type, table_factory,
-      table_factory_options, bloom_locality, cf_paths, prefix_extractor,
-      prefix_extractor_options, has_start, has_end, start, end, last_sequence,
-      earliest_write_conflict_snapshot, preserve_deletes_seqnum, file_metadata,
-      inputs, cf_name, target_file_size, compression, compression_opts,
-      existing_snapshots, smallest_user_key, largest_user_key, level,
-      output_level, number_levels, skip_filters, bottommost_level,
-      allow_ingest_behind, preserve_deletes, int_tbl_prop_collector_factories);
-
-#ifdef USE_AJSON
-#else
-}  // namespace TERARKDB_NAMESPACE
-#endif
+#include "util/string_util.h"
+#include "utilities/util/valvec.hpp"
 
 namespace TERARKDB_NAMESPACE {
 
@@ -273,10 +76,11 @@ class WorkerSeparateHelper : public SeparateHelper, public LazyBufferState {
   using SeparateHelper::TransToSeparate;
   Status TransToSeparate(const Slice& internal_key, LazyBuffer& value,
                          const Slice& meta, bool is_merge,
-                         bool is_index) override {
+                         bool is_index, uint64_t location) override {
     return SeparateHelper::TransToSeparate(
         internal_key, value, value.file_number(), meta, is_merge, is_index,
-        value_meta_extractor_.get());
+        value_meta_extractor_.get(),
+        keep_value_location_ ? location : kNoLocation);
   }
 
   LazyBuffer TransToCombined(const Slice& user_key, uint64_t sequence,
@@ -302,16 +106,18 @@ class WorkerSeparateHelper : public SeparateHelper, public LazyBufferState {
   WorkerSeparateHelper(
       DependenceMap* dependence_map,
       std::unique_ptr<ValueExtractor> value_meta_extractor,
-      void* inplace_decode_arg,
+      bool keep_value_location, void* inplace_decode_arg,
       Status (*inplace_decode_callback)(void* arg, LazyBuffer* buffer,
                                         LazyBufferContext* rep))
       : dependence_map_(dependence_map),
         value_meta_extractor_(std::move(value_meta_extractor)),
+        keep_value_location_(keep_value_location),
         inplace_decode_arg_(inplace_decode_arg),
         inplace_decode_callback_(inplace_decode_callback) {}
 
   DependenceMap* dependence_map_;
   std::unique_ptr<ValueExtractor> value_meta_extractor_;
+  bool keep_value_location_;
   void* inplace_decode_arg_;
   Status (*inplace_decode_callback_)(void* arg, LazyBuffer* buffer,
                                      LazyBufferContext* rep);
@@ -320,8 +126,8 @@ class WorkerSeparateHelper : public SeparateHelper, public LazyBufferState {
 std::function<CompactionWorkerResult()>
 RemoteCompactionDispatcher::StartCompaction(
     const CompactionWorkerContext& context) {
-  ajson::string_stream stream;
-  ajson::save_to(stream, context);
+  std::string encoded_context;
+  context.EncodeTo(&encoded_context);
   struct Result {
     Result(std::future<std::string>&& _future) : future(_future.share()) {}
 
@@ -329,29 +135,114 @@ RemoteCompactionDispatcher::StartCompaction(
 
     CompactionWorkerResult operator()() {
       CompactionWorkerResult result;
-      std::string encoded_result = future.get();
-      try {
-        ajson::load_from_buff(result, encoded_result);
-      } catch (const std::exception& ex) {
+      const std::string& encoded_result = future.get();
+      Slice input(encoded_result);
+      Status s = result.DecodeFrom(&input);
+      if (!s.ok()) {
         terark::string_appender<> detail;
         detail << "encoded_result[len=" << encoded_result.size() << "]: ";
         detail << Slice(encoded_result).ToString(true /*hex*/);
-        result.status = Status::Corruption(
-            terark::fstring("exception.what = ") + ex.what(), detail);
+        result = CompactionWorkerResult();
+        result.status = Status::Corruption(s.ToString(), detail);
       }
       return result;
     }
   };
-  std::future<std::string> str_result = DoCompaction(stream.str());
+  std::future<std::string> str_result =
+      DoCompaction(std::move(encoded_context));
   return Result(std::move(str_result));
 }
 
 static bool g_isCompactionWorkerNode = false;
 bool IsCompactionWorkerNode() { return g_isCompactionWorkerNode; }
 
+// TableReaders opened by previous jobs of a worker. A worker that serves many
+// jobs keeps the readers of shared inputs (and their warmed index and filter
+// blocks) instead of re-opening every input for each job. The readers stay
+// valid as long as the table options of the incoming jobs don't change.
+struct WorkerTableReaderCache {
+  // Upper bound of cached readers which are not used by any running job
+  static const size_t kMaxIdleReaders = 512;
+
+  // File numbers restart when a DB is recreated at the same path, so a reader
+  // is only reused for a file of the same size and sequence range
+  struct CachedReader {
+    uint64_t file_size;
+    SequenceNumber smallest_seqno;
+    SequenceNumber largest_seqno;
+    std::shared_ptr<TableReader> reader;
+
+    bool SameFile(const FileDescriptor& fd) const {
+      return file_size == fd.file_size &&
+             smallest_seqno == fd.smallest_seqno &&
+             largest_seqno == fd.largest_seqno;
+    }
+  };
+
+  std::string signature;
+  ImmutableDBOptions db_options;
+  ColumnFamilyOptions cf_options;
+  std::unique_ptr<ImmutableCFOptions> ioptions;
+  std::mutex mutex;
+  std::unordered_map<uint64_t, CachedReader> readers;
+
+  WorkerTableReaderCache(std::string&& _signature,
+                         const ImmutableDBOptions& _db_options,
+                         const ColumnFamilyOptions& _cf_options)
+      : signature(std::move(_signature)),
+        db_options(_db_options),
+        cf_options(_cf_options) {
+    // Readers only need the table related options, drop the job specific
+    // objects which are owned by the job
+    cf_options.merge_operator.reset();
+    cf_options.compaction_filter = nullptr;
+    cf_options.compaction_filter_factory.reset();
+    cf_options.value_meta_extractor_factory.reset();
+    ioptions.reset(new ImmutableCFOptions(db_options, cf_options));
+  }
+
+  ~WorkerTableReaderCache() { readers.clear(); }
+
+  // The inputs of a finished job are compacted away and their files are about
+  // to be deleted, don't keep them open. Running jobs still holding one of
+  // the readers keep it alive until they finish.
+  void DropReaders(const std::vector<std::pair<int, uint64_t>>& inputs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& pair : inputs) {
+      readers.erase(pair.second);
+    }
+  }
+
+  void EvictIdleReaders() {
+    for (auto it = readers.begin();
+         readers.size() > kMaxIdleReaders && it != readers.end();) {
+      if (it->second.reader.use_count() == 1) {
+        it = readers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+};
+
 struct RemoteCompactionDispatcher::Worker::Rep {
   EnvOptions env_options;
   Env* env;
+  std::mutex table_reader_cache_mutex;
+  std::shared_ptr<WorkerTableReaderCache> table_reader_cache;
+
+  std::shared_ptr<WorkerTableReaderCache> GetTableReaderCache(
+      std::string&& signature, const ImmutableDBOptions& db_options,
+      const ColumnFamilyOptions& cf_options) {
+    std::lock_guard<std::mutex> lock(table_reader_cache_mutex);
+    if (table_reader_cache == nullptr ||
+        table_reader_cache->signature != signature) {
+      // Jobs still running on the old cache keep it alive
+      table_reader_cache = std::make_shared<WorkerTableReaderCache>(
+          std::move(signature), db_options, cf_options);
+    }
+    return table_reader_cache;
+  }
 };
 
 RemoteCompactionDispatcher::Worker::Worker(EnvOptions env_options, Env* env) {
@@ -400,14 +291,19 @@ class RemoteCompactionProxy : public CompactionIterator::CompactionProxy {
 static std::string make_error(Status&& status) {
   CompactionWorkerResult result;
   result.status = std::move(status);
-  ajson::string_stream stream;
-  ajson::save_to(stream, result);
-  return stream.str();
+  std::string encoded_result;
+  result.EncodeTo(&encoded_result);
+  return encoded_result;
 };
 
 std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
   CompactionWorkerContext context;
-  ajson::load_from_buff(context, data);
+  {
+    Status s = context.DecodeFrom(&data);
+    if (!s.ok()) {
+      return make_error(std::move(s));
+    }
+  }
   context.compaction_filter_context.smallest_user_key =
       context.smallest_user_key;
   context.compaction_filter_context.largest_user_key = context.largest_user_key;
@@ -549,7 +445,27 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
       assert(false);
     }
   }
-  std::unordered_map<uint64_t, std::unique_ptr<TableReader>> table_cache;
+  std::string reader_signature;
+  for (const std::string* str :
+       {&context.user_comparator, &context.table_factory,
+        &context.table_factory_options, &context.prefix_extractor,
+        &context.prefix_extractor_options}) {
+    PutLengthPrefixedSlice(&reader_signature, *str);
+  }
+  for (auto& path : context.cf_paths) {
+    PutLengthPrefixedSlice(&reader_signature, path);
+  }
+  auto reader_cache = rep_->GetTableReaderCache(
+      std::move(reader_signature), immutable_db_options, cf_options);
+  // Only the readers of the files the inputs depend on, e.g. blob ssts, are
+  // worth keeping for later jobs
+  struct InputReadersDropper {
+    WorkerTableReaderCache* cache;
+    const std::vector<std::pair<int, uint64_t>>& inputs;
+    ~InputReadersDropper() { cache->DropReaders(inputs); }
+  } input_readers_dropper{reader_cache.get(), context.inputs};
+  // Readers used by this job, pinned until the job finishes
+  std::unordered_map<uint64_t, std::shared_ptr<TableReader>> table_cache;
   std::mutex table_cache_mutex;
   auto get_table_reader = [&](uint64_t file_number, TableReader** reader_ptr) {
     std::lock_guard<std::mutex> lock(table_cache_mutex);
@@ -557,27 +473,41 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
     if (find == table_cache.end()) {
       assert(contxt_dependence_map.count(file_number) > 0);
       const FileMetaData* file_metadata = contxt_dependence_map[file_number];
-      std::string file_name =
-          TableFileName(immutable_cf_options.cf_paths, file_number,
-                        file_metadata->fd.GetPathId());
-      std::unique_ptr<RandomAccessFile> file;
-      auto s = env->NewRandomAccessFile(file_name, &file, env_opt);
-      if (!s.ok()) {
-        return s;
-      }
-      std::unique_ptr<RandomAccessFileReader> file_reader(
-          new RandomAccessFileReader(std::move(file), file_name, env));
-      std::unique_ptr<TableReader> reader;
-      TableReaderOptions table_reader_options(
-          immutable_cf_options, mutable_cf_options.prefix_extractor.get(),
-          env_opt, *icmp, true, false, -1, file_number);
-      s = immutable_cf_options.table_factory->NewTableReader(
-          table_reader_options, std::move(file_reader),
-          file_metadata->fd.file_size, &reader, false);
-      if (!s.ok()) {
-        return s;
+      std::lock_guard<std::mutex> cache_lock(reader_cache->mutex);
+      auto cached = reader_cache->readers.find(file_number);
+      if (cached != reader_cache->readers.end() &&
+          cached->second.SameFile(file_metadata->fd)) {
+        find = table_cache.emplace(file_number, cached->second.reader).first;
+      } else {
+        auto& ioptions = *reader_cache->ioptions;
+        std::string file_name = TableFileName(
+            ioptions.cf_paths, file_number, file_metadata->fd.GetPathId());
+        std::unique_ptr<RandomAccessFile> file;
+        auto s = env->NewRandomAccessFile(file_name, &file, env_opt);
+        if (!s.ok()) {
+          return s;
+        }
+        std::unique_ptr<RandomAccessFileReader> file_reader(
+            new RandomAccessFileReader(std::move(file), file_name, env));
+        std::unique_ptr<TableReader> reader;
+        TableReaderOptions table_reader_options(
+            ioptions, reader_cache->cf_options.prefix_extractor.get(), env_opt,
+            ioptions.internal_comparator, true, false, -1, file_number);
+        s = ioptions.table_factory->NewTableReader(
+            table_reader_options, std::move(file_reader),
+            file_metadata->fd.file_size, &reader, false);
+        if (!s.ok()) {
+          return s;
+        }
+        std::shared_ptr<TableReader> shared_reader(std::move(reader));
+        auto& fd = file_metadata->fd;
+        reader_cache->readers[file_number] =
+            WorkerTableReaderCache::CachedReader{
+                fd.file_size, fd.smallest_seqno, fd.largest_seqno,
+                shared_reader};
+        find = table_cache.emplace(file_number, std::move(shared_reader)).first;
+        reader_cache->EvictIdleReaders();
       }
-      find = table_cache.emplace(file_number, std::move(reader)).first;
     }
     if (reader_ptr != nullptr) {
       *reader_ptr = find->second.get();
@@ -677,7 +607,8 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
 
   WorkerSeparateHelper separate_helper(
       &contxt_dependence_map, create_value_meta_extractor(),
-      &separate_inplace_decode, c_style_callback(separate_inplace_decode));
+      mutable_cf_options.enable_blob_value_location, &separate_inplace_decode,
+      c_style_callback(separate_inplace_decode));
 
   CompactionRangeDelAggregator range_del_agg(icmp, context.existing_snapshots);
 
@@ -1093,19 +1024,20 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
   auto finish_time = system_clock::now();
   auto duration = duration_cast<microseconds>(finish_time - start_time);
   result.time_us = duration.count();
-  ajson::string_stream stream;
-  ajson::save_to(stream, result);
-  return stream.str();
+  std::string encoded_result;
+  result.EncodeTo(&encoded_result);
+  return encoded_result;
 }
 
 void RemoteCompactionDispatcher::Worker::DebugSerializeCheckResult(Slice data) {
 #ifdef WITH_TERARK_ZIP
   using namespace terark;
-  LittleEndianDataInput<MemIO> dio;
-  dio.set((void*)(data.data_), data.size());
   CompactionWorkerResult res;
-  dio >> res;
+  Status s = res.DecodeFrom(&data);
   string_appender<> str;
+  if (!s.ok()) {
+    str << "CompactionWorkerResult: decode failed: " << s.ToString() << "\n";
+  }
   str << "CompactionWorkerResult: time_us = " << res.time_us << " ("
       << (res.time_us * 1e-6) << " sec), ";
   str << "  status = " << res.status.ToString() << "\n";
@@ -1131,6 +1063,77 @@ void RemoteCompactionDispatcher::Worker::DebugSerializeCheckResult(Slice data) {
 #endif
 }
 
+// A frame is a fixed64 payload length followed by the payload
+static const uint64_t kMaxFrameSize = uint64_t(1) << 30;
+
+static bool WriteFrame(int fd, Slice data) {
+  char header[sizeof(uint64_t)];
+  EncodeFixed64(header, data.size());
+  for (Slice buf : {Slice(header, sizeof header), data}) {
+    while (!buf.empty()) {
+      ssize_t n = ::write(fd, buf.data(), buf.size());
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      buf.remove_prefix(n);
+    }
+  }
+  return true;
+}
+
+static bool ReadFully(int fd, char* buf, size_t size, size_t* done) {
+  *done = 0;
+  while (*done < size) {
+    ssize_t n = ::read(fd, buf + *done, size - *done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    *done += n;
+  }
+  return true;
+}
+
+// Returns OK on success, NotFound on a clean EOF before the frame
+static Status ReadFrame(int fd, std::string* data) {
+  char header[sizeof(uint64_t)];
+  size_t done;
+  if (!ReadFully(fd, header, sizeof header, &done)) {
+    return done == 0 && errno == 0 ? Status::NotFound()
+                                   : Status::IOError("Read frame header");
+  }
+  uint64_t size = DecodeFixed64(header);
+  if (size > kMaxFrameSize) {
+    return Status::Corruption("Frame too large", ToString(size));
+  }
+  data->resize(size);
+  if (!ReadFully(fd, &(*data)[0], data->size(), &done)) {
+    return Status::IOError("Read frame payload");
+  }
+  return Status::OK();
+}
+
+Status RemoteCompactionDispatcher::Worker::Serve(int input_fd, int output_fd) {
+  std::string data;
+  for (;;) {
+    errno = 0;
+    Status s = ReadFrame(input_fd, &data);
+    if (s.IsNotFound()) {
+      return Status::OK();
+    } else if (!s.ok()) {
+      return s;
+    }
+    if (!WriteFrame(output_fd, DoCompaction(data))) {
+      return Status::IOError("Write frame");
+    }
+  }
+}
+
 const char* RemoteCompactionDispatcher::Name() const {
   return "RemoteCompactionDispatcher";
 }
@@ -1178,4 +1181,157 @@ std::shared_ptr<CompactionDispatcher> NewCommandLineCompactionDispatcher(
   return std::make_shared<CommandLineCompactionDispatcher>(std::move(cmd));
 }
 
+// Keeps up to max_workers long-lived worker processes, each one running
+// Worker::Serve on its stdin/stdout. Process startup, option object creation
+// and table reader warmup are paid once per worker instead of once per job.
+class WorkerPoolCompactionDispatcher : public RemoteCompactionDispatcher {
+  struct Process {
+    pid_t pid;
+    int request_fd;
+    int result_fd;
+  };
+
+  std::string m_cmd;
+  size_t m_max_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::vector<Process> m_idle;
+  size_t m_num_workers;
+
+  Status Spawn(Process* process) {
+    int request_pipe[2], result_pipe[2];
+    if (pipe2(request_pipe, O_CLOEXEC) != 0) {
+      return Status::IOError("pipe2", strerror(errno));
+    }
+    if (pipe2(result_pipe, O_CLOEXEC) != 0) {
+      Status s = Status::IOError("pipe2", strerror(errno));
+      ::close(request_pipe[0]);
+      ::close(request_pipe[1]);
+      return s;
+    }
+    const char* cmd = m_cmd.c_str();
+    pid_t pid = fork();
+    if (pid == 0) {
+      // dup2 clears O_CLOEXEC on the target descriptors
+      if (dup2(request_pipe[0], 0) < 0 || dup2(result_pipe[1], 1) < 0) {
+        _exit(126);
+      }
+      execl("/bin/sh", "sh", "-c", cmd, (char*)nullptr);
+      _exit(127);
+    }
+    Status s;
+    if (pid < 0) {
+      s = Status::IOError("fork", strerror(errno));
+      ::close(request_pipe[1]);
+      ::close(result_pipe[0]);
+    } else {
+      process->pid = pid;
+      process->request_fd = request_pipe[1];
+      process->result_fd = result_pipe[0];
+    }
+    ::close(request_pipe[0]);
+    ::close(result_pipe[1]);
+    return s;
+  }
+
+  static void Stop(const Process& process, bool kill_worker) {
+    ::close(process.request_fd);
+    ::close(process.result_fd);
+    if (kill_worker) {
+      ::kill(process.pid, SIGKILL);
+    }
+    int status;
+    while (::waitpid(process.pid, &status, 0) < 0 && errno == EINTR) {
+    }
+  }
+
+  Status Acquire(Process* process) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cond.wait(lock, [this] {
+        return !m_idle.empty() || m_num_workers < m_max_workers;
+      });
+      if (!m_idle.empty()) {
+        *process = m_idle.back();
+        m_idle.pop_back();
+        return Status::OK();
+      }
+      ++m_num_workers;
+    }
+    Status s = Spawn(process);
+    if (!s.ok()) {
+      Release(nullptr);
+    }
+    return s;
+  }
+
+  // process == nullptr means the worker is gone
+  void Release(const Process* process) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (process != nullptr) {
+      m_idle.push_back(*process);
+    } else {
+      --m_num_workers;
+    }
+    m_cond.notify_one();
+  }
+
+  std::string Run(const std::string& data) {
+    // A dead worker must not take the DB process down with SIGPIPE, this
+    // thread belongs to this job only
+    sigset_t sigset;
+    sigemptyset(&sigset);
+    sigaddset(&sigset, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigset, nullptr);
+
+    Process process;
+    Status s = Acquire(&process);
+    if (!s.ok()) {
+      return make_error(std::move(s));
+    }
+    std::string result;
+    errno = 0;
+    if (WriteFrame(process.request_fd, data)) {
+      s = ReadFrame(process.result_fd, &result);
+    } else {
+      s = Status::IOError("Write frame", strerror(errno));
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "ERROR: CompactWorker(%s, pid=%d) = %s\n", m_cmd.c_str(),
+              int(process.pid), s.ToString().c_str());
+      Stop(process, true);
+      Release(nullptr);
+      return make_error(Status::Aborted("Compaction worker died", m_cmd));
+    }
+    Release(&process);
+    return result;
+  }
+
+ public:
+  WorkerPoolCompactionDispatcher(std::string&& cmd, size_t max_workers)
+      : m_cmd(std::move(cmd)),
+        m_max_workers(std::max<size_t>(max_workers, 1)),
+        m_num_workers(0) {}
+
+  ~WorkerPoolCompactionDispatcher() {
+    // Closing stdin makes the idle workers exit
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& process : m_idle) {
+      Stop(process, false);
+    }
+  }
+
+  std::future<std::string> DoCompaction(std::string data) override {
+    return std::async(std::launch::async,
+                      [this](const std::string& _data) { return Run(_data); },
+                      std::move(data));
+  }
+};
+
+std::shared_ptr<CompactionDispatcher> NewWorkerPoolCompactionDispatcher(
+    std::string cmd, size_t max_workers) {
+  return std::make_shared<WorkerPoolCompactionDispatcher>(std::move(cmd),
+                                                          max_workers);
+}
+
 }  // namespace TERARKDB_NAMESPACE
@@ -0,0 +1,138 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/compaction_dispatcher.h"
+
+#include <unistd.h>
+
+#include "db/compaction.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/coding.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace TERARKDB_NAMESPACE {
+
+class CompactionDispatcherTest : public testing::Test {
+ public:
+  class TestWorker : public RemoteCompactionDispatcher::Worker {
+   public:
+    TestWorker() : Worker(EnvOptions(), Env::Default()) {}
+
+    std::string GenerateOutputFileName(size_t file_index) override {
+      return test::TmpDir() + "/dispatcher_" + ToString(file_index) + ".sst";
+    }
+  };
+
+  CompactionDispatcherTest() {
+    EXPECT_EQ(pipe(request_pipe_), 0);
+    EXPECT_EQ(pipe(result_pipe_), 0);
+  }
+
+  ~CompactionDispatcherTest() {
+    for (int fd : {request_pipe_[0], request_pipe_[1], result_pipe_[0],
+                   result_pipe_[1]}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+
+  void WriteRaw(const std::string& data) {
+    ASSERT_EQ(write(request_pipe_[1], data.data(), data.size()),
+              ssize_t(data.size()));
+  }
+
+  void WriteFrame(const std::string& data) {
+    std::string frame;
+    PutFixed64(&frame, data.size());
+    frame.append(data);
+    WriteRaw(frame);
+  }
+
+  void CloseRequest() {
+    close(request_pipe_[1]);
+    request_pipe_[1] = -1;
+  }
+
+  Status Serve() {
+    TestWorker worker;
+    Status s = worker.Serve(request_pipe_[0], result_pipe_[1]);
+    close(result_pipe_[1]);
+    result_pipe_[1] = -1;
+    return s;
+  }
+
+  std::string ReadAllResults() {
+    std::string data;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(result_pipe_[0], buf, sizeof buf)) > 0) {
+      data.append(buf, n);
+    }
+    return data;
+  }
+
+  int request_pipe_[2];
+  int result_pipe_[2];
+};
+
+TEST_F(CompactionDispatcherTest, ServeReturnsErrorResultPerFrame) {
+  WriteFrame("not a compaction context");
+  WriteFrame("");
+  CloseRequest();
+  ASSERT_OK(Serve());
+
+  std::string data = ReadAllResults();
+  Slice input(data);
+  for (int i = 0; i < 2; ++i) {
+    uint64_t size;
+    ASSERT_TRUE(GetFixed64(&input, &size));
+    ASSERT_LE(size, input.size());
+    Slice frame(input.data(), size);
+    input.remove_prefix(size);
+    CompactionWorkerResult result;
+    ASSERT_OK(result.DecodeFrom(&frame));
+    ASSERT_TRUE(result.status.IsCorruption());
+  }
+  ASSERT_TRUE(input.empty());
+}
+
+TEST_F(CompactionDispatcherTest, ServeRejectsOversizedFrame) {
+  std::string header;
+  PutFixed64(&header, uint64_t(1) << 40);
+  WriteRaw(header);
+  CloseRequest();
+  ASSERT_TRUE(Serve().IsCorruption());
+  ASSERT_TRUE(ReadAllResults().empty());
+}
+
+TEST_F(CompactionDispatcherTest, ServeRejectsTruncatedFrame) {
+  std::string header;
+  PutFixed64(&header, 100);
+  WriteRaw(header + "short");
+  CloseRequest();
+  ASSERT_NOK(Serve());
+  ASSERT_TRUE(ReadAllResults().empty());
+}
+
+TEST_F(CompactionDispatcherTest, WorkerPoolReportsDeadWorker) {
+  CompactionWorkerContext context;
+  context.user_comparator = "leveldb.BytewiseComparator";
+  // exits without answering, then answers with a frame size over the limit
+  for (const char* cmd :
+       {"exit 0", "printf '\\377\\377\\377\\377\\377\\377\\377\\377'"}) {
+    auto dispatcher = NewWorkerPoolCompactionDispatcher(cmd, 1);
+    CompactionWorkerResult result = dispatcher->StartCompaction(context)();
+    ASSERT_TRUE(result.status.IsAborted()) << result.status.ToString();
+  }
+}
+
+}  // namespace TERARKDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -179,6 +179,9 @@ class CompactionIterator {
   // current output.
   LazyBuffer value_;
   std::string value_meta_;
+  // Location of the separated value inside its value sst, kept when the
+  // value index is passed through
+  uint64_t value_location_ = SeparateHelper::kNoLocation;
   // The status is OK unless compaction iterator encounters a merge operand
   // while not having a merge operator defined.
   Status status_;
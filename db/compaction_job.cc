@@ -155,6 +155,11 @@ struct CompactionJob::SubcompactionState {
   // actual range for this subcompaction
   InternalKey actual_start, actual_end;
 
+  // The input blob files of this garbage collection sub-job. A garbage
+  // collection is split by input blob files instead of key ranges, each
+  // input file number must be inherited by exactly one output file.
+  std::vector<CompactionInputFiles> blob_inputs;
+
   // The return status of this subcompaction
   Status status;
 
@@ -243,6 +248,7 @@ struct CompactionJob::SubcompactionState {
     end = std::move(o.end);
     actual_start = std::move(o.actual_start);
     actual_end = std::move(o.actual_end);
+    blob_inputs = std::move(o.blob_inputs);
     status = std::move(o.status);
     outputs = std::move(o.outputs);
     outfile = std::move(o.outfile);
@@ -775,7 +781,39 @@ int CompactionJob::Prepare(int sub_compaction_slots) {
   // Is this compaction producing files at the bottommost level?
   bottommost_level_ = c->bottommost_level();
 
-  if (c->compaction_type() != kMapCompaction && !c->input_range().empty()) {
+  if (c->compaction_type() == kGarbageCollection) {
+    assert(c->inputs()->size() == 1 && c->inputs()->front().level == -1);
+    auto& files = c->inputs()->front().files;
+    size_t n = std::min({uint32_t(sub_compaction_slots + 1),
+                         uint32_t(files.size()), c->max_subcompactions()});
+    n = std::max<size_t>(n, 1);
+    // Balance the sub-jobs by file size, the biggest file goes to the
+    // lightest sub-job
+    std::vector<FileMetaData*> sorted_files(files);
+    std::sort(sorted_files.begin(), sorted_files.end(),
+              [](FileMetaData* a, FileMetaData* b) {
+                return a->fd.GetFileSize() > b->fd.GetFileSize();
+              });
+    std::vector<uint64_t> sub_sizes(n);
+    std::vector<CompactionInputFiles> sub_inputs(n);
+    for (auto f : sorted_files) {
+      size_t i = std::min_element(sub_sizes.begin(), sub_sizes.end()) -
+                 sub_sizes.begin();
+      sub_sizes[i] += f->fd.GetFileSize();
+      sub_inputs[i].level = -1;
+      sub_inputs[i].files.emplace_back(f);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      compact_->sub_compact_states.emplace_back(c, nullptr, nullptr,
+                                                sub_sizes[i]);
+      compact_->sub_compact_states.back().blob_inputs.emplace_back(
+          std::move(sub_inputs[i]));
+    }
+    if (n > 1) {
+      MeasureTime(stats_, NUM_SUBCOMPACTIONS_SCHEDULED, n);
+    }
+  } else if (c->compaction_type() != kMapCompaction &&
+             !c->input_range().empty()) {
     auto& input_range = c->input_range();
     size_t n =
         std::min({uint32_t(sub_compaction_slots + 1),
@@ -978,6 +1016,11 @@ static std::shared_ptr<CompactionDispatcher> GetCmdLineDispatcher() {
   const char* cmdline = getenv("TerarkDB_compactionWorkerCommandLine");
   if (cmdline) {
 #ifdef WITH_TERARK_ZIP
+    // Workers started by cmdline serve many jobs if a pool size is given
+    const char* pool_size = getenv("TerarkDB_compactionWorkerPoolSize");
+    if (pool_size && atoi(pool_size) > 0) {
+      return NewWorkerPoolCompactionDispatcher(cmdline, atoi(pool_size));
+    }
     return NewCommandLineCompactionDispatcher(cmdline);
 #endif
   }
@@ -1050,7 +1093,8 @@ Status CompactionJob::Run() {
     }
     context.compaction_filter_factory = factory->Name();
   }
-  context.blob_config = c->mutable_cf_options()->get_blob_config();
+  context.blob_config = c->column_family_data()->GetBlobConfig(
+      *c->mutable_cf_options(), c->output_level());
   context.separation_type = c->separation_type();
   context.table_factory = iopt->table_factory->Name();
   s = iopt->table_factory->GetOptionString(&context.table_factory_options,
@@ -1463,6 +1507,13 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
            << compaction_job_stats_->num_single_del_fallthru;
   }
 
+  if (compaction_job_stats_ != nullptr &&
+      compact_->compaction->compaction_type() == kGarbageCollection) {
+    stream << "num_gc_sub_jobs" << compaction_job_stats_->num_gc_sub_jobs;
+    stream << "gc_input_bytes_per_second"
+           << compaction_job_stats_->gc_input_bytes_per_second;
+  }
+
   if (measure_io_stats_ && compaction_job_stats_ != nullptr) {
     stream << "file_write_nanos" << compaction_job_stats_->file_write_nanos;
     stream << "file_range_sync_nanos"
@@ -1540,6 +1591,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 
   const MutableCFOptions* mutable_cf_options =
       sub_compact->compaction->mutable_cf_options();
+  const BlobConfig blob_config = cfd->GetBlobConfig(
+      *mutable_cf_options, sub_compact->compaction->output_level());
 
   // To build compression dictionary, we sample the first output file, assuming
   // it'll reach the maximum length. We optionally pass these samples through
@@ -1591,16 +1644,18 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   struct BuilderSeparateHelper : public SeparateHelper {
     SeparateHelper* separate_helper = nullptr;
     std::unique_ptr<ValueExtractor> value_meta_extractor;
+    bool keep_value_location = false;
     Status (*trans_to_separate_callback)(void* args, const Slice& key,
                                          LazyBuffer& value) = nullptr;
     void* trans_to_separate_callback_args = nullptr;
 
     Status TransToSeparate(const Slice& internal_key, LazyBuffer& value,
                            const Slice& meta, bool is_merge,
-                           bool is_index) override {
+                           bool is_index, uint64_t location) override {
       return SeparateHelper::TransToSeparate(
           internal_key, value, value.file_number(), meta, is_merge, is_index,
-          value_meta_extractor.get());
+          value_meta_extractor.get(),
+          keep_value_location ? location : kNoLocation);
     }
 
     Status TransToSeparate(const Slice& key, LazyBuffer& value) override {
@@ -1624,6 +1679,9 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
             ->value_meta_extractor_factory->CreateValueExtractor(context);
   }
 
+  separate_helper.keep_value_location =
+      mutable_cf_options->enable_blob_value_location;
+
   size_t target_blob_file_size =
       MaxBlobSize(*mutable_cf_options, cfd->ioptions()->num_levels,
                   cfd->ioptions()->compaction_style);
@@ -1650,7 +1708,10 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       s = SeparateHelper::TransToSeparate(
           key, value, blob_meta->fd.GetNumber(), Slice(),
           GetInternalKeyType(key) == kTypeMerge, false,
-          separate_helper.value_meta_extractor.get());
+          separate_helper.value_meta_extractor.get(),
+          separate_helper.keep_value_location
+              ? blob_builder->LastEntryLocation()
+              : SeparateHelper::kNoLocation);
     }
     return s;
   };
@@ -1695,8 +1756,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       versions_->LastSequence(), &existing_snapshots_,
       earliest_write_conflict_snapshot_, snapshot_checker_, env_,
       ShouldReportDetailedTime(env_, stats_), false, &range_del_agg,
-      sub_compact->compaction, mutable_cf_options->get_blob_config(),
-      compaction_filter, shutting_down_, preserve_deletes_seqnum_,
+      sub_compact->compaction, blob_config, compaction_filter,
+      shutting_down_, preserve_deletes_seqnum_,
       &rebuild_blobs_info.blobs));
   auto c_iter = sub_compact->c_iter.get();
   c_iter->SeekToFirst();
@@ -1749,7 +1810,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         cfd->user_comparator(), merge_ptr, versions_->LastSequence(),
         &existing_snapshots_, earliest_write_conflict_snapshot_,
         snapshot_checker_, env_, false, false, range_del_agg_ptr,
-        sub_compact->compaction, mutable_cf_options->get_blob_config(),
+        sub_compact->compaction, blob_config,
         second_pass_iter_storage.compaction_filter, shutting_down_,
         preserve_deletes_seqnum_, &rebuild_blobs_info.blobs);
   };
@@ -2049,9 +2110,34 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 void CompactionJob::ProcessGarbageCollection(SubcompactionState* sub_compact) {
   assert(sub_compact != nullptr);
   ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
-
-  std::unique_ptr<InternalIterator> input(versions_->MakeInputIterator(
-      sub_compact->compaction, nullptr, env_options_for_read_));
+  Version* input_version = sub_compact->compaction->input_version();
+  auto& dependence_map = input_version->storage_info()->dependence_map();
+  auto& sub_inputs = sub_compact->blob_inputs;
+  assert(sub_inputs.size() == 1 && sub_inputs.front().level == -1);
+  auto& files = sub_inputs.front().files;
+
+  // Merge the input blob files of this sub-job only
+  auto make_input_iter = [&]() -> InternalIterator* {
+    ReadOptions read_options;
+    read_options.verify_checksums = true;
+    read_options.fill_cache = false;
+    read_options.total_order_seek = true;
+    std::vector<InternalIterator*> list;
+    for (auto f : files) {
+      list.emplace_back(cfd->table_cache()->NewIterator(
+          read_options, env_options_for_read_, cfd->internal_comparator(), *f,
+          dependence_map, nullptr /* range_del_agg */,
+          sub_compact->compaction->mutable_cf_options()
+              ->prefix_extractor.get(),
+          nullptr /* table_reader_ptr */,
+          nullptr /* no per level latency histogram */,
+          true /* for_compaction */, nullptr /* arena */,
+          false /* skip_filters */, -1 /* level */));
+    }
+    return NewMergingIterator(&cfd->internal_comparator(), list.data(),
+                              static_cast<int>(list.size()));
+  };
+  std::unique_ptr<InternalIterator> input(make_input_iter());
 
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_PROCESS_KV);
@@ -2080,10 +2166,7 @@ void CompactionJob::ProcessGarbageCollection(SubcompactionState* sub_compact) {
   std::unordered_map<Slice, uint64_t, SliceHasher> conflict_map;
   std::mutex conflict_map_mutex;
 
-  auto create_iter = [&](Arena* /* arena */) {
-    return versions_->MakeInputIterator(sub_compact->compaction, nullptr,
-                                        env_options_for_read_);
-  };
+  auto create_iter = [&](Arena* /* arena */) { return make_input_iter(); };
   auto filter_conflict = [&](const Slice& ikey, const LazyBuffer& value) {
     std::lock_guard<std::mutex> lock(conflict_map_mutex);
     auto find = conflict_map.find(ikey);
@@ -2101,8 +2184,6 @@ void CompactionJob::ProcessGarbageCollection(SubcompactionState* sub_compact) {
   }
   sub_compact->blob_builder->SetSecondPassIterator(&second_pass_iter);
 
-  Version* input_version = sub_compact->compaction->input_version();
-  auto& dependence_map = input_version->storage_info()->dependence_map();
   auto& comp = cfd->internal_comparator();
   std::string last_key;
   uint64_t last_file_number = uint64_t(-1);
@@ -2115,8 +2196,8 @@ void CompactionJob::ProcessGarbageCollection(SubcompactionState* sub_compact) {
     uint64_t file_number_mismatch = 0;
   } counter;
   std::vector<std::pair<uint64_t, FileMetaData*>> blob_meta_cache;
-  assert(!sub_compact->compaction->inputs()->empty());
-  blob_meta_cache.reserve(sub_compact->compaction->inputs()->front().size());
+  assert(!files.empty());
+  blob_meta_cache.reserve(files.size());
   while (status.ok() && !cfd->IsDropped() && input->Valid()) {
     ++counter.input;
     Slice curr_key = input->key();
@@ -2223,9 +2304,9 @@ void CompactionJob::ProcessGarbageCollection(SubcompactionState* sub_compact) {
   std::vector<uint64_t> inheritance_tree;
   size_t inheritance_tree_pruge_count = 0;
   if (status.ok()) {
-    status = BuildInheritanceTree(
-        *sub_compact->compaction->inputs(), dependence_map, input_version,
-        &inheritance_tree, &inheritance_tree_pruge_count);
+    status = BuildInheritanceTree(sub_inputs, dependence_map, input_version,
+                                  &inheritance_tree,
+                                  &inheritance_tree_pruge_count);
   }
   Status s = FinishCompactionOutputBlob(status, sub_compact, inheritance_tree);
   if (status.ok()) {
@@ -2233,9 +2314,10 @@ void CompactionJob::ProcessGarbageCollection(SubcompactionState* sub_compact) {
   }
   if (status.ok()) {
     auto& meta = sub_compact->blob_outputs.front().meta;
-    auto& inputs = *sub_compact->compaction->inputs();
-    assert(inputs.size() == 1 && inputs.front().level == -1);
-    auto& files = inputs.front().files;
+    uint64_t num_antiquation = 0;
+    for (auto f : files) {
+      num_antiquation += f->num_antiquation;
+    }
     ROCKS_LOG_INFO(
         db_options_.info_log,
         "[%s] [JOB %d] Table #%" PRIu64 " GC: %" PRIu64
@@ -2245,7 +2327,7 @@ void CompactionJob::ProcessGarbageCollection(SubcompactionState* sub_compact) {
         " file number mismatch ], inheritance tree: %zd -> %zd",
         cfd->GetName().c_str(), job_id_, meta.fd.GetNumber(), counter.input,
         files.size(), counter.input - meta.prop.num_entries,
-        sub_compact->compaction->num_antiquation() * 100. / counter.input,
+        num_antiquation * 100. / counter.input,
         counter.garbage_type, counter.get_not_found,
         counter.file_number_mismatch,
         meta.prop.inheritance.size() + inheritance_tree_pruge_count,
@@ -3204,6 +3286,18 @@ void CompactionJob::UpdateCompactionJobStats(
                  CompactionJobStats::kMaxPrefixLength,
                  &compaction_job_stats_->largest_output_key_prefix);
     }
+
+    if (compact_->compaction->compaction_type() == kGarbageCollection) {
+      compaction_job_stats_->num_gc_sub_jobs =
+          compact_->sub_compact_states.size();
+      compaction_job_stats_->gc_input_bytes =
+          compaction_job_stats_->total_input_bytes;
+      compaction_job_stats_->gc_elapsed_micros =
+          std::max<uint64_t>(stats.micros, 1);
+      compaction_job_stats_->gc_input_bytes_per_second =
+          compaction_job_stats_->gc_input_bytes * 1000000 /
+          compaction_job_stats_->gc_elapsed_micros;
+    }
   }
 #else
   (void)stats;
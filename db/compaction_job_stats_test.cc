@@ -474,6 +474,26 @@ class CompactionJobStatsChecker : public EventListener {
   bool verify_next_comp_io_stats_;
 };
 
+// An EventListener which collects the stats of garbage collections.
+class GarbageCollectionStatsCollector : public EventListener {
+ public:
+  virtual void OnCompactionCompleted(DB* /*db*/, const CompactionJobInfo& ci) {
+    if (ci.compaction_reason == CompactionReason::kGarbageCollection) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.push_back(ci.stats);
+    }
+  }
+
+  std::vector<CompactionJobStats> stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<CompactionJobStats> stats_;
+};
+
 // An EventListener which helps verify the compaction statistics in
 // the test DeletionStatsTest.
 class CompactionJobDeletionStatsChecker : public CompactionJobStatsChecker {
@@ -934,6 +954,66 @@ TEST_P(CompactionJobStatsTest, UniversalCompactionTest) {
   ASSERT_EQ(stats_checker->NumberOfUnverifiedStats(), 0U);
 }
 
+TEST_P(CompactionJobStatsTest, GarbageCollectionStatsTest) {
+  auto* collector = new GarbageCollectionStatsCollector();
+  Options options;
+  options.listeners.emplace_back(collector);
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.blob_gc_ratio = 0.05;
+  options.level0_file_num_compaction_trigger = 2;
+  options.max_background_compactions = 4;
+  options.max_subcompactions = max_subcompactions_;
+  options.enable_lazy_compaction = false;
+  DestroyAndReopen(options);
+
+  // The rounds after the first overwrite half of the keys, the blob files of
+  // the former rounds keep live values among the garbage
+  const std::string value(200, 'v');
+  for (int round = 0; round < 6; ++round) {
+    for (int i = 0; i < 1000; i += round == 0 ? 1 : 2) {
+      ASSERT_OK(Put(Key(i, 10), value));
+    }
+    ASSERT_OK(Flush());
+    dbfull()->TEST_WaitForCompact();
+  }
+
+  auto stats = collector->stats();
+  ASSERT_FALSE(stats.empty());
+  CompactionJobStats total;
+  size_t max_sub_jobs = 0;
+  for (auto& s : stats) {
+    ASSERT_GT(s.gc_elapsed_micros, 0);
+    ASSERT_EQ(s.gc_input_bytes, s.total_input_bytes);
+    ASSERT_EQ(s.gc_input_bytes_per_second,
+              s.gc_input_bytes * 1000000 / s.gc_elapsed_micros);
+    max_sub_jobs = std::max(max_sub_jobs, s.num_gc_sub_jobs);
+    total.Add(s);
+  }
+  if (max_subcompactions_ > 1) {
+    ASSERT_GT(max_sub_jobs, 1);
+  } else {
+    ASSERT_EQ(max_sub_jobs, 1);
+  }
+  // The aggregated rate is the rate of the summed bytes and time, not the sum
+  // of the rates of the sub-jobs
+  ASSERT_EQ(total.gc_input_bytes_per_second,
+            total.gc_input_bytes * 1000000 / total.gc_elapsed_micros);
+
+  CompactionJobStats sub_job[2];
+  sub_job[0].num_gc_sub_jobs = sub_job[1].num_gc_sub_jobs = 1;
+  sub_job[0].gc_input_bytes = 3000000;
+  sub_job[0].gc_elapsed_micros = 1000000;
+  sub_job[1].gc_input_bytes = 1000000;
+  sub_job[1].gc_elapsed_micros = 3000000;
+  CompactionJobStats job;
+  job.Add(sub_job[0]);
+  job.Add(sub_job[1]);
+  ASSERT_EQ(2, job.num_gc_sub_jobs);
+  ASSERT_EQ(1000000, job.gc_input_bytes_per_second);
+}
+
 INSTANTIATE_TEST_CASE_P(CompactionJobStatsTest, CompactionJobStatsTest,
                         ::testing::Values(1, 4));
 }  // namespace TERARKDB_NAMESPACE
@@ -904,6 +904,8 @@ Compaction* CompactionPicker::PickGarbageCollection(
   auto push_candidate = [&](FileMetaData* f) {
     if (f->is_gc_permitted() && !f->being_compacted) {
       GarbageFileInfo gc_blob(f);
+      // Log ssts written by flush follow the same rule, they are folded into
+      // essence ssts once they are fragments or dirty enough
       if (gc_blob.estimate_size <= fragment_size ||
           gc_blob.score >= mutable_cf_options.blob_gc_ratio ||
           gc_blob.f->marked_for_compaction) {
@@ -950,7 +952,7 @@ Compaction* CompactionPicker::PickGarbageCollection(
       ioptions_, vstorage, mutable_cf_options, bottommost_level, 1, true);
   params.compression_opts =
       GetCompressionOptions(ioptions_, vstorage, bottommost_level, true);
-  params.max_subcompactions = 1;
+  params.max_subcompactions = mutable_cf_options.max_subcompactions;
   params.score = vstorage->total_garbage_ratio();
   params.compaction_type = kGarbageCollection;
   params.compaction_reason = CompactionReason::kGarbageCollection;
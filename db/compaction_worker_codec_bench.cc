@@ -0,0 +1,280 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "db/compaction.h"
+#include "rocksdb/env.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/ajson_msd.hpp"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+#include "util/stop_watch.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+
+DEFINE_int32(num_files, 2000, "number of input files in the context");
+
+DEFINE_int32(key_size, 64, "size of user keys and file boundaries");
+
+DEFINE_int32(num_snapshots, 16, "number of existing snapshots");
+
+DEFINE_int32(num_runs, 100, "number of encode/decode runs");
+
+DEFINE_int32(seed, 301, "random number generator seed");
+
+// The JSON encoding RemoteCompactionDispatcher used before the binary wire
+// format, kept here as the baseline: every EncodedString and InternalKey is
+// hex encoded.
+
+struct AJsonStatus {
+  unsigned char code, subcode, sev;
+  std::string state;
+};
+AJSON(AJsonStatus, code, subcode, sev, state);
+
+namespace ajson {
+template <>
+struct json_impl<TERARKDB_NAMESPACE::Status, void> {
+  static inline void read(reader& rd, TERARKDB_NAMESPACE::Status& v) {
+    AJsonStatus s;
+    json_impl<AJsonStatus>::read(rd, s);
+    v = TERARKDB_NAMESPACE::Status(s.code, s.subcode, s.sev,
+                                   s.state.empty() ? nullptr : s.state.c_str());
+  }
+  template <typename write_ty>
+  static inline void write(write_ty& wt, TERARKDB_NAMESPACE::Status const& v) {
+    AJsonStatus s = {v.code(), v.subcode(), v.severity(),
+                     v.getState() == nullptr ? std::string() : v.getState()};
+    json_impl<AJsonStatus>::template write<write_ty>(wt, s);
+  }
+};
+
+template <>
+struct json_impl<TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString,
+                 void> {
+  static inline void read(
+      reader& rd,
+      TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString& v) {
+    std::string s;
+    json_impl<std::string>::read(rd, s);
+    v.data.resize(s.size() / 2);
+    for (size_t i = 0; i < s.size(); i += 2) {
+      char x[3] = {s[i], s[i + 1], '\0'};
+      v.data[i / 2] = std::stoi(x, nullptr, 16);
+    }
+  }
+  template <typename write_ty>
+  static inline void write(
+      write_ty& wt,
+      TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString const& v) {
+    json_impl<std::string>::template write<write_ty>(
+        wt, TERARKDB_NAMESPACE::Slice(v.data).ToString(true));
+  }
+};
+
+template <>
+struct json_impl<TERARKDB_NAMESPACE::InternalKey, void> {
+  static inline void read(reader& rd, TERARKDB_NAMESPACE::InternalKey& v) {
+    TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString s;
+    json_impl<TERARKDB_NAMESPACE::CompactionWorkerContext::EncodedString>::read(
+        rd, s);
+    *v.rep() = std::move(s.data);
+  }
+  template <typename write_ty>
+  static inline void write(write_ty& wt,
+                           TERARKDB_NAMESPACE::InternalKey const& v) {
+    TERARKDB_NAMESPACE::Slice s(*v.rep());
+    json_impl<std::string>::template write<write_ty>(wt, s.ToString(true));
+  }
+};
+}  // namespace ajson
+
+using namespace TERARKDB_NAMESPACE;
+
+AJSON(Dependence, file_number, entry_count);
+
+using FileInfo = CompactionWorkerResult::FileInfo;
+AJSON(FileInfo, smallest, largest, file_name, smallest_seqno, largest_seqno,
+      file_size, marked_for_compaction);
+
+AJSON(CompactionWorkerResult, status, actual_start, actual_end, files, stat_all,
+      time_us);
+
+AJSON(FileDescriptor, packed_number_and_path_id, file_size, smallest_seqno,
+      largest_seqno);
+
+AJSON(TablePropertyCache, num_entries, num_deletions, raw_key_size,
+      raw_value_size, flags, purpose, max_read_amp, read_amp, dependence,
+      inheritance);
+
+AJSON(FileMetaData, fd, smallest, largest, prop);
+
+AJSON(CompressionOptions, window_bits, level, strategy, max_dict_bytes,
+      zstd_max_train_bytes, enabled);
+
+AJSON(CompactionFilterContext, is_full_compaction, is_manual_compaction,
+      column_family_id);
+
+using NameParam = CompactionWorkerContext::NameParam;
+AJSON(NameParam, name, param);
+
+AJSON(BlobConfig, blob_size, large_key_ratio);
+
+AJSON(CompactionWorkerContext, user_comparator, merge_operator,
+      merge_operator_data, value_meta_extractor_factory,
+      value_meta_extractor_factory_options, compaction_filter,
+      compaction_filter_factory, compaction_filter_context,
+      compaction_filter_data, blob_config, separation_type, table_factory,
+      table_factory_options, bloom_locality, cf_paths, prefix_extractor,
+      prefix_extractor_options, has_start, has_end, start, end, last_sequence,
+      earliest_write_conflict_snapshot, preserve_deletes_seqnum, file_metadata,
+      inputs, cf_name, target_file_size, compression, compression_opts,
+      existing_snapshots, smallest_user_key, largest_user_key, level,
+      output_level, number_levels, skip_filters, bottommost_level,
+      allow_ingest_behind, preserve_deletes, int_tbl_prop_collector_factories);
+
+namespace {
+
+struct Stats {
+  uint64_t encode_nanos = 0;
+  uint64_t decode_nanos = 0;
+  size_t encoded_size = 0;
+};
+
+void PrintStats(const char* name, const Stats& s) {
+  std::cout << std::left << std::setw(10) << name << std::right
+            << " size: " << std::setw(12) << s.encoded_size
+            << " bytes, encode: " << std::setw(10)
+            << s.encode_nanos / (FLAGS_num_runs * 1.0e3)
+            << " us, decode: " << std::setw(10)
+            << s.decode_nanos / (FLAGS_num_runs * 1.0e3) << " us\n";
+}
+
+InternalKey RandomInternalKey(Random* rnd, SequenceNumber seq) {
+  std::string user_key;
+  for (int i = 0; i < FLAGS_key_size; ++i) {
+    user_key.push_back(static_cast<char>(rnd->Uniform(256)));
+  }
+  return InternalKey(user_key, seq, kTypeValue);
+}
+
+void MakeContext(Random* rnd, CompactionWorkerContext* context) {
+  context->user_comparator = "leveldb.BytewiseComparator";
+  context->merge_operator = "";
+  context->compaction_filter_factory = "";
+  context->compaction_filter_context = CompactionFilterContext{};
+  context->blob_config = BlobConfig{512, 0.25};
+  context->separation_type = 0;
+  context->table_factory = "TerarkZipTable";
+  context->table_factory_options = std::string(1024, 'o');
+  context->bloom_locality = 0;
+  context->cf_paths.emplace_back("/data/terarkdb");
+  context->has_start = context->has_end = true;
+  context->start = RandomInternalKey(rnd, 0).user_key();
+  context->end = RandomInternalKey(rnd, 0).user_key();
+  context->last_sequence = 1ULL << 40;
+  context->earliest_write_conflict_snapshot = kMaxSequenceNumber;
+  context->preserve_deletes_seqnum = 0;
+  for (int i = 0; i < FLAGS_num_files; ++i) {
+    uint64_t file_number = 1000 + i;
+    FileMetaData f;
+    f.fd = FileDescriptor(file_number, 0, 64ULL << 20, i * 100, i * 100 + 99);
+    f.smallest = RandomInternalKey(rnd, i * 100);
+    f.largest = RandomInternalKey(rnd, i * 100 + 99);
+    f.prop.num_entries = 1 << 20;
+    f.prop.raw_key_size = f.prop.num_entries * FLAGS_key_size;
+    f.prop.raw_value_size = f.prop.num_entries * 512;
+    for (int j = 0; j < 4; ++j) {
+      f.prop.dependence.emplace_back(Dependence{rnd->Next(), rnd->Next()});
+      f.prop.inheritance.emplace_back(rnd->Next());
+    }
+    context->file_metadata.emplace_back(file_number, f);
+    context->inputs.emplace_back(i % 2, file_number);
+  }
+  context->cf_name = "default";
+  context->target_file_size = 64ULL << 20;
+  context->compression = kNoCompression;
+  for (int i = 0; i < FLAGS_num_snapshots; ++i) {
+    context->existing_snapshots.emplace_back(i * 1000);
+  }
+  context->smallest_user_key = context->start;
+  context->largest_user_key = context->end;
+  context->level = 1;
+  context->output_level = 2;
+  context->number_levels = 7;
+  context->skip_filters = context->bottommost_level = false;
+  context->allow_ingest_behind = context->preserve_deletes = false;
+  context->int_tbl_prop_collector_factories.emplace_back(
+      NameParam{"TtlCollectorFactory", {std::string(64, 'p')}});
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ParseCommandLineFlags(&argc, &argv, true);
+
+  Random rnd(FLAGS_seed);
+  CompactionWorkerContext context;
+  MakeContext(&rnd, &context);
+  Env* env = Env::Default();
+
+  Stats json_stats, binary_stats;
+  for (int i = 0; i < FLAGS_num_runs; ++i) {
+    std::string encoded;
+    {
+      StopWatchNano stop_watch(env, true /* auto_start */);
+      ajson::string_stream stream;
+      ajson::save_to(stream, context);
+      encoded = stream.str();
+      json_stats.encode_nanos += stop_watch.ElapsedNanos();
+    }
+    json_stats.encoded_size = encoded.size();
+    {
+      StopWatchNano stop_watch(env, true /* auto_start */);
+      CompactionWorkerContext decoded;
+      ajson::load_from_buff(decoded, &encoded[0], encoded.size());
+      json_stats.decode_nanos += stop_watch.ElapsedNanos();
+    }
+
+    encoded.clear();
+    {
+      StopWatchNano stop_watch(env, true /* auto_start */);
+      context.EncodeTo(&encoded);
+      binary_stats.encode_nanos += stop_watch.ElapsedNanos();
+    }
+    binary_stats.encoded_size = encoded.size();
+    {
+      StopWatchNano stop_watch(env, true /* auto_start */);
+      CompactionWorkerContext decoded;
+      Slice input(encoded);
+      Status s = decoded.DecodeFrom(&input);
+      binary_stats.decode_nanos += stop_watch.ElapsedNanos();
+      if (!s.ok()) {
+        fprintf(stderr, "DecodeFrom: %s\n", s.ToString().c_str());
+        return 1;
+      }
+    }
+  }
+
+  std::cout << "CompactionWorkerContext with " << FLAGS_num_files
+            << " input files, " << FLAGS_num_runs << " runs\n";
+  PrintStats("json", json_stats);
+  PrintStats("binary", binary_stats);
+  return 0;
+}
+
+#endif  // GFLAGS
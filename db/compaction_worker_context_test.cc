@@ -0,0 +1,144 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/coding.h"
+#include "util/testharness.h"
+
+namespace TERARKDB_NAMESPACE {
+
+class CompactionWorkerContextTest : public testing::Test {};
+
+TEST_F(CompactionWorkerContextTest, EncodeDecodeContext) {
+  CompactionWorkerContext context;
+  context.user_comparator = "leveldb.BytewiseComparator";
+  context.merge_operator_data = std::string("\0\1\2", 3);
+  context.compaction_filter_context = CompactionFilterContext{};
+  context.compaction_filter_context.column_family_id = 7;
+  context.blob_config = BlobConfig{512, 0.25};
+  context.separation_type = 2;
+  context.table_factory = "BlockBasedTable";
+  context.bloom_locality = 1;
+  context.cf_paths = {"/a", "/b"};
+  context.has_start = true;
+  context.has_end = false;
+  context.start = std::string("start");
+  context.last_sequence = 1ULL << 50;
+  context.earliest_write_conflict_snapshot = kMaxSequenceNumber;
+  context.preserve_deletes_seqnum = 3;
+  FileMetaData f;
+  f.fd = FileDescriptor(100, 1, 4096, 10, 20);
+  f.smallest = InternalKey("a", 10, kTypeValue);
+  f.largest = InternalKey("z", 20, kTypeValueIndex);
+  f.prop.num_entries = 9;
+  f.prop.purpose = kMapSst;
+  f.prop.read_amp = 1.5;
+  f.prop.dependence = {Dependence{101, 5}, Dependence{102, 4}};
+  f.prop.inheritance = {98, 99};
+  context.file_metadata.emplace_back(100, f);
+  context.inputs.emplace_back(-1, 100);
+  context.cf_name = "default";
+  context.target_file_size = 1 << 20;
+  context.compression = kZSTD;
+  context.compression_opts.window_bits = -14;
+  context.existing_snapshots = {5, 15};
+  context.smallest_user_key = std::string("a");
+  context.largest_user_key = std::string("z");
+  context.level = 1;
+  context.output_level = 2;
+  context.number_levels = 7;
+  context.skip_filters = true;
+  context.bottommost_level = false;
+  context.allow_ingest_behind = false;
+  context.preserve_deletes = true;
+  context.int_tbl_prop_collector_factories.emplace_back(
+      CompactionWorkerContext::NameParam{"collector", {std::string("p")}});
+
+  std::string encoded, encoded2;
+  context.EncodeTo(&encoded);
+  CompactionWorkerContext decoded;
+  Slice input(encoded);
+  ASSERT_OK(decoded.DecodeFrom(&input));
+  ASSERT_TRUE(input.empty());
+  decoded.EncodeTo(&encoded2);
+  ASSERT_EQ(encoded, encoded2);
+
+  ASSERT_EQ(7U, decoded.compaction_filter_context.column_family_id);
+  ASSERT_EQ(-14, decoded.compression_opts.window_bits);
+  ASSERT_EQ(-1, decoded.inputs[0].first);
+  auto& df = decoded.file_metadata[0].second;
+  ASSERT_EQ(100U, df.fd.GetNumber());
+  ASSERT_EQ(1U, df.fd.GetPathId());
+  ASSERT_EQ(f.smallest.Encode(), df.smallest.Encode());
+  ASSERT_TRUE(df.prop.is_map_sst());
+  ASSERT_EQ(2U, df.prop.dependence.size());
+  ASSERT_EQ(4U, df.prop.dependence[1].entry_count);
+  ASSERT_EQ(1.5, df.prop.read_amp);
+
+  // Truncated input must not be accepted
+  for (size_t size : {size_t(0), size_t(3), encoded.size() / 2,
+                      encoded.size() - 1}) {
+    Slice truncated(encoded.data(), size);
+    CompactionWorkerContext bad;
+    ASSERT_TRUE(bad.DecodeFrom(&truncated).IsCorruption());
+  }
+}
+
+TEST_F(CompactionWorkerContextTest, EncodeDecodeResult) {
+  CompactionWorkerResult result;
+  result.status = Status::Corruption("bad", "block");
+  result.actual_start = InternalKey("a", 1, kTypeValue);
+  CompactionWorkerResult::FileInfo file_info;
+  file_info.smallest = InternalKey("a", 1, kTypeValue);
+  file_info.largest = InternalKey("b", 2, kTypeValue);
+  file_info.file_name = "Worker-0";
+  file_info.smallest_seqno = 1;
+  file_info.largest_seqno = 2;
+  file_info.file_size = 1234;
+  file_info.marked_for_compaction = FileMetaData::kMarkedFromTableBuilder;
+  result.files.emplace_back(file_info);
+  result.stat_all = "stat";
+  result.time_us = 42;
+
+  std::string encoded;
+  result.EncodeTo(&encoded);
+  CompactionWorkerResult decoded;
+  Slice input(encoded);
+  ASSERT_OK(decoded.DecodeFrom(&input));
+  ASSERT_EQ(result.status.ToString(), decoded.status.ToString());
+  ASSERT_EQ(0U, decoded.actual_end.size());
+  ASSERT_EQ(1U, decoded.files.size());
+  ASSERT_EQ("Worker-0", decoded.files[0].file_name);
+  ASSERT_EQ(1234U, decoded.files[0].file_size);
+  ASSERT_EQ(FileMetaData::kMarkedFromTableBuilder,
+            decoded.files[0].marked_for_compaction);
+  ASSERT_EQ(42U, decoded.time_us);
+
+  // A count the input can't hold is rejected before sizing anything
+  CompactionWorkerResult empty;
+  std::string empty_encoded;
+  empty.EncodeTo(&empty_encoded);
+  // magic, version, status, actual_start, actual_end, then the file count
+  const size_t kFileCountOffset = 4 + 1 + 4 + 1 + 1;
+  ASSERT_EQ(0, empty_encoded[kFileCountOffset]);
+  std::string huge_count = empty_encoded.substr(0, kFileCountOffset);
+  PutVarint64(&huge_count, uint64_t(1) << 60);
+  huge_count.append(empty_encoded.substr(kFileCountOffset + 1));
+  input = huge_count;
+  ASSERT_TRUE(decoded.DecodeFrom(&input).IsCorruption());
+
+  // Unknown format version
+  encoded[4] = 0x7f;
+  input = encoded;
+  ASSERT_TRUE(decoded.DecodeFrom(&input).IsNotSupported());
+}
+
+}  // namespace TERARKDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,12 +14,63 @@
 #if !defined(ROCKSDB_LITE)
 #include "util/sync_point.h"
 #endif
+#ifdef WITH_TERARK_ZIP
+#include "table/terark_zip_table.h"
+#endif
 
 namespace TERARKDB_NAMESPACE {
 
 class DBBasicTest : public DBTestBase {
  public:
   DBBasicTest() : DBTestBase("/db_basic_test") {}
+
+  // Flushes 100 values, 90 of them large enough to go to log ssts, and reads
+  // them back before and after a reopen
+  void FlushSeparatedValueToLogSst(const Options& options) {
+    DestroyAndReopen(options);
+
+    auto value_of = [](int i) {
+      return i % 10 == 0 ? "small" : Key(i) + std::string(100, 'a' + i % 26);
+    };
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_OK(Put(Key(i), value_of(i)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_EQ(1, NumTableFilesAtLevel(0));
+
+    auto cfd =
+        static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+            ->cfd();
+    auto vstorage = cfd->current()->storage_info();
+    auto& log_ssts = vstorage->LevelFiles(-1);
+    ASSERT_GT(log_ssts.size(), 0U);
+    uint64_t num_separated = 0;
+    for (auto f : log_ssts) {
+      ASSERT_EQ(uint8_t(kLogSst), f->prop.purpose);
+      num_separated += f->prop.num_entries;
+    }
+    ASSERT_EQ(90U, num_separated);
+    auto l0_file = vstorage->LevelFiles(0).front();
+    ASSERT_EQ(uint8_t(kEssenceSst), l0_file->prop.purpose);
+    ASSERT_EQ(log_ssts.size(), l0_file->prop.dependence.size());
+
+    for (int reopen = 0; reopen < 2; ++reopen) {
+      if (reopen) {
+        Reopen(options);
+      }
+      for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(value_of(i), Get(Key(i)));
+      }
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+      int i = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+        ASSERT_EQ(Key(i), iter->key().ToString());
+        ASSERT_EQ(value_of(i), iter->value().ToString());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(100, i);
+    }
+  }
 };
 
 TEST_F(DBBasicTest, OpenWhenOpen) {
@@ -847,6 +898,291 @@ TEST_F(DBBasicTest, MultiGetEmpty) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, MultiGetSeparatedValue) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  auto value_of = [](int i) { return Key(i) + std::string(100, 'a' + i % 26); };
+  for (int cf = 0; cf < 2; ++cf) {
+    for (int i = 0; i < 200; i += 2) {
+      ASSERT_OK(Put(cf, Key(i), value_of(i)));
+    }
+    ASSERT_OK(Flush(cf));
+    for (int i = 1; i < 200; i += 2) {
+      ASSERT_OK(Put(cf, Key(i), value_of(i)));
+    }
+    ASSERT_OK(Flush(cf));
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), handles_[cf], nullptr,
+                                nullptr));
+  }
+  ASSERT_GT(NumTableFilesAtLevel(-1), 0);
+  // Overwrite some keys in memtable, their values are not separated
+  ASSERT_OK(Put(1, Key(7), "v7"));
+  ASSERT_OK(Delete(0, Key(9)));
+
+  std::vector<Slice> keys;
+  std::vector<std::string> key_strs;
+  std::vector<ColumnFamilyHandle*> cfs;
+  Random rnd(301);
+  for (int i = 0; i < 64; ++i) {
+    key_strs.emplace_back(Key(rnd.Uniform(210)));
+    cfs.emplace_back(handles_[i % 2]);
+  }
+  key_strs.emplace_back(Key(7));
+  cfs.emplace_back(handles_[1]);
+  key_strs.emplace_back(Key(9));
+  cfs.emplace_back(handles_[0]);
+  for (auto& k : key_strs) {
+    keys.emplace_back(k);
+  }
+
+  for (bool batch_separated_fetch : {true, false}) {
+    ReadOptions read_options;
+    read_options.batch_separated_fetch = batch_separated_fetch;
+    std::vector<std::string> values;
+    std::vector<Status> s = db_->MultiGet(read_options, cfs, keys, &values);
+    ASSERT_EQ(keys.size(), s.size());
+    ASSERT_EQ(keys.size(), values.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      std::string expect;
+      Status get_s = db_->Get(ReadOptions(), cfs[i], keys[i], &expect);
+      ASSERT_EQ(get_s.ToString(), s[i].ToString());
+      if (get_s.ok()) {
+        ASSERT_EQ(expect, values[i]);
+      }
+    }
+    ASSERT_EQ("v7", values[keys.size() - 2]);
+    ASSERT_TRUE(s[keys.size() - 1].IsNotFound());
+  }
+}
+
+TEST_F(DBBasicTest, MultiGetPrefetchSeparatedValues) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 256;  // a few values per data block
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  auto value_of = [](int i) { return Key(i) + std::string(100, 'a' + i % 26); };
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_GT(NumTableFilesAtLevel(-1), 0);
+  // Start over with a cold block cache
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  size_t prefetched_blocks = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::PrefetchForKeys:Read", [&](void* arg) {
+        prefetched_blocks += *static_cast<size_t*>(arg);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < 100; i += 3) {
+    key_strs.emplace_back(Key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<std::string> values;
+  std::vector<Status> s = db_->MultiGet(ReadOptions(), keys, &values);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(keys.size(), s.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_OK(s[i]);
+    ASSERT_EQ(value_of(static_cast<int>(i) * 3), values[i]);
+  }
+  // The blocks of the separated values were read as one batch
+  ASSERT_GT(prefetched_blocks, 1U);
+}
+
+TEST_F(DBBasicTest, GetSeparatedValueStatistics) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  auto value_of = [](int i) { return Key(i) + std::string(100, 'a' + i % 26); };
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_GT(NumTableFilesAtLevel(-1), 0);
+  ASSERT_OK(Put(Key(7), "v7"));
+
+  SetPerfLevel(kEnableTimeExceptForMutex);
+  get_perf_context()->Reset();
+  uint64_t value_bytes = 0;
+  for (int i = 0; i < 10; ++i) {
+    std::string value = Get(Key(i));
+    if (i == 7) {
+      ASSERT_EQ("v7", value);
+    } else {
+      ASSERT_EQ(value_of(i), value);
+      value_bytes += value.size();
+    }
+  }
+  SetPerfLevel(kDisable);
+
+  // Key(7) is found in memtable, it isn't separated
+  ASSERT_EQ(9U, TestGetTickerCount(options, SEPARATE_VALUE_FETCH));
+  ASSERT_EQ(value_bytes,
+            TestGetTickerCount(options, SEPARATE_VALUE_FETCH_BYTES));
+  ASSERT_EQ(9U, TestGetTickerCount(options, READ_DEPENDENCE_MAP_LOOKUP));
+  ASSERT_EQ(0U, TestGetTickerCount(options, SEPARATE_VALUE_MISSING));
+  HistogramData fetch_size;
+  options.statistics->histogramData(SEPARATE_VALUE_SIZE, &fetch_size);
+  ASSERT_EQ(9U, fetch_size.count);
+  ASSERT_EQ(9U, get_perf_context()->separate_value_fetch_count);
+  ASSERT_EQ(value_bytes, get_perf_context()->separate_value_fetch_bytes);
+  ASSERT_EQ(9U, get_perf_context()->dependence_map_lookup_count);
+  ASSERT_GT(get_perf_context()->separate_value_fetch_time, 0U);
+}
+
+TEST_F(DBBasicTest, GetSeparatedValueAtLocation) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.enable_blob_value_location = true;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 256;  // a few values per data block
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  auto value_of = [](int i) { return Key(i) + std::string(100, 'a' + i % 26); };
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(value_of(i), Get(Key(i)));
+  }
+  ASSERT_EQ(100U, TestGetTickerCount(options, SEPARATE_VALUE_LOCATION_HIT));
+  ASSERT_EQ(0U, TestGetTickerCount(options, SEPARATE_VALUE_MISSING));
+
+  // Compactions pass the value indexes through along with their locations
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(value_of(i), Get(Key(i)));
+  }
+  ASSERT_EQ(200U, TestGetTickerCount(options, SEPARATE_VALUE_LOCATION_HIT));
+  ASSERT_EQ(0U, TestGetTickerCount(options, SEPARATE_VALUE_MISSING));
+
+  // Without the option no location is written
+  ASSERT_OK(dbfull()->SetOptions({{"enable_blob_value_location", "false"}}));
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(Put(Key(i), value_of(i + 1)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(value_of(i + 1), Get(Key(i)));
+  }
+  ASSERT_EQ(200U, TestGetTickerCount(options, SEPARATE_VALUE_LOCATION_HIT));
+  ASSERT_EQ(0U, TestGetTickerCount(options, SEPARATE_VALUE_MISSING));
+}
+
+TEST_F(DBBasicTest, RowAndBlobCache) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.statistics = CreateDBStatistics();
+  options.row_cache = NewLRUCache(1 << 20);
+  options.blob_cache = NewLRUCache(1 << 20);
+  DestroyAndReopen(options);
+
+  auto value_of = [](int i) { return Key(i) + std::string(100, 'a' + i % 26); };
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_GT(NumTableFilesAtLevel(-1), 0);
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(value_of(i), Get(Key(i)));
+  }
+  // Lookups of the blob ssts don't go through the row cache
+  ASSERT_EQ(0U, TestGetTickerCount(options, ROW_CACHE_HIT));
+  ASSERT_EQ(100U, TestGetTickerCount(options, ROW_CACHE_MISS));
+  ASSERT_EQ(0U, TestGetTickerCount(options, BLOB_CACHE_HIT));
+  ASSERT_EQ(100U, TestGetTickerCount(options, BLOB_CACHE_MISS));
+  ASSERT_EQ(100U, TestGetTickerCount(options, SEPARATE_VALUE_FETCH));
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(value_of(i), Get(Key(i)));
+  }
+  ASSERT_EQ(100U, TestGetTickerCount(options, ROW_CACHE_HIT));
+  ASSERT_EQ(100U, TestGetTickerCount(options, BLOB_CACHE_HIT));
+  // Every value came from the blob cache
+  ASSERT_EQ(100U, TestGetTickerCount(options, SEPARATE_VALUE_FETCH));
+
+  // Deletions are cached as well, and a snapshot reads its own rows
+  ASSERT_OK(Delete(Key(0)));
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put(Key(1), "v1"));
+  ASSERT_OK(Flush());
+  for (int round = 0; round < 2; ++round) {
+    ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+    ASSERT_EQ("v1", Get(Key(1)));
+    ASSERT_EQ(value_of(1), Get(Key(1), snapshot));
+  }
+  db_->ReleaseSnapshot(snapshot);
+
+  // Compactions rewrite the key ssts, the values are still served from the
+  // blob cache
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  uint64_t blob_cache_hit = TestGetTickerCount(options, BLOB_CACHE_HIT);
+  for (int i = 2; i < 100; ++i) {
+    ASSERT_EQ(value_of(i), Get(Key(i)));
+  }
+  ASSERT_GT(TestGetTickerCount(options, BLOB_CACHE_HIT), blob_cache_hit);
+}
+
+TEST_F(DBBasicTest, FlushSeparatedValueToLogSst) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.enable_log_sst_flush = true;
+  FlushSeparatedValueToLogSst(options);
+}
+
+#ifdef WITH_TERARK_ZIP
+// TerarkZip tables are built in two passes, the second pass finds the values
+// in the log ssts written by the first one
+TEST_F(DBBasicTest, FlushSeparatedValueToLogSstTerarkZip) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.enable_log_sst_flush = true;
+  options.enable_blob_value_location = true;
+  TerarkZipTableOptions terark_zip_options;
+  terark_zip_options.localTempDir = dbname_;
+  terark_zip_options.terarkZipMinLevel = 0;
+  options.table_factory.reset(NewTerarkZipTableFactory(
+      terark_zip_options,
+      std::shared_ptr<TableFactory>(NewBlockBasedTableFactory())));
+  ASSERT_TRUE(options.table_factory->IsBuilderNeedSecondPass());
+  FlushSeparatedValueToLogSst(options);
+}
+#endif  // WITH_TERARK_ZIP
+
 TEST_F(DBBasicTest, ChecksumTest) {
   BlockBasedTableOptions table_options;
   Options options = CurrentOptions();
@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "db/db_test_util.h"
+#include "db/table_cache.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/experimental.h"
@@ -26,6 +27,20 @@ namespace TERARKDB_NAMESPACE {
 class DBCompactionTest : public DBTestBase {
  public:
   DBCompactionTest() : DBTestBase("/db_compaction_test") {}
+
+  // Flushes three rounds of every step-th key in [0, num_keys), interleaved
+  // so the ssts overlap, then links them from a map sst at level 1 with a
+  // lazy compaction of level 0. The value of a key ends with its round.
+  void LinkFromMapSst(int num_keys, int step) {
+    for (int round = 0; round < 3; ++round) {
+      for (int i = round * step; i < num_keys; i += 3 * step) {
+        ASSERT_OK(Put(Key(i), Key(i) + "_" + ToString(round)));
+      }
+      ASSERT_OK(Flush());
+    }
+    ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+    ASSERT_EQ(1, NumTableFilesAtLevel(1));
+  }
 };
 
 class DBCompactionTestWithParam
@@ -425,6 +440,114 @@ TEST_F(DBCompactionTest, LazyCompactionTest) {
   }
 }
 
+TEST_F(DBCompactionTest, LazyCompactionMapSstGet) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.enable_lazy_compaction = true;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  // The map sst links several ssts per element
+  LinkFromMapSst(300, 1);
+
+  // The second round reads the decoded map sst from the table cache
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 300; ++i) {
+      ASSERT_EQ(Key(i) + "_" + ToString(i % 3), Get(Key(i)));
+    }
+    ASSERT_EQ("NOT_FOUND", Get(Key(300)));
+    ASSERT_EQ("NOT_FOUND", Get(""));
+  }
+  ASSERT_GT(TestGetTickerCount(options, READ_MAP_SST_HOPS), 0U);
+
+  // Evicted along with the map sst, and rebuilt on demand
+  std::vector<LiveFileMetaData> level_files;
+  dbfull()->GetLiveFilesMetaData(&level_files);
+  for (auto& f : level_files) {
+    uint64_t number;
+    FileType type;
+    ASSERT_TRUE(ParseFileName(f.name.substr(1), &number, &type));
+    TableCache::Evict(dbfull()->TEST_table_cache(), number);
+  }
+  for (int i = 0; i < 300; ++i) {
+    ASSERT_EQ(Key(i) + "_" + ToString(i % 3), Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, LazyCompactionMapSstIndexCharge) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.enable_lazy_compaction = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  LinkFromMapSst(300, 1);
+
+  // Decoding the map sst needs io, a read from the block cache only may
+  // still find the key
+  auto& block_cache = table_options.block_cache;
+  block_cache->EraseUnRefEntries();
+  std::string value;
+  bool value_found = true;
+  ASSERT_TRUE(db_->KeyMayExist(ReadOptions(), Key(1), &value, &value_found));
+  ASSERT_FALSE(value_found);
+
+  // The decoded map sst is charged to the block cache by its size. Without
+  // fill_cache it's the only entry the read adds
+  size_t usage = block_cache->GetUsage();
+  ReadOptions no_fill;
+  no_fill.fill_cache = false;
+  ASSERT_OK(db_->Get(no_fill, Key(1), &value));
+  ASSERT_EQ(Key(1) + "_1", value);
+  ASSERT_GT(block_cache->GetUsage(), usage + 2 * Key(1).size());
+}
+
+TEST_F(DBCompactionTest, LazyCompactionMapElementFilter) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.enable_lazy_compaction = true;
+  options.map_element_filter_bits_per_key = 10;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  // Even keys only, map elements link all three ssts
+  LinkFromMapSst(600, 2);
+
+  for (int i = 0; i < 600; i += 2) {
+    ASSERT_EQ(Key(i) + "_" + ToString(i / 2 % 3), Get(Key(i)));
+  }
+  uint64_t hops = TestGetTickerCount(options, READ_MAP_SST_HOPS);
+  ASSERT_GT(hops, 0U);
+  for (int i = 1; i < 600; i += 2) {
+    ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+  }
+  // Without filters each miss probes every linked sst
+  ASSERT_GT(TestGetTickerCount(options, MAP_ELEMENT_FILTER_USEFUL), 250U);
+  ASSERT_LT(TestGetTickerCount(options, READ_MAP_SST_HOPS) - hops, 150U);
+}
+
+TEST_F(DBCompactionTest, LazyCompactionMapElementFilterBudget) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.enable_lazy_compaction = true;
+  options.map_element_filter_bits_per_key = 10;
+  // Too small for any element to get a filter
+  options.max_compaction_bytes = 1;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  LinkFromMapSst(600, 2);
+
+  for (int i = 0; i < 600; ++i) {
+    ASSERT_EQ(i % 2 == 0 ? Key(i) + "_" + ToString(i / 2 % 3) : "NOT_FOUND",
+              Get(Key(i)));
+  }
+  ASSERT_GT(TestGetTickerCount(options, READ_MAP_SST_HOPS), 0U);
+  ASSERT_EQ(0U, TestGetTickerCount(options, MAP_ELEMENT_FILTER_USEFUL));
+}
+
 TEST_P(DBCompactionTestWithParam, CompactionsPreserveDeletes) {
   //  For each options type we test following
   //  - Enable preserve_deletes
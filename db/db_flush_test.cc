@@ -248,6 +248,63 @@ TEST_F(DBFlushTest, FlushError) {
   ASSERT_NE(s, Status::OK());
 }
 
+TEST_F(DBFlushTest, FlushPartitions) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.force_consistency_checks = true;
+  options.max_flush_partitions = 4;
+  Reopen(options);
+
+  auto value_of = [](int i, int round) {
+    return "v" + ToString(round) + "_" + ToString(i);
+  };
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 1000; i += round + 1) {
+      ASSERT_OK(Put(Key(i), value_of(i, round)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_EQ(4 * (round + 1), NumTableFilesAtLevel(0));
+    // The partitions of one flush count once for the level 0 triggers
+    auto cfd = static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+                   ->cfd();
+    ASSERT_EQ(round + 1,
+              cfd->current()->storage_info()->l0_delay_trigger_count());
+  }
+
+  // Partitions of a flush don't overlap
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  std::map<SequenceNumber, std::vector<LiveFileMetaData>> flushes;
+  for (auto& f : files) {
+    if (f.level == 0) {
+      flushes[f.largest_seqno].emplace_back(f);
+    }
+  }
+  ASSERT_EQ(2U, flushes.size());
+  for (auto& flush : flushes) {
+    auto& partitions = flush.second;
+    ASSERT_EQ(4U, partitions.size());
+    std::sort(partitions.begin(), partitions.end(),
+              [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+                return a.smallestkey < b.smallestkey;
+              });
+    for (size_t i = 1; i < partitions.size(); ++i) {
+      ASSERT_LT(partitions[i - 1].largestkey, partitions[i].smallestkey);
+    }
+  }
+
+  auto verify = [&] {
+    for (int i = 0; i < 1000; ++i) {
+      ASSERT_EQ(value_of(i, i % 2 == 0 ? 1 : 0), Get(Key(i)));
+    }
+  };
+  verify();
+  Reopen(options);
+  verify();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  verify();
+}
+
 TEST_F(DBFlushTest, ManualFlushFailsInReadOnlyMode) {
   // Regression test for bug where manual flush hangs forever when the DB
   // is in read-only mode. Verify it now at least returns, despite failing.
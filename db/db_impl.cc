@@ -256,6 +256,8 @@ static std::string seek_qps_metric_name = "dbiter_seek_qps";
 static std::string next_qps_metric_name = "dbiter_next_qps";
 static std::string seekforprev_qps_metric_name = "dbiter_seekforprev_qps";
 static std::string prev_qps_metric_name = "dbiter_prev_qps";
+static std::string separate_value_fetch_qps_metric_name =
+    "version_fetchbuffer_qps";
 
 static std::string write_latency_metric_name = "dbimpl_writeimpl_latency";
 static std::string read_latency_metric_name = "dbimpl_getimpl_latency";
@@ -266,6 +268,8 @@ static std::string next_latency_metric_name = "dbiter_next_latency";
 static std::string seekforprev_latency_metric_name =
     "dbiter_seekforprev_latency";
 static std::string prev_latency_metric_name = "dbiter_prev_latency";
+static std::string separate_value_fetch_latency_metric_name =
+    "version_fetchbuffer_latency";
 
 static std::string write_throughput_metric_name = "dbimpl_writeimpl_throughput";
 static std::string write_batch_size_metric_name = "dbimpl_writeimpl_batch_size";
@@ -392,6 +396,10 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       prev_qps_reporter_(*metrics_reporter_factory_->BuildCountReporter(
           prev_qps_metric_name, bytedance_tags_,
           immutable_db_options_.info_log.get(), env_)),
+      separate_value_fetch_qps_reporter_(
+          *metrics_reporter_factory_->BuildCountReporter(
+              separate_value_fetch_qps_metric_name, bytedance_tags_,
+              immutable_db_options_.info_log.get(), env_)),
 
       write_latency_reporter_(*metrics_reporter_factory_->BuildHistReporter(
           write_latency_metric_name, bytedance_tags_,
@@ -416,6 +424,10 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       prev_latency_reporter_(*metrics_reporter_factory_->BuildHistReporter(
           prev_latency_metric_name, bytedance_tags_,
           immutable_db_options_.info_log.get(), env_)),
+      separate_value_fetch_latency_reporter_(
+          *metrics_reporter_factory_->BuildHistReporter(
+              separate_value_fetch_latency_metric_name, bytedance_tags_,
+              immutable_db_options_.info_log.get(), env_)),
       write_throughput_reporter_(*metrics_reporter_factory_->BuildCountReporter(
           write_throughput_metric_name, bytedance_tags_,
           immutable_db_options_.info_log.get(), env_)),
@@ -437,7 +449,12 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
 
   versions_.reset(new VersionSet(dbname_, &immutable_db_options_, env_options_,
                                  seq_per_batch, table_cache_.get(),
-                                 write_buffer_manager_, &write_controller_));
+                                 write_buffer_manager_, &write_controller_,
+                                 &block_cache_tracer_));
+  versions_->separate_value_fetch_latency_reporter_ =
+      &separate_value_fetch_latency_reporter_;
+  versions_->separate_value_fetch_qps_reporter_ =
+      &separate_value_fetch_qps_reporter_;
   column_family_memtables_.reset(
       new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
 
@@ -1027,28 +1044,71 @@ void DBImpl::ScheduleTtlGC() {
     }
     uint64_t now = cfd->ioptions()->ttl_extractor_factory->Now();
     VersionStorageInfo* vstorage = cfd->current()->storage_info();
+    // The queue keeps the files removed after they were pushed, rebuild it
+    // once they outnumber the live files
+    size_t live_count = 0;
     for (int l = 0; l < vstorage->num_non_empty_levels(); l++) {
-      for (auto meta : vstorage->LevelFiles(l)) {
-        if (meta->being_compacted) {
-          continue;
-        }
-        ++total_count;
-        bool marked =
-            !!(meta->marked_for_compaction & FileMetaData::kMarkedFromTTL);
-        old_mark_count += marked;
-        TEST_SYNC_POINT("DBImpl:Exist-SST");
-        if (!marked &&
-            should_marked_for_compacted(
-                l, meta->fd.GetNumber(), meta->prop.earliest_time_begin_compact,
-                meta->prop.latest_time_end_compact, now)) {
-          meta->marked_for_compaction |= FileMetaData::kMarkedFromTTL;
-          marked = true;
-        }
-        if (marked) {
-          new_mark_count++;
-          TEST_SYNC_POINT("DBImpl:ScheduleTtlGC-mark");
-        }
+      live_count += vstorage->LevelFiles(l).size();
+    }
+    if (!cfd->ttl_gc_queue_initialized() ||
+        cfd->ttl_gc_queue_size() > 2 * live_count + 64) {
+      cfd->ResetTtlGCQueue();
+    }
+    auto& dependence_map = vstorage->dependence_map();
+    // A trivial move pushes the file again with its new level, the entry of
+    // its old level is stale
+    auto is_at_level = [&](int level, FileMetaData* f) {
+      if (level >= vstorage->num_non_empty_levels()) {
+        return false;
+      }
+      if (level == 0) {
+        auto& files = vstorage->LevelFiles(0);
+        return std::find(files.begin(), files.end(), f) != files.end();
       }
+      auto& brief = vstorage->LevelFilesBrief(level);
+      size_t i = FindFile(cfd->internal_comparator(), brief,
+                          f->smallest.Encode());
+      return i < brief.num_files && brief.files[i].file_metadata == f;
+    };
+    std::vector<ColumnFamilyData::TtlGCEntry> busy;
+    ColumnFamilyData::TtlGCEntry entry;
+    while (cfd->PopDueTtlGCEntry(now, &entry)) {
+      auto find = dependence_map.find(entry.file_number);
+      if (find == dependence_map.end() ||
+          find->second->fd.GetNumber() != entry.file_number) {
+        // Compacted away
+        continue;
+      }
+      FileMetaData* meta = find->second;
+      if (!is_at_level(entry.level, meta)) {
+        // Moved to another level
+        continue;
+      }
+      if (meta->being_compacted) {
+        busy.emplace_back(entry);
+        continue;
+      }
+      ++total_count;
+      bool marked =
+          !!(meta->marked_for_compaction & FileMetaData::kMarkedFromTTL);
+      old_mark_count += marked;
+      TEST_SYNC_POINT("DBImpl:Exist-SST");
+      if (!marked &&
+          should_marked_for_compacted(
+              entry.level, meta->fd.GetNumber(),
+              meta->prop.earliest_time_begin_compact,
+              meta->prop.latest_time_end_compact, now)) {
+        meta->marked_for_compaction |= FileMetaData::kMarkedFromTTL;
+        marked = true;
+      }
+      if (marked) {
+        new_mark_count++;
+        TEST_SYNC_POINT("DBImpl:ScheduleTtlGC-mark");
+      }
+    }
+    // Files being compacted are checked again by the next run
+    for (auto& e : busy) {
+      cfd->AddToTtlGCQueue(e);
     }
     if (new_mark_count > old_mark_count) {
       vstorage->ComputeCompactionScore(*cfd->ioptions(),
@@ -1060,9 +1120,10 @@ void DBImpl::ScheduleTtlGC() {
     }
     ROCKS_LOG_BUFFER(&log_buffer_debug,
                      "[%s] SSTs total marked = %" PRIu64
-                     ", new marked = %" PRIu64 ", file count: %" PRIu64,
+                     ", new marked = %" PRIu64 ", due file count: %" PRIu64
+                     ", file count: %" ROCKSDB_PRIszt,
                      cfd->GetName().c_str(), old_mark_count, new_mark_count,
-                     total_count);
+                     total_count, live_count);
   }
   if (unscheduled_compactions_ > 0) {
     MaybeScheduleFlushOrCompaction();
@@ -1609,7 +1670,10 @@ Status DBImpl::SyncWAL() {
   RecordTick(stats_, WAL_FILE_SYNCED);
   Status status;
   for (log::Writer* log : logs_to_sync) {
-    status = log->file()->SyncWithoutFlush(immutable_db_options_.use_fsync);
+    for (size_t i = 0; status.ok() && i < log->num_streams(); ++i) {
+      status = log->stream(i)->file()->SyncWithoutFlush(
+          immutable_db_options_.use_fsync);
+    }
     if (!status.ok()) {
       break;
     }
@@ -2159,12 +2223,31 @@ std::vector<Status> DBImpl::MultiGet(
   // merge_operands will contain the sequence of merges in the latter case.
   size_t num_found = 0;
   size_t counting = num_keys;
+  std::vector<LazyBuffer> lazy_vals;
+  lazy_vals.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    lazy_vals.emplace_back(&(*values)[i]);
+  }
+  // Keys whose separated value was left unfetched by the first pass
+  std::vector<size_t> pending_fetch;
+  // Sequence of the value index of each pending key
+  std::vector<SequenceNumber> index_seqs(num_keys, kMaxSequenceNumber);
+  auto finish_one = [&](size_t i) {
+    Status& s = stat_list[i];
+    std::string* value = &(*values)[i];
+    if (s.ok()) {
+      s = std::move(lazy_vals[i]).dump(value);
+    }
+    if (s.ok()) {
+      bytes_read += value->size();
+      num_found++;
+    }
+  };
   auto get_one = [&](size_t i) {
     // Contain a list of merge operations if merge occurs.
     MergeContext merge_context;
     Status& s = stat_list[i];
-    std::string* value = &(*values)[i];
-    LazyBuffer lazy_val(value);
+    LazyBuffer& lazy_val = lazy_vals[i];
 
     LookupKey lkey(keys[i], snapshot);
     auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family[i]);
@@ -2192,18 +2275,81 @@ std::vector<Status> DBImpl::MultiGet(
     if (!done) {
       PERF_TIMER_GUARD(get_from_output_files_time);
       super_version->current->Get(read_options, keys[i], lkey, &lazy_val, &s,
-                                  &merge_context, &max_covering_tombstone_seq);
+                                  &merge_context, &max_covering_tombstone_seq,
+                                  nullptr /* value_found */,
+                                  nullptr /* key_exists */, &index_seqs[i],
+                                  nullptr /* callback */,
+                                  read_options.batch_separated_fetch);
       RecordTick(stats_, MEMTABLE_MISS);
     }
-    if (s.ok()) {
-      s = std::move(lazy_val).dump(value);
-    }
-    if (s.ok()) {
-      bytes_read += value->size();
-      num_found++;
+    if (s.ok() && !lazy_val.valid()) {
+      pending_fetch.emplace_back(i);
+    } else {
+      finish_one(i);
     }
     counting--;
   };
+  // Blob SSTs are sorted by key, so fetching the separated values of one blob
+  // file in key order walks its index and data blocks forward, and values
+  // living in the same data block are read once
+  auto fetch_group = [&](size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+      finish_one(pending_fetch[j]);
+    }
+  };
+  // Read the blocks of a group together first, the fetches then hit the block
+  // cache. A failed prefetch is only logged, the fetches report the error.
+  auto prefetch_and_fetch_group = [&](size_t begin, size_t end) {
+    uint64_t file_number = lazy_vals[pending_fetch[begin]].file_number();
+    if (end - begin > 1 && file_number != uint64_t(-1)) {
+      std::vector<Slice> user_keys;
+      std::vector<SequenceNumber> seqs;
+      for (size_t j = begin; j < end; ++j) {
+        user_keys.emplace_back(keys[pending_fetch[j]]);
+        seqs.emplace_back(index_seqs[pending_fetch[j]]);
+      }
+      auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(
+          column_family[pending_fetch[begin]]);
+      auto mgd = multiget_cf_data.find(cfh->cfd()->GetID())->second;
+      Status s = mgd->super_version->current->PrefetchSeparatedValues(
+          file_number, user_keys.data(), seqs.data(), user_keys.size());
+      if (!s.ok()) {
+        ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                       "Prefetch separated values of #%" PRIu64 " failed: %s",
+                       file_number, s.ToString().c_str());
+      }
+    }
+    fetch_group(begin, end);
+  };
+  auto sort_pending_fetch = [&] {
+    std::sort(pending_fetch.begin(), pending_fetch.end(),
+              [&](size_t l, size_t r) {
+                auto l_cf_id = column_family[l]->GetID();
+                auto r_cf_id = column_family[r]->GetID();
+                if (l_cf_id != r_cf_id) {
+                  return l_cf_id < r_cf_id;
+                }
+                if (lazy_vals[l].file_number() != lazy_vals[r].file_number()) {
+                  return lazy_vals[l].file_number() < lazy_vals[r].file_number();
+                }
+                return column_family[l]->GetComparator()->Compare(keys[l],
+                                                                  keys[r]) < 0;
+              });
+  };
+  // Split pending_fetch into runs of the same column family and blob file
+  auto for_each_group = [&](const std::function<void(size_t, size_t)>& func) {
+    for (size_t begin = 0, end; begin < pending_fetch.size(); begin = end) {
+      auto cf_id = column_family[pending_fetch[begin]]->GetID();
+      auto file_number = lazy_vals[pending_fetch[begin]].file_number();
+      for (end = begin + 1;
+           end < pending_fetch.size() &&
+           column_family[pending_fetch[end]]->GetID() == cf_id &&
+           lazy_vals[pending_fetch[end]].file_number() == file_number;
+           ++end) {
+      }
+      func(begin, end);
+    }
+  };
 #ifdef WITH_BOOSTLIB
   if (read_options.aio_concurrency && immutable_db_options_.use_aio_reads) {
 #if 0
@@ -2225,15 +2371,35 @@ std::vector<Status> DBImpl::MultiGet(
       // boost::this_fiber::yield();
       tls->m_fy.unchecked_yield();
     }
+    if (!pending_fetch.empty()) {
+      // One fiber per blob file, so reads of different files overlap
+      sort_pending_fetch();
+      size_t group_counting = 0;
+      for_each_group([&](size_t begin, size_t end) {
+        ++group_counting;
+        tls->push([&, begin, end]() {
+          fetch_group(begin, end);
+          group_counting--;
+        });
+      });
+      while (group_counting) {
+        tls->m_fy.unchecked_yield();
+      }
+    }
 #endif
   } else {
 #endif
     for (size_t i = 0; i < num_keys; ++i) {
       get_one(i);
     }
+    if (!pending_fetch.empty()) {
+      sort_pending_fetch();
+      for_each_group(prefetch_and_fetch_group);
+    }
 #ifdef WITH_BOOSTLIB
   }
 #endif
+  lazy_vals.clear();
 
   // Post processing (decrement reference counts and record statistics)
   PERF_TIMER_GUARD(get_post_process_time);
@@ -2407,6 +2573,10 @@ autovector<Status> DBImpl::CreateColumnFamilyImpl(
     if (s[i].ok()) {
       s[i] = CheckCFPathsSupported(initial_db_options_, *cf_options[i]);
     }
+    if (s[i].ok()) {
+      s[i] = CheckWriteBufferManagerSupported(initial_db_options_,
+                                              *cf_options[i]);
+    }
     if (s[i].ok()) {
       for (auto& cf_path : cf_options[i]->cf_paths) {
         s[i] = env_->CreateDirIfMissing(cf_path.path);
@@ -4442,6 +4612,7 @@ Status DBImpl::IngestExternalFile(
   }
 
   SuperVersionContext sv_context(/* create_superversion */ true);
+  WriteContext write_context(immutable_db_options_.info_log.get());
   TEST_SYNC_POINT("DBImpl::AddFile:Start");
   {
     // Lock db mutex
@@ -4482,6 +4653,30 @@ Status DBImpl::IngestExternalFile(
       }
     }
 
+    // A global sequence assigned to the ingested files has no WAL record,
+    // which recovery of multiple WAL streams takes for lost records. Switch
+    // to a new log first, so the sequence falls between two logs.
+    if (status.ok() && immutable_db_options_.wal_streams > 1 && !log_empty_) {
+      autovector<ColumnFamilyData*> cfds;
+      cfds.push_back(cfd);
+      FlushRequestVec flush_req_vec;
+      ProcessAtomicFlushGroup(&cfds, &flush_req_vec);
+      for (auto switch_cfd : cfds) {
+        switch_cfd->Ref();
+        status = SwitchMemtable(switch_cfd, &write_context);
+        switch_cfd->Unref();
+        if (!status.ok()) {
+          break;
+        }
+      }
+      if (status.ok()) {
+        PrepareFlushReqVec(flush_req_vec, true /* force_flush */);
+        SchedulePendingFlush(flush_req_vec,
+                             FlushReason::kExternalFileIngestion);
+        MaybeScheduleFlushOrCompaction();
+      }
+    }
+
     // Run the ingestion job
     if (status.ok()) {
       status = ingestion_job.Run();
@@ -4629,6 +4824,18 @@ Status DBImpl::EndTrace() {
   return s;
 }
 
+Status DBImpl::StartBlockCacheTrace(
+    const TraceOptions& trace_options,
+    std::unique_ptr<TraceWriter>&& trace_writer) {
+  return block_cache_tracer_.StartTrace(env_, trace_options,
+                                        std::move(trace_writer));
+}
+
+Status DBImpl::EndBlockCacheTrace() {
+  block_cache_tracer_.EndTrace();
+  return Status::OK();
+}
+
 Status DBImpl::TraceIteratorSeek(const uint32_t& cf_id, const Slice& key) {
   Status s;
   if (tracer_) {
@@ -60,6 +60,7 @@
 #include "util/repeatable_thread.h"
 #include "util/stop_watch.h"
 #include "util/thread_local.h"
+#include "trace_replay/block_cache_tracer.h"
 #include "util/trace_replay.h"
 #include "utilities/console/server.h"
 
@@ -84,8 +85,6 @@ struct JobContext;
 struct ExternalSstFileInfo;
 struct MemTableInfo;
 
-const uint64_t kMicrosInSecond = 1000 * 1000;
-
 class DBImpl : public DB {
  public:
   DBImpl(const DBOptions& options, const std::string& dbname,
@@ -370,6 +369,14 @@ class DBImpl : public DB {
 
   using DB::EndTrace;
   virtual Status EndTrace() override;
+
+  using DB::StartBlockCacheTrace;
+  Status StartBlockCacheTrace(
+      const TraceOptions& options,
+      std::unique_ptr<TraceWriter>&& trace_writer) override;
+
+  using DB::EndBlockCacheTrace;
+  Status EndBlockCacheTrace() override;
   Status TraceIteratorSeek(const uint32_t& cf_id, const Slice& key);
   Status TraceIteratorSeekForPrev(const uint32_t& cf_id, const Slice& key);
 #endif  // ROCKSDB_LITE
@@ -829,6 +836,7 @@ class DBImpl : public DB {
   std::unordered_map<std::string, RecoveredTransaction*>
       recovered_transactions_;
   std::unique_ptr<Tracer> tracer_;
+  BlockCacheTracer block_cache_tracer_;
   InstrumentedMutex trace_mutex_;
 
   // Except in DB::Open(), WriteOptionsFile can only be called when:
@@ -1131,6 +1139,21 @@ class DBImpl : public DB {
                       uint64_t recycle_log_number, const DBOptions& db_options,
                       Env::WriteLifeTimeHint write_hint);
 
+  // Create the extra WAL streams of `log` when wal_streams > 1.
+  Status AddWalStreams(log::Writer* log, const EnvOptions& env_options,
+                       Env::WriteLifeTimeHint write_hint);
+
+  // Called by every member of a parallel write group logging by stream. The
+  // first writer of each stream appends the batches of its stream to it as a
+  // single record. Returns once all records of the group are written, with
+  // the first error among them.
+  Status WriteToWALStream(WriteThread::WriteGroup* write_group,
+                          WriteThread::Writer* w);
+  // Append the batches of the writers of `w`'s WAL stream in `write_group` to
+  // that stream as a single record.
+  Status WriteStreamRecord(const WriteThread::WriteGroup& write_group,
+                           WriteThread::Writer* w);
+
   void FillLogWriterPool();
 
   Status SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context);
@@ -1847,6 +1870,7 @@ class DBImpl : public DB {
   QPSReporter next_qps_reporter_;
   QPSReporter seekforprev_qps_reporter_;
   QPSReporter prev_qps_reporter_;
+  QPSReporter separate_value_fetch_qps_reporter_;
 
   LatencyReporter write_latency_reporter_;
   LatencyReporter read_latency_reporter_;
@@ -1855,6 +1879,7 @@ class DBImpl : public DB {
   LatencyReporter next_latency_reporter_;
   LatencyReporter seekforprev_latency_reporter_;
   LatencyReporter prev_latency_reporter_;
+  LatencyReporter separate_value_fetch_latency_reporter_;
 
   ThroughputReporter write_throughput_reporter_;
   DistributionReporter write_batch_size_reporter_;
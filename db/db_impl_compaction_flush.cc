@@ -86,7 +86,7 @@ Status DBImpl::SyncClosedLogs(JobContext* job_context) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
                      "[JOB %d] Syncing log #%" PRIu64, job_context->job_id,
                      log->get_log_number());
-      s = log->file()->Sync(immutable_db_options_.use_fsync);
+      s = log->Sync(immutable_db_options_.use_fsync);
       if (!s.ok()) {
         break;
       }
@@ -3043,7 +3043,8 @@ Status DBImpl::BackgroundGarbageCollection(bool* made_progress,
         &event_logger_, c->mutable_cf_options()->paranoid_file_checks,
         c->mutable_cf_options()->report_bg_io_stats, dbname_,
         &garbage_collection_job_stats);
-    garbage_collection_job.Prepare(0 /* sub_compaction_slots */);
+    garbage_collection_job.Prepare(
+        GetSubCompactionSlots(c->max_subcompactions()));
     NotifyOnCompactionBegin(c->column_family_data(), c.get(), status,
                             garbage_collection_job_stats, job_context->job_id);
 
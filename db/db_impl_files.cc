@@ -387,6 +387,11 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
       candidate_files.emplace_back(JobContext::CandidateFileInfo{
           LogFileName(kDumbDbName, file_num),
           state.PushPath(immutable_db_options_.wal_dir)});
+      for (size_t i = 1; i < immutable_db_options_.wal_streams; ++i) {
+        candidate_files.emplace_back(JobContext::CandidateFileInfo{
+            LogStreamFileName(kDumbDbName, file_num, i),
+            state.PushPath(immutable_db_options_.wal_dir)});
+      }
     }
   }
   for (auto filename : state.manifest_delete_files) {
@@ -462,6 +467,10 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
                 (log_recycle_files_set.find(number) !=
                  log_recycle_files_set.end()));
         break;
+      case kWalStreamFile:
+        keep = ((number >= state.log_number) ||
+                (number == state.prev_log_number));
+        break;
       case kDescriptorFile:
         // Keep my manifest file, and any newer incarnations'
         // (can happen during manifest roll)
@@ -522,8 +531,9 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
       fname = MakeTableFileName(*candidate_file.file_path, number);
       dir_to_sync = *candidate_file.file_path;
     } else {
-      dir_to_sync =
-          (type == kLogFile) ? immutable_db_options_.wal_dir : dbname_;
+      dir_to_sync = (type == kLogFile || type == kWalStreamFile)
+                        ? immutable_db_options_.wal_dir
+                        : dbname_;
       fname = dir_to_sync +
               ((!dir_to_sync.empty() && dir_to_sync.back() == '/') ||
                        (!to_delete.empty() && to_delete.front() == '/')
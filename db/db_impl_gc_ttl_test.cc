@@ -100,6 +100,138 @@ TEST_F(DBImplGCTTL_Test, BlockBasedTableTest) {
   run();
   read();
 }
+TEST_F(DBImplGCTTL_Test, TtlGCQueueExpiryOrder) {
+  init();
+  options.env = mock_env_.get();
+  options.disable_auto_compactions = true;
+  SetUp();
+  Reopen(options);
+  // Later files expire earlier
+  for (int i = 0; i < 4; i++) {
+    char ts_string[8];
+    EncodeFixed64(ts_string, (4 - i) * 100);
+    for (int j = 0; j < 100; j++) {
+      std::string value = "value";
+      value.append(ts_string, 8);
+      ASSERT_OK(Put(Key(j), value));
+    }
+    ASSERT_OK(Flush());
+  }
+  auto cfd = static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+                 ->cfd();
+  InstrumentedMutexLock l(dbfull()->mutex());
+  // L0 files are sorted newest first, which is the expiry order here
+  auto& files = cfd->current()->storage_info()->LevelFiles(0);
+  ASSERT_EQ(4, files.size());
+  cfd->ResetTtlGCQueue();
+  ASSERT_EQ(4, cfd->ttl_gc_queue_size());
+  ColumnFamilyData::TtlGCEntry entry;
+  ASSERT_FALSE(cfd->PopDueTtlGCEntry(0, &entry));
+  uint64_t last_due_time = 0;
+  for (auto f : files) {
+    ASSERT_TRUE(cfd->PopDueTtlGCEntry(port::kMaxUint64, &entry));
+    ASSERT_EQ(f->fd.GetNumber(), entry.file_number);
+    ASSERT_LE(last_due_time, entry.due_time);
+    last_due_time = entry.due_time;
+  }
+  ASSERT_FALSE(cfd->PopDueTtlGCEntry(port::kMaxUint64, &entry));
+}
+
+TEST_F(DBImplGCTTL_Test, TtlGCQueueSkipsDeletedFiles) {
+  init();
+  options.env = mock_env_.get();
+  options.disable_auto_compactions = true;
+  SetUp();
+  Reopen(options);
+  char ts_string[8];
+  EncodeFixed64(ts_string, ttl);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 100; j++) {
+      std::string value = "value";
+      value.append(ts_string, 8);
+      ASSERT_OK(Put(Key(i * 100 + j), value));
+    }
+    ASSERT_OK(Flush());
+  }
+  auto cfd = static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+                 ->cfd();
+  {
+    InstrumentedMutexLock l(dbfull()->mutex());
+    cfd->ResetTtlGCQueue();
+    ASSERT_EQ(4, cfd->ttl_gc_queue_size());
+  }
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  int live_files = 0;
+  {
+    InstrumentedMutexLock l(dbfull()->mutex());
+    auto* vstorage = cfd->current()->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); level++) {
+      live_files += static_cast<int>(vstorage->LevelFiles(level).size());
+    }
+    ASSERT_EQ(0, vstorage->LevelFiles(0).size());
+    // The compaction outputs are pushed, the inputs stay until popped
+    ASSERT_EQ(4 + live_files, cfd->ttl_gc_queue_size());
+  }
+  ASSERT_GT(live_files, 0);
+  cnt = 0;
+  mark = 0;
+  dbfull()->TEST_WaitForStatsDumpRun(
+      [&] { mock_env_->set_current_time(ttl + ttl); });
+  ASSERT_TRUE(flag);
+  // Only the live files are visited, the deleted ones are dropped
+  ASSERT_EQ(live_files, cnt);
+  ASSERT_EQ(live_files, mark);
+  InstrumentedMutexLock l(dbfull()->mutex());
+  ASSERT_EQ(0, cfd->ttl_gc_queue_size());
+}
+
+TEST_F(DBImplGCTTL_Test, TtlGCQueueSkipsMovedFiles) {
+  init();
+  options.env = mock_env_.get();
+  options.disable_auto_compactions = true;
+  SetUp();
+  int trivial_moves = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:TrivialMove",
+      [&](void* /*arg*/) { trivial_moves++; });
+  Reopen(options);
+  char ts_string[8];
+  EncodeFixed64(ts_string, ttl);
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 100; j++) {
+      std::string value = "value";
+      value.append(ts_string, 8);
+      ASSERT_OK(Put(Key(i * 100 + j), value));
+    }
+    ASSERT_OK(Flush());
+  }
+  auto cfd = static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+                 ->cfd();
+  {
+    InstrumentedMutexLock l(dbfull()->mutex());
+    cfd->ResetTtlGCQueue();
+    ASSERT_EQ(2, cfd->ttl_gc_queue_size());
+  }
+  MoveFilesToLevel(2);
+  ASSERT_GT(trivial_moves, 0);
+  ASSERT_EQ("0,0,2", FilesPerLevel());
+  {
+    InstrumentedMutexLock l(dbfull()->mutex());
+    // The moved files are pushed again with every level they passed
+    ASSERT_LT(2, cfd->ttl_gc_queue_size());
+  }
+  cnt = 0;
+  mark = 0;
+  dbfull()->TEST_WaitForStatsDumpRun(
+      [&] { mock_env_->set_current_time(ttl + ttl); });
+  ASSERT_TRUE(flag);
+  // Each file is visited once, at its current level
+  ASSERT_EQ(2, cnt);
+  ASSERT_EQ(2, mark);
+}
+
 #ifdef TERARK_ZIP
 TEST_F(DBImplGCTTL_Test, TerarkTableTest) {
   init();
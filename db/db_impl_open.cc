@@ -13,6 +13,9 @@
 #endif
 #include <inttypes.h>
 
+#include <deque>
+#include <functional>
+
 #include "db/builder.h"
 #include "db/error_handler.h"
 #include "db/map_builder.h"
@@ -22,6 +25,7 @@
 #include "rocksdb/wal_filter.h"
 #include "table/block_based_table_factory.h"
 #include "util/c_style_callback.h"
+#include "util/mutexlock.h"
 #include "util/rate_limiter.h"
 #include "util/sst_file_manager_impl.h"
 #include "util/string_util.h"
@@ -113,6 +117,17 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
         std::max(result.prepare_log_writer_num, result.recycle_log_file_num);
   }
 
+  // Extra WAL streams are only written by the parallel memtable writers of the
+  // main write queue, and are neither recycled, archived nor flushed manually.
+  if (result.wal_streams == 0 ||
+      (result.wal_streams > 1 &&
+       (!result.allow_concurrent_memtable_write ||
+        result.enable_pipelined_write || result.two_write_queues ||
+        result.manual_wal_flush || result.recycle_log_file_num > 0 ||
+        result.WAL_ttl_seconds > 0 || result.WAL_size_limit_MB > 0))) {
+    result.wal_streams = 1;
+  }
+
   if (result.wal_dir.empty()) {
     // Use dbname as default
     result.wal_dir = dbname;
@@ -197,6 +212,9 @@ static Status ValidateOptions(
     if (s.ok()) {
       s = CheckCFPathsSupported(db_options, cfd.options);
     }
+    if (s.ok()) {
+      s = CheckWriteBufferManagerSupported(db_options, cfd.options);
+    }
     if (!s.ok()) {
       return s;
     }
@@ -228,6 +246,313 @@ static Status ValidateOptions(
 
   return Status::OK();
 }
+
+// Reads the records of a log file and of its extra WAL streams (see
+// DBOptions::wal_streams) in sequence order. Each stream is ordered by itself,
+// so merging on the sequence in the write batch header of every record
+// restores the global order. The streams are flushed on their own, so one may
+// lose records another one kept. With a reporter, reading stops at the first
+// gap in the sequences and the gap is reported as a corruption.
+class WalStreamMerger {
+ public:
+  WalStreamMerger(std::vector<std::unique_ptr<log::Reader>>&& readers,
+                  log::Reader::Reporter* gap_reporter)
+      : streams_(readers.size()),
+        last_(readers.size()),
+        gap_reporter_(readers.size() > 1 ? gap_reporter : nullptr),
+        next_sequence_(kMaxSequenceNumber),
+        stopped_(false) {
+    for (size_t i = 0; i < readers.size(); ++i) {
+      streams_[i].reader = std::move(readers[i]);
+    }
+  }
+
+  bool ReadRecord(Slice* record, WALRecoveryMode wal_recovery_mode) {
+    if (stopped_) {
+      return false;
+    }
+    for (size_t i = 0; i < streams_.size(); ++i) {
+      auto& stream = streams_[i];
+      if (!stream.started || i == last_) {
+        stream.started = true;
+        stream.valid = stream.reader->ReadRecord(
+            &stream.record, &stream.scratch, wal_recovery_mode);
+      }
+    }
+    last_ = streams_.size();
+    SequenceNumber min_sequence = kMaxSequenceNumber;
+    for (size_t i = 0; i < streams_.size(); ++i) {
+      auto& stream = streams_[i];
+      if (!stream.valid) {
+        continue;
+      }
+      // Records too small to hold a header go first so that they are reported
+      // as corrupted right away.
+      SequenceNumber sequence =
+          stream.record.size() < WriteBatchInternal::kHeader
+              ? 0
+              : DecodeFixed64(stream.record.data());
+      if (last_ == streams_.size() || sequence < min_sequence) {
+        min_sequence = sequence;
+        last_ = i;
+      }
+    }
+    if (last_ == streams_.size()) {
+      return false;
+    }
+    *record = streams_[last_].record;
+    if (gap_reporter_ != nullptr &&
+        record->size() >= WriteBatchInternal::kHeader) {
+      if (next_sequence_ != kMaxSequenceNumber &&
+          min_sequence != next_sequence_) {
+        stopped_ = true;
+        gap_reporter_->Corruption(
+            record->size(),
+            Status::Corruption("WAL streams miss sequence " +
+                               ToString(next_sequence_)));
+        return false;
+      }
+      next_sequence_ = min_sequence + DecodeFixed32(record->data() + 8);
+    }
+    return true;
+  }
+
+ private:
+  struct Stream {
+    std::unique_ptr<log::Reader> reader;
+    std::string scratch;
+    Slice record;
+    bool started = false;
+    bool valid = false;
+  };
+  std::vector<Stream> streams_;
+  // The stream whose record was returned last, it is advanced on the next call
+  size_t last_;
+  log::Reader::Reporter* gap_reporter_;
+  // The sequence the next record must start at
+  SequenceNumber next_sequence_;
+  bool stopped_;
+};
+
+// Reads and checksums the records of a log on a background thread if
+// background is set, so that decoding the log overlaps with the memtable
+// inserts and the flushes of the recovery thread. At most max_buffered_bytes
+// of records are read ahead. Otherwise the records are read on the calling
+// thread. read_status is the status the log readers report corruptions to,
+// reading stops at the first corruption like the recovery loop does.
+class WalRecordPrefetcher {
+ public:
+  WalRecordPrefetcher(WalStreamMerger* reader, WALRecoveryMode wal_recovery_mode,
+                      const Status* read_status, size_t max_buffered_bytes,
+                      bool background)
+      : reader_(reader),
+        wal_recovery_mode_(wal_recovery_mode),
+        read_status_(read_status),
+        max_buffered_bytes_(max_buffered_bytes),
+        cv_(&mutex_),
+        buffered_bytes_(0),
+        done_(false),
+        stop_(false),
+        background_(background) {
+    if (background_) {
+      thread_ = port::Thread([this] { BackgroundRead(); });
+    }
+  }
+
+  ~WalRecordPrefetcher() { Stop(); }
+
+  // The returned record is valid until the next call.
+  bool ReadRecord(Slice* record) {
+    if (!background_) {
+      return reader_->ReadRecord(record, wal_recovery_mode_) &&
+             (read_status_ == nullptr || read_status_->ok());
+    }
+    MutexLock l(&mutex_);
+    while (records_.empty() && !done_) {
+      cv_.Wait();
+    }
+    if (records_.empty()) {
+      return false;
+    }
+    current_ = std::move(records_.front());
+    records_.pop_front();
+    buffered_bytes_ -= current_.size();
+    cv_.SignalAll();
+    *record = current_;
+    return true;
+  }
+
+  // Stops reading ahead and waits for the background thread. The read status
+  // may be inspected afterwards.
+  void Stop() {
+    {
+      MutexLock l(&mutex_);
+      stop_ = true;
+      cv_.SignalAll();
+    }
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+ private:
+  void BackgroundRead() {
+    Slice record;
+    while (reader_->ReadRecord(&record, wal_recovery_mode_) &&
+           (read_status_ == nullptr || read_status_->ok())) {
+      MutexLock l(&mutex_);
+      while (buffered_bytes_ >= max_buffered_bytes_ && !stop_) {
+        cv_.Wait();
+      }
+      if (stop_) {
+        break;
+      }
+      buffered_bytes_ += record.size();
+      records_.emplace_back(record.data(), record.size());
+      cv_.SignalAll();
+    }
+    MutexLock l(&mutex_);
+    done_ = true;
+    cv_.SignalAll();
+  }
+
+  WalStreamMerger* reader_;
+  const WALRecoveryMode wal_recovery_mode_;
+  const Status* read_status_;
+  const size_t max_buffered_bytes_;
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  std::deque<std::string> records_;
+  size_t buffered_bytes_;
+  bool done_;
+  bool stop_;
+  std::string current_;
+  const bool background_;
+  port::Thread thread_;
+};
+
+// A few threads inserting the write batches of a recovery group into the
+// memtables, together with the recovery thread. Lives for one RecoverLogFiles.
+class RecoveryInsertPool {
+ public:
+  explicit RecoveryInsertPool(size_t num_threads)
+      : cv_(&mutex_),
+        done_cv_(&mutex_),
+        func_(nullptr),
+        n_(0),
+        next_(0),
+        running_(0),
+        generation_(0),
+        stop_(false) {
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this] { BackgroundWork(); });
+    }
+  }
+
+  ~RecoveryInsertPool() {
+    {
+      MutexLock l(&mutex_);
+      stop_ = true;
+      cv_.SignalAll();
+    }
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  // Calls func(i) for every i in [0, n) and returns once all calls are done.
+  void Run(size_t n, const std::function<void(size_t)>& func) {
+    {
+      MutexLock l(&mutex_);
+      func_ = &func;
+      n_ = n;
+      next_.store(0, std::memory_order_relaxed);
+      ++generation_;
+      cv_.SignalAll();
+    }
+    Work(n, func);
+    MutexLock l(&mutex_);
+    while (running_ > 0) {
+      done_cv_.Wait();
+    }
+    // Threads waking up late must not see this call any more
+    func_ = nullptr;
+    n_ = 0;
+  }
+
+ private:
+  void Work(size_t n, const std::function<void(size_t)>& func) {
+    size_t i;
+    while (n > 0 && (i = next_.fetch_add(1, std::memory_order_relaxed)) < n) {
+      func(i);
+    }
+  }
+
+  void BackgroundWork() {
+    uint64_t seen_generation = 0;
+    MutexLock l(&mutex_);
+    while (true) {
+      while (!stop_ && generation_ == seen_generation) {
+        cv_.Wait();
+      }
+      if (stop_) {
+        return;
+      }
+      seen_generation = generation_;
+      if (func_ == nullptr) {
+        continue;
+      }
+      const std::function<void(size_t)>* func = func_;
+      size_t n = n_;
+      ++running_;
+      mutex_.Unlock();
+      Work(n, *func);
+      mutex_.Lock();
+      if (--running_ == 0) {
+        done_cv_.SignalAll();
+      }
+    }
+  }
+
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  port::CondVar done_cv_;
+  const std::function<void(size_t)>* func_;
+  size_t n_;
+  std::atomic<size_t> next_;
+  size_t running_;
+  uint64_t generation_;
+  bool stop_;
+  std::vector<port::Thread> threads_;
+};
+
+// Parses a recovered write batch before it joins a recovery group. Batches
+// that fail to parse or hold merges are inserted one by one instead, so a
+// corrupted batch is never inserted together with the batches behind it.
+struct RecoveryBatchChecker : public WriteBatch::Handler {
+  bool has_merge = false;
+
+  Status PutCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status DeleteCF(uint32_t, const Slice&) override { return Status::OK(); }
+  Status SingleDeleteCF(uint32_t, const Slice&) override {
+    return Status::OK();
+  }
+  Status DeleteRangeCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status MergeCF(uint32_t, const Slice&, const Slice&) override {
+    has_merge = true;
+    return Status::OK();
+  }
+  Status MarkBeginPrepare(bool) override { return Status::OK(); }
+  Status MarkEndPrepare(const Slice&) override { return Status::OK(); }
+  Status MarkNoop(bool) override { return Status::OK(); }
+  Status MarkRollback(const Slice&) override { return Status::OK(); }
+  Status MarkCommit(const Slice&) override { return Status::OK(); }
+};
+
 }  // namespace
 Status DBImpl::NewDB() {
   VersionEdit new_db;
@@ -394,6 +719,11 @@ Status DBImpl::Recover(
     }
   }
 
+  // Keys of the caches which outlive the process are prefixed with the DB
+  // identity, which a read only DB may lack
+  if (GetDbIdentity(db_id_).ok()) {
+    versions_->GetColumnFamilySet()->set_db_id(db_id_);
+  }
   Status s = versions_->Recover(column_families, read_only);
 
   if (immutable_db_options_.paranoid_checks && s.ok()) {
@@ -487,13 +817,32 @@ Status DBImpl::Recover(
       if (!read_only) {
         // Remove tailing empty log files that create by pre-create log writer
         while (!logs.empty()) {
-          std::string fname =
-              LogFileName(immutable_db_options_.wal_dir, logs.back());
-          uint64_t bytes;
-          if (!env_->GetFileSize(fname, &bytes).ok() || bytes > 0) {
+          std::vector<std::string> fnames{
+              LogFileName(immutable_db_options_.wal_dir, logs.back())};
+          for (size_t i = 1;; ++i) {
+            std::string stream_fname = LogStreamFileName(
+                immutable_db_options_.wal_dir, logs.back(), i);
+            if (!env_->FileExists(stream_fname).ok()) {
+              break;
+            }
+            fnames.emplace_back(std::move(stream_fname));
+          }
+          bool empty = true;
+          for (auto& fname : fnames) {
+            uint64_t bytes;
+            if (!env_->GetFileSize(fname, &bytes).ok() || bytes > 0) {
+              empty = false;
+              break;
+            }
+          }
+          if (!empty) {
             break;
           }
-          env_->DeleteFile(fname);
+          // Streams go first so that a crash never leaves them without their
+          // log file.
+          for (auto it = fnames.rbegin(); it != fnames.rend(); ++it) {
+            env_->DeleteFile(*it);
+          }
           logs.pop_back();
         }
       }
@@ -646,6 +995,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
   };
 
   mutex_.AssertHeld();
+  const uint64_t recovery_start_micros = env_->NowMicros();
   Status status;
   std::unordered_map<int, VersionEdit> version_edits;
   // no need to refcount because iteration is under mutex
@@ -682,6 +1032,34 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
   }
 #endif
 
+  // With wal_recovery_threads and concurrent memtable writes the batches of a
+  // log are inserted by several threads in groups, like the parallel write
+  // groups of WriteImpl.
+  // Batches holding merges are still inserted one by one. A group holds at
+  // most 1/8 of the smallest write buffer, so memtables are still flushed
+  // close to where they fill up.
+  const size_t kRecoveryInsertGroupSize = 64;
+  const size_t kMaxPrefetchedRecordBytes = 32 << 20;
+  std::unique_ptr<RecoveryInsertPool> insert_pool;
+  size_t max_group_bytes = port::kMaxSizet;
+  if (immutable_db_options_.wal_recovery_threads > 1 &&
+      immutable_db_options_.allow_concurrent_memtable_write &&
+      !immutable_db_options_.allow_2pc && !seq_per_batch_ && batch_per_txn_) {
+    insert_pool.reset(
+        new RecoveryInsertPool(immutable_db_options_.wal_recovery_threads - 1));
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      max_group_bytes = std::min(
+          max_group_bytes,
+          cfd->GetLatestMutableCFOptions()->write_buffer_size / 8);
+    }
+  }
+  std::vector<WriteBatch> pending_batches;
+  std::vector<size_t> pending_record_sizes;
+  size_t pending_bytes = 0;
+  uint64_t num_records = 0;
+  uint64_t num_record_bytes = 0;
+  uint64_t num_concurrent_records = 0;
+
   bool stop_replay_by_wal_filter = false;
   bool stop_replay_for_corruption = false;
   bool flushed = false;
@@ -721,54 +1099,159 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       continue;
     }
 
-    std::unique_ptr<SequentialFileReader> file_reader;
-    {
-      std::unique_ptr<SequentialFile> file;
-      status = env_->NewSequentialFile(fname, &file,
-                                       env_->OptimizeForLogRead(env_options_));
+    // The log file comes first, followed by its extra WAL streams if any.
+    std::vector<std::string> stream_fnames{fname};
+    for (size_t i = 1;; ++i) {
+      std::string stream_fname =
+          LogStreamFileName(immutable_db_options_.wal_dir, log_number, i);
+      if (!env_->FileExists(stream_fname).ok()) {
+        break;
+      }
+      stream_fnames.emplace_back(std::move(stream_fname));
+    }
+    std::vector<LogReporter> reporters(stream_fnames.size());
+    std::vector<std::unique_ptr<log::Reader>> readers;
+    // Corruptions found by the log readers go to read_status, they may run on
+    // the prefetch thread.
+    Status read_status;
+    for (size_t i = 0; status.ok() && i < stream_fnames.size(); ++i) {
+      std::unique_ptr<SequentialFileReader> file_reader;
+      {
+        std::unique_ptr<SequentialFile> file;
+        status = env_->NewSequentialFile(
+            stream_fnames[i], &file, env_->OptimizeForLogRead(env_options_));
+        if (!status.ok()) {
+          break;
+        }
+        file_reader.reset(
+            new SequentialFileReader(std::move(file), stream_fnames[i]));
+      }
+
+      // Create the log reader.
+      LogReporter& reporter = reporters[i];
+      reporter.env = env_;
+      reporter.info_log = immutable_db_options_.info_log.get();
+      reporter.fname = stream_fnames[i].c_str();
+      if (!immutable_db_options_.paranoid_checks ||
+          immutable_db_options_.wal_recovery_mode ==
+              WALRecoveryMode::kSkipAnyCorruptedRecords) {
+        reporter.status = nullptr;
+      } else {
+        reporter.status = &read_status;
+      }
+      // We intentially make log::Reader do checksumming even if
+      // paranoid_checks==false so that corruptions cause entire commits
+      // to be skipped instead of propagating bad information (like overly
+      // large sequence numbers).
+      readers.emplace_back(new log::Reader(
+          immutable_db_options_.info_log, std::move(file_reader), &reporter,
+          true /*checksum*/, log_number, false /* retry_after_eof */));
+    }
+    if (!status.ok()) {
+      MaybeIgnoreError(&status);
       if (!status.ok()) {
+        return status;
+      } else {
+        // Fail with one log file, but that's ok.
+        // Try next one.
+        continue;
+      }
+    }
+    // Corruptions found while replaying go to status
+    LogReporter reporter = reporters[0];
+    if (reporter.status != nullptr) {
+      reporter.status = &status;
+    }
+    // Sequences per batch don't follow from the counts of the records
+    WalStreamMerger reader(std::move(readers),
+                           seq_per_batch_ ? nullptr : &reporters[0]);
+    WalRecordPrefetcher prefetcher(
+        &reader, immutable_db_options_.wal_recovery_mode,
+        reporters[0].status == nullptr ? nullptr : &read_status,
+        kMaxPrefetchedRecordBytes,
+        immutable_db_options_.wal_recovery_threads > 0 /* background */);
+
+    // Inserts the pending batches with the insert pool, returns whether any
+    // of them had valid writes. The batches parsed before they were queued,
+    // so what can still fail here is unsupported content, which fails the
+    // open; the sequence still only advances past the batches inserted.
+    auto insert_pending_batches = [&]() {
+      size_t n = pending_batches.size();
+      std::vector<Status> results(n);
+      std::vector<SequenceNumber> next_seqs(n);
+      std::unique_ptr<bool[]> valid_writes(new bool[n]());
+      insert_pool->Run(n, [&](size_t i) {
+        ColumnFamilyMemTablesImpl column_family_memtables(
+            versions_->GetColumnFamilySet());
+        results[i] = WriteBatchInternal::InsertInto(
+            &pending_batches[i], &column_family_memtables, &flush_scheduler_,
+            true, log_number, this, true /* concurrent_memtable_writes */,
+            &next_seqs[i], &valid_writes[i], seq_per_batch_, batch_per_txn_);
+      });
+      // Concurrent inserts update the flush state of a memtable only after
+      // the batch is done, past the check made by the inserter.
+      for (auto cfd : *versions_->GetColumnFamilySet()) {
+        if (!cfd->IsDropped() && cfd->mem()->ShouldScheduleFlush() &&
+            cfd->mem()->MarkFlushScheduled()) {
+          flush_scheduler_.ScheduleFlush(cfd);
+        }
+      }
+      bool has_valid_writes = false;
+      for (size_t i = 0; i < n && status.ok(); ++i) {
+        status = results[i];
         MaybeIgnoreError(&status);
         if (!status.ok()) {
-          return status;
+          reporter.Corruption(pending_record_sizes[i], status);
         } else {
-          // Fail with one log file, but that's ok.
-          // Try next one.
-          continue;
+          has_valid_writes |= valid_writes[i];
+        }
+        if (results[i].ok()) {
+          *next_sequence = next_seqs[i];
         }
       }
-      file_reader.reset(new SequentialFileReader(std::move(file), fname));
-    }
-
-    // Create the log reader.
-    LogReporter reporter;
-    reporter.env = env_;
-    reporter.info_log = immutable_db_options_.info_log.get();
-    reporter.fname = fname.c_str();
-    if (!immutable_db_options_.paranoid_checks ||
-        immutable_db_options_.wal_recovery_mode ==
-            WALRecoveryMode::kSkipAnyCorruptedRecords) {
-      reporter.status = nullptr;
-    } else {
-      reporter.status = &status;
-    }
-    // We intentially make log::Reader do checksumming even if
-    // paranoid_checks==false so that corruptions cause entire commits
-    // to be skipped instead of propagating bad information (like overly
-    // large sequence numbers).
-    log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, log_number,
-                       false /* retry_after_eof */);
+      num_concurrent_records += n;
+      pending_batches.clear();
+      pending_record_sizes.clear();
+      pending_bytes = 0;
+      return has_valid_writes;
+    };
+
+    // Flushes the memtables scheduled for flush by the inserts
+    auto flush_scheduled_memtables = [&]() {
+      // we can do this because this is called before client has access to the
+      // DB and there is only a single thread operating on DB
+      ColumnFamilyData* cfd;
+
+      while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+        cfd->Unref();
+        // If this asserts, it means that InsertInto failed in
+        // filtering updates to already-flushed column families
+        assert(cfd->GetLogNumber() <= log_number);
+        auto iter = version_edits.find(cfd->GetID());
+        assert(iter != version_edits.end());
+        VersionEdit* edit = &iter->second;
+        Status s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+        if (!s.ok()) {
+          return s;
+        }
+        flushed = true;
+
+        cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                               /* needs_dup_key_check */ false,
+                               *next_sequence);
+      }
+      return Status::OK();
+    };
 
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
-    std::string scratch;
     Slice record;
     WriteBatch batch;
 
-    while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode) &&
+    while (!stop_replay_by_wal_filter && prefetcher.ReadRecord(&record) &&
            status.ok()) {
+      ++num_records;
+      num_record_bytes += record.size();
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
@@ -880,45 +1363,67 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       // we just ignore the update.
       // That's why we set ignore missing column families to true
       bool has_valid_writes = false;
-      status = WriteBatchInternal::InsertInto(
-          &batch, column_family_memtables_.get(), &flush_scheduler_, true,
-          log_number, this, false /* concurrent_memtable_writes */,
-          next_sequence, &has_valid_writes, seq_per_batch_, batch_per_txn_);
-      MaybeIgnoreError(&status);
+      RecoveryBatchChecker checker;
+      if (insert_pool != nullptr && !stop_replay_for_corruption &&
+          batch.Iterate(&checker).ok() && !checker.has_merge) {
+        pending_batches.emplace_back(std::move(batch));
+        pending_record_sizes.push_back(record.size());
+        pending_bytes += record.size();
+        if (pending_batches.size() < kRecoveryInsertGroupSize &&
+            pending_bytes < max_group_bytes) {
+          continue;
+        }
+        has_valid_writes = insert_pending_batches();
+      } else {
+        if (!pending_batches.empty()) {
+          has_valid_writes = insert_pending_batches();
+        }
+        if (status.ok()) {
+          bool batch_has_valid_writes = false;
+          status = WriteBatchInternal::InsertInto(
+              &batch, column_family_memtables_.get(), &flush_scheduler_, true,
+              log_number, this, false /* concurrent_memtable_writes */,
+              next_sequence, &batch_has_valid_writes, seq_per_batch_,
+              batch_per_txn_);
+          MaybeIgnoreError(&status);
+          if (!status.ok()) {
+            // We are treating this as a failure while reading since we read
+            // valid blocks that do not form coherent data
+            reporter.Corruption(record.size(), status);
+          }
+          has_valid_writes |= batch_has_valid_writes;
+        }
+      }
       if (!status.ok()) {
-        // We are treating this as a failure while reading since we read valid
-        // blocks that do not form coherent data
-        reporter.Corruption(record.size(), status);
         continue;
       }
 
       if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->Unref();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= log_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
-
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 /* needs_dup_key_check */ false,
-                                 *next_sequence);
+        status = flush_scheduled_memtables();
+        if (!status.ok()) {
+          // Reflect errors immediately so that conditions like full
+          // file-systems cause the DB::Open() to fail.
+          return status;
         }
       }
     }
+    prefetcher.Stop();
+    // The batches read before a corruption are still replayed
+    if (status.ok() && !pending_batches.empty()) {
+      bool has_valid_writes = insert_pending_batches();
+      if (status.ok() && has_valid_writes && !read_only) {
+        status = flush_scheduled_memtables();
+        if (!status.ok()) {
+          return status;
+        }
+      }
+    }
+    pending_batches.clear();
+    pending_record_sizes.clear();
+    pending_bytes = 0;
+    if (status.ok() && !read_status.ok()) {
+      status = read_status;
+    }
 
     if (!status.ok()) {
       if (status.IsNotSupported()) {
@@ -1049,8 +1554,17 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
     status = RestoreAliveLogFiles(log_numbers, log_seqs);
   }
 
+  uint64_t recovery_micros = env_->NowMicros() - recovery_start_micros;
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "[JOB %d] Recovered %" ROCKSDB_PRIszt " log files, %" PRIu64
+                 " records (%" PRIu64 " inserted concurrently), %" PRIu64
+                 " bytes in %" PRIu64 " ms: %s",
+                 job_id, log_numbers.size(), num_records,
+                 num_concurrent_records, num_record_bytes,
+                 recovery_micros / 1000, status.ToString().c_str());
   event_logger_.Log() << "job" << job_id << "event"
-                      << "recovery_finished";
+                      << "recovery_finished"
+                      << "recovery_time_micros" << recovery_micros;
 
   return status;
 }
@@ -1365,6 +1879,8 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
                 std::move(file_writer), new_log_number,
                 impl->immutable_db_options_.recycle_log_file_num > 0,
                 impl->immutable_db_options_.manual_wal_flush));
+        s = impl->AddWalStreams(impl->logs_.back().writer, opt_env_options,
+                                write_hint);
       }
 
       autovector<const ColumnFamilyOptions*> cf_options_list;
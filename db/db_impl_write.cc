@@ -13,6 +13,9 @@
 #endif
 #include <inttypes.h>
 
+#include <functional>
+#include <thread>
+
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
 #include "monitoring/perf_context_imp.h"
@@ -94,6 +97,12 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   if (write_options.sync && write_options.disableWAL) {
     return Status::InvalidArgument("Sync writes has to enable WAL.");
   }
+  if (write_options.disableWAL && immutable_db_options_.wal_streams > 1) {
+    // Recovery takes a gap in the sequences of the WAL streams for lost
+    // records
+    return Status::NotSupported(
+        "disableWAL is not compatible with wal_streams");
+  }
   if (two_write_queues_ && immutable_db_options_.enable_pipelined_write) {
     return Status::NotSupported(
         "pipelined_writes is not compatible with concurrent prepares");
@@ -131,6 +140,15 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
 
   if (!write_options.disableWAL) {
     RecordTick(stats_, WRITE_WITH_WAL);
+    if (immutable_db_options_.wal_streams > 1) {
+      // Writers running on the same core group share a WAL stream.
+      int core = port::PhysicalCoreID();
+      size_t hash = core >= 0 ? static_cast<size_t>(core)
+                              : std::hash<std::thread::id>()(
+                                    std::this_thread::get_id());
+      w.wal_stream = hash % immutable_db_options_.wal_streams;
+      TEST_SYNC_POINT_CALLBACK("DBImpl::WriteImpl:WalStream", &w.wal_stream);
+    }
   }
 
   StopWatch write_sw(env_, immutable_db_options_.statistics.get(), DB_WRITE);
@@ -139,7 +157,16 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   if (w.state == WriteThread::STATE_PARALLEL_MEMTABLE_WRITER) {
     // we are a non-leader in a parallel group
 
-    if (w.ShouldWriteToMemtable()) {
+    Status log_status;
+    if (w.write_group->log_writer != nullptr) {
+      PERF_TIMER_STOP(write_pre_and_post_process_time);
+      PERF_TIMER_GUARD(write_wal_time);
+      // The leader reports a failure, the group exit hands it to us
+      log_status = WriteToWALStream(w.write_group, &w);
+      PERF_TIMER_START(write_pre_and_post_process_time);
+    }
+
+    if (w.ShouldWriteToMemtable() && log_status.ok()) {
       PERF_TIMER_STOP(write_pre_and_post_process_time);
       PERF_TIMER_GUARD(write_memtable_time);
 
@@ -167,8 +194,10 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         }
       }
       // TODO(myabandeh): propagate status to write_group
-      auto last_sequence = w.write_group->last_sequence;
-      versions_->SetLastSequence(last_sequence);
+      if (w.write_group->stream_status.ok()) {
+        auto last_sequence = w.write_group->last_sequence;
+        versions_->SetLastSequence(last_sequence);
+      }
       MemTableInsertStatusCheck(w.status);
       write_thread_.ExitAsBatchGroupFollower(&w);
     }
@@ -268,6 +297,14 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     // the seq per valid written key to mem.
     size_t seq_inc = seq_per_batch_ ? valid_batches : total_count;
 
+    // With several WAL streams, a parallel group is logged by the first
+    // writer of each stream rather than by the leader alone. Sync writes keep
+    // the single merged record so that one fsync covers the whole group.
+    const bool log_by_stream = parallel && !write_options.disableWAL &&
+                               !need_log_sync && !two_write_queues_ &&
+                               !seq_per_batch_ &&
+                               log_writer->num_streams() > 1;
+
     const bool concurrent_update = two_write_queues_;
     // Update stats while we are an exclusive group leader, so we know
     // that nobody else can be writing to these particular stats.
@@ -297,7 +334,28 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     PERF_TIMER_STOP(write_pre_and_post_process_time);
 
     if (!two_write_queues_) {
-      if (status.ok() && !write_options.disableWAL) {
+      if (status.ok() && log_by_stream) {
+        PERF_TIMER_GUARD(write_wal_time);
+        size_t log_size = 0;
+        size_t write_with_wal = 0;
+        for (auto* writer : write_group) {
+          if (!writer->CallbackFailed()) {
+            writer->log_used = logfile_number_;
+            log_size += WriteBatchInternal::ByteSize(writer->batch);
+            ++write_with_wal;
+          }
+        }
+        if (log_used != nullptr) {
+          *log_used = logfile_number_;
+        }
+        total_log_size_ += log_size;
+        alive_log_files_.back().AddSize(log_size);
+        log_empty_ = false;
+        stats->AddDBStats(InternalStats::WAL_FILE_BYTES, log_size);
+        RecordTick(stats_, WAL_FILE_BYTES, log_size);
+        stats->AddDBStats(InternalStats::WRITE_WITH_WAL, write_with_wal);
+        RecordTick(stats_, WRITE_WITH_WAL, write_with_wal);
+      } else if (status.ok() && !write_options.disableWAL) {
         PERF_TIMER_GUARD(write_wal_time);
         status = WriteToWAL(write_group, log_writer, log_used, need_log_sync,
                             need_log_dir_sync, last_sequence + 1);
@@ -334,28 +392,49 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         // logic in WriteBatchInternal::InsertInto(write_group...) as well as
         // with WriteBatchInternal::InsertInto(write_batch...) that is called on
         // the merged batch during recovery from the WAL.
-        for (auto* writer : write_group) {
-          if (writer->CallbackFailed()) {
-            continue;
-          }
-          writer->sequence = next_sequence;
-          if (seq_per_batch_) {
-            assert(writer->batch_cnt);
-            next_sequence += writer->batch_cnt;
-          } else if (writer->ShouldWriteToMemtable()) {
-            next_sequence += WriteBatchInternal::Count(writer->batch);
+        //
+        // When logging by stream, sequences are handed out stream by stream so
+        // that the record of every stream covers a contiguous range.
+        size_t num_streams = log_by_stream ? log_writer->num_streams() : 1;
+        for (size_t stream = 0; stream < num_streams; ++stream) {
+          bool first_of_stream = true;
+          for (auto* writer : write_group) {
+            if (writer->CallbackFailed() ||
+                (log_by_stream && writer->wal_stream != stream)) {
+              continue;
+            }
+            writer->log_to_stream = log_by_stream && first_of_stream;
+            first_of_stream = false;
+            writer->sequence = next_sequence;
+            if (seq_per_batch_) {
+              assert(writer->batch_cnt);
+              next_sequence += writer->batch_cnt;
+            } else if (writer->ShouldWriteToMemtable()) {
+              next_sequence += WriteBatchInternal::Count(writer->batch);
+            }
           }
         }
         write_group.last_sequence = last_sequence;
+        if (log_by_stream) {
+          write_group.log_writer = log_writer;
+          for (auto* writer : write_group) {
+            write_group.pending_stream_records += writer->log_to_stream;
+          }
+        }
         write_thread_.LaunchParallelMemTableWriters(&write_group);
         in_parallel_group = true;
 
+        if (log_by_stream) {
+          PERF_TIMER_GUARD(write_wal_time);
+          status = WriteToWALStream(&write_group, &w);
+        }
+
         // Each parallel follower is doing each own writes. The leader should
         // also do its own.
-        if (w.ShouldWriteToMemtable()) {
+        if (w.ShouldWriteToMemtable() && status.ok()) {
           ColumnFamilyMemTablesImpl column_family_memtables(
               versions_->GetColumnFamilySet());
-          assert(w.sequence == current_sequence);
+          assert(log_by_stream || w.sequence == current_sequence);
           w.status = WriteBatchInternal::InsertInto(
               &w, w.sequence, &column_family_memtables, &flush_scheduler_,
               write_options.ignore_missing_column_families, 0 /*log_number*/,
@@ -905,9 +984,8 @@ Status DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
     //  - as long as other threads don't modify it, it's safe to read
     //    from std::deque from multiple threads concurrently.
     for (auto& log : logs_) {
-      auto f = log.writer->file();
-      if (f != nullptr) {
-        status = f->Sync(immutable_db_options_.use_fsync);
+      if (log.writer->file() != nullptr) {
+        status = log.writer->Sync(immutable_db_options_.use_fsync);
       }
       if (!status.ok()) {
         break;
@@ -938,6 +1016,57 @@ Status DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   return status;
 }
 
+Status DBImpl::WriteToWALStream(WriteThread::WriteGroup* write_group,
+                                WriteThread::Writer* w) {
+  assert(write_group->log_writer != nullptr);
+  Status status;
+  if (w->log_to_stream) {
+    status = WriteStreamRecord(*write_group, w);
+  }
+  std::unique_lock<std::mutex> guard(write_group->stream_mutex);
+  if (w->log_to_stream) {
+    if (!status.ok() && write_group->stream_status.ok()) {
+      write_group->stream_status = status;
+    }
+    if (--write_group->pending_stream_records == 0) {
+      write_group->stream_cv.notify_all();
+    }
+  }
+  // Nothing may reach the memtables before the whole group is logged, a
+  // failed record would otherwise leave sequences of other streams inserted
+  // but neither logged nor published
+  write_group->stream_cv.wait(
+      guard, [write_group] { return write_group->pending_stream_records == 0; });
+  return write_group->stream_status;
+}
+
+Status DBImpl::WriteStreamRecord(const WriteThread::WriteGroup& write_group,
+                                 WriteThread::Writer* w) {
+  assert(w->log_to_stream);
+  WriteBatch tmp_batch;
+  WriteBatch* merged_batch = nullptr;
+  for (auto* writer : write_group) {
+    if (writer->CallbackFailed() || writer->wal_stream != w->wal_stream) {
+      continue;
+    }
+    if (merged_batch == nullptr) {
+      assert(writer == w);
+      merged_batch = writer->batch;
+      continue;
+    }
+    if (merged_batch != &tmp_batch) {
+      WriteBatchInternal::Append(&tmp_batch, merged_batch,
+                                 /*WAL_only*/ true);
+      merged_batch = &tmp_batch;
+    }
+    WriteBatchInternal::Append(&tmp_batch, writer->batch, /*WAL_only*/ true);
+  }
+  assert(merged_batch != nullptr);
+  WriteBatchInternal::SetSequence(merged_batch, w->sequence);
+  return write_group.log_writer->stream(w->wal_stream)
+      ->AddRecord(WriteBatchInternal::Contents(merged_batch));
+}
+
 Status DBImpl::ConcurrentWriteToWAL(const WriteThread::WriteGroup& write_group,
                                     uint64_t* log_used,
                                     SequenceNumber* last_sequence,
@@ -1142,6 +1271,20 @@ Status DBImpl::SwitchWAL(WriteContext* write_context) {
   return status;
 }
 
+namespace {
+// Flushing a memtable costs a fixed overhead for the new table file, the
+// manifest write and one more L0 file to compact, besides the work per entry
+// and per byte. Expressed in bytes of memtable.
+const double kFlushFixedCost = 2 << 20;
+const double kFlushCostPerEntry = 32;
+
+double FlushEfficiency(MemTable* mem) {
+  double bytes = static_cast<double>(mem->ApproximateMemoryUsage());
+  return bytes / (kFlushFixedCost + mem->num_entries() * kFlushCostPerEntry +
+                  bytes);
+}
+}  // namespace
+
 Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
   mutex_.AssertHeld();
   assert(write_context != nullptr);
@@ -1158,9 +1301,16 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
   autovector<ColumnFamilyData*> cfds;
   FlushRequestVec flush_req_vec;
   ColumnFamilyData* cfd_picked = nullptr;
+  WriteBufferManager* full_node_picked = nullptr;
   SequenceNumber seq_num_for_cf_picked = kMaxSequenceNumber;
   size_t largest_cfd_size = 0;
+  double best_score = 0;
 
+  // Flushing frees memory only below the budget nodes that ran full. Racing
+  // writers may have released the pressure already, then any column family
+  // is a candidate as before.
+  autovector<std::pair<ColumnFamilyData*, WriteBufferManager*>> candidates;
+  bool any_full_node = false;
   for (auto cfd : *versions_->GetColumnFamilySet()) {
     if (cfd->IsDropped()) {
       continue;
@@ -1168,24 +1318,53 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
     if (!cfd->mem()->IsEmpty()) {
       // We only consider active mem table, hoping immutable memtable is already
       // in the process of flushing.
-      if (flush_pri == kFlushOldest) {
-        uint64_t seq = cfd->mem()->GetCreationSeq();
-        if (cfd_picked == nullptr || seq < seq_num_for_cf_picked) {
-          cfd_picked = cfd;
-          seq_num_for_cf_picked = seq;
-        }
-      } else if (!cfd->queued_for_flush()) {
-        assert(flush_pri == kFlushLargest);
-        size_t cfd_size = cfd->mem()->ApproximateMemoryUsage();
-        if (cfd_picked == nullptr || cfd_size > largest_cfd_size) {
-          cfd_picked = cfd;
-          largest_cfd_size = cfd_size;
-        }
+      WriteBufferManager* full_node = cfd->write_buffer_manager();
+      while (full_node != nullptr && !full_node->ExceedsBudget()) {
+        full_node = full_node->parent();
+      }
+      any_full_node |= full_node != nullptr;
+      candidates.emplace_back(cfd, full_node);
+    }
+  }
+  for (auto& candidate : candidates) {
+    auto cfd = candidate.first;
+    if (any_full_node && candidate.second == nullptr) {
+      continue;
+    }
+    if (flush_pri == kFlushOldest) {
+      uint64_t seq = cfd->mem()->GetCreationSeq();
+      if (cfd_picked == nullptr || seq < seq_num_for_cf_picked) {
+        cfd_picked = cfd;
+        full_node_picked = candidate.second;
+        seq_num_for_cf_picked = seq;
+      }
+    } else if (cfd->queued_for_flush()) {
+      continue;
+    } else if (flush_pri == kFlushMostEfficient) {
+      // Bytes freed per flush cost, scaled by how far the budget nodes of the
+      // column family are above their weighted share
+      double score = FlushEfficiency(cfd->mem()) *
+                     cfd->write_buffer_manager()->ShareRatio();
+      if (cfd_picked == nullptr || score > best_score) {
+        cfd_picked = cfd;
+        full_node_picked = candidate.second;
+        best_score = score;
+      }
+    } else {
+      assert(flush_pri == kFlushLargest);
+      size_t cfd_size = cfd->mem()->ApproximateMemoryUsage();
+      if (cfd_picked == nullptr || cfd_size > largest_cfd_size) {
+        cfd_picked = cfd;
+        full_node_picked = candidate.second;
+        largest_cfd_size = cfd_size;
       }
     }
   }
   if (cfd_picked != nullptr) {
     cfds.push_back(cfd_picked);
+    if (full_node_picked != nullptr) {
+      full_node_picked->RecordFlush();
+    }
   }
   ProcessAtomicFlushGroup(&cfds, &flush_req_vec);
   uint64_t memory_usage = write_buffer_manager_->memory_usage();
@@ -1196,8 +1375,10 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
         "Flushing column family [%s] with %s. Write buffer is using %" PRIu64
         " bytes out of a total of %" PRIu64 ".",
         cfd->GetName().c_str(),
-        flush_pri == kFlushLargest ? "largest mem table size"
-                                   : "oldest sequence number",
+        flush_pri == kFlushOldest
+            ? "oldest sequence number"
+            : flush_pri == kFlushLargest ? "largest mem table size"
+                                         : "best bytes freed per flush cost",
         memory_usage, buffer_size);
   }
 
@@ -1457,6 +1638,31 @@ Status DBImpl::NewLogWriter(std::unique_ptr<log::Writer>* new_log,
     new_log->reset(new log::Writer(
         std::move(file_writer), new_log_number,
         immutable_db_options_.recycle_log_file_num > 0, manual_wal_flush_));
+    s = AddWalStreams(new_log->get(), opt_env_opt, write_hint);
+    if (!s.ok()) {
+      new_log->reset();
+    }
+  }
+  return s;
+}
+
+Status DBImpl::AddWalStreams(log::Writer* log, const EnvOptions& env_options,
+                             Env::WriteLifeTimeHint write_hint) {
+  Status s;
+  for (size_t i = 1; s.ok() && i < immutable_db_options_.wal_streams; ++i) {
+    std::string fname = LogStreamFileName(immutable_db_options_.wal_dir,
+                                          log->get_log_number(), i);
+    std::unique_ptr<WritableFile> file;
+    s = NewWritableFile(env_, fname, &file, env_options);
+    if (s.ok()) {
+      file->SetWriteLifeTimeHint(write_hint);
+      std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
+          std::move(file), fname, env_options, nullptr /* stats */,
+          immutable_db_options_.listeners));
+      log->AddStream(std::unique_ptr<log::Writer>(
+          new log::Writer(std::move(file_writer), log->get_log_number(),
+                          false /* recycle_log_files */)));
+    }
   }
   return s;
 }
@@ -80,6 +80,8 @@ class DBIter final : public Iterator {
       prev_found_count_ = 0;
       bytes_read_ = 0;
       skip_count_ = 0;
+      value_meta_filtered_count_ = 0;
+      blob_fetch_avoided_count_ = 0;
     }
 
     void BumpGlobalStatistics(Statistics* global_statistics) {
@@ -89,7 +91,13 @@ class DBIter final : public Iterator {
       RecordTick(global_statistics, NUMBER_DB_PREV_FOUND, prev_found_count_);
       RecordTick(global_statistics, ITER_BYTES_READ, bytes_read_);
       RecordTick(global_statistics, NUMBER_ITER_SKIP, skip_count_);
+      RecordTick(global_statistics, ITER_VALUE_META_FILTERED,
+                 value_meta_filtered_count_);
+      RecordTick(global_statistics, ITER_BLOB_FETCH_AVOIDED,
+                 blob_fetch_avoided_count_);
       PERF_COUNTER_ADD(iter_read_bytes, bytes_read_);
+      PERF_COUNTER_ADD(value_meta_filtered_count, value_meta_filtered_count_);
+      PERF_COUNTER_ADD(blob_fetch_avoided_count, blob_fetch_avoided_count_);
       ResetCounters();
     }
 
@@ -105,6 +113,10 @@ class DBIter final : public Iterator {
     uint64_t bytes_read_;
     // Map to Tickers::NUMBER_ITER_SKIP
     uint64_t skip_count_;
+    // Map to Tickers::ITER_VALUE_META_FILTERED
+    uint64_t value_meta_filtered_count_;
+    // Map to Tickers::ITER_BLOB_FETCH_AVOIDED
+    uint64_t blob_fetch_avoided_count_;
   };
 
   DBIter(Env* _env, const ReadOptions& read_options,
@@ -135,8 +147,18 @@ class DBIter final : public Iterator {
         read_callback_(read_callback),
         db_impl_(db_impl),
         cfd_(cfd),
-        start_seqnum_(read_options.iter_start_seqnum) {
+        start_seqnum_(read_options.iter_start_seqnum),
+        read_options_(read_options) {
     RecordTick(statistics_, NO_ITERATOR_CREATED);
+    ResetScanHelper();
+    if (read_options_.value_meta_filter &&
+        cf_options.value_meta_extractor_factory != nullptr) {
+      ValueExtractorContext context;
+      context.column_family_id = cfd_ == nullptr ? 0 : cfd_->GetID();
+      value_meta_extractor_ =
+          cf_options.value_meta_extractor_factory->CreateValueExtractor(
+              context);
+    }
     prefix_extractor_ = mutable_cf_options.prefix_extractor.get();
     max_skip_ = max_sequential_skip_in_iterations;
     max_skippable_internal_keys_ = read_options.max_skippable_internal_keys;
@@ -146,6 +168,7 @@ class DBIter final : public Iterator {
     RecordTick(statistics_, NO_ITERATOR_DELETED);
     ResetValueAndCounter();
     merge_context_.Clear();
+    scan_helper_.reset();
     local_stats_.BumpGlobalStatistics(statistics_);
     if (!arena_mode_) {
       delete iter_;
@@ -164,6 +187,7 @@ class DBIter final : public Iterator {
             self->PinLazyBuffer();
             self->separate_helper_ =
                 new_sv == nullptr ? nullptr : new_sv->current;
+            self->ResetScanHelper();
           },
           this);
     }
@@ -174,6 +198,7 @@ class DBIter final : public Iterator {
     assert(iter_ == nullptr);
     iter_ = iter;
     separate_helper_ = separate_helper;
+    ResetScanHelper();
     SetSVDestructCallback(sv_destruct_callback);
   }
   virtual ReadRangeDelAggregator* GetRangeDelAggregator() {
@@ -251,12 +276,37 @@ class DBIter final : public Iterator {
   LazyBuffer GetValue(const ParsedInternalKey& ikey, ValueType index_type) {
     if (separate_helper_ == nullptr || ikey.type != index_type) {
       return iter_->value();
+    } else if (scan_helper_) {
+      return scan_helper_->TransToCombined(saved_key_.GetUserKey(),
+                                           ikey.sequence, iter_->value());
     } else {
       return separate_helper_->TransToCombined(saved_key_.GetUserKey(),
                                                ikey.sequence, iter_->value());
     }
   }
 
+  // Set *filtered if ReadOptions::value_meta_filter rejects the value of
+  // ikey, which must be the kTypeValue or kTypeValueIndex entry at iter_. A
+  // separated value is filtered by the meta in its value index, without being
+  // fetched, and *separated is set. Return false on error, with status_ set.
+  bool CheckValueMetaFilter(const ParsedInternalKey& ikey, bool* filtered,
+                            bool* separated);
+  void RecordValueMetaFiltered(bool separated) {
+    ++local_stats_.value_meta_filtered_count_;
+    if (separated) {
+      ++local_stats_.blob_fetch_avoided_count_;
+    }
+  }
+
+  // The scan helper refers to separate_helper_, recreate it whenever
+  // separate_helper_ changes. Buffers from the old one must be pinned
+  void ResetScanHelper() {
+    scan_helper_.reset(separate_helper_ == nullptr ||
+                               read_options_.blob_readahead_size == 0
+                           ? nullptr
+                           : separate_helper_->NewScanHelper(read_options_));
+  }
+
   void PrevInternal();
   bool TooManyInternalKeysSkipped(bool increment = true);
   bool IsVisible(SequenceNumber sequence);
@@ -327,12 +377,47 @@ class DBIter final : public Iterator {
   // for diff snapshots we want the lower bound on the seqnum;
   // if this value > 0 iterator will return internal keys
   SequenceNumber start_seqnum_;
+  // Reads separated values through read-ahead iterators if
+  // ReadOptions::blob_readahead_size is set
+  const ReadOptions read_options_;
+  std::unique_ptr<SeparateHelper> scan_helper_;
+  // Extracts the value meta of inline values for value_meta_filter
+  std::unique_ptr<ValueExtractor> value_meta_extractor_;
 
   // No copying allowed
   DBIter(const DBIter&);
   void operator=(const DBIter&);
 };
 
+bool DBIter::CheckValueMetaFilter(const ParsedInternalKey& ikey,
+                                  bool* filtered, bool* separated) {
+  *filtered = false;
+  *separated = separate_helper_ != nullptr && ikey.type == kTypeValueIndex;
+  if (!read_options_.value_meta_filter) {
+    return true;
+  }
+  LazyBuffer value = iter_->value();
+  Status s = value.fetch();
+  Slice value_meta;
+  std::string extracted_meta;
+  if (s.ok()) {
+    if (*separated) {
+      value_meta = SeparateHelper::DecodeValueMeta(value.slice());
+    } else if (value_meta_extractor_ != nullptr) {
+      s = value_meta_extractor_->Extract(ikey.user_key, value.slice(),
+                                         &extracted_meta);
+      value_meta = extracted_meta;
+    }
+  }
+  if (!s.ok()) {
+    valid_ = false;
+    status_ = std::move(s);
+    return false;
+  }
+  *filtered = !read_options_.value_meta_filter(ikey.user_key, value_meta);
+  return true;
+}
+
 inline bool DBIter::ParseKey(ParsedInternalKey* ikey) {
   if (!ParseInternalKey(iter_->key(), ikey)) {
     status_ = Status::Corruption("corrupted internal key in DBIter");
@@ -504,6 +589,19 @@ bool DBIter::FindNextUserEntryInternal(bool skipping, bool prefix_check) {
                 reseek_done = false;
                 PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
               } else {
+                bool filtered, separated;
+                if (!CheckValueMetaFilter(ikey_, &filtered, &separated)) {
+                  return false;
+                }
+                if (filtered) {
+                  // Skip all upcoming entries for this key, the newest
+                  // value hides them
+                  RecordValueMetaFiltered(separated);
+                  skipping = true;
+                  num_skipped = 0;
+                  reseek_done = false;
+                  break;
+                }
                 value_ = GetValue(ikey_, kTypeValueIndex);
                 valid_ = true;
                 return true;
@@ -847,6 +945,9 @@ bool DBIter::FindValueForCurrentKey() {
   // kTypeValue)
   ValueType last_not_merge_type = kTypeDeletion;
   ValueType last_key_entry_type = kTypeDeletion;
+  // Whether value_meta_filter rejected the last value
+  bool value_filtered = false;
+  bool value_separated = false;
 
   size_t num_skipped = 0;
   while (iter_->Valid()) {
@@ -879,6 +980,9 @@ bool DBIter::FindValueForCurrentKey() {
           last_key_entry_type = kTypeRangeDeletion;
           PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
         } else {
+          if (!CheckValueMetaFilter(ikey, &value_filtered, &value_separated)) {
+            return false;
+          }
           value_ = GetValue(ikey, kTypeValueIndex);
           value_.pin(LazyBufferPinLevel::Internal);
         }
@@ -950,6 +1054,12 @@ bool DBIter::FindValueForCurrentKey() {
       break;
     case kTypeValueIndex:
     case kTypeValue:
+      if (value_filtered) {
+        RecordValueMetaFiltered(value_separated);
+        value_.reset();
+        valid_ = false;
+        return true;
+      }
       break;
     default:
       assert(false);
@@ -1011,6 +1121,15 @@ bool DBIter::FindValueForCurrentKeyUsingSeek() {
     return true;
   }
   if (ikey.type == kTypeValue || ikey.type == kTypeValueIndex) {
+    bool filtered, separated;
+    if (!CheckValueMetaFilter(ikey, &filtered, &separated)) {
+      return false;
+    }
+    if (filtered) {
+      RecordValueMetaFiltered(separated);
+      valid_ = false;
+      return true;
+    }
     value_ = GetValue(ikey, kTypeValueIndex);
     value_.pin(LazyBufferPinLevel::Internal);
     valid_ = true;
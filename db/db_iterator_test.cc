@@ -1614,6 +1614,152 @@ TEST_P(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+TEST_P(DBIteratorTest, BlobReadAhead) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  DestroyAndReopen(options);
+
+  auto value_of = [](int i) { return Key(i) + std::string(1000, 'a' + i % 26); };
+  for (int i = 0; i < 300; i += 2) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 1; i < 300; i += 2) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(-1), 0);
+  // Newer values in memtable are not separated
+  ASSERT_OK(Put(Key(7), "v7"));
+  ASSERT_OK(Delete(Key(9)));
+
+  PerfLevel prev_perf_level = GetPerfLevel();
+  SetPerfLevel(kEnableCount);
+  for (size_t readahead_size : {0, 64 << 10}) {
+    ReadOptions read_options;
+    read_options.blob_readahead_size = readahead_size;
+    get_perf_context()->Reset();
+    std::unique_ptr<Iterator> iter(NewIterator(read_options));
+    int i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+      if (i == 9) {
+        ++i;
+      }
+      ASSERT_EQ(Key(i), iter->key());
+      ASSERT_EQ(i == 7 ? "v7" : value_of(i), iter->value());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(300, i);
+
+    // Seek into the middle, then scan backward
+    iter->Seek(Key(150));
+    for (i = 150; iter->Valid() && i >= 100; iter->Prev(), --i) {
+      ASSERT_EQ(Key(i), iter->key());
+      ASSERT_EQ(value_of(i), iter->value());
+    }
+    ASSERT_OK(iter->status());
+
+    if (readahead_size == 0) {
+      ASSERT_EQ(0U, get_perf_context()->blob_prefetch_used_bytes);
+    } else {
+      ASSERT_GT(get_perf_context()->blob_prefetch_used_bytes, 0U);
+    }
+  }
+  SetPerfLevel(prev_perf_level);
+}
+
+namespace {
+// Uses the first byte of the value as its value meta
+class TagValueExtractor : public ValueExtractor {
+ public:
+  Status Extract(const Slice& /*key*/, const Slice& value,
+                 std::string* output) const override {
+    output->assign(value.data(), std::min<size_t>(1, value.size()));
+    return Status::OK();
+  }
+};
+
+class TagValueExtractorFactory : public ValueExtractorFactory {
+ public:
+  std::unique_ptr<ValueExtractor> CreateValueExtractor(
+      const Context& /*context*/) const override {
+    return std::unique_ptr<ValueExtractor>(new TagValueExtractor());
+  }
+  const char* Name() const override { return "TagValueExtractorFactory"; }
+};
+}  // namespace
+
+TEST_P(DBIteratorTest, ValueMetaFilter) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.value_meta_extractor_factory =
+      std::make_shared<TagValueExtractorFactory>();
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  auto value_of = [](int i) {
+    return std::string(1, 'a' + i % 3) + std::string(1000, 'x');
+  };
+  for (int i = 0; i < 300; ++i) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(-1), 0);
+  // Newer values in memtable are not separated, their meta is extracted
+  ASSERT_OK(Put(Key(0), "b0"));
+  ASSERT_OK(Put(Key(1), "a1"));
+
+  auto expected = [&](int i) {
+    return i == 1 || (i != 0 && i % 3 == 0);
+  };
+  ReadOptions read_options;
+  read_options.value_meta_filter = [](const Slice& /*user_key*/,
+                                      const Slice& value_meta) {
+    return value_meta == "a";
+  };
+  PerfLevel prev_perf_level = GetPerfLevel();
+  SetPerfLevel(kEnableCount);
+  get_perf_context()->Reset();
+  std::unique_ptr<Iterator> iter(NewIterator(read_options));
+  int count = 0;
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    while (!expected(i)) {
+      ++i;
+    }
+    ASSERT_EQ(Key(i), iter->key());
+    ASSERT_EQ(i == 1 ? "a1" : value_of(i), iter->value());
+    ++count;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(100, count);
+
+  // Seek into the middle, then scan backward
+  iter->Seek(Key(151));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(153), iter->key());
+  for (i = 153; iter->Valid() && i >= 100; iter->Prev(), i -= 3) {
+    ASSERT_EQ(Key(i), iter->key());
+    ASSERT_EQ(value_of(i), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  iter.reset();
+
+  // Filtered separated values are never fetched
+  ASSERT_GT(get_perf_context()->blob_fetch_avoided_count, 0);
+  ASSERT_LT(get_perf_context()->blob_fetch_avoided_count,
+            get_perf_context()->value_meta_filtered_count);
+  ASSERT_EQ(get_perf_context()->blob_fetch_avoided_count,
+            options.statistics->getTickerCount(ITER_BLOB_FETCH_AVOIDED));
+  SetPerfLevel(prev_perf_level);
+}
+
 // Insert a key, create a snapshot iterator, overwrite key lots of times,
 // seek to a smaller key. Expect DBIter to fall back to a seek instead of
 // going through all the overwrites linearly.
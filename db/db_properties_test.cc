@@ -10,6 +10,7 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <sstream>
 #include <string>
 
 #include "db/db_test_util.h"
@@ -1624,6 +1625,112 @@ TEST_F(DBPropertiesTest, BlockCacheProperties) {
   ASSERT_EQ(0, value);
 }
 
+TEST_F(DBPropertiesTest, AdaptiveBlobSize) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.num_levels = 4;
+  options.blob_size = 64;
+  options.blob_large_key_ratio = 0;
+  options.enable_adaptive_blob_size = true;
+  DestroyAndReopen(options);
+
+  auto get_blob_sizes = [&]() {
+    std::string property;
+    EXPECT_TRUE(db_->GetProperty(DB::Properties::kAdaptiveBlobSize, &property));
+    std::vector<size_t> blob_sizes;
+    std::istringstream lines(property);
+    std::string line;
+    while (std::getline(lines, line)) {
+      int level;
+      size_t blob_size;
+      if (sscanf(line.c_str(), "L%d: %zu", &level, &blob_size) == 2) {
+        EXPECT_EQ(static_cast<size_t>(level), blob_sizes.size());
+        blob_sizes.push_back(blob_size);
+      }
+    }
+    EXPECT_EQ(static_cast<size_t>(options.num_levels), blob_sizes.size());
+    return blob_sizes;
+  };
+
+  // No histogram yet, every level uses blob_size
+  for (auto blob_size : get_blob_sizes()) {
+    ASSERT_EQ(64, blob_size);
+  }
+
+  Random rnd(301);
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, i % 2 == 0 ? 16 : 4096)));
+  }
+  ASSERT_OK(Flush());
+  // Compactions rewrite values already counted by the flush
+  std::string flushed_histogram;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kAdaptiveBlobSize,
+                               &flushed_histogram));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::string compacted_histogram;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kAdaptiveBlobSize,
+                               &compacted_histogram));
+  ASSERT_EQ(flushed_histogram, compacted_histogram);
+
+  // Only the large values are worth separating, and deeper levels rewrite
+  // inlined values fewer times
+  auto blob_sizes = get_blob_sizes();
+  ASSERT_GT(blob_sizes[1], 16);
+  ASSERT_LE(blob_sizes[1], 4096);
+  for (int level = 2; level < options.num_levels; ++level) {
+    ASSERT_GE(blob_sizes[level], blob_sizes[level - 1]);
+  }
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_EQ(i % 2 == 0 ? 16 : 4096, Get(Key(i)).size());
+  }
+
+  // Only weighing the read cost separates nothing
+  ASSERT_OK(dbfull()->SetOptions(
+      {{"adaptive_blob_size_write_weight", "0"}}));
+  for (auto blob_size : get_blob_sizes()) {
+    ASSERT_GT(blob_size, 4096);
+  }
+
+  ASSERT_OK(dbfull()->SetOptions({{"enable_adaptive_blob_size", "false"}}));
+  for (auto blob_size : get_blob_sizes()) {
+    ASSERT_EQ(64, blob_size);
+  }
+}
+
+TEST_F(DBPropertiesTest, AdaptiveBlobSizeAfterReopen) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.blob_size = 64;
+  options.blob_large_key_ratio = 0;
+  options.enable_adaptive_blob_size = true;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, i % 2 == 0 ? 16 : 4096)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  std::string histogram;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kAdaptiveBlobSize, &histogram));
+
+  // Rebuilt from the live ssts, the key ssts count the inlined values and the
+  // blob ssts the separated ones
+  Reopen(options);
+  std::string reopened_histogram;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kAdaptiveBlobSize,
+                               &reopened_histogram));
+  ASSERT_EQ(histogram, reopened_histogram);
+
+  // Not read at open without enable_adaptive_blob_size
+  options.enable_adaptive_blob_size = false;
+  Reopen(options);
+  ASSERT_OK(dbfull()->SetOptions({{"enable_adaptive_blob_size", "true"}}));
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kAdaptiveBlobSize,
+                               &reopened_histogram));
+  ASSERT_NE(histogram, reopened_histogram);
+}
+
 #endif  // ROCKSDB_LITE
 }  // namespace TERARKDB_NAMESPACE
 
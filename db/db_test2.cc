@@ -17,6 +17,7 @@
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/terark_namespace.h"
 #include "rocksdb/wal_filter.h"
+#include "trace_replay/block_cache_tracer.h"
 
 namespace TERARKDB_NAMESPACE {
 
@@ -455,6 +456,77 @@ TEST_F(DBTest2, SharedWriteBufferLimitAcrossDB) {
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBTest2, ColumnFamilyWriteBufferBudget) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  // Avoid undeterministic value by malloc_usable_size();
+  // Force arena block size to 1
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::Arena:0", [&](void* arg) {
+        size_t* block_size = static_cast<size_t*>(arg);
+        *block_size = 1;
+      });
+
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::AllocateNewBlock:0", [&](void* arg) {
+        std::pair<size_t*, size_t*>* pair =
+            static_cast<std::pair<size_t*, size_t*>*>(arg);
+        *std::get<0>(*pair) = *std::get<1>(*pair);
+      });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  options.write_buffer_size = 500000;  // this is never hit
+  options.write_buffer_flush_pri = kFlushMostEfficient;
+  std::shared_ptr<WriteBufferManager> db_budget(
+      new WriteBufferManager(400000));
+  options.write_buffer_manager = db_budget;
+  Reopen(options);
+
+  // A budget outside of the DB budget is rejected
+  Options cf_options = options;
+  cf_options.cf_write_buffer_manager.reset(
+      new WriteBufferManager(100000, std::make_shared<WriteBufferManager>(0),
+                             "orphan"));
+  ColumnFamilyHandle* handle = nullptr;
+  ASSERT_TRUE(
+      db_->CreateColumnFamily(cf_options, "cf1", &handle).IsInvalidArgument());
+
+  cf_options.cf_write_buffer_manager.reset(
+      new WriteBufferManager(100000, db_budget, "cf1"));
+  CreateColumnFamilies({"cf1"}, cf_options);
+  CreateColumnFamilies({"cf2"}, options);
+  ReopenWithColumnFamilies({"default", "cf1", "cf2"},
+                           {options, cf_options, options});
+
+  WriteOptions wo;
+  wo.disableWAL = true;
+  std::function<void()> wait_flush = [&]() {
+    dbfull()->TEST_WaitForFlushMemTable(handles_[0]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[1]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[2]);
+  };
+
+  // cf2 holds more memory, but only cf1 ran out of its budget
+  ASSERT_OK(Put(2, Key(1), DummyString(150000), wo));
+  ASSERT_OK(Put(1, Key(1), DummyString(90000), wo));
+  wait_flush();
+  ASSERT_OK(Put(2, Key(2), DummyString(1), wo));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf1"),
+            static_cast<uint64_t>(1));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf2"),
+            static_cast<uint64_t>(0));
+
+  std::string stats;
+  ASSERT_TRUE(dbfull()->GetProperty(
+      handles_[1], DB::Properties::kWriteBufferManagerStats, &stats));
+  ASSERT_NE(std::string::npos, stats.find("cf1: usage"));
+  ASSERT_NE(std::string::npos, stats.find("flushes 1"));
+
+  Close();
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 TEST_F(DBTest2, TestWriteBufferNoLimitWithCache) {
   Options options = CurrentOptions();
   options.arena_block_size = 4096;
@@ -2763,6 +2835,55 @@ TEST_F(DBTest2, TraceWithLimit) {
   ASSERT_OK(DestroyDB(dbname2, options));
 }
 
+TEST_F(DBTest2, BlockCacheTrace) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 20);
+  table_options.cache_index_and_filter_blocks = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("a", "1"));
+  ASSERT_OK(Put("b", "2"));
+  ASSERT_OK(Flush());
+
+  std::string trace_filename = dbname_ + "/block_cache.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, EnvOptions(), trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartBlockCacheTrace(TraceOptions(), std::move(trace_writer)));
+  ASSERT_EQ("1", Get("a"));
+  ASSERT_EQ("1", Get("a"));
+  ASSERT_OK(db_->EndBlockCacheTrace());
+  // Not traced as it is after EndBlockCacheTrace.
+  ASSERT_EQ("2", Get("b"));
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(
+      NewFileTraceReader(env_, EnvOptions(), trace_filename, &trace_reader));
+  BlockCacheTraceReader reader(std::move(trace_reader));
+  BlockCacheTraceHeader header;
+  ASSERT_OK(reader.ReadHeader(&header));
+  int num_index_accesses = 0;
+  int num_data_accesses = 0;
+  BlockCacheTraceRecord record;
+  while (reader.ReadAccess(&record).ok()) {
+    ASSERT_EQ(TableReaderCaller::kUserGet, record.caller);
+    if (record.block_type == TraceType::kBlockTraceIndexBlock) {
+      num_index_accesses++;
+    } else if (record.block_type == TraceType::kBlockTraceDataBlock) {
+      ASSERT_EQ("a", record.referenced_key);
+      ASSERT_EQ(Boolean::kTrue, record.referenced_key_exist_in_block);
+      if (num_data_accesses > 0) {
+        // The data block is in the block cache after the first Get.
+        ASSERT_EQ(Boolean::kTrue, record.is_cache_hit);
+      }
+      num_data_accesses++;
+    }
+  }
+  ASSERT_EQ(2, num_index_accesses);
+  ASSERT_EQ(2, num_data_accesses);
+}
+
 #endif  // ROCKSDB_LITE
 
 TEST_F(DBTest2, LazyBufferAndMmapReads) {
@@ -8,18 +8,58 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "db/db_test_util.h"
+#include "db/log_format.h"
+#include "db/write_batch_internal.h"
 #include "options/options_helper.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/terark_namespace.h"
+#include "rocksdb/wal_filter.h"
 #include "util/fault_injection_test_env.h"
 #include "util/sync_point.h"
 
 namespace TERARKDB_NAMESPACE {
+namespace {
+// The WAL stream picked for the writes of the calling thread
+thread_local size_t wal_stream_of_thread = 0;
+}  // namespace
+
 class DBWALTest : public DBTestBase {
  public:
   DBWALTest() : DBTestBase("/db_wal_test") {}
 
+  // Writes batches from num_threads threads, thread t logs to WAL stream
+  // t % wal_streams. Leaders wait a bit for followers so that the writes go
+  // in parallel groups even on a single core.
+  void WriteToWalStreams(int num_threads, int num_batches,
+                         std::function<void(int, int, WriteBatch*)> fill) {
+    size_t wal_streams = dbfull()->GetDBOptions().wal_streams;
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::WriteImpl:WalStream", [](void* arg) {
+          *reinterpret_cast<size_t*>(arg) = wal_stream_of_thread;
+        });
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::WriteImpl:BeforeLeaderEnters",
+        [](void* /*arg*/) { Env::Default()->SleepForMicroseconds(100); });
+    SyncPoint::GetInstance()->EnableProcessing();
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        wal_stream_of_thread = t % wal_streams;
+        for (int i = 0; i < num_batches; ++i) {
+          WriteBatch batch;
+          fill(t, i, &batch);
+          ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+  }
+
 #if defined(ROCKSDB_PLATFORM_POSIX)
   uint64_t GetAllocatedFileSize(std::string file_name) {
     struct stat sbuf;
@@ -1225,6 +1265,261 @@ TEST_F(DBWALTest, RecoverWithoutFlush) {
   ASSERT_EQ(Get("bar"), "bar_v3");
 }
 
+TEST_F(DBWALTest, RecoverWalStreams) {
+  const int kNumThreads = 8;
+  const int kNumKeys = 500;
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.avoid_flush_during_recovery = true;
+  options.write_buffer_size = 64 * 1024 * 1024;
+  options.allow_concurrent_memtable_write = true;
+  options.wal_streams = 4;
+  Reopen(options);
+  ASSERT_EQ(4U, dbfull()->GetDBOptions().wal_streams);
+
+  WriteToWalStreams(kNumThreads, kNumKeys, [](int t, int i, WriteBatch* batch) {
+    batch->Put("key" + ToString(t) + "_" + ToString(i), ToString(i));
+    batch->Put("shared" + ToString(i % 10), ToString(t));
+  });
+  ASSERT_OK(Put("foo", "v1"));
+  WriteOptions no_wal;
+  no_wal.disableWAL = true;
+  ASSERT_TRUE(dbfull()->Put(no_wal, "bar", "v1").IsNotSupported());
+
+  std::vector<std::string> shared;
+  for (int i = 0; i < 10; ++i) {
+    shared.push_back(Get("shared" + ToString(i)));
+  }
+  SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+  uint64_t log_number = dbfull()->TEST_LogfileNumber();
+  Close();
+  // Every stream got records of its own
+  for (size_t i = 1; i < 4; ++i) {
+    uint64_t stream_size = 0;
+    ASSERT_OK(env_->GetFileSize(LogStreamFileName(dbname_, log_number, i),
+                                &stream_size));
+    ASSERT_GT(stream_size, 0);
+  }
+
+  Reopen(options);
+  ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_EQ(ToString(i), Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(shared[i], Get("shared" + ToString(i)));
+  }
+  ASSERT_EQ("v1", Get("foo"));
+}
+
+TEST_F(DBWALTest, RecoverTruncatedWalStream) {
+  const int kNumThreads = 4;
+  const int kNumKeys = 1000;
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.avoid_flush_during_recovery = true;
+  options.write_buffer_size = 64 * 1024 * 1024;
+  options.allow_concurrent_memtable_write = true;
+  options.wal_streams = 2;
+  options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+  DestroyAndReopen(options);
+
+  WriteToWalStreams(kNumThreads, kNumKeys, [](int t, int i, WriteBatch* batch) {
+    batch->Put("key" + ToString(t) + "_" + ToString(i), ToString(i));
+  });
+  uint64_t log_number = dbfull()->TEST_LogfileNumber();
+  Close();
+
+  // Lose the second half of the records of stream 1, as a crash may do
+  std::string stream_fname = LogStreamFileName(dbname_, log_number, 1);
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env_, stream_fname, &contents));
+  std::vector<size_t> record_ends;
+  for (size_t pos = 0; pos + log::kHeaderSize <= contents.size();) {
+    size_t block_left = log::kBlockSize - pos % log::kBlockSize;
+    if (block_left < static_cast<size_t>(log::kHeaderSize)) {
+      pos += block_left;
+      continue;
+    }
+    size_t length = static_cast<uint8_t>(contents[pos + 4]) |
+                    (static_cast<uint8_t>(contents[pos + 5]) << 8);
+    char type = contents[pos + 6];
+    pos += log::kHeaderSize + length;
+    if (type == log::kFullType || type == log::kLastType) {
+      record_ends.push_back(pos);
+    }
+  }
+  ASSERT_GT(record_ends.size(), 1);
+  contents.resize(record_ends[record_ends.size() / 2 - 1]);
+  ASSERT_OK(WriteStringToFile(env_, contents, stream_fname));
+
+  // Recovery stops at the first lost sequence, the later records of stream 0
+  // are dropped with it
+  Reopen(options);
+  SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+  ASSERT_LT(last_sequence, kNumThreads * kNumKeys);
+  int num_keys = 0;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ++num_keys;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(last_sequence, num_keys);
+}
+
+TEST_F(DBWALTest, RecoverWalStreamsAfterIngestion) {
+  const int kNumThreads = 4;
+  const int kNumKeys = 200;
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.avoid_flush_during_recovery = true;
+  options.write_buffer_size = 64 * 1024 * 1024;
+  options.allow_concurrent_memtable_write = true;
+  options.wal_streams = 2;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("ingested", "v1"));
+  ASSERT_OK(Flush());
+  auto fill = [](int round) {
+    return [round](int t, int i, WriteBatch* batch) {
+      batch->Put("key" + ToString(t) + "_" + ToString(i), ToString(round));
+    };
+  };
+  WriteToWalStreams(kNumThreads, kNumKeys, fill(0));
+  uint64_t log_number = dbfull()->TEST_LogfileNumber();
+
+  // Overlapping the flushed key only, the ingested file gets a global
+  // sequence without a memtable flush
+  std::string file = dbname_ + "/ingested.sst";
+  SstFileWriter writer(EnvOptions(), options);
+  ASSERT_OK(writer.Open(file));
+  ASSERT_OK(writer.Put("ingested", "v2"));
+  ASSERT_OK(writer.Finish());
+  ASSERT_OK(db_->IngestExternalFile({file}, IngestExternalFileOptions()));
+  ASSERT_GT(dbfull()->TEST_LogfileNumber(), log_number);
+
+  WriteToWalStreams(kNumThreads, kNumKeys, fill(1));
+  SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+
+  Reopen(options);
+  ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+  ASSERT_EQ("v2", Get("ingested"));
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_EQ("1", Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+}
+
+TEST_F(DBWALTest, RecoverLargeWal) {
+  const int kNumBatches = 2000;
+  const int kBatchSize = 8;
+  // Replay on the opening thread, with a prefetch thread only and with
+  // concurrent inserts
+  for (size_t recovery_threads : {0, 1, 4}) {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    options.disable_auto_compactions = true;
+    options.allow_concurrent_memtable_write = true;
+    options.wal_recovery_threads = recovery_threads;
+    options.merge_operator = MergeOperators::CreateStringAppendOperator();
+    // Keep everything in the WAL while writing
+    options.write_buffer_size = 64 * 1024 * 1024;
+    DestroyAndReopen(options);
+    CreateAndReopenWithCF({"pikachu"}, options);
+
+    Random rnd(301);
+    std::map<std::string, std::string> expected[2];
+    for (int i = 0; i < kNumBatches; ++i) {
+      WriteBatch batch;
+      for (int j = 0; j < kBatchSize; ++j) {
+        int cf = (i + j) % 2;
+        std::string key = Key(i * kBatchSize + j);
+        std::string value = RandomString(&rnd, 200);
+        ASSERT_OK(batch.Put(handles_[cf], key, value));
+        expected[cf][key] = value;
+      }
+      if (i % 100 == 0) {
+        // A merge makes the batch be replayed by itself
+        std::string key = "merge" + ToString(i % 300);
+        ASSERT_OK(batch.Merge(handles_[1], key, ToString(i)));
+        auto& value = expected[1][key];
+        value = value.empty() ? ToString(i) : value + "," + ToString(i);
+      }
+      ASSERT_OK(db_->Write(WriteOptions(), &batch));
+    }
+    SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+    ASSERT_EQ(0, NumTableFilesAtLevel(0, 0));
+    ASSERT_EQ(0, NumTableFilesAtLevel(0, 1));
+
+    // Memtables fill up several times while replaying
+    options.write_buffer_size = 256 * 1024;
+    ReopenWithColumnFamilies({"default", "pikachu"}, options);
+    ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+    ASSERT_GT(NumTableFilesAtLevel(0, 0), 1);
+    ASSERT_GT(NumTableFilesAtLevel(0, 1), 1);
+    for (int cf = 0; cf < 2; ++cf) {
+      for (auto& kv : expected[cf]) {
+        ASSERT_EQ(kv.second, Get(cf, kv.first));
+      }
+    }
+  }
+}
+
+TEST_F(DBWALTest, RecoverConcurrentStopsAtCorruptedBatch) {
+  // Replaces the batch at one sequence with a batch that fails to parse
+  class CorruptBatchFilter : public WalFilter {
+   public:
+    explicit CorruptBatchFilter(SequenceNumber sequence)
+        : sequence_(sequence) {}
+
+    WalProcessingOption LogRecord(const WriteBatch& batch,
+                                  WriteBatch* new_batch,
+                                  bool* batch_changed) const override {
+      if (WriteBatchInternal::Sequence(&batch) == sequence_) {
+        std::string rep = batch.Data().substr(0, WriteBatchInternal::kHeader);
+        rep.push_back(static_cast<char>(0x7f));  // unknown tag
+        WriteBatchInternal::SetContents(new_batch, rep);
+        *batch_changed = true;
+      }
+      return WalProcessingOption::kContinueProcessing;
+    }
+
+    const char* Name() const override { return "CorruptBatchFilter"; }
+
+   private:
+    SequenceNumber sequence_;
+  };
+
+  const int kNumKeys = 200;
+  const SequenceNumber kCorruptedSequence = 50;
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.allow_concurrent_memtable_write = true;
+  options.wal_recovery_threads = 4;
+  options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+  DestroyAndReopen(options);
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+  }
+  ASSERT_EQ(SequenceNumber(kNumKeys), dbfull()->GetLatestSequenceNumber());
+
+  CorruptBatchFilter filter(kCorruptedSequence);
+  options.wal_filter = &filter;
+  Reopen(options);
+  // The batches behind the corrupted one share its insert group, none of
+  // them may be recovered
+  ASSERT_EQ(kCorruptedSequence - 1, dbfull()->GetLatestSequenceNumber());
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(SequenceNumber(i + 1) < kCorruptedSequence
+                  ? "v" + ToString(i)
+                  : "NOT_FOUND",
+              Get(Key(i)));
+  }
+}
+
 TEST_F(DBWALTest, RecoverWithoutFlushMultipleCF) {
   const std::string kSmallValue = "v";
   const std::string kLargeValue = DummyString(1024);
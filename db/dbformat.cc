@@ -198,18 +198,55 @@ void IterKey::EnlargeBuffer(size_t key_size) {
   buf_size_ = key_size;
 }
 
+constexpr uint64_t SeparateHelper::kNoLocation;
+constexpr uint64_t SeparateHelper::kLocationFlag;
+
+uint64_t SeparateHelper::DecodeLocation(const Slice& slice) {
+  uint64_t location;
+  if ((DecodeRawFileNumber(slice) & kLocationFlag) == 0 ||
+      GetVarint64Ptr(slice.data() + sizeof(uint64_t),
+                     slice.data() + slice.size(), &location) == nullptr) {
+    return kNoLocation;
+  }
+  return location;
+}
+
+Slice SeparateHelper::DecodeValueMeta(const Slice& slice) {
+  assert(slice.size() >= sizeof(uint64_t));
+  Slice meta(slice.data() + sizeof(uint64_t), slice.size() - sizeof(uint64_t));
+  if ((DecodeRawFileNumber(slice) & kLocationFlag) != 0) {
+    uint64_t location;
+    if (!GetVarint64(&meta, &location)) {
+      return Slice();
+    }
+  }
+  return meta;
+}
+
 Status SeparateHelper::TransToSeparate(
     const Slice& internal_key, LazyBuffer& value, uint64_t file_number,
     const Slice& meta, bool is_merge, bool is_index,
-    const ValueExtractor* value_meta_extractor) {
+    const ValueExtractor* value_meta_extractor, uint64_t location) {
   assert(file_number != uint64_t(-1));
+  assert((file_number & kLocationFlag) == 0);
+  char location_buf[kMaxVarint64Length];
+  Slice location_slice;
+  if (location != kNoLocation) {
+    file_number |= kLocationFlag;
+    char* end = EncodeVarint64(location_buf, location);
+    location_slice = Slice(location_buf, end - location_buf);
+  }
+  uint64_t encoded_file_number = file_number;
+  file_number &= ~kLocationFlag;
   if (value_meta_extractor == nullptr || is_merge) {
-    value.reset(EncodeFileNumber(file_number), true, file_number);
+    Slice parts[] = {EncodeFileNumber(encoded_file_number), location_slice};
+    value.reset(SliceParts(parts, 2), file_number);
     return Status::OK();
   }
   if (is_index) {
-    Slice parts[] = {EncodeFileNumber(file_number), meta};
-    value.reset(SliceParts(parts, 2), file_number);
+    Slice parts[] = {EncodeFileNumber(encoded_file_number), location_slice,
+                     meta};
+    value.reset(SliceParts(parts, 3), file_number);
     return Status::OK();
   } else {
     auto s = value.fetch();
@@ -220,8 +257,9 @@ Status SeparateHelper::TransToSeparate(
     s = value_meta_extractor->Extract(ExtractUserKey(internal_key),
                                       value.slice(), &value_meta);
     if (s.ok()) {
-      Slice parts[] = {EncodeFileNumber(file_number), value_meta};
-      value.reset(SliceParts(parts, 2), file_number);
+      Slice parts[] = {EncodeFileNumber(encoded_file_number), location_slice,
+                       value_meta};
+      value.reset(SliceParts(parts, 3), file_number);
     }
     return s;
   }
@@ -665,12 +665,15 @@ struct MapSstElement {
     uint64_t size;
   };
   std::vector<LinkTarget> link;
+  // Full filter of the user keys all links hold in this range, empty if none
+  Slice filter;
   enum Flags : uint64_t {
     kEmpty = 0,
     kIncludeSmallest = 1ULL << 0,
     kIncludeLargest = 1ULL << 1,
     kHasDeleteRange = 1ULL << 2,
     kMarkedForCompaction = 1ULL << 3,
+    kHasFilter = 1ULL << 4,
   };
 
   MapSstElement() : union_flags(0) {}
@@ -678,6 +681,7 @@ struct MapSstElement {
   bool Decode(Slice ikey, Slice value) {
     link.clear();
     smallest_key.clear();
+    filter.clear();
     largest_key = ikey;
     uint64_t flags;
     uint64_t link_count;
@@ -703,6 +707,9 @@ struct MapSstElement {
         return false;
       }
     }
+    if ((flags & kHasFilter) != 0 && !GetLengthPrefixedSlice(&value, &filter)) {
+      return false;
+    }
     return value.empty();
   }
 
@@ -713,7 +720,8 @@ struct MapSstElement {
     uint64_t flags = (include_smallest ? kIncludeSmallest : kEmpty) |
                      (include_largest ? kIncludeLargest : kEmpty) |
                      (has_delete_range ? kHasDeleteRange : kEmpty) |
-                     (marked_for_compaction ? kMarkedForCompaction : kEmpty);
+                     (marked_for_compaction ? kMarkedForCompaction : kEmpty) |
+                     (filter.empty() ? kEmpty : kHasFilter);
     PutVarint64Varint64(buffer, flags, link.size());
     PutLengthPrefixedSlice(buffer, smallest_key);
     for (auto& l : link) {
@@ -722,6 +730,9 @@ struct MapSstElement {
     for (auto& l : link) {
       PutVarint64(buffer, l.size);
     }
+    if (!filter.empty()) {
+      PutLengthPrefixedSlice(buffer, filter);
+    }
     return Slice(*buffer);
   }
 
@@ -788,13 +799,21 @@ class SeparateHelper {
  public:
   virtual ~SeparateHelper() = default;
 
+  // A value index is the fixed64 file number of the value sst, optionally
+  // followed by a varint64 location of the value inside that sst, and then
+  // the value meta. The high bit of the file number marks the location.
+  // The location comes from TableBuilder::LastEntryLocation() and is only
+  // meaningful to the reader of that very sst.
+  static constexpr uint64_t kNoLocation = uint64_t(-1);
+  static constexpr uint64_t kLocationFlag = 1ull << 63;
+
   static Slice EncodeFileNumber(uint64_t& file_number) {
     if (!port::kLittleEndian) {
       file_number = EndianTransform(file_number, sizeof file_number);
     }
     return Slice(reinterpret_cast<char*>(&file_number), sizeof file_number);
   }
-  static uint64_t DecodeFileNumber(const Slice& slice) {
+  static uint64_t DecodeRawFileNumber(const Slice& slice) {
     assert(slice.size() >= sizeof(uint64_t));
     uint64_t file_number;
     memcpy(&file_number, slice.data(), sizeof(uint64_t));
@@ -803,23 +822,24 @@ class SeparateHelper {
     }
     return file_number;
   }
-  static Slice DecodeValueMeta(const Slice& slice) {
-    assert(slice.size() >= sizeof(uint64_t));
-    return Slice(slice.data() + sizeof(uint64_t),
-                 slice.size() - sizeof(uint64_t));
+  static uint64_t DecodeFileNumber(const Slice& slice) {
+    return DecodeRawFileNumber(slice) & ~kLocationFlag;
   }
+  static uint64_t DecodeLocation(const Slice& slice);
+  static Slice DecodeValueMeta(const Slice& slice);
 
   static Status TransToSeparate(const Slice& internal_key, LazyBuffer& value,
                                 uint64_t file_number, const Slice& meta,
                                 bool is_merge, bool is_index,
-                                const ValueExtractor* value_meta_extractor);
+                                const ValueExtractor* value_meta_extractor,
+                                uint64_t location = kNoLocation);
 
   virtual Status TransToSeparate(const Slice& internal_key, LazyBuffer& value,
                                  const Slice& meta, bool is_merge,
-                                 bool is_index) {
+                                 bool is_index, uint64_t location) {
     assert(value.file_number() != uint64_t(-1));
     return TransToSeparate(internal_key, value, value.file_number(), meta,
-                           is_merge, is_index, nullptr);
+                           is_merge, is_index, nullptr, location);
   }
 
   virtual Status TransToSeparate(const Slice& /*internal_key*/,
@@ -829,6 +849,14 @@ class SeparateHelper {
 
   virtual LazyBuffer TransToCombined(const Slice& user_key, uint64_t sequence,
                                      const LazyBuffer& value) const = 0;
+
+  // Create a helper which reads the separated values of a scan through
+  // read-ahead iterators of the value files. The helper must not outlive
+  // this. Return nullptr if not supported
+  virtual SeparateHelper* NewScanHelper(
+      const ReadOptions& /*read_options*/) const {
+    return nullptr;
+  }
 };
 
 extern Slice ArenaPinSlice(const Slice& slice, Arena* arena);
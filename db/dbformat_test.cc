@@ -10,6 +10,7 @@
 #include "db/dbformat.h"
 
 #include "rocksdb/terark_namespace.h"
+#include "rocksdb/value_extractor.h"
 #include "util/logging.h"
 #include "util/testharness.h"
 
@@ -202,6 +203,43 @@ TEST_F(FormatTest, RangeTombstoneSerializeEndKey) {
   ASSERT_LT(cmp.Compare(t.SerializeEndKey(), k), 0);
 }
 
+TEST_F(FormatTest, ValueIndexLocation) {
+  struct PrefixExtractor : public ValueExtractor {
+    Status Extract(const Slice& /*key*/, const Slice& value,
+                   std::string* output) const override {
+      output->assign(value.data(), 2);
+      return Status::OK();
+    }
+  } extractor;
+  std::string ikey;
+  AppendInternalKey(&ikey, ParsedInternalKey("key", 100U, kTypeValue));
+  LazyBuffer value("value");
+  ASSERT_OK(SeparateHelper::TransToSeparate(ikey, value, 123, Slice(), false,
+                                            false, nullptr));
+  ASSERT_EQ(sizeof(uint64_t), value.size());
+  ASSERT_EQ(123U, SeparateHelper::DecodeFileNumber(value.slice()));
+  ASSERT_EQ(SeparateHelper::kNoLocation,
+            SeparateHelper::DecodeLocation(value.slice()));
+  ASSERT_EQ("", SeparateHelper::DecodeValueMeta(value.slice()).ToString());
+
+  for (uint64_t location : {uint64_t(0), uint64_t(300), uint64_t(1) << 40}) {
+    LazyBuffer index("value");
+    ASSERT_OK(SeparateHelper::TransToSeparate(ikey, index, 123, Slice(), false,
+                                              false, &extractor, location));
+    ASSERT_EQ(123U, index.file_number());
+    ASSERT_EQ(123U, SeparateHelper::DecodeFileNumber(index.slice()));
+    ASSERT_EQ(location, SeparateHelper::DecodeLocation(index.slice()));
+    ASSERT_EQ("va", SeparateHelper::DecodeValueMeta(index.slice()).ToString());
+
+    // Passing the index through keeps the meta
+    LazyBuffer copy("index");
+    ASSERT_OK(SeparateHelper::TransToSeparate(
+        ikey, copy, 123, SeparateHelper::DecodeValueMeta(index.slice()), false,
+        true, &extractor, location));
+    ASSERT_EQ(index.slice(), copy.slice());
+  }
+}
+
 }  // namespace TERARKDB_NAMESPACE
 
 int main(int argc, char** argv) {
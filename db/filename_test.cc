@@ -38,6 +38,7 @@ TEST_F(FileNameTest, Parse) {
   } cases[] = {
       {"100.log", 100, kLogFile, kAllMode},
       {"0.log", 0, kLogFile, kAllMode},
+      {"100.log.3", 100, kWalStreamFile, kAllMode},
       {"0.sst", 0, kTableFile, kAllMode},
       {"CURRENT", 0, kCurrentFile, kAllMode},
       {"LOCK", 0, kDBLockFile, kAllMode},
@@ -97,7 +98,10 @@ TEST_F(FileNameTest, Parse) {
                                  "184467440737095516150.log",
                                  "100",
                                  "100.",
-                                 "100.lop"};
+                                 "100.lop",
+                                 "100.log.",
+                                 "100.log.0",
+                                 "100.log.2x"};
   for (unsigned int i = 0; i < sizeof(errors) / sizeof(errors[0]); i++) {
     std::string f = errors[i];
     ASSERT_TRUE(!ParseFileName(f, &number, &type)) << f;
@@ -143,6 +147,12 @@ TEST_F(FileNameTest, Construction) {
   ASSERT_EQ(192U, number);
   ASSERT_EQ(kLogFile, type);
 
+  fname = LogStreamFileName("foo", 192, 2);
+  ASSERT_EQ("foo/", std::string(fname.data(), 4));
+  ASSERT_TRUE(ParseFileName(fname.c_str() + 4, &number, &type));
+  ASSERT_EQ(192U, number);
+  ASSERT_EQ(kWalStreamFile, type);
+
   fname = TableFileName({DbPath("bar", 0)}, 200, 0);
   std::string fname1 =
       TableFileName({DbPath("foo", 0), DbPath("bar", 0)}, 200, 1);
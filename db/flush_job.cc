@@ -16,6 +16,10 @@
 #include <inttypes.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
 #include <vector>
 
 #include "db/builder.h"
@@ -57,6 +61,136 @@
 
 namespace TERARKDB_NAMESPACE {
 
+namespace {
+
+// Restricts the flush input to user keys in [start, end), nullptr for
+// unbounded. Takes the ownership of the arena allocated input iterator.
+class FlushPartitionIterator : public InternalIterator {
+ public:
+  FlushPartitionIterator(InternalIterator* iter, const Comparator* ucmp,
+                         const Slice* start, const Slice* end)
+      : iter_(iter), ucmp_(ucmp), start_(start), end_(end), valid_(false) {}
+
+  ~FlushPartitionIterator() override { iter_->~InternalIterator(); }
+
+  bool Valid() const override { return valid_; }
+  void SeekToFirst() override {
+    if (start_ == nullptr) {
+      iter_->SeekToFirst();
+    } else {
+      SeekUserKey(*start_);
+    }
+    Update();
+  }
+  void SeekToLast() override {
+    if (end_ == nullptr) {
+      iter_->SeekToLast();
+    } else {
+      SeekUserKey(*end_);
+      if (iter_->Valid()) {
+        iter_->Prev();
+      } else {
+        iter_->SeekToLast();
+      }
+    }
+    Update();
+  }
+  void Seek(const Slice& target) override {
+    if (start_ != nullptr &&
+        ucmp_->Compare(ExtractUserKey(target), *start_) < 0) {
+      SeekUserKey(*start_);
+    } else {
+      iter_->Seek(target);
+    }
+    Update();
+  }
+  void SeekForPrev(const Slice& target) override {
+    if (end_ != nullptr && ucmp_->Compare(ExtractUserKey(target), *end_) >= 0) {
+      SeekToLast();
+      return;
+    }
+    iter_->SeekForPrev(target);
+    Update();
+  }
+  void Next() override {
+    iter_->Next();
+    Update();
+  }
+  void Prev() override {
+    iter_->Prev();
+    Update();
+  }
+  Slice key() const override { return iter_->key(); }
+  LazyBuffer value() const override { return iter_->value(); }
+  Status status() const override { return iter_->status(); }
+
+ private:
+  void SeekUserKey(const Slice& user_key) {
+    InternalKey ikey;
+    ikey.SetMinPossibleForUserKey(user_key);
+    iter_->Seek(ikey.Encode());
+  }
+
+  void Update() {
+    valid_ = iter_->Valid();
+    if (valid_) {
+      Slice user_key = ExtractUserKey(iter_->key());
+      valid_ = (start_ == nullptr || ucmp_->Compare(user_key, *start_) >= 0) &&
+               (end_ == nullptr || ucmp_->Compare(user_key, *end_) < 0);
+    }
+  }
+
+  InternalIterator* iter_;
+  const Comparator* ucmp_;
+  const Slice* start_;
+  const Slice* end_;
+  bool valid_;
+};
+
+// Picks at most n - 1 user keys splitting the input into ranges of roughly
+// equal number of entries. All versions of a user key fall into one range.
+Status PickFlushPartitionBoundaries(InternalIterator* iter,
+                                    const Comparator* ucmp,
+                                    uint64_t num_entries, size_t n,
+                                    std::vector<std::string>* boundaries) {
+  uint64_t step = num_entries / n;
+  if (step == 0) {
+    return Status::OK();
+  }
+  uint64_t count = 0;
+  for (iter->SeekToFirst(); iter->Valid() && boundaries->size() + 1 < n;
+       iter->Next()) {
+    if (count++ < step * (boundaries->size() + 1)) {
+      continue;
+    }
+    Slice user_key = ExtractUserKey(iter->key());
+    if (boundaries->empty() || ucmp->Compare(user_key, boundaries->back()) > 0) {
+      boundaries->emplace_back(user_key.data(), user_key.size());
+    }
+  }
+  return iter->status();
+}
+
+// A helper of a partitioned flush, run by the flush thread pool. The helpers
+// and the flush thread take partitions from the same counter, so the flush
+// finishes even if no helper gets a thread.
+struct FlushPartitionHelperArg {
+  std::function<void()>* build_partitions;
+  std::promise<void> finished;
+};
+
+void BGWorkFlushPartition(void* arg) {
+  auto helper = static_cast<FlushPartitionHelperArg*>(arg);
+  (*helper->build_partitions)();
+  helper->finished.set_value();
+}
+
+void UnscheduleFlushPartition(void* arg) {
+  static_cast<FlushPartitionHelperArg*>(arg)->finished.set_value();
+}
+
+}  // namespace
+
 const char* GetFlushReasonString(FlushReason flush_reason) {
   switch (flush_reason) {
     case FlushReason::kOthers:
@@ -307,6 +441,7 @@ Status FlushJob::WriteLevel0Table() {
   db_mutex_->AssertHeld();
   const uint64_t start_micros = db_options_.env->NowMicros();
   Status s;
+  size_t num_level0_outputs = 1;
   {
     auto write_hint = cfd_->CalculateSSTWriteHint(0);
     db_mutex_->Unlock();
@@ -392,21 +527,161 @@ Status FlushJob::WriteLevel0Table() {
         }
         return range_del_iters;
       };
-      s = BuildTable(
-          dbname_, versions_, db_options_.env, *cfd_->ioptions(),
-          mutable_cf_options_, env_options_, cfd_->table_cache(),
-          c_style_callback(get_arena_input_iter), &get_arena_input_iter,
-          c_style_callback(get_range_del_iters), &get_range_del_iters, &meta_,
-          cfd_->internal_comparator(),
-          cfd_->int_tbl_prop_collector_factories(mutable_cf_options_),
-          cfd_->int_tbl_prop_collector_factories_for_blob(mutable_cf_options_),
-          cfd_->GetID(), cfd_->GetName(), existing_snapshots_,
-          earliest_write_conflict_snapshot_, snapshot_checker_,
-          output_compression_, cfd_->ioptions()->compression_opts,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          TableFileCreationReason::kFlush, event_logger_, job_context_->job_id,
-          Env::IO_HIGH, &table_properties_, 0 /* level */, flush_load_,
-          current_time, oldest_key_time, write_hint);
+      auto& ucmp = *cfd_->user_comparator();
+      std::vector<std::string> boundaries;
+      size_t max_partitions = mutable_cf_options_.max_flush_partitions;
+      if (max_partitions > 1 && get_range_del_iters().empty()) {
+        // Range tombstones would stretch every partition over their range
+        Arena sample_arena;
+        ScopedArenaIterator sample_iter(get_arena_input_iter(sample_arena));
+        s = PickFlushPartitionBoundaries(sample_iter.get(), &ucmp,
+                                         total_num_entries, max_partitions,
+                                         &boundaries);
+        if (!s.ok()) {
+          boundaries.clear();
+          s = Status::OK();
+        }
+      }
+
+      struct FlushPartition {
+        Slice start, end;
+        std::vector<FileMetaData> meta;
+        std::vector<TableProperties> table_properties;
+        uint64_t bytes_written = 0;
+        bool on_flush_thread = true;
+        Status status;
+      };
+      std::vector<FlushPartition> partitions(boundaries.size() + 1);
+      for (size_t i = 0; i < partitions.size(); ++i) {
+        auto& partition = partitions[i];
+        if (i > 0) {
+          partition.start = boundaries[i - 1];
+        }
+        if (i < boundaries.size()) {
+          partition.end = boundaries[i];
+        }
+        if (i == 0) {
+          partition.meta = std::move(meta_);
+        } else {
+          partition.meta.emplace_back();
+          partition.meta.front().fd =
+              FileDescriptor(versions_->NewFileNumber(), 0, 0);
+        }
+      }
+      meta_.clear();
+      if (partitions.size() > 1) {
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Level-0 flush split into %zd partitions",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       partitions.size());
+      }
+
+      const std::thread::id flush_thread_id = std::this_thread::get_id();
+      auto build_partition = [&](size_t i) {
+        auto& partition = partitions[i];
+        uint64_t bytes_written_before = IOSTATS(bytes_written);
+        const Slice* start = i > 0 ? &partition.start : nullptr;
+        const Slice* end = i + 1 < partitions.size() ? &partition.end : nullptr;
+        auto get_partition_input_iter = [&](Arena& arena) {
+          InternalIterator* input = get_arena_input_iter(arena);
+          if (start == nullptr && end == nullptr) {
+            return input;
+          }
+          return static_cast<InternalIterator*>(
+              new (arena.AllocateAligned(sizeof(FlushPartitionIterator)))
+                  FlushPartitionIterator(input, &ucmp, start, end));
+        };
+        partition.status = BuildTable(
+            dbname_, versions_, db_options_.env, *cfd_->ioptions(),
+            mutable_cf_options_, env_options_, cfd_->table_cache(),
+            c_style_callback(get_partition_input_iter),
+            &get_partition_input_iter, c_style_callback(get_range_del_iters),
+            &get_range_del_iters, &partition.meta, cfd_->internal_comparator(),
+            cfd_->int_tbl_prop_collector_factories(mutable_cf_options_),
+            cfd_->int_tbl_prop_collector_factories_for_blob(
+                mutable_cf_options_),
+            cfd_->GetID(), cfd_->GetName(), existing_snapshots_,
+            earliest_write_conflict_snapshot_, snapshot_checker_,
+            output_compression_, cfd_->ioptions()->compression_opts,
+            mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
+            TableFileCreationReason::kFlush, event_logger_,
+            job_context_->job_id, Env::IO_HIGH, &partition.table_properties,
+            0 /* level */, flush_load_, current_time, oldest_key_time,
+            write_hint);
+        partition.bytes_written =
+            IOSTATS(bytes_written) - bytes_written_before;
+        partition.on_flush_thread =
+            std::this_thread::get_id() == flush_thread_id;
+      };
+      std::atomic<size_t> next_partition(0);
+      std::function<void()> build_partitions = [&] {
+        size_t i;
+        while ((i = next_partition.fetch_add(1)) < partitions.size()) {
+          build_partition(i);
+        }
+      };
+      // Helpers which haven't got a thread when the flush thread runs out of
+      // partitions are taken back from the queue
+      std::vector<FlushPartitionHelperArg> helpers(partitions.size() - 1);
+      std::vector<std::future<void>> helpers_finished;
+      for (auto& helper : helpers) {
+        helper.build_partitions = &build_partitions;
+        helpers_finished.emplace_back(helper.finished.get_future());
+        db_options_.env->Schedule(&BGWorkFlushPartition, &helper,
+                                  Env::Priority::HIGH, this,
+                                  &UnscheduleFlushPartition);
+      }
+      build_partitions();
+      if (!helpers.empty()) {
+        db_options_.env->UnSchedule(this, Env::Priority::HIGH);
+      }
+      for (auto& finished : helpers_finished) {
+        finished.wait();
+      }
+
+      // Level 0 outputs go first, then blobs of all partitions
+      for (auto& partition : partitions) {
+        if (!partition.on_flush_thread) {
+          IOSTATS_ADD(bytes_written, partition.bytes_written);
+        }
+        if (s.ok()) {
+          s = partition.status;
+        }
+        if (partition.meta.front().fd.GetFileSize() > 0) {
+          meta_.emplace_back(partition.meta.front());
+          table_properties_.emplace_back(partition.table_properties.front());
+        }
+      }
+      num_level0_outputs = meta_.size();
+      if (num_level0_outputs == 0) {
+        meta_.emplace_back(partitions.front().meta.front());
+        table_properties_.emplace_back(
+            partitions.front().table_properties.front());
+      }
+      for (auto& partition : partitions) {
+        if (partition.meta.front().fd.GetFileSize() == 0) {
+          continue;
+        }
+        for (size_t i = 1; i < partition.meta.size(); ++i) {
+          meta_.emplace_back(std::move(partition.meta[i]));
+          table_properties_.emplace_back(
+              std::move(partition.table_properties[i]));
+        }
+      }
+      if (num_level0_outputs > 1) {
+        // Partitions take the seqno range of the whole flush, so they stay
+        // together in level 0 order
+        SequenceNumber smallest_seqno = kMaxSequenceNumber;
+        SequenceNumber largest_seqno = 0;
+        for (size_t i = 0; i < num_level0_outputs; ++i) {
+          smallest_seqno = std::min(smallest_seqno, meta_[i].fd.smallest_seqno);
+          largest_seqno = std::max(largest_seqno, meta_[i].fd.largest_seqno);
+        }
+        for (size_t i = 0; i < num_level0_outputs; ++i) {
+          meta_[i].fd.smallest_seqno = smallest_seqno;
+          meta_[i].fd.largest_seqno = largest_seqno;
+        }
+      }
       if (s.ok() && cfd_->ioptions()->ttl_extractor_factory != nullptr) {
         ROCKS_LOG_INFO(db_options_.info_log,
                        "FlushOutput earliest_time_begin_compact = %" PRIu64
@@ -443,11 +718,15 @@ Status FlushJob::WriteLevel0Table() {
     // Add file to L0
     for (size_t i = 0; i < meta_.size(); ++i) {
       auto& f = meta_[i];
-      edit_->AddFile(i == 0 ? 0 : -1, f.fd.GetNumber(), f.fd.GetPathId(),
+      edit_->AddFile(i < num_level0_outputs ? 0 : -1, f.fd.GetNumber(),
+                     f.fd.GetPathId(),
                      f.fd.GetFileSize(), f.smallest, f.largest,
                      f.fd.smallest_seqno, f.fd.largest_seqno,
                      f.marked_for_compaction, f.prop);
     }
+    for (auto& prop : table_properties_) {
+      cfd_->UpdateValueSizeHistogram(prop);
+    }
   }
 
   // Note that here we treat flush as level 0 compaction in internal stats
@@ -232,6 +232,7 @@ static const std::string num_live_versions = "num-live-versions";
 static const std::string current_version_number =
     "current-super-version-number";
 static const std::string estimate_live_data_size = "estimate-live-data-size";
+static const std::string num_inheritance_entries = "num-inheritance-entries";
 static const std::string min_log_number_to_keep_str = "min-log-number-to-keep";
 static const std::string min_obsolete_sst_number_to_keep_str =
     "min-obsolete-sst-number-to-keep";
@@ -253,6 +254,9 @@ static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
 static const std::string options_statistics = "options-statistics";
+static const std::string adaptive_blob_size = "adaptive-blob-size";
+static const std::string write_buffer_manager_stats =
+    "write-buffer-manager-stats";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -311,6 +315,8 @@ const std::string DB::Properties::kCurrentSuperVersionNumber =
     rocksdb_prefix + current_version_number;
 const std::string DB::Properties::kEstimateLiveDataSize =
     rocksdb_prefix + estimate_live_data_size;
+const std::string DB::Properties::kNumInheritanceEntries =
+    rocksdb_prefix + num_inheritance_entries;
 const std::string DB::Properties::kMinLogNumberToKeep =
     rocksdb_prefix + min_log_number_to_keep_str;
 const std::string DB::Properties::kMinObsoleteSstNumberToKeep =
@@ -338,6 +344,10 @@ const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
+const std::string DB::Properties::kAdaptiveBlobSize =
+    rocksdb_prefix + adaptive_blob_size;
+const std::string DB::Properties::kWriteBufferManagerStats =
+    rocksdb_prefix + write_buffer_manager_stats;
 
 const std::unordered_map<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
@@ -430,6 +440,9 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kEstimateLiveDataSize,
          {true, nullptr, &InternalStats::HandleEstimateLiveDataSize, nullptr,
           nullptr}},
+        {DB::Properties::kNumInheritanceEntries,
+         {true, nullptr, &InternalStats::HandleNumInheritanceEntries, nullptr,
+          nullptr}},
         {DB::Properties::kMinLogNumberToKeep,
          {false, nullptr, &InternalStats::HandleMinLogNumberToKeep, nullptr,
           nullptr}},
@@ -471,6 +484,12 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kOptionsStatistics,
          {false, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
+        {DB::Properties::kAdaptiveBlobSize,
+         {false, &InternalStats::HandleAdaptiveBlobSize, nullptr, nullptr,
+          nullptr}},
+        {DB::Properties::kWriteBufferManagerStats,
+         {false, &InternalStats::HandleWriteBufferManagerStats, nullptr,
+          nullptr, nullptr}},
 };
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
@@ -635,6 +654,26 @@ bool InternalStats::HandleAggregatedTablePropertiesAtLevel(std::string* value,
   return true;
 }
 
+bool InternalStats::HandleAdaptiveBlobSize(std::string* value,
+                                           Slice /*suffix*/) {
+  *value =
+      cfd_->GetAdaptiveBlobSizeString(*cfd_->GetLatestMutableCFOptions());
+  return true;
+}
+
+bool InternalStats::HandleWriteBufferManagerStats(std::string* value,
+                                                  Slice /*suffix*/) {
+  auto* root = cfd_->write_buffer_manager();
+  if (root == nullptr) {
+    return false;
+  }
+  while (root->parent() != nullptr) {
+    root = root->parent();
+  }
+  root->GetStats(value);
+  return true;
+}
+
 bool InternalStats::HandleNumImmutableMemTable(uint64_t* value, DBImpl* /*db*/,
                                                Version* /*version*/) {
   *value = cfd_->imm()->NumNotFlushed();
@@ -825,6 +864,19 @@ bool InternalStats::HandleEstimateLiveDataSize(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleNumInheritanceEntries(uint64_t* value,
+                                                DBImpl* /*db*/,
+                                                Version* version) {
+  const auto* vstorage = version->storage_info();
+  *value = 0;
+  for (int level = -1; level < vstorage->num_levels(); ++level) {
+    for (auto f : vstorage->LevelFiles(level)) {
+      *value += f->prop.inheritance.size();
+    }
+  }
+  return true;
+}
+
 bool InternalStats::HandleMinLogNumberToKeep(uint64_t* value, DBImpl* db,
                                              Version* /*version*/) {
   *value = db->MinLogNumberToKeep();
@@ -477,6 +477,8 @@ class InternalStats {
   bool HandleSsTables(std::string* value, Slice suffix);
   bool HandleAggregatedTableProperties(std::string* value, Slice suffix);
   bool HandleAggregatedTablePropertiesAtLevel(std::string* value, Slice suffix);
+  bool HandleAdaptiveBlobSize(std::string* value, Slice suffix);
+  bool HandleWriteBufferManagerStats(std::string* value, Slice suffix);
   bool HandleNumImmutableMemTable(uint64_t* value, DBImpl* db,
                                   Version* version);
   bool HandleNumImmutableMemTableFlushed(uint64_t* value, DBImpl* db,
@@ -517,6 +519,8 @@ class InternalStats {
                                      Version* version);
   bool HandleEstimateLiveDataSize(uint64_t* value, DBImpl* db,
                                   Version* version);
+  bool HandleNumInheritanceEntries(uint64_t* value, DBImpl* db,
+                                   Version* version);
   bool HandleMinLogNumberToKeep(uint64_t* value, DBImpl* db, Version* version);
   bool HandleMinObsoleteSstNumberToKeep(uint64_t* value, DBImpl* db,
                                         Version* version);
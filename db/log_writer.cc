@@ -38,9 +38,35 @@ Writer::~Writer() {
   Frozen();
 }
 
-Status Writer::WriteBuffer() { return dest_->Flush(); }
+Status Writer::WriteBuffer() {
+  Status s = dest_->Flush();
+  for (size_t i = 0; s.ok() && i < streams_.size(); ++i) {
+    s = streams_[i]->WriteBuffer();
+  }
+  return s;
+}
+
+Status Writer::Frozen() {
+  Status s = dest_->Frozen();
+  for (size_t i = 0; s.ok() && i < streams_.size(); ++i) {
+    s = streams_[i]->Frozen();
+  }
+  return s;
+}
+
+Status Writer::Sync(bool use_fsync) {
+  Status s = dest_->Sync(use_fsync);
+  for (size_t i = 0; s.ok() && i < streams_.size(); ++i) {
+    s = streams_[i]->Sync(use_fsync);
+  }
+  return s;
+}
 
-Status Writer::Frozen() { return dest_->Frozen(); }
+void Writer::AddStream(std::unique_ptr<Writer>&& stream) {
+  assert(stream != nullptr && stream->streams_.empty());
+  assert(stream->log_number_ == log_number_);
+  streams_.emplace_back(std::move(stream));
+}
 
 Status Writer::AddRecord(const Slice& slice) {
   const char* ptr = slice.data();
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "db/log_format.h"
 #include "rocksdb/slice.h"
@@ -92,6 +93,19 @@ class Writer {
   // may still have data un-synced if we close it immedately.
   Status Frozen();
 
+  // Flush and sync this writer and all its streams.
+  Status Sync(bool use_fsync);
+
+  // Attach an extra stream (see DBOptions::wal_streams) that shares the log
+  // number of this writer. The stream is owned, flushed and synced together
+  // with this writer.
+  void AddStream(std::unique_ptr<Writer>&& stream);
+
+  size_t num_streams() const { return streams_.size() + 1; }
+
+  // Stream 0 is this writer itself.
+  Writer* stream(size_t i) { return i == 0 ? this : streams_[i - 1].get(); }
+
   bool TEST_BufferIsEmpty();
 
  private:
@@ -111,6 +125,8 @@ class Writer {
   // layer to manually does the flush by calling ::WriteBuffer()
   bool manual_flush_;
 
+  std::vector<std::unique_ptr<Writer>> streams_;
+
   // No copying allowed
   Writer(const Writer&);
   void operator=(const Writer&);
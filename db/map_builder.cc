@@ -26,6 +26,8 @@
 #include "db/event_helpers.h"
 #include "db/range_del_aggregator.h"
 #include "monitoring/thread_status_util.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/terark_namespace.h"
 #include "table/merging_iterator.h"
 #include "table/two_level_iterator.h"
@@ -120,6 +122,8 @@ struct RangeWithDepend {
   bool marked_for_compaction;
   bool stable;
   std::vector<MapSstElement::LinkTarget> dependence;
+  // Filter of the input map element, only valid while stable
+  Slice filter;
 
   RangeWithDepend() = default;
 
@@ -149,6 +153,9 @@ struct RangeWithDepend {
     marked_for_compaction = map_element.marked_for_compaction;
     stable = true;
     dependence = map_element.link;
+    if (!map_element.filter.empty()) {
+      filter = ArenaPinSlice(map_element.filter, arena);
+    }
   }
   RangeWithDepend(const Range& range, Arena* arena) {
     assert(range.include_start);
@@ -247,12 +254,27 @@ struct MapBuilderRangesItem {
   }
 };
 
+// Building the filter of an element reads the keys of its links, it costs
+// up to filter_budget_bytes per map sst (the larger of the link sizes and the
+// key bytes read). Elements past the budget go without a filter. The reads
+// are charged to the rate limiter when it limits reads.
 class MapSstElementIterator : public MapSstRangeIterator {
  public:
   MapSstElementIterator(const std::vector<RangeWithDepend>& ranges,
                         IteratorCache& iterator_cache,
-                        const InternalKeyComparator& icomp)
-      : ranges_(ranges), iterator_cache_(iterator_cache), icomp_(icomp) {}
+                        const InternalKeyComparator& icomp,
+                        uint32_t filter_bits_per_key,
+                        uint64_t filter_budget_bytes, RateLimiter* rate_limiter)
+      : filter_budget_bytes_(filter_budget_bytes),
+        rate_limiter_(rate_limiter),
+        ranges_(ranges),
+        iterator_cache_(iterator_cache),
+        icomp_(icomp) {
+    if (filter_bits_per_key > 0) {
+      filter_policy_.reset(
+          NewBloomFilterPolicy(static_cast<int>(filter_bits_per_key)));
+    }
+  }
   bool Valid() const override { return !buffer_.empty(); }
   void SeekToFirst() override {
     where_ = ranges_.begin();
@@ -282,6 +304,62 @@ class MapSstElementIterator : public MapSstRangeIterator {
       status_ = iter->status();
     }
   }
+  // Put the user keys of all links in [start, end] into one filter, keys at
+  // an excluded bound only cost false positives. Leaves the filter empty once
+  // the budget runs out.
+  bool BuildFilter(const Slice& start, const Slice& end,
+                   const std::vector<MapSstElement::LinkTarget>& links) {
+    std::unique_ptr<FilterBitsBuilder> builder(
+        filter_policy_->GetFilterBitsBuilder());
+    for (auto& link : links) {
+      const FileMetaData* meta =
+          iterator_cache_.GetFileMetaData(link.file_number);
+      if (meta == nullptr) {
+        status_ =
+            Status::Corruption("MapSstElementIterator missing FileMetaData");
+        return false;
+      }
+      uint64_t read_bytes = 0;
+      bool exhausted = false;
+      auto iter = iterator_cache_.GetIterator(meta, nullptr);
+      for (iter->Seek(start);
+           iter->Valid() && icomp_.Compare(iter->key(), end) <= 0;
+           iter->Next()) {
+        read_bytes += iter->key().size();
+        if (read_bytes > filter_budget_bytes_) {
+          exhausted = true;
+          break;
+        }
+        builder->AddKey(ExtractUserKey(iter->key()));
+      }
+      read_bytes = std::max(read_bytes, link.size);
+      RequestReadBytes(read_bytes);
+      if (!iter->status().ok()) {
+        status_ = iter->status();
+        return false;
+      }
+      if (exhausted || read_bytes > filter_budget_bytes_) {
+        filter_budget_bytes_ = 0;
+        return true;
+      }
+      filter_budget_bytes_ -= read_bytes;
+    }
+    map_elements_.filter = builder->Finish(&filter_buffer_);
+    return true;
+  }
+  void RequestReadBytes(uint64_t bytes) {
+    if (rate_limiter_ == nullptr ||
+        !rate_limiter_->IsRateLimited(RateLimiter::OpType::kRead)) {
+      return;
+    }
+    while (bytes > 0) {
+      int64_t request = static_cast<int64_t>(std::min<uint64_t>(
+          bytes, rate_limiter_->GetSingleBurstBytes()));
+      rate_limiter_->Request(request, Env::IO_LOW, nullptr /* stats */,
+                             RateLimiter::OpType::kRead);
+      bytes -= request;
+    }
+  }
   void PrepareNext() {
     while (true) {
       if (where_ == ranges_.end()) {
@@ -311,6 +389,7 @@ class MapSstElementIterator : public MapSstRangeIterator {
       map_elements_.has_delete_range = where_->has_delete_range;
       map_elements_.marked_for_compaction = where_->marked_for_compaction;
       bool stable = where_->stable;
+      Slice filter = where_->filter;
       auto& links = map_elements_.link = where_->dependence;
       assert(!map_elements_.include_smallest);
       assert(map_elements_.include_largest);
@@ -395,6 +474,18 @@ class MapSstElementIterator : public MapSstRangeIterator {
           continue;
         }
       }
+      map_elements_.filter.clear();
+      if (filter_policy_ && links.size() > 1) {
+        if (stable && !filter.empty()) {
+          map_elements_.filter = filter;
+        } else if (filter_budget_bytes_ > 0 &&
+                   range_size <= filter_budget_bytes_) {
+          if (!BuildFilter(start, end, links)) {
+            buffer_.clear();
+            return;
+          }
+        }
+      }
       sst_read_amp_ = std::max(sst_read_amp_, map_elements_.link.size());
       sst_read_amp_ratio_ += map_elements_.link.size() * range_size;
       sst_read_amp_size_ += range_size;
@@ -408,6 +499,10 @@ class MapSstElementIterator : public MapSstRangeIterator {
   MapSstElement map_elements_;
   InternalKey temp_start_, temp_end_;
   std::string buffer_;
+  std::unique_ptr<const FilterPolicy> filter_policy_;
+  std::unique_ptr<const char[]> filter_buffer_;
+  uint64_t filter_budget_bytes_;
+  RateLimiter* rate_limiter_;
   std::vector<RangeWithDepend>::const_iterator where_;
   const std::vector<RangeWithDepend>& ranges_;
   std::unordered_map<uint64_t, uint64_t> dependence_build_;
@@ -768,6 +863,7 @@ std::vector<RangeWithDepend> PartitionRangeWithDepend(
     auto& has_delete_range = output.back().has_delete_range;
     auto& marked_for_compaction = output.back().marked_for_compaction;
     auto& stable = output.back().stable;
+    auto& filter = output.back().filter;
     assert(a != nullptr || b != nullptr);
     switch (type) {
       case PartitionType::kMerge:
@@ -784,11 +880,13 @@ std::vector<RangeWithDepend> PartitionRangeWithDepend(
             has_delete_range = a->has_delete_range;
             marked_for_compaction = a->marked_for_compaction;
             stable = a->stable;
+            filter = a->filter;
           }
         } else {
           has_delete_range = b->has_delete_range;
           marked_for_compaction = b->marked_for_compaction;
           stable = b->stable;
+          filter = b->filter;
           dependence = b->dependence;
         }
         break;
@@ -797,6 +895,7 @@ std::vector<RangeWithDepend> PartitionRangeWithDepend(
           has_delete_range = a->has_delete_range;
           marked_for_compaction = a->marked_for_compaction;
           stable = a->stable;
+          filter = a->filter;
           dependence = a->dependence;
         } else {
           assert(b->dependence.empty());
@@ -807,6 +906,7 @@ std::vector<RangeWithDepend> PartitionRangeWithDepend(
           has_delete_range = a->has_delete_range;
           marked_for_compaction = a->marked_for_compaction;
           stable = a->stable;
+          filter = a->filter;
           dependence = a->dependence;
           assert(b->dependence.empty());
         }
@@ -1275,8 +1375,11 @@ Status MapBuilder::Build(const std::vector<CompactionInputFiles>& inputs,
     return s;
   }
 
-  MapSstElementIterator output_iter(ranges, iterator_cache,
-                                    cfd->internal_comparator());
+  MapSstElementIterator output_iter(
+      ranges, iterator_cache, cfd->internal_comparator(),
+      version->GetMutableCFOptions().map_element_filter_bits_per_key,
+      version->GetMutableCFOptions().max_compaction_bytes,
+      cfd->ioptions()->rate_limiter);
   assert(std::is_sorted(ranges.begin(), ranges.end(),
                         TERARK_FIELD(point[1]) < icomp));
   FileMetaData file_meta;
@@ -1536,8 +1639,11 @@ Status MapBuilder::Build(const std::vector<CompactionInputFiles>& inputs,
       continue;
     }
 
-    MapSstElementIterator output_iter(level_ranges.ranges, iterator_cache,
-                                      cfd->internal_comparator());
+    MapSstElementIterator output_iter(
+        level_ranges.ranges, iterator_cache, cfd->internal_comparator(),
+        version->GetMutableCFOptions().map_element_filter_bits_per_key,
+        version->GetMutableCFOptions().max_compaction_bytes,
+        cfd->ioptions()->rate_limiter);
     ScopedArenaIterator tombstone_iter;
     if (!level_ranges.tombstones.empty()) {
       MergeIteratorBuilder builder(&icomp, iterator_cache.GetArena());
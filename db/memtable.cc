@@ -71,8 +71,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       mem_tracker_(write_buffer_manager),
       arena_(moptions_.arena_block_size,
              (write_buffer_manager != nullptr &&
-              (write_buffer_manager->enabled() ||
-               write_buffer_manager->cost_to_cache()))
+              write_buffer_manager->tracks_memory())
                  ? &mem_tracker_
                  : nullptr,
              mutable_cf_options.memtable_huge_page_size),
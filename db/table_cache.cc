@@ -9,12 +9,17 @@
 
 #include "db/table_cache.h"
 
+#include <algorithm>
+
 #include "db/dbformat.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/version_edit.h"
 #include "monitoring/perf_context_imp.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/persistent_cache.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/terark_namespace.h"
+#include "table/block_based_table_factory.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
 #include "table/iterator_wrapper.h"
@@ -25,6 +30,7 @@
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
 #include "util/filename.h"
+#include "util/hash.h"
 #include "util/stop_watch.h"
 #include "util/sync_point.h"
 
@@ -38,6 +44,10 @@ static void DeleteEntry(const Slice& /*key*/, void* value) {
   delete typed_value;
 }
 
+static void DeleteCharArray(void* arg1, void* /*arg2*/) {
+  delete[] reinterpret_cast<char*>(arg1);
+}
+
 static void UnrefEntry(void* arg1, void* arg2) {
   Cache* cache = reinterpret_cast<Cache*>(arg1);
   Cache::Handle* h = reinterpret_cast<Cache::Handle*>(arg2);
@@ -56,6 +66,14 @@ static Slice GetSliceForFileNumber(const uint64_t* file_number) {
                sizeof(*file_number));
 }
 
+// The decoded index of a map sst is keyed by the file number and a tag byte,
+// so that it may share the table cache with its table reader
+static Slice GetMapSstIndexKey(uint64_t file_number, char* buf) {
+  memcpy(buf, &file_number, sizeof file_number);
+  buf[sizeof file_number] = 'm';
+  return Slice(buf, sizeof file_number + 1);
+}
+
 static bool InheritanceMismatch(const FileMetaData& sst_meta,
                                 const FileMetaData& blob_meta) {
   assert(std::is_sorted(sst_meta.prop.dependence.begin(),
@@ -141,16 +159,46 @@ class LazyCreateIterator : public Snapshot {
 }  // namespace
 
 TableCache::TableCache(const ImmutableCFOptions& ioptions,
-                       const EnvOptions& env_options, Cache* const cache)
+                       const EnvOptions& env_options, Cache* const cache,
+                       BlockCacheTracer* const block_cache_tracer,
+                       const std::string& db_id)
     : ioptions_(ioptions),
       env_options_(env_options),
       cache_(cache),
-      immortal_tables_(false) {
+      map_sst_index_cache_(cache),
+      immortal_tables_(false),
+      block_cache_tracer_(block_cache_tracer),
+      blob_fetch_total_(0) {
   if (ioptions_.row_cache) {
     // If the same cache is shared by multiple instances, we need to
     // disambiguate its entries.
     PutVarint64(&row_cache_id_, ioptions_.row_cache->NewId());
   }
+  if (ioptions_.blob_cache) {
+    PutVarint64(&blob_cache_id_, ioptions_.blob_cache->NewId());
+  }
+  if (ioptions_.table_factory != nullptr &&
+      BlockBasedTableFactory::kName == ioptions_.table_factory->Name()) {
+    auto* table_options = reinterpret_cast<BlockBasedTableOptions*>(
+        ioptions_.table_factory->GetOptions());
+    if (table_options != nullptr && !table_options->no_block_cache &&
+        table_options->block_cache != nullptr) {
+      // Like the blocks of deleted ssts, the indexes of deleted map ssts age
+      // out of the block cache
+      map_sst_index_cache_ = table_options->block_cache.get();
+      PutVarint64(&map_sst_index_cache_id_, map_sst_index_cache_->NewId());
+    }
+  }
+  if (ioptions_.blob_persistent_cache && !db_id.empty()) {
+    PutLengthPrefixedSlice(&blob_persistent_cache_id_, db_id);
+  }
+  if (!blob_persistent_cache_id_.empty() &&
+      ioptions_.blob_persistent_cache_admission_fetches > 1) {
+    blob_fetch_counts_.reset(new std::atomic<uint8_t>[kBlobFetchCounters]);
+    for (size_t i = 0; i < kBlobFetchCounters; ++i) {
+      blob_fetch_counts_[i].store(0, std::memory_order_relaxed);
+    }
+  }
 }
 
 TableCache::~TableCache() {}
@@ -226,12 +274,14 @@ Status TableCache::GetTableReaderImpl(
             record_read_stats ? ioptions_.statistics : nullptr, SST_READ_MICROS,
             file_read_hist, ioptions_.rate_limiter, for_compaction,
             ioptions_.listeners));
+    TableReaderOptions table_reader_options(
+        ioptions_, prefix_extractor, env_options, internal_comparator,
+        skip_filters, immortal_tables_, level, fd.GetNumber(),
+        fd.largest_seqno);
+    table_reader_options.block_cache_tracer = block_cache_tracer_;
     s = ioptions_.table_factory->NewTableReader(
-        TableReaderOptions(ioptions_, prefix_extractor, env_options,
-                           internal_comparator, skip_filters, immortal_tables_,
-                           level, fd.GetNumber(), fd.largest_seqno),
-        std::move(file_reader), fd.GetFileSize(), table_reader,
-        prefetch_index_and_filter_in_cache);
+        table_reader_options, std::move(file_reader), fd.GetFileSize(),
+        table_reader, prefetch_index_and_filter_in_cache);
     TEST_SYNC_POINT("TableCache::GetTableReader:0");
   }
   return s;
@@ -239,9 +289,146 @@ Status TableCache::GetTableReaderImpl(
 
 void TableCache::EraseHandle(const FileDescriptor& fd, Cache::Handle* handle) {
   ReleaseHandle(handle);
-  uint64_t number = fd.GetNumber();
-  Slice key = GetSliceForFileNumber(&number);
-  cache_->Erase(key);
+  Evict(cache_, fd.GetNumber());
+}
+
+// Point lookups through a map sst binary search the largest keys of its
+// elements here instead of seeking the map sst and decoding the element
+// values again. Links stay file numbers: the FileMetaData they resolve to
+// belong to versions, and this outlives them in the table cache.
+struct TableCache::MapSstIndex {
+  struct Element {
+    size_t largest_offset;
+    size_t smallest_offset;
+    size_t link_offset;
+    uint32_t largest_size;
+    uint32_t smallest_size;
+    uint32_t link_count;
+    uint32_t filter_index;
+    bool include_smallest;
+    bool include_largest;
+  };
+  static constexpr uint32_t kNoFilter = uint32_t(-1);
+  std::string keys;
+  std::vector<Element> elements;
+  std::vector<uint64_t> links;
+  std::string filter_data;
+  std::vector<std::unique_ptr<FilterBitsReader>> filters;
+
+  Slice largest_key(const Element& e) const {
+    return Slice(keys.data() + e.largest_offset, e.largest_size);
+  }
+  Slice smallest_key(const Element& e) const {
+    return Slice(keys.data() + e.smallest_offset, e.smallest_size);
+  }
+  const uint64_t* link(const Element& e) const {
+    return links.data() + e.link_offset;
+  }
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(*this) + keys.capacity() +
+           elements.capacity() * sizeof(Element) +
+           links.capacity() * sizeof(uint64_t) + filter_data.capacity() +
+           filters.capacity() * sizeof(filters[0]);
+  }
+  // False if none of the links of e holds user_key
+  bool MayMatch(const Element& e, const Slice& user_key) const {
+    return e.filter_index == kNoFilter ||
+           filters[e.filter_index]->MayMatch(user_key);
+  }
+
+  // First element whose largest key isn't less than k, where a seek of the
+  // map sst would land
+  std::vector<Element>::const_iterator LowerBound(
+      const InternalKeyComparator& icomp, const Slice& k) const {
+    return std::lower_bound(elements.begin(), elements.end(), k,
+                            [&](const Element& e, const Slice& target) {
+                              return icomp.Compare(largest_key(e), target) < 0;
+                            });
+  }
+};
+
+Status TableCache::FindMapSstIndex(const ReadOptions& options,
+                                   const FileDescriptor& fd, TableReader* t,
+                                   const SliceTransform* prefix_extractor,
+                                   Cache::Handle** handle) {
+  char key_buf[sizeof(uint64_t) + 1];
+  std::string key = map_sst_index_cache_id_;
+  key.append(GetMapSstIndexKey(fd.GetNumber(), key_buf).ToString());
+  *handle = map_sst_index_cache_->Lookup(key);
+  if (*handle != nullptr) {
+    return Status::OK();
+  }
+  std::unique_ptr<MapSstIndex> index(new MapSstIndex);
+  ReadOptions read_options;
+  read_options.read_tier = options.read_tier;
+  read_options.fill_cache = options.fill_cache;
+  std::unique_ptr<InternalIterator> iter(
+      t->NewIterator(read_options, prefix_extractor));
+  MapSstElement map_element;
+  std::vector<std::pair<size_t, size_t>> filter_bounds;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    LazyBuffer value = iter->value();
+    auto s = value.fetch();
+    if (!s.ok()) {
+      return s;
+    }
+    if (!map_element.Decode(iter->key(), value.slice())) {
+      return Status::Corruption("Map sst invalid link_value");
+    }
+    MapSstIndex::Element element;
+    element.largest_offset = index->keys.size();
+    element.largest_size =
+        static_cast<uint32_t>(map_element.largest_key.size());
+    index->keys.append(map_element.largest_key.data(),
+                       map_element.largest_key.size());
+    element.smallest_offset = index->keys.size();
+    element.smallest_size =
+        static_cast<uint32_t>(map_element.smallest_key.size());
+    index->keys.append(map_element.smallest_key.data(),
+                       map_element.smallest_key.size());
+    element.link_offset = index->links.size();
+    element.link_count = static_cast<uint32_t>(map_element.link.size());
+    for (auto& link : map_element.link) {
+      index->links.emplace_back(link.file_number);
+    }
+    element.filter_index = MapSstIndex::kNoFilter;
+    if (!map_element.filter.empty()) {
+      element.filter_index = static_cast<uint32_t>(filter_bounds.size());
+      filter_bounds.emplace_back(index->filter_data.size(),
+                                 map_element.filter.size());
+      index->filter_data.append(map_element.filter.data(),
+                                map_element.filter.size());
+    }
+    element.include_smallest = map_element.include_smallest;
+    element.include_largest = map_element.include_largest;
+    index->elements.emplace_back(element);
+  }
+  if (!iter->status().ok()) {
+    return iter->status();
+  }
+  index->keys.shrink_to_fit();
+  index->elements.shrink_to_fit();
+  index->links.shrink_to_fit();
+  index->filter_data.shrink_to_fit();
+  if (!filter_bounds.empty()) {
+    // Full filters carry their own probe count, bits per key only matters to
+    // the builder
+    std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(10));
+    index->filters.reserve(filter_bounds.size());
+    for (auto& bound : filter_bounds) {
+      index->filters.emplace_back(policy->GetFilterBitsReader(
+          Slice(index->filter_data.data() + bound.first, bound.second)));
+    }
+  }
+  size_t charge = map_sst_index_cache_ == cache_
+                      ? 1
+                      : index->ApproximateMemoryUsage();
+  auto s = map_sst_index_cache_->Insert(key, index.get(), charge,
+                                        &DeleteEntry<MapSstIndex>, handle);
+  if (s.ok()) {
+    index.release();
+  }
+  return s;
 }
 
 Status TableCache::FindTable(const EnvOptions& env_options,
@@ -477,6 +664,35 @@ Status TableCache::Get(const ReadOptions& options,
   auto& fd = file_meta.fd;
   IterKey key_buffer;
   Status s;
+#ifndef ROCKSDB_LITE
+  // Rows are cached per key sst, which map ssts forward to unchanged, so
+  // rewriting the map ssts above doesn't invalidate them. Tables with range
+  // deletions of their own must be read to find the covering tombstones
+  std::string row_cache_key;
+  std::string row_cache_entry;
+  if (ioptions_.row_cache && inheritance == nullptr &&
+      !file_meta.prop.is_map_sst() && get_context->RowCacheable() &&
+      (options.ignore_range_deletions ||
+       !file_meta.prop.has_range_deletions())) {
+    // Lookups at or above the largest sequence of the table all see the same
+    // entry and share a cache key
+    SequenceNumber seq_no = 0;
+    SequenceNumber ikey_seq = GetInternalKeySeqno(k);
+    if (ikey_seq < fd.largest_seqno) {
+      seq_no = ikey_seq + 1;
+    }
+    Slice user_key = ExtractUserKey(k);
+    row_cache_key.assign(row_cache_id_);
+    PutVarint64(&row_cache_key, fd.GetNumber());
+    PutVarint64(&row_cache_key, seq_no);
+    row_cache_key.append(user_key.data(), user_key.size());
+    if (GetFromRowCache(row_cache_key, user_key, fd.GetNumber(),
+                        get_context)) {
+      return Status::OK();
+    }
+    get_context->SetRowCacheEntry(&row_cache_entry);
+  }
+#endif  // ROCKSDB_LITE
   TableReader* t = fd.table_reader;
   Cache::Handle* handle = nullptr;
   if (t == nullptr) {
@@ -495,6 +711,15 @@ Status TableCache::Get(const ReadOptions& options,
                                      get_context->max_covering_tombstone_seq());
     if (!file_meta.prop.is_map_sst()) {
       s = t->Get(options, k, get_context, prefix_extractor, skip_filters);
+#ifndef ROCKSDB_LITE
+      if (s.ok() && !row_cache_entry.empty()) {
+        size_t charge = row_cache_key.size() + row_cache_entry.size() +
+                        sizeof(std::string);
+        auto row_ptr = new std::string(std::move(row_cache_entry));
+        ioptions_.row_cache->Insert(row_cache_key, row_ptr, charge,
+                                    &DeleteEntry<std::string>);
+      }
+#endif  // ROCKSDB_LITE
     } else if (dependence_map.empty()) {
       s = Status::Corruption(
           "TableCache::Get: Composite sst depend files missing");
@@ -503,31 +728,16 @@ Status TableCache::Get(const ReadOptions& options,
       ReadOptions forward_options = options;
       forward_options.ignore_range_deletions |=
           file_meta.prop.map_handle_range_deletions();
-      auto get_from_map = [&](const Slice& largest_key,
-                              LazyBuffer&& map_value) {
-        s = map_value.fetch();
-        if (!s.ok()) {
-          return false;
-        }
-        // Manual inline MapSstElement::Decode
-        const char* err_msg = "Map sst invalid link_value";
-        Slice map_input = map_value.slice();
-        Slice smallest_key;
-        uint64_t link_count;
-        uint64_t flags;
+      auto& icomp = internal_comparator;
+      auto get_from_map = [&](const MapSstIndex& index,
+                              const MapSstIndex::Element& element) {
+        Slice smallest_key = index.smallest_key(element);
+        Slice largest_key = index.largest_key(element);
         Slice find_k = k;
-        auto& icomp = internal_comparator;
-
-        if (!GetVarint64(&map_input, &flags) ||
-            !GetVarint64(&map_input, &link_count) ||
-            !GetLengthPrefixedSlice(&map_input, &smallest_key)) {
-          s = Status::Corruption(err_msg);
-          return false;
-        }
         // don't care kNoRecords, Get call need load
         // max_covering_tombstone_seq
-        int include_smallest = (flags & MapSstElement::kIncludeSmallest) != 0;
-        int include_largest = (flags & MapSstElement::kIncludeLargest) != 0;
+        int include_smallest = element.include_smallest;
+        int include_largest = element.include_largest;
 
         // include_smallest ? cmp_result > 0 : cmp_result >= 0
         if (icomp.Compare(smallest_key, k) >= include_smallest) {
@@ -575,18 +785,26 @@ Status TableCache::Get(const ReadOptions& options,
               std::max(min_seq_type_backup, seq_type + !include_largest));
         }
 
-        uint64_t file_number;
-        for (uint64_t i = 0; i < link_count; ++i) {
-          if (!GetVarint64(&map_input, &file_number)) {
-            s = Status::Corruption(err_msg);
-            return false;
-          }
+        if (forward_options.ignore_range_deletions &&
+            !index.MayMatch(element, ExtractUserKey(k))) {
+          // Links don't hold k, and their tombstones are handled by the map
+          RecordTick(ioptions_.statistics, MAP_ELEMENT_FILTER_USEFUL);
+          get_context->SetMinSequenceAndType(min_seq_type_backup);
+          return is_largest_user_key;
+        }
+        const uint64_t* link = index.link(element);
+        for (uint64_t i = 0; i < element.link_count; ++i) {
+          uint64_t file_number = link[i];
+          RecordTick(ioptions_.statistics, READ_DEPENDENCE_MAP_LOOKUP);
+          PERF_COUNTER_ADD(dependence_map_lookup_count, 1);
           auto find = dependence_map.find(file_number);
           if (find == dependence_map.end()) {
             s = Status::Corruption("Map sst dependence missing");
             return false;
           }
           assert(find->second->fd.GetNumber() == file_number);
+          RecordTick(ioptions_.statistics, READ_MAP_SST_HOPS);
+          PERF_COUNTER_ADD(map_sst_hop_count, 1);
           s = Get(forward_options, internal_comparator, *find->second,
                   dependence_map, find_k, get_context, prefix_extractor,
                   file_read_hist, skip_filters, level, inheritance);
@@ -600,20 +818,256 @@ Status TableCache::Get(const ReadOptions& options,
         get_context->SetMinSequenceAndType(min_seq_type_backup);
         return is_largest_user_key;
       };
-      t->RangeScan(&k, prefix_extractor, &get_from_map,
-                   c_style_callback(get_from_map));
+      Cache::Handle* index_handle = nullptr;
+      s = FindMapSstIndex(options, fd, t, prefix_extractor, &index_handle);
+      if (s.ok()) {
+        auto index = reinterpret_cast<const MapSstIndex*>(
+            map_sst_index_cache_->Value(index_handle));
+        auto it = index->LowerBound(icomp, k);
+        while (it != index->elements.end() && get_from_map(*index, *it)) {
+          ++it;
+        }
+        map_sst_index_cache_->Release(index_handle);
+      } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+        // Decoding the map sst needs io
+        get_context->MarkKeyMayExist();
+        s = Status::OK();
+      }
     }
   } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
     // Couldn't find Table in cache but treat as kFound if no_io set
     get_context->MarkKeyMayExist();
     s = Status::OK();
   }
+#ifndef ROCKSDB_LITE
+  if (!row_cache_key.empty()) {
+    get_context->SetRowCacheEntry(nullptr);
+  }
+#endif  // ROCKSDB_LITE
   if (handle != nullptr) {
     ReleaseHandle(handle);
   }
   return s;
 }
 
+Status TableCache::GetAtLocation(
+    const ReadOptions& options,
+    const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, const Slice& k, uint64_t location,
+    GetContext* get_context, const SliceTransform* prefix_extractor) {
+  assert(!file_meta.prop.is_map_sst());
+  auto& fd = file_meta.fd;
+  Status s;
+  TableReader* t = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(env_options_, internal_comparator, fd, &handle,
+                  prefix_extractor,
+                  options.read_tier == kBlockCacheTier /* no_io */,
+                  true /* record_read_stats */, nullptr /* file_read_hist */,
+                  true /* skip_filters */);
+    if (s.ok()) {
+      t = GetTableReaderFromHandle(handle);
+    }
+  }
+  if (s.ok()) {
+    s = t->GetAtLocation(options, k, location, get_context);
+  } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+    // Couldn't find Table in cache but treat as kFound if no_io set
+    get_context->MarkKeyMayExist();
+    s = Status::OK();
+  }
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
+  return s;
+}
+
+bool TableCache::GetFromRowCache(const Slice& row_cache_key,
+                                 const Slice& user_key, uint64_t file_number,
+                                 GetContext* get_context) {
+  Cache* row_cache = ioptions_.row_cache.get();
+  auto row_handle = row_cache->Lookup(row_cache_key);
+  if (row_handle == nullptr) {
+    RecordTick(ioptions_.statistics, ROW_CACHE_MISS);
+    return false;
+  }
+  // Entry layout: type, varint sequence, value. See GetContext::SaveValue
+  Slice entry = *reinterpret_cast<std::string*>(row_cache->Value(row_handle));
+  ParsedInternalKey parsed_key;
+  parsed_key.user_key = user_key;
+  parsed_key.type = static_cast<ValueType>(entry[0]);
+  entry.remove_prefix(1);
+  if (!GetVarint64(&entry, &parsed_key.sequence)) {
+    assert(false);
+    row_cache->Release(row_handle);
+    return false;
+  }
+  RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
+  bool matched = false;
+  get_context->SaveValue(
+      parsed_key,
+      LazyBuffer(entry, Cleanable(&UnrefEntry, row_cache, row_handle),
+                 file_number),
+      &matched);
+  assert(matched);
+  return true;
+}
+
+void TableCache::ComputeBlobCacheKey(const Slice& user_key,
+                                     SequenceNumber sequence,
+                                     uint64_t blob_file_number,
+                                     std::string* key) const {
+  key->assign(blob_cache_id_);
+  PutVarint64(key, blob_file_number);
+  PutVarint64(key, sequence);
+  key->append(user_key.data(), user_key.size());
+}
+
+void TableCache::ComputeBlobPersistentCacheKey(
+    const std::string& blob_cache_key, std::string* key) const {
+  assert(blob_cache_key.compare(0, blob_cache_id_.size(), blob_cache_id_) ==
+         0);
+  key->assign(blob_persistent_cache_id_);
+  key->append(blob_cache_key, blob_cache_id_.size(), std::string::npos);
+}
+
+bool TableCache::GetFromBlobCache(const Slice& user_key,
+                                  SequenceNumber sequence,
+                                  uint64_t blob_file_number,
+                                  uint64_t file_number, LazyBuffer* value) {
+#ifndef ROCKSDB_LITE
+  Cache* blob_cache = ioptions_.blob_cache.get();
+  if (blob_cache == nullptr) {
+    return false;
+  }
+  std::string key;
+  ComputeBlobCacheKey(user_key, sequence, blob_file_number, &key);
+  auto blob_handle = blob_cache->Lookup(key);
+  if (blob_handle == nullptr) {
+    RecordTick(ioptions_.statistics, BLOB_CACHE_MISS);
+    return false;
+  }
+  RecordTick(ioptions_.statistics, BLOB_CACHE_HIT);
+  *value = LazyBuffer(*reinterpret_cast<std::string*>(
+                          blob_cache->Value(blob_handle)),
+                      Cleanable(&UnrefEntry, blob_cache, blob_handle),
+                      file_number);
+  return true;
+#else
+  (void)user_key;
+  (void)sequence;
+  (void)blob_file_number;
+  (void)file_number;
+  (void)value;
+  return false;
+#endif  // ROCKSDB_LITE
+}
+
+bool TableCache::GetFromBlobPersistentCache(const Slice& user_key,
+                                            SequenceNumber sequence,
+                                            uint64_t blob_file_number,
+                                            uint64_t file_number,
+                                            LazyBuffer* value) {
+#ifndef ROCKSDB_LITE
+  PersistentCache* persistent_cache = ioptions_.blob_persistent_cache.get();
+  if (persistent_cache == nullptr || blob_persistent_cache_id_.empty()) {
+    return false;
+  }
+  std::string key;
+  ComputeBlobCacheKey(user_key, sequence, blob_file_number, &key);
+  std::string persistent_key;
+  ComputeBlobPersistentCacheKey(key, &persistent_key);
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  if (!persistent_cache->Lookup(persistent_key, &data, &size).ok()) {
+    RecordTick(ioptions_.statistics, BLOB_PERSISTENT_CACHE_MISS);
+    return false;
+  }
+  RecordTick(ioptions_.statistics, BLOB_PERSISTENT_CACHE_HIT);
+  Cache* blob_cache = ioptions_.blob_cache.get();
+  if (blob_cache != nullptr) {
+    size_t charge = key.size() + size + sizeof(std::string);
+    blob_cache->Insert(key, new std::string(data.get(), size), charge,
+                       &DeleteEntry<std::string>);
+  }
+  Slice slice(data.get(), size);
+  value->reset(slice, Cleanable(&DeleteCharArray, data.release(), nullptr),
+               file_number);
+  return true;
+#else
+  (void)user_key;
+  (void)sequence;
+  (void)blob_file_number;
+  (void)file_number;
+  (void)value;
+  return false;
+#endif  // ROCKSDB_LITE
+}
+
+void TableCache::InsertBlobCache(const Slice& user_key,
+                                 SequenceNumber sequence,
+                                 uint64_t blob_file_number,
+                                 const Slice& value) {
+#ifndef ROCKSDB_LITE
+  Cache* blob_cache = ioptions_.blob_cache.get();
+  PersistentCache* persistent_cache = ioptions_.blob_persistent_cache.get();
+  if (blob_persistent_cache_id_.empty()) {
+    persistent_cache = nullptr;
+  }
+  if (blob_cache == nullptr && persistent_cache == nullptr) {
+    return;
+  }
+  std::string key;
+  ComputeBlobCacheKey(user_key, sequence, blob_file_number, &key);
+  if (blob_cache != nullptr) {
+    size_t charge = key.size() + value.size() + sizeof(std::string);
+    blob_cache->Insert(key, new std::string(value.data(), value.size()),
+                       charge, &DeleteEntry<std::string>);
+  }
+  if (persistent_cache != nullptr &&
+      value.size() <= ioptions_.blob_persistent_cache_max_value_size) {
+    std::string persistent_key;
+    ComputeBlobPersistentCacheKey(key, &persistent_key);
+    if (AdmitBlobPersistentCache(persistent_key) &&
+        persistent_cache->Insert(persistent_key, value.data(), value.size())
+            .ok()) {
+      RecordTick(ioptions_.statistics, BLOB_PERSISTENT_CACHE_ADD);
+    }
+  }
+#else
+  (void)user_key;
+  (void)sequence;
+  (void)blob_file_number;
+  (void)value;
+#endif  // ROCKSDB_LITE
+}
+
+bool TableCache::AdmitBlobPersistentCache(const Slice& key) {
+  if (blob_fetch_counts_ == nullptr) {
+    return true;
+  }
+  uint64_t total = blob_fetch_total_.fetch_add(1, std::memory_order_relaxed);
+  if (total % kBlobFetchDecayPeriod == kBlobFetchDecayPeriod - 1) {
+    auto& decay =
+        blob_fetch_counts_[total / kBlobFetchDecayPeriod % kBlobFetchCounters];
+    decay.store(decay.load(std::memory_order_relaxed) >> 1,
+                std::memory_order_relaxed);
+  }
+  // Racing fetches may lose an increment, the counts are only a hint
+  auto& count =
+      blob_fetch_counts_[Hash(key.data(), key.size(), 0) % kBlobFetchCounters];
+  uint32_t fetches = count.load(std::memory_order_relaxed) + 1u;
+  uint32_t threshold =
+      std::min(ioptions_.blob_persistent_cache_admission_fetches, 255u);
+  if (fetches >= threshold) {
+    count.store(0, std::memory_order_relaxed);
+    return true;
+  }
+  count.store(static_cast<uint8_t>(fetches), std::memory_order_relaxed);
+  return false;
+}
+
 Status TableCache::GetTableProperties(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator,
@@ -672,6 +1126,8 @@ size_t TableCache::GetMemoryUsageByTableReader(
 
 void TableCache::Evict(Cache* cache, uint64_t file_number) {
   cache->Erase(GetSliceForFileNumber(&file_number));
+  char key_buf[sizeof(uint64_t) + 1];
+  cache->Erase(GetMapSstIndexKey(file_number, key_buf));
 }
 
 void TableCache::TEST_AddMockTableReader(TableReader* table_reader,
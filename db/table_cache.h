@@ -12,6 +12,8 @@
 #pragma once
 #include <stdint.h>
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,11 +36,16 @@ class Arena;
 struct FileDescriptor;
 class GetContext;
 class HistogramImpl;
+class BlockCacheTracer;
 
 class TableCache {
  public:
+  // db_id prefixes the keys of the blob persistent cache, which outlives the
+  // process. Without it the blob persistent cache isn't used.
   TableCache(const ImmutableCFOptions& ioptions,
-             const EnvOptions& storage_options, Cache* cache);
+             const EnvOptions& storage_options, Cache* cache,
+             BlockCacheTracer* const block_cache_tracer = nullptr,
+             const std::string& db_id = std::string());
   ~TableCache();
 
   // Return an iterator for the specified file number (the corresponding
@@ -79,6 +86,36 @@ class TableCache {
              int level = -1,
              const FileMetaData* inheritance = nullptr);
 
+  // Look up k in a plain sst starting from the location recorded when k was
+  // added, see TableBuilder::LastEntryLocation(). Filters and the row cache
+  // are skipped, it's meant for the separated values of a value index.
+  Status GetAtLocation(const ReadOptions& options,
+                       const InternalKeyComparator& internal_comparator,
+                       const FileMetaData& file_meta, const Slice& k,
+                       uint64_t location, GetContext* get_context,
+                       const SliceTransform* prefix_extractor = nullptr);
+
+  // Serve a separated value from the blob cache, returns false on miss.
+  // Entries are keyed by the blob file number recorded in the value index, the
+  // sequence and the user key of the value, so they outlive the key ssts and
+  // map ssts referring to them.
+  // @param file_number The file holding the value, stamped on *value
+  bool GetFromBlobCache(const Slice& user_key, SequenceNumber sequence,
+                        uint64_t blob_file_number, uint64_t file_number,
+                        LazyBuffer* value);
+
+  // Serve a separated value from DBOptions::blob_persistent_cache, returns
+  // false on miss. A hit is copied into the blob cache as well
+  bool GetFromBlobPersistentCache(const Slice& user_key,
+                                  SequenceNumber sequence,
+                                  uint64_t blob_file_number,
+                                  uint64_t file_number, LazyBuffer* value);
+
+  // Insert a separated value fetched from the blob ssts into the blob cache,
+  // and into the blob persistent cache if it passes the admission
+  void InsertBlobCache(const Slice& user_key, SequenceNumber sequence,
+                       uint64_t blob_file_number, const Slice& value);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
@@ -141,6 +178,17 @@ class TableCache {
   void TEST_AddMockTableReader(TableReader* table_reader, FileDescriptor fd);
 
  private:
+  // Decoded elements of a map sst
+  struct MapSstIndex;
+
+  // Find the decoded element index of the map sst fd in
+  // map_sst_index_cache_, decoding the map sst through t on a miss. Returns
+  // Incomplete if that needs io the read tier of options doesn't allow. The
+  // caller releases *handle from map_sst_index_cache_
+  Status FindMapSstIndex(const ReadOptions& options, const FileDescriptor& fd,
+                         TableReader* t, const SliceTransform* prefix_extractor,
+                         Cache::Handle** handle);
+
   // Build a table reader
   Status GetTableReader(const EnvOptions& env_options,
                         const InternalKeyComparator& internal_comparator,
@@ -163,11 +211,42 @@ class TableCache {
                             bool prefetch_index_and_filter_in_cache,
                             bool for_compaction, bool force_memory);
 
+  // Replay the entry cached for row_cache_key into get_context, returns false
+  // on miss
+  bool GetFromRowCache(const Slice& row_cache_key, const Slice& user_key,
+                       uint64_t file_number, GetContext* get_context);
+
+  void ComputeBlobCacheKey(const Slice& user_key, SequenceNumber sequence,
+                           uint64_t blob_file_number, std::string* key) const;
+  // The cache id of a blob cache key is only unique within the process, swap
+  // it for the DB identity
+  void ComputeBlobPersistentCacheKey(const std::string& blob_cache_key,
+                                     std::string* key) const;
+
+  // Values are admitted to the blob persistent cache by the fetch counter
+  // their key hashes to. Fetches halve one counter in turn, every counter
+  // once per kBlobFetchDecayPeriod * kBlobFetchCounters fetches, so old
+  // fetches fade out.
+  static const size_t kBlobFetchCounters = 1 << 16;
+  static const uint64_t kBlobFetchDecayPeriod = 4;
+
+  bool AdmitBlobPersistentCache(const Slice& key);
+
   const ImmutableCFOptions& ioptions_;
   const EnvOptions& env_options_;
   Cache* const cache_;
+  // Decoded map sst indexes are charged by their size to the block cache of
+  // a block based table. Without one they stay in the table cache, which
+  // counts tables, with a charge of 1
+  Cache* map_sst_index_cache_;
+  std::string map_sst_index_cache_id_;
   std::string row_cache_id_;
+  std::string blob_cache_id_;
+  std::string blob_persistent_cache_id_;
   bool immortal_tables_;
+  BlockCacheTracer* const block_cache_tracer_;
+  std::unique_ptr<std::atomic<uint8_t>[]> blob_fetch_counts_;
+  std::atomic<uint64_t> blob_fetch_total_;
 };
 
 }  // namespace TERARKDB_NAMESPACE
@@ -5,6 +5,9 @@
 
 #include "db/table_properties_collector.h"
 
+#include <algorithm>
+#include <cinttypes>
+
 #include "db/dbformat.h"
 #include "monitoring/histogram.h"
 #include "rocksdb/env.h"
@@ -237,6 +240,192 @@ IntTblPropCollectorFactory* NewTtlIntTblPropCollectorFactory(
                                            ttl_max_scan_cap);
 }
 
+const size_t ValueSizeHistogram::kNumBuckets;
+const uint64_t ValueSizeHistogram::kMaxBlobSize;
+
+size_t ValueSizeHistogram::BucketIndex(uint64_t value_size) {
+  size_t index = 0;
+  while (value_size != 0 && index < kNumBuckets - 1) {
+    value_size >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+void ValueSizeHistogram::Add(uint64_t value_size) {
+  size_t index = BucketIndex(value_size);
+  ++count_[index];
+  bytes_[index] += value_size;
+}
+
+void ValueSizeHistogram::Merge(const ValueSizeHistogram& other) {
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    count_[i] += other.count_[i];
+    bytes_[i] += other.bytes_[i];
+  }
+}
+
+void ValueSizeHistogram::Decay() {
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    count_[i] /= 2;
+    bytes_[i] /= 2;
+  }
+}
+
+void ValueSizeHistogram::Clear() {
+  std::fill(std::begin(count_), std::end(count_), 0);
+  std::fill(std::begin(bytes_), std::end(bytes_), 0);
+}
+
+uint64_t ValueSizeHistogram::num_values() const {
+  uint64_t sum = 0;
+  for (auto count : count_) {
+    sum += count;
+  }
+  return sum;
+}
+
+uint64_t ValueSizeHistogram::total_bytes() const {
+  uint64_t sum = 0;
+  for (auto bytes : bytes_) {
+    sum += bytes;
+  }
+  return sum;
+}
+
+void ValueSizeHistogram::Encode(std::string* dst) const {
+  uint32_t num_buckets = kNumBuckets;
+  while (num_buckets > 0 && count_[num_buckets - 1] == 0) {
+    --num_buckets;
+  }
+  PutVarint32(dst, num_buckets);
+  for (uint32_t i = 0; i < num_buckets; ++i) {
+    PutVarint64Varint64(dst, count_[i], bytes_[i]);
+  }
+}
+
+bool ValueSizeHistogram::Decode(Slice src) {
+  Clear();
+  uint32_t num_buckets;
+  if (!GetVarint32(&src, &num_buckets) || num_buckets > kNumBuckets) {
+    return false;
+  }
+  for (uint32_t i = 0; i < num_buckets; ++i) {
+    if (!GetVarint64(&src, &count_[i]) || !GetVarint64(&src, &bytes_[i])) {
+      Clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ValueSizeHistogram::PickBlobSize(double write_weight,
+                                        double rewrite_ratio,
+                                        size_t min_blob_size) const {
+  uint64_t total_values = num_values();
+  uint64_t total_bytes_value = total_bytes();
+  if (total_values == 0 || total_bytes_value == 0) {
+    return min_blob_size;
+  }
+  // Candidate i separates the buckets [i, kNumBuckets), kNumBuckets separates
+  // nothing. Candidates below min_blob_size are never considered.
+  size_t min_index = BucketIndex(min_blob_size);
+  if (min_index == 0 || (uint64_t(1) << (min_index - 1)) < min_blob_size) {
+    ++min_index;
+  }
+  double write_cost = write_weight * rewrite_ratio;
+  double read_cost = 1 - write_weight;
+  size_t best_index = kNumBuckets;
+  double best_cost = write_cost;
+  uint64_t separated_values = 0;
+  uint64_t separated_bytes = 0;
+  for (size_t i = kNumBuckets; i-- > min_index;) {
+    separated_values += count_[i];
+    separated_bytes += bytes_[i];
+    double cost = write_cost * (total_bytes_value - separated_bytes) /
+                      total_bytes_value +
+                  read_cost * separated_values / total_values;
+    // Ties keep the larger threshold, it separates fewer values
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_index = i;
+    }
+  }
+  uint64_t blob_size = best_index == kNumBuckets
+                          ? kMaxBlobSize
+                          : uint64_t(1) << (best_index - 1);
+  return static_cast<size_t>(std::min<uint64_t>(
+      std::max<uint64_t>(blob_size, min_blob_size), port::kMaxSizet - 1));
+}
+
+std::string ValueSizeHistogram::ToString() const {
+  std::string result;
+  char buffer[128];
+  snprintf(buffer, sizeof(buffer),
+           "Values: %" PRIu64 " Bytes: %" PRIu64 "\n", num_values(),
+           total_bytes());
+  result.append(buffer);
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    if (count_[i] == 0) {
+      continue;
+    }
+    uint64_t lower = i == 0 ? 0 : uint64_t(1) << (i - 1);
+    uint64_t upper = uint64_t(1) << i;
+    snprintf(buffer, sizeof(buffer),
+             "[%" PRIu64 ", %" PRIu64 ") %" PRIu64 " %" PRIu64 "\n", lower,
+             upper, count_[i], bytes_[i]);
+    result.append(buffer);
+  }
+  return result;
+}
+
+class ValueSizeHistogramCollector : public IntTblPropCollector {
+ public:
+  Status Finish(UserCollectedProperties* properties) override {
+    if (!histogram_.Empty()) {
+      std::string value;
+      histogram_.Encode(&value);
+      properties->emplace(TablePropertiesNames::kValueSizeHistogram,
+                          std::move(value));
+    }
+    return Status::OK();
+  }
+
+  const char* Name() const override { return "ValueSizeHistogramCollector"; }
+
+  Status InternalAdd(const Slice& key, const Slice& value,
+                     uint64_t /*file_size*/) override {
+    EntryType entry_type = GetEntryType(ExtractValueType(key));
+    if (entry_type == kEntryPut || entry_type == kEntryMerge) {
+      histogram_.Add(value.size());
+    }
+    return Status::OK();
+  }
+
+  UserCollectedProperties GetReadableProperties() const override {
+    return UserCollectedProperties();
+  }
+
+ private:
+  ValueSizeHistogram histogram_;
+};
+
+class ValueSizeHistogramCollectorFactory : public IntTblPropCollectorFactory {
+ public:
+  IntTblPropCollector* CreateIntTblPropCollector(
+      const TablePropertiesCollectorFactory::Context&) override {
+    return new ValueSizeHistogramCollector();
+  }
+
+  const char* Name() const override {
+    return "ValueSizeHistogramCollectorFactory";
+  }
+};
+
+IntTblPropCollectorFactory* NewValueSizeHistogramCollectorFactory() {
+  return new ValueSizeHistogramCollectorFactory();
+}
+
 uint64_t GetDeletedKeys(const UserCollectedProperties& props) {
   bool property_present_ignored;
   return GetUint64Property(props, TablePropertiesNames::kDeletedKeys,
@@ -157,4 +157,50 @@ extern IntTblPropCollectorFactory* NewTtlIntTblPropCollectorFactory(
     const TtlExtractorFactory* ttl_extractor_factory, double ttl_gc_ratio,
     size_t ttl_max_scan_cap);
 
+// Value size distribution with power-of-two buckets. Bucket 0 holds empty
+// values and bucket i holds values in [2^(i-1), 2^i).
+class ValueSizeHistogram {
+ public:
+  static const size_t kNumBuckets = 40;
+  // Larger than any value, but unlike size_t(-1) it keeps separation enabled
+  static const uint64_t kMaxBlobSize = uint64_t(1) << (kNumBuckets - 1);
+
+  void Add(uint64_t value_size);
+  void Merge(const ValueSizeHistogram& other);
+  // Halve every bucket, so that older samples weigh less than newer ones
+  void Decay();
+  void Clear();
+
+  bool Empty() const { return num_values() == 0; }
+  uint64_t num_values() const;
+  uint64_t total_bytes() const;
+
+  void Encode(std::string* dst) const;
+  bool Decode(Slice src);
+
+  // Pick the smallest value size to separate, trading the bytes of inlined
+  // values rewritten by later compactions against the point reads that have
+  // to fetch a separated value:
+  //   cost(T) = write_weight * rewrite_ratio * inlined_bytes / total_bytes
+  //           + (1 - write_weight) * separated_values / total_values
+  // rewrite_ratio is the share of levels the output still has to pass
+  // through. Returns kMaxBlobSize if separating nothing is the cheapest, and
+  // min_blob_size if the histogram is empty.
+  size_t PickBlobSize(double write_weight, double rewrite_ratio,
+                      size_t min_blob_size) const;
+
+  std::string ToString() const;
+
+ private:
+  static size_t BucketIndex(uint64_t value_size);
+
+  uint64_t count_[kNumBuckets] = {};
+  uint64_t bytes_[kNumBuckets] = {};
+};
+
+// Collects the sizes of put and merge values into
+// TablePropertiesNames::kValueSizeHistogram. Separated values are counted by
+// the blob sst holding them.
+extern IntTblPropCollectorFactory* NewValueSizeHistogramCollectorFactory();
+
 }  // namespace TERARKDB_NAMESPACE
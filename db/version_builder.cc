@@ -47,6 +47,13 @@ bool NewestFirstBySeqNo(FileMetaData* a, FileMetaData* b) {
 }
 
 namespace {
+// Partitions of one flush don't overlap and share the seqno range of the
+// whole flush
+bool IsSameFlushPartitions(FileMetaData* a, FileMetaData* b) {
+  return a->fd.smallest_seqno == b->fd.smallest_seqno &&
+         a->fd.largest_seqno == b->fd.largest_seqno;
+}
+
 bool BySmallestKey(FileMetaData* a, FileMetaData* b,
                    const InternalKeyComparator* cmp) {
   int r = cmp->Compare(a->smallest, b->smallest);
@@ -262,8 +269,16 @@ class VersionBuilder::Rep {
     } else {
       auto& item = ib.first->second;
       item.level = level;
-      context_->UnrefFile(item.f);
-      item.f = f;
+      if (item.f->prop.inheritance != f->prop.inheritance) {
+        // re-added with an inheritance from before ShrinkInheritance
+        DelInheritance(item.f);
+        context_->UnrefFile(item.f);
+        item.f = f;
+        PutInheritance(&item, ib.first.pos());
+      } else {
+        context_->UnrefFile(item.f);
+        item.f = f;
+      }
     }
     if (level >= 0) {
       context_->levels[level].emplace(file_number, f);
@@ -436,11 +451,62 @@ class VersionBuilder::Rep {
         context_->maintainer_job_limit -= f->fd.GetFileSize();
         f->marked_for_compaction |= FileMetaData::kMarkedFromUpdateBlob;
       }
+      ShrinkInheritance();
     }
 
     context_->new_deleted_files = 0;
   }
 
+  // Once the files depending on an ancestor of a blob sst are rewritten (by
+  // kMarkedFromUpdateBlob compactions) or dropped, nothing can depend on that
+  // ancestor again: new files only take dependences from their inputs. Drop
+  // such entries from the inheritance, otherwise they stay in memory and in
+  // every manifest snapshot until the blob sst is GC-ed again, which never
+  // happens to a blob sst without garbage.
+  void ShrinkInheritance() {
+    auto& inheritance_counter = context_->inheritance_counter;
+    auto is_obsolete = [&](uint64_t file_number) {
+      auto find = inheritance_counter.find(file_number);
+      assert(find != inheritance_counter.end());
+      return !find->second.depended;
+    };
+    for (auto& pair : context_->dependence_map) {
+      auto& item = pair.second;
+      auto& inheritance = item.f->prop.inheritance;
+      if (item.f->being_compacted ||
+          std::none_of(inheritance.begin(), inheritance.end(), is_obsolete)) {
+        continue;
+      }
+      if (item.f->refs > 1) {
+        // other versions keep the old inheritance
+        auto f = new FileMetaData(*item.f);
+        f->table_reader_handle = nullptr;
+        f->refs = 1;
+        context_->UnrefFile(item.f);
+        item.f = f;
+        if (item.level >= 0) {
+          context_->levels[item.level][pair.first] = f;
+        }
+      }
+      auto& new_inheritance = item.f->prop.inheritance;
+      new_inheritance.erase(
+          std::remove_if(new_inheritance.begin(), new_inheritance.end(),
+                         [&](uint64_t file_number) {
+                           auto find = inheritance_counter.find(file_number);
+                           assert(find != inheritance_counter.end());
+                           if (find->second.depended) {
+                             return false;
+                           }
+                           if (--find->second.count == 0) {
+                             inheritance_counter.erase(find);
+                           }
+                           return true;
+                         }),
+          new_inheritance.end());
+      new_inheritance.shrink_to_fit();
+    }
+  }
+
   void CheckDependence(VersionStorageInfo* vstorage, FileMetaData* f,
                        bool is_map) {
     for (auto& dependence : f->prop.dependence) {
@@ -495,7 +561,8 @@ class VersionBuilder::Rep {
                       external_file_seqno);
               abort();
             }
-          } else if (f1->fd.smallest_seqno <= f2->fd.smallest_seqno) {
+          } else if (f1->fd.smallest_seqno <= f2->fd.smallest_seqno &&
+                     !IsSameFlushPartitions(f1, f2)) {
             fprintf(stderr,
                     "L0 files seqno %" PRIu64 " %" PRIu64 " vs. %" PRIu64
                     " %" PRIu64 "\n",
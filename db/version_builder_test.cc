@@ -397,6 +397,46 @@ TEST_F(VersionBuilderTest, ApplyDeleteAndSaveTo) {
   UnrefFilesInVersion(&new_vstorage);
 }
 
+TEST_F(VersionBuilderTest, ShrinkInheritance) {
+  // Blob sst 10 is the GC output of 3 and 4, key sst 1 still points at 3
+  Add(1, 1U, "100", "199", 100U, 0, 100U, 100U, 1, 0, 0, 0,
+      GetPropCache(kEssenceSst, {3U}));
+  Add(-1, 10U, "100", "199", 100U, 0, 100U, 100U, 1, 0, 0, 0,
+      GetPropCache(kEssenceSst, {}, {3U, 4U}));
+  UpdateVersionStorageInfo();
+
+  EnvOptions env_options;
+  VersionBuilder version_builder(env_options, nullptr, &vstorage_);
+  VersionStorageInfo new_vstorage(&icmp_, ucmp_, options_.num_levels,
+                                  kCompactionStyleLevel, false);
+  version_builder.SaveTo(&new_vstorage, 0);
+
+  ASSERT_EQ(1U, new_vstorage.LevelFiles(-1).size());
+  ASSERT_EQ(std::vector<uint64_t>{3U},
+            new_vstorage.LevelFiles(-1)[0]->prop.inheritance);
+  ASSERT_EQ(2U, vstorage_.LevelFiles(-1)[0]->prop.inheritance.size());
+  ASSERT_TRUE(VerifyDependFiles(&new_vstorage, {1U, 10U, 3U}));
+
+  // Key sst 1 rewritten to point at 10
+  VersionEdit version_edit;
+  version_edit.AddFile(1, 2U, 0, 100U, GetInternalKey("100"),
+                       GetInternalKey("199"), 200, 200, false,
+                       GetPropCache(kEssenceSst, {10U}));
+  version_edit.DeleteFile(1, 1U);
+  VersionBuilder version_builder2(env_options, nullptr, &new_vstorage);
+  VersionStorageInfo new_vstorage2(&icmp_, ucmp_, options_.num_levels,
+                                   kCompactionStyleLevel, false);
+  version_builder2.Apply(&version_edit);
+  version_builder2.SaveTo(&new_vstorage2, 0);
+
+  ASSERT_EQ(1U, new_vstorage2.LevelFiles(-1).size());
+  ASSERT_TRUE(new_vstorage2.LevelFiles(-1)[0]->prop.inheritance.empty());
+  ASSERT_TRUE(VerifyDependFiles(&new_vstorage2, {2U, 10U}));
+
+  UnrefFilesInVersion(&new_vstorage2);
+  UnrefFilesInVersion(&new_vstorage);
+}
+
 TEST_F(VersionBuilderTest, EstimatedActiveKeys) {
   // const uint32_t kTotalSamples = 20;
   const uint32_t kNumLevels = 5;
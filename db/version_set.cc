@@ -32,6 +32,7 @@
 #include "db/table_cache.h"
 #include "db/version_builder.h"
 #include "monitoring/file_read_sample.h"
+#include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
 #include "rocksdb/env.h"
@@ -71,6 +72,13 @@ int FindFileInRange(const InternalKeyComparator& icmp,
                                TERARK_FIELD(largest_key), "" < icmp));
 }
 
+// The partitions of one flush share the seqno range of the whole flush and
+// don't overlap, so they are a single sorted run of level 0
+bool IsSameFlushPartitions(const FileMetaData* a, const FileMetaData* b) {
+  return a->fd.smallest_seqno == b->fd.smallest_seqno &&
+         a->fd.largest_seqno == b->fd.largest_seqno;
+}
+
 Status OverlapWithIterator(const Comparator* ucmp,
                            const Slice& smallest_user_key,
                            const Slice& largest_user_key,
@@ -1269,69 +1277,404 @@ Version::Version(ColumnFamilyData* column_family_data, VersionSet* vset,
       mutable_cf_options_(mutable_cf_options),
       version_number_(version_number) {}
 
+namespace {
+// The fetch context of a separated value holds the user key data, the user
+// key size with the location of the value above the low 32 bits, the
+// sequence and the dependence map entry of the blob sst
+LazyBufferContext SeparateValueContext(
+    const Slice& user_key, uint64_t sequence, uint64_t location,
+    const DependenceMap::value_type& dependence) {
+  uint64_t size_and_location = user_key.size();
+  if (location < port::kMaxUint32 && user_key.size() <= port::kMaxUint32) {
+    size_and_location |= (location + 1) << 32;
+  }
+  return {reinterpret_cast<uint64_t>(user_key.data()), size_and_location,
+          sequence, reinterpret_cast<uint64_t>(&dependence)};
+}
+
+Slice SeparateValueUserKey(const LazyBufferContext& context) {
+  return Slice(reinterpret_cast<const char*>(context.data[0]),
+               context.data[1] & port::kMaxUint32);
+}
+
+uint64_t SeparateValueLocation(const LazyBufferContext& context) {
+  uint64_t location = context.data[1] >> 32;
+  return location == 0 ? SeparateHelper::kNoLocation : location - 1;
+}
+
+// The location recorded in a value index is only good for the blob sst that
+// was written along with it, GC moves values elsewhere
+uint64_t SeparateValueLocation(const Slice& value_index,
+                               const FileMetaData& blob) {
+  if (SeparateHelper::DecodeFileNumber(value_index) != blob.fd.GetNumber()) {
+    return SeparateHelper::kNoLocation;
+  }
+  return SeparateHelper::DecodeLocation(value_index);
+}
+
+// Accounts a separated value fetch in statistics, perf context and the
+// metrics reporters
+class SeparateValueFetchGuard {
+ public:
+  SeparateValueFetchGuard(const VersionSet* vset, Env* env,
+                          Statistics* statistics)
+      : statistics_(statistics),
+        perf_timer_(&(perf_context.separate_value_fetch_time)),
+        stop_watch_(env, statistics, SEPARATE_VALUE_FETCH_MICROS),
+        latency_guard_(vset->separate_value_fetch_latency_reporter()) {
+    perf_timer_.Start();
+    vset->separate_value_fetch_qps_reporter()->AddCount(1);
+  }
+
+  const Status& Finish(const Status& s, const LazyBuffer* buffer) {
+    if (s.ok()) {
+      RecordTick(statistics_, SEPARATE_VALUE_FETCH);
+      RecordTick(statistics_, SEPARATE_VALUE_FETCH_BYTES, buffer->size());
+      MeasureTime(statistics_, SEPARATE_VALUE_SIZE, buffer->size());
+      PERF_COUNTER_ADD(separate_value_fetch_count, 1);
+      PERF_COUNTER_ADD(separate_value_fetch_bytes, buffer->size());
+    } else if (s.IsCorruption()) {
+      RecordTick(statistics_, SEPARATE_VALUE_MISSING);
+    }
+    return s;
+  }
+
+ private:
+  Statistics* statistics_;
+  PerfStepTimer perf_timer_;
+  StopWatch stop_watch_;
+  LatencyHistGuard latency_guard_;
+};
+}  // namespace
+
 Status Version::fetch_buffer(LazyBuffer* buffer) const {
+  LazyBufferContext context = *get_context(buffer);
+  if (GetFromBlobPersistentCache(context, buffer)) {
+    return Status::OK();
+  }
+  SeparateValueFetchGuard guard(vset_, env_, db_statistics_);
+  auto s = guard.Finish(FetchSeparatedValue(buffer), buffer);
+  if (s.ok()) {
+    InsertBlobCache(context, buffer->slice());
+  }
+  return s;
+}
+
+bool Version::GetFromBlobPersistentCache(const LazyBufferContext& context,
+                                         LazyBuffer* buffer) const {
+  Slice user_key = SeparateValueUserKey(context);
+  auto& pair = *reinterpret_cast<DependenceMap::value_type*>(context.data[3]);
+  return table_cache_->GetFromBlobPersistentCache(
+      user_key, context.data[2], pair.first, pair.second->fd.GetNumber(),
+      buffer);
+}
+
+void Version::InsertBlobCache(const LazyBufferContext& context,
+                              const Slice& value) const {
+  Slice user_key = SeparateValueUserKey(context);
+  auto& pair = *reinterpret_cast<DependenceMap::value_type*>(context.data[3]);
+  table_cache_->InsertBlobCache(user_key, context.data[2], pair.first, value);
+}
+
+Status Version::FetchSeparatedValue(LazyBuffer* buffer) const {
   auto context = get_context(buffer);
-  Slice user_key(reinterpret_cast<const char*>(context->data[0]),
-                 context->data[1]);
+  Slice user_key = SeparateValueUserKey(*context);
   uint64_t sequence = context->data[2];
+  uint64_t location = SeparateValueLocation(*context);
   auto pair = *reinterpret_cast<DependenceMap::value_type*>(context->data[3]);
-  bool value_found = false;
-  SequenceNumber context_seq;
-  GetContext get_context(cfd_->internal_comparator().user_comparator(), nullptr,
-                         cfd_->ioptions()->info_log, db_statistics_,
-                         GetContext::kNotFound, user_key, buffer, &value_found,
-                         nullptr, nullptr, nullptr, env_, &context_seq);
   IterKey iter_key;
   iter_key.SetInternalKey(user_key, sequence, kValueTypeForSeek);
-  auto s = table_cache_->Get(
-      ReadOptions(), cfd_->internal_comparator(), *pair.second,
-      storage_info_.dependence_map(), iter_key.GetInternalKey(), &get_context,
-      mutable_cf_options_.prefix_extractor.get(), nullptr, true);
-  if (!s.ok()) {
-    return s;
-  }
-  if (context_seq != sequence || (get_context.State() != GetContext::kFound &&
-                                  get_context.State() != GetContext::kMerge)) {
-    if (get_context.State() == GetContext::kCorrupt) {
-      return std::move(get_context).CorruptReason();
+  auto fetch = [&](uint64_t at) -> Status {
+    bool value_found = false;
+    SequenceNumber context_seq;
+    GetContext get_context(cfd_->internal_comparator().user_comparator(),
+                           nullptr, cfd_->ioptions()->info_log,
+                           db_statistics_, GetContext::kNotFound, user_key,
+                           buffer, &value_found, nullptr, nullptr, nullptr,
+                           env_, &context_seq);
+    Status s;
+    if (at != SeparateHelper::kNoLocation) {
+      s = table_cache_->GetAtLocation(
+          ReadOptions(), cfd_->internal_comparator(), *pair.second,
+          iter_key.GetInternalKey(), at, &get_context,
+          mutable_cf_options_.prefix_extractor.get());
     } else {
-      char buf[128];
-      snprintf(buf, sizeof buf,
-               "file number = %" PRIu64 "(%" PRIu64 "), sequence = %" PRIu64,
-               pair.second->fd.GetNumber(), pair.first, sequence);
-      return Status::Corruption("Separate value missing", buf);
+      s = table_cache_->Get(ReadOptions(), cfd_->internal_comparator(),
+                            *pair.second, storage_info_.dependence_map(),
+                            iter_key.GetInternalKey(), &get_context,
+                            mutable_cf_options_.prefix_extractor.get(),
+                            nullptr, true);
     }
+    if (!s.ok()) {
+      return s;
+    }
+    if (context_seq != sequence ||
+        (get_context.State() != GetContext::kFound &&
+         get_context.State() != GetContext::kMerge)) {
+      if (get_context.State() == GetContext::kCorrupt) {
+        return std::move(get_context).CorruptReason();
+      } else {
+        char buf[128];
+        snprintf(buf, sizeof buf,
+                 "file number = %" PRIu64 "(%" PRIu64 "), sequence = %" PRIu64,
+                 pair.second->fd.GetNumber(), pair.first, sequence);
+        return Status::Corruption("Separate value missing", buf);
+      }
+    }
+    assert(buffer->file_number() == pair.second->fd.GetNumber());
+    return Status::OK();
+  };
+  // A location gone bad only costs the keyed lookup
+  if (location != SeparateHelper::kNoLocation && fetch(location).ok()) {
+    return Status::OK();
   }
-  assert(buffer->file_number() == pair.second->fd.GetNumber());
-  return Status::OK();
+  return fetch(SeparateHelper::kNoLocation);
+}
+
+Status Version::PrefetchSeparatedValues(uint64_t file_number,
+                                        const Slice* user_keys,
+                                        const SequenceNumber* sequences,
+                                        size_t num_keys) const {
+  auto& dependence_map = storage_info_.dependence_map();
+  auto find = dependence_map.find(file_number);
+  if (find == dependence_map.end() || find->second->prop.is_map_sst()) {
+    return Status::OK();
+  }
+  std::vector<std::string> key_bufs(num_keys);
+  std::vector<Slice> keys(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    AppendInternalKey(&key_bufs[i], ParsedInternalKey(user_keys[i],
+                                                      sequences[i],
+                                                      kValueTypeForSeek));
+    keys[i] = key_bufs[i];
+  }
+  auto& fd = find->second->fd;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (table_reader == nullptr) {
+    Status s = table_cache_->FindTable(
+        env_options_, cfd_->internal_comparator(), fd, &handle,
+        mutable_cf_options_.prefix_extractor.get(), false /* no_io */,
+        true /* record_read_stats */, nullptr /* file_read_hist */,
+        true /* skip_filters */);
+    if (!s.ok()) {
+      return s;
+    }
+    table_reader = table_cache_->GetTableReaderFromHandle(handle);
+  }
+  // Same options as the fetches in FetchSeparatedValue()
+  Status s =
+      table_reader->PrefetchForKeys(ReadOptions(), keys.data(), keys.size());
+  if (handle != nullptr) {
+    table_cache_->ReleaseHandle(handle);
+  }
+  return s;
 }
 
 LazyBuffer Version::TransToCombined(const Slice& user_key, uint64_t sequence,
                                     const LazyBuffer& value) const {
+  return TransToCombined(user_key, sequence, value, this);
+}
+
+LazyBuffer Version::TransToCombined(const Slice& user_key, uint64_t sequence,
+                                    const LazyBuffer& value,
+                                    const LazyBufferState* state) const {
   auto s = value.fetch();
   if (!s.ok()) {
     return LazyBuffer(std::move(s));
   }
   uint64_t file_number = SeparateHelper::DecodeFileNumber(value.slice());
   auto& dependence_map = storage_info_.dependence_map();
+  RecordTick(db_statistics_, READ_DEPENDENCE_MAP_LOOKUP);
+  PERF_COUNTER_ADD(dependence_map_lookup_count, 1);
   auto find = dependence_map.find(file_number);
   if (find == dependence_map.end()) {
+    RecordTick(db_statistics_, SEPARATE_VALUE_MISSING);
     return LazyBuffer(Status::Corruption("Separate value dependence missing"));
+  }
+  LazyBuffer cached;
+  if (table_cache_->GetFromBlobCache(user_key, sequence, file_number,
+                                     find->second->fd.GetNumber(), &cached)) {
+    return cached;
   } else {
     return LazyBuffer(
-        this,
-        {reinterpret_cast<uint64_t>(user_key.data()), user_key.size(), sequence,
-         reinterpret_cast<uint64_t>(&*find)},
+        state,
+        SeparateValueContext(
+            user_key, sequence,
+            SeparateValueLocation(value.slice(), *find->second), *find),
         Slice::Invalid(), find->second->fd.GetNumber());
   }
 }
 
+// Reads the separated values of a scan through read-ahead iterators of the
+// blob files. Values are stored in key order inside a blob file, so the
+// values a scan needs from a blob file are usually a few entries apart,
+// stepping the blob file iterator forward turns a random read per value into
+// sequential reads.
+class BlobScanHelper : public SeparateHelper, private LazyBufferState {
+ public:
+  // Blob files fetched less than this are read by Version::fetch_buffer,
+  // a short scan shouldn't pay for opening a read-ahead table reader
+  static constexpr uint32_t kMinFetchesBeforeReadahead = 3;
+  // Step the blob file iterator forward at most this many entries before
+  // falling back to Seek
+  static constexpr uint32_t kMaxSequentialSkip = 16;
+  // Read-ahead iterators kept open, least recently used ones are closed
+  static constexpr size_t kMaxBlobIterators = 8;
+
+  BlobScanHelper(const Version* version, const ReadOptions& read_options)
+      : version_(version) {
+    read_options_.verify_checksums = read_options.verify_checksums;
+    read_options_.fill_cache = read_options.fill_cache;
+    read_options_.read_tier = read_options.read_tier;
+    read_options_.readahead_size = read_options.blob_readahead_size;
+    read_options_.total_order_seek = true;
+  }
+
+  ~BlobScanHelper() override {
+    for (auto& blob : blobs_) {
+      delete blob.iter;
+    }
+  }
+
+  LazyBuffer TransToCombined(const Slice& user_key, uint64_t sequence,
+                             const LazyBuffer& value) const override {
+    return version_->TransToCombined(user_key, sequence, value, this);
+  }
+
+ private:
+  struct BlobIterator {
+    uint64_t file_number;
+    uint32_t fetch_count;
+    InternalIterator* iter;
+  };
+
+  void destroy(LazyBuffer* /*buffer*/) const override {}
+
+  // The buffer may outlive the iterator, hand it over to the version
+  Status pin_buffer(LazyBuffer* buffer) const override {
+    LazyBufferContext context = *get_context(buffer);
+    buffer->reset(static_cast<const LazyBufferState*>(version_), context,
+                  Slice::Invalid(), buffer->file_number());
+    return Status::OK();
+  }
+
+  Status fetch_buffer(LazyBuffer* buffer) const override {
+    LazyBufferContext context = *get_context(buffer);
+    if (version_->GetFromBlobPersistentCache(context, buffer)) {
+      return Status::OK();
+    }
+    SeparateValueFetchGuard guard(version_->vset_, version_->env_,
+                                  version_->db_statistics_);
+    auto s = guard.Finish(ReadAhead(buffer), buffer);
+    if (s.ok() && read_options_.fill_cache) {
+      version_->InsertBlobCache(context, buffer->slice());
+    }
+    return s;
+  }
+
+  Status ReadAhead(LazyBuffer* buffer) const {
+    auto context = get_context(buffer);
+    Slice user_key = SeparateValueUserKey(*context);
+    uint64_t sequence = context->data[2];
+    auto& pair = *reinterpret_cast<DependenceMap::value_type*>(context->data[3]);
+    InternalIterator* iter = GetBlobIterator(*pair.second);
+    if (iter == nullptr) {
+      return version_->FetchSeparatedValue(buffer);
+    }
+    auto& icomp = version_->cfd_->internal_comparator();
+    iter_key_.SetInternalKey(user_key, sequence, kValueTypeForSeek);
+    Slice target = iter_key_.GetInternalKey();
+    uint64_t prev_bytes_read = IOSTATS(bytes_read);
+    bool need_seek = true;
+    if (iter->Valid() && icomp.Compare(iter->key(), target) <= 0) {
+      for (uint32_t i = 0; i < kMaxSequentialSkip; ++i) {
+        if (icomp.Compare(iter->key(), target) >= 0) {
+          need_seek = false;
+          break;
+        }
+        iter->Next();
+        if (!iter->Valid()) {
+          break;
+        }
+      }
+    }
+    if (need_seek) {
+      iter->Seek(target);
+    }
+    PERF_COUNTER_ADD(blob_prefetch_read_bytes,
+                     IOSTATS(bytes_read) - prev_bytes_read);
+    ParsedInternalKey ikey;
+    if (!iter->Valid() || !ParseInternalKey(iter->key(), &ikey) ||
+        ikey.sequence != sequence ||
+        (ikey.type != kTypeValue && ikey.type != kTypeMerge) ||
+        icomp.user_comparator()->Compare(ikey.user_key, user_key) != 0) {
+      // Let the version report the error
+      return version_->FetchSeparatedValue(buffer);
+    }
+    LazyBuffer value = iter->value();
+    auto s = value.fetch();
+    if (!s.ok()) {
+      return s;
+    }
+    PERF_COUNTER_ADD(blob_prefetch_used_bytes, value.size());
+    buffer->reset(value.slice(), true /* copy */, pair.second->fd.GetNumber());
+    return Status::OK();
+  }
+
+  // Return nullptr if the blob file doesn't deserve a read-ahead iterator yet
+  InternalIterator* GetBlobIterator(const FileMetaData& f) const {
+    uint64_t file_number = f.fd.GetNumber();
+    auto it = std::find_if(blobs_.begin(), blobs_.end(),
+                           [file_number](const BlobIterator& blob) {
+                             return blob.file_number == file_number;
+                           });
+    if (it == blobs_.end()) {
+      if (blobs_.size() >= kMaxBlobIterators) {
+        delete blobs_.front().iter;
+        blobs_.erase(blobs_.begin());
+      }
+      blobs_.emplace_back(BlobIterator{file_number, 0, nullptr});
+    } else if (it + 1 != blobs_.end()) {
+      // Most recently used goes back
+      std::rotate(it, it + 1, blobs_.end());
+    }
+    auto& blob = blobs_.back();
+    if (blob.iter == nullptr &&
+        ++blob.fetch_count >= kMinFetchesBeforeReadahead) {
+      auto cfd = version_->cfd_;
+      blob.iter = version_->table_cache_->NewIterator(
+          read_options_, version_->env_options_, cfd->internal_comparator(), f,
+          version_->storage_info_.dependence_map(),
+          nullptr /* range_del_agg */,
+          version_->mutable_cf_options_.prefix_extractor.get(),
+          nullptr /* table_reader_ptr */, nullptr /* file_read_hist */,
+          false /* for_compaction */, nullptr /* arena */,
+          true /* skip_filters */, -1 /* level */);
+    }
+    return blob.iter;
+  }
+
+  const Version* version_;
+  ReadOptions read_options_;
+  mutable std::vector<BlobIterator> blobs_;
+  mutable IterKey iter_key_;
+};
+
+SeparateHelper* Version::NewScanHelper(const ReadOptions& read_options) const {
+  if (read_options.blob_readahead_size == 0 ||
+      storage_info_.LevelFiles(-1).empty()) {
+    return nullptr;
+  }
+  return new BlobScanHelper(this, read_options);
+}
+
 void Version::Get(const ReadOptions& read_options, const Slice& user_key,
                   const LookupKey& k, LazyBuffer* value, Status* status,
                   MergeContext* merge_context,
                   SequenceNumber* max_covering_tombstone_seq, bool* value_found,
                   bool* key_exists, SequenceNumber* seq,
-                  ReadCallback* callback) {
+                  ReadCallback* callback, bool defer_separated_fetch) {
   Slice ikey = k.internal_key();
 
   assert(status->ok() || status->IsMergeInProgress());
@@ -1346,6 +1689,7 @@ void Version::Get(const ReadOptions& read_options, const Slice& user_key,
       status->ok() ? GetContext::kNotFound : GetContext::kMerge, user_key,
       value, value_found, merge_context, this, max_covering_tombstone_seq,
       this->env_, seq, callback);
+  get_context.SetDeferSeparatedFetch(defer_separated_fetch);
 
   FilePicker fp(
       storage_info_.files_, user_key, ikey, &storage_info_.level_files_brief_,
@@ -1781,10 +2125,15 @@ void VersionStorageInfo::ComputeCompactionScore(
       // overwrites/deletions).
       int num_sorted_runs = 0;
       uint64_t total_size = 0;
+      const FileMetaData* last_counted = nullptr;
       for (auto* f : files_[level]) {
         if (!f->being_compacted) {
           total_size += f->compensated_file_size;
-          num_sorted_runs++;
+          if (last_counted == nullptr ||
+              !IsSameFlushPartitions(last_counted, f)) {
+            num_sorted_runs++;
+          }
+          last_counted = f;
         }
       }
       if (compaction_style_ == kCompactionStyleUniversal) {
@@ -2683,7 +3032,12 @@ void VersionStorageInfo::CalculateBaseBytes(const ImmutableCFOptions& ioptions,
                                             const MutableCFOptions& options) {
   // Special logic to set number of sorted runs.
   // It is to match the previous behavior when all files are in L0.
-  int num_l0_count = static_cast<int>(files_[0].size());
+  int num_l0_count = 0;
+  for (size_t i = 0; i < files_[0].size(); ++i) {
+    if (i == 0 || !IsSameFlushPartitions(files_[0][i - 1], files_[0][i])) {
+      num_l0_count++;
+    }
+  }
   if (compaction_style_ == kCompactionStyleUniversal &&
       !ioptions.enable_lazy_compaction) {
     // For universal compaction, we use level0 score to indicate
@@ -2935,10 +3289,11 @@ VersionSet::VersionSet(const std::string& dbname,
                        const EnvOptions& storage_options, bool seq_per_batch,
                        Cache* table_cache,
                        WriteBufferManager* write_buffer_manager,
-                       WriteController* write_controller)
-    : column_family_set_(
-          new ColumnFamilySet(dbname, _db_options, storage_options, table_cache,
-                              write_buffer_manager, write_controller)),
+                       WriteController* write_controller,
+                       BlockCacheTracer* const block_cache_tracer)
+    : column_family_set_(new ColumnFamilySet(
+          dbname, _db_options, storage_options, table_cache,
+          write_buffer_manager, write_controller, block_cache_tracer)),
       env_(_db_options->env),
       dbname_(dbname),
       db_options_(_db_options),
@@ -2954,7 +3309,9 @@ VersionSet::VersionSet(const std::string& dbname,
       manifest_file_size_(0),
       manifest_edit_count_(0),
       seq_per_batch_(seq_per_batch),
-      env_options_(storage_options) {}
+      env_options_(storage_options),
+      separate_value_fetch_latency_reporter_(DummyHistReporterHandle()),
+      separate_value_fetch_qps_reporter_(DummyCountReporterHandle()) {}
 
 void CloseTables(void* ptr, size_t) {
   TableReader* table_reader = reinterpret_cast<TableReader*>(ptr);
@@ -3356,6 +3713,15 @@ Status VersionSet::ProcessManifestWrites(std::deque<ManifestWriter>& writers,
       for (int i = 0; i < static_cast<int>(versions.size()); ++i) {
         ColumnFamilyData* cfd = versions[i]->cfd_;
         AppendVersion(cfd, versions[i]);
+        if (cfd->ttl_gc_queue_initialized()) {
+          for (auto e : batch_edits) {
+            if (e->column_family_ == cfd->GetID()) {
+              for (auto& pair : e->GetNewFiles()) {
+                cfd->AddToTtlGCQueue(pair.first, pair.second);
+              }
+            }
+          }
+        }
       }
     }
     manifest_file_number_ = pending_manifest_file_number_;
@@ -3934,6 +4300,9 @@ Status VersionSet::Recover(
       // Install recovered version
       v->PrepareApply(*cfd->GetLatestMutableCFOptions());
       AppendVersion(cfd, v);
+      if (cfd->GetLatestMutableCFOptions()->enable_adaptive_blob_size) {
+        cfd->InitValueSizeHistogram(v);
+      }
     }
 
     manifest_file_size_ = current_manifest_file_size;
@@ -45,6 +45,7 @@
 #include "options/db_options.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
+#include "rocksdb/metrics_reporter.h"
 #include "rocksdb/terark_namespace.h"
 
 namespace TERARKDB_NAMESPACE {
@@ -53,6 +54,8 @@ namespace log {
 class Writer;
 }
 
+class BlobScanHelper;
+class BlockCacheTracer;
 class Compaction;
 class LogBuffer;
 class LookupKey;
@@ -662,13 +665,23 @@ class Version : public SeparateHelper, private LazyBufferState {
   //                      *key_exists will be set to false.
   // If seq is non-null, *seq will be set to the sequence number found
   // for the key if a key was found.
+  // If defer_separated_fetch is true, a separated value may be returned
+  // unfetched, the caller must fetch it while this version is still alive.
   //
   // REQUIRES: lock is not held
   void Get(const ReadOptions&, const Slice& user_key, const LookupKey& key,
            LazyBuffer* value, Status* status, MergeContext* merge_context,
            SequenceNumber* max_covering_tombstone_seq,
            bool* value_found = nullptr, bool* key_exists = nullptr,
-           SequenceNumber* seq = nullptr, ReadCallback* callback = nullptr);
+           SequenceNumber* seq = nullptr, ReadCallback* callback = nullptr,
+           bool defer_separated_fetch = false);
+
+  // Read the blocks holding the separated values of (user_keys[i],
+  // sequences[i]) from blob sst file_number together, before fetching them
+  // one by one. The keys must be sorted.
+  Status PrefetchSeparatedValues(uint64_t file_number, const Slice* user_keys,
+                                 const SequenceNumber* sequences,
+                                 size_t num_keys) const;
 
   void GetKey(const Slice& user_key, const Slice& ikey, Status* status,
               ValueType* type, SequenceNumber* seq, LazyBuffer* value,
@@ -815,9 +828,31 @@ class Version : public SeparateHelper, private LazyBufferState {
 
   Status fetch_buffer(LazyBuffer* buffer) const override;
 
+  // fetch_buffer without accounting the fetch in statistics
+  Status FetchSeparatedValue(LazyBuffer* buffer) const;
+
+  // Serve the value of a TransToCombined context from the blob persistent
+  // cache, returns false on miss
+  bool GetFromBlobPersistentCache(const LazyBufferContext& context,
+                                  LazyBuffer* buffer) const;
+
+  // Insert the value fetched for a TransToCombined context into the blob cache
+  void InsertBlobCache(const LazyBufferContext& context,
+                       const Slice& value) const;
+
   LazyBuffer TransToCombined(const Slice& user_key, uint64_t sequence,
                              const LazyBuffer& value) const override;
 
+  // TransToCombined with the buffers fetched by state instead of the version
+  LazyBuffer TransToCombined(const Slice& user_key, uint64_t sequence,
+                             const LazyBuffer& value,
+                             const LazyBufferState* state) const;
+
+  SeparateHelper* NewScanHelper(
+      const ReadOptions& read_options) const override;
+
+  friend class BlobScanHelper;
+
   // No copying allowed
   Version(const Version&);
   void operator=(const Version&);
@@ -861,7 +896,8 @@ class VersionSet {
   VersionSet(const std::string& dbname, const ImmutableDBOptions* db_options,
              const EnvOptions& env_options, bool seq_per_batch,
              Cache* table_cache, WriteBufferManager* write_buffer_manager,
-             WriteController* write_controller);
+             WriteController* write_controller,
+             BlockCacheTracer* const block_cache_tracer = nullptr);
   ~VersionSet();
 
   // Apply *edit to the current version to form a new descriptor that
@@ -1098,6 +1134,13 @@ class VersionSet {
 
   const ImmutableDBOptions* db_options() const { return db_options_; }
 
+  HistReporterHandle* separate_value_fetch_latency_reporter() const {
+    return separate_value_fetch_latency_reporter_;
+  }
+  CountReporterHandle* separate_value_fetch_qps_reporter() const {
+    return separate_value_fetch_qps_reporter_;
+  }
+
   static uint64_t GetNumLiveVersions(Version* dummy_versions);
 
   static uint64_t GetTotalSstFilesSize(Version* dummy_versions);
@@ -1202,6 +1245,11 @@ class VersionSet {
   // env options for all reads and writes except compactions
   EnvOptions env_options_;
 
+  // Separated value fetches of the versions are reported here, DBImpl points
+  // them at its own reporters
+  HistReporterHandle* separate_value_fetch_latency_reporter_;
+  CountReporterHandle* separate_value_fetch_qps_reporter_;
+
   // No copying allowed
   VersionSet(const VersionSet&);
   void operator=(const VersionSet&);
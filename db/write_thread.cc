@@ -628,7 +628,8 @@ void WriteThread::ExitAsBatchGroupFollower(Writer* w) {
 
   assert(w->state == STATE_PARALLEL_MEMTABLE_WRITER);
   assert(write_group->status.ok());
-  ExitAsBatchGroupLeader(*write_group, write_group->status);
+  // A failed WAL stream record fails the whole group
+  ExitAsBatchGroupLeader(*write_group, write_group->stream_status);
   assert(w->status.ok());
   assert(w->state == STATE_COMPLETED);
   SetState(write_group->leader, STATE_COMPLETED);
@@ -28,6 +28,10 @@
 
 namespace TERARKDB_NAMESPACE {
 
+namespace log {
+class Writer;
+}  // namespace log
+
 class WriteThread {
  public:
   enum State : uint8_t {
@@ -80,6 +84,15 @@ class WriteThread {
     Writer* leader = nullptr;
     Writer* last_writer = nullptr;
     SequenceNumber last_sequence;
+    // Set when the members of a parallel group log to their own WAL streams.
+    log::Writer* log_writer = nullptr;
+    // The members insert into memtables only after all stream records are
+    // written, stream_status is the first record error. Both need
+    // stream_mutex
+    size_t pending_stream_records = 0;
+    Status stream_status;
+    std::mutex stream_mutex;
+    std::condition_variable stream_cv;
     // before running goes to zero, status needs leader->StateMutex()
     Status status;
     std::atomic<size_t> running;
@@ -131,6 +144,8 @@ class WriteThread {
     SequenceNumber sequence;  // the sequence number to use for the first key
     Status status;            // status of memtable inserter
     Status callback_status;   // status returned by callback->Callback()
+    size_t wal_stream;        // WAL stream picked for this writer
+    bool log_to_stream;  // logs the batches of its stream in a parallel group
 
     std::aligned_storage<sizeof(std::mutex)>::type state_mutex_bytes;
     std::aligned_storage<sizeof(std::condition_variable)>::type state_cv_bytes;
@@ -152,6 +167,8 @@ class WriteThread {
           state(STATE_INIT),
           write_group(nullptr),
           sequence(kMaxSequenceNumber),
+          wal_stream(0),
+          log_to_stream(false),
           link_older(nullptr),
           link_newer(nullptr) {}
 
@@ -173,6 +190,8 @@ class WriteThread {
           state(STATE_INIT),
           write_group(nullptr),
           sequence(kMaxSequenceNumber),
+          wal_stream(0),
+          log_to_stream(false),
           link_older(nullptr),
           link_newer(nullptr) {}
 
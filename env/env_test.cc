@@ -36,6 +36,10 @@
 #ifdef ROCKSDB_FALLOCATE_PRESENT
 #include <errno.h>
 #endif
+#if defined(OS_LINUX) && defined(WITH_BOOSTLIB) && !defined(WITH_TERARK_ZIP)
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+#endif
 
 #include "env/env_chroot.h"
 #include "port/port.h"
@@ -845,6 +849,59 @@ TEST_F(EnvPosixTest, PositionedAppend) {
 }
 #endif  // !ROCKSDB_LITE
 
+#if defined(OS_LINUX) && defined(WITH_BOOSTLIB) && !defined(WITH_TERARK_ZIP)
+// Fibers read through io_uring, or through pread on kernels without it
+TEST_F(EnvPosixTest, FiberAioReads) {
+  const std::string fname = test::PerThreadDBPath(env_, "fiber_aio_reads");
+  const size_t kFileSize = 1 << 20;
+  const size_t kReadSize = 4096;
+  Random rnd(301);
+  std::string expected_data;
+  test::RandomString(&rnd, kFileSize, &expected_data);
+  ASSERT_OK(WriteStringToFile(env_, expected_data, fname));
+
+  EnvOptions soptions;
+  soptions.use_aio_reads = true;
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(fname, &file, soptions));
+  ASSERT_TRUE(file->use_aio_reads());
+
+  // More fibers than reads the ring keeps in flight, the reads it can't take
+  // fall back to pread. The last read crosses the end of the file and comes
+  // back short
+  const size_t kFibers = 1024;
+  std::vector<uint64_t> offsets(kFibers);
+  std::vector<std::string> scratches(kFibers, std::string(kReadSize, '\0'));
+  std::vector<Slice> results(kFibers);
+  std::vector<Status> statuses(kFibers);
+  std::vector<boost::fibers::fiber> fibers;
+  for (size_t i = 0; i < kFibers; ++i) {
+    offsets[i] = i + 1 == kFibers ? kFileSize - kReadSize / 2
+                                  : rnd.Uniform(kFileSize - kReadSize);
+    fibers.emplace_back([&, i] {
+      statuses[i] = file->Read(offsets[i], kReadSize, &results[i],
+                               &scratches[i][0]);
+    });
+  }
+  for (auto& fiber : fibers) {
+    fiber.join();
+  }
+  for (size_t i = 0; i < kFibers; ++i) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ(results[i].ToString(),
+              expected_data.substr(offsets[i], kReadSize));
+  }
+  ASSERT_EQ(results.back().size(), kReadSize / 2);
+
+  // The main context has no fiber to overlap with and reads through pread
+  Slice result;
+  std::string scratch(kReadSize, '\0');
+  ASSERT_OK(file->Read(kFileSize - kReadSize, kReadSize, &result, &scratch[0]));
+  ASSERT_EQ(result.ToString(), expected_data.substr(kFileSize - kReadSize));
+  ASSERT_OK(env_->DeleteFile(fname));
+}
+#endif
+
 // Only works in linux platforms
 TEST_P(EnvPosixTestWithParam, RandomAccessUniqueID) {
   // Create file.
@@ -1509,6 +1566,50 @@ TEST_P(EnvPosixTestWithParam, WritableFileWrapper) {
   EXPECT_EQ(24, step);
 }
 
+TEST_P(EnvPosixTestWithParam, MultiRead) {
+  const std::string path = test::PerThreadDBPath(env_, "multi_read_file");
+  const size_t kFileBytes = 1 << 20;
+  Random rnd(301);
+  std::string data;
+  test::RandomString(&rnd, kFileBytes, &data);
+  {
+    std::unique_ptr<WritableFile> wf;
+    ASSERT_OK(env_->NewWritableFile(path, &wf, EnvOptions()));
+    ASSERT_OK(wf->Append(data));
+    ASSERT_OK(wf->Close());
+  }
+
+  for (size_t queue_depth : {0, 4, 32}) {
+    EnvOptions soptions;
+    soptions.multi_read_queue_depth = queue_depth;
+    std::unique_ptr<RandomAccessFile> file;
+    ASSERT_OK(env_->NewRandomAccessFile(path, &file, soptions));
+
+    const size_t kNumReads = 100;
+    std::vector<FSReadRequest> reqs(kNumReads);
+    std::vector<std::string> scratches(kNumReads);
+    for (size_t i = 0; i < kNumReads; ++i) {
+      if (i + 1 < kNumReads) {
+        reqs[i].offset = rnd.Uniform(static_cast<int>(kFileBytes - 8192));
+        reqs[i].len = rnd.Uniform(8192) + 1;
+      } else {
+        // Crosses end of file
+        reqs[i].offset = kFileBytes - 100;
+        reqs[i].len = 4096;
+      }
+      scratches[i].resize(reqs[i].len);
+      reqs[i].scratch = &scratches[i][0];
+    }
+    ASSERT_OK(file->MultiRead(reqs.data(), reqs.size()));
+    for (auto& req : reqs) {
+      ASSERT_OK(req.status);
+      ASSERT_EQ(data.substr(static_cast<size_t>(req.offset), req.len),
+                req.result.ToString());
+    }
+  }
+  ASSERT_OK(env_->DeleteFile(path));
+}
+
 TEST_P(EnvPosixTestWithParam, PosixRandomRWFile) {
   const std::string path = test::PerThreadDBPath(env_, "random_rw_file");
 
@@ -26,6 +26,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #ifdef OS_LINUX
+#include <linux/aio_abi.h>
 #include <sys/statfs.h>
 #include <sys/syscall.h>
 #include <sys/sysmacros.h>
@@ -33,6 +34,17 @@
 #ifdef WITH_TERARK_ZIP
 #include <terark/thread/fiber_aio.hpp>
 #endif
+// Without terark-zip, fibers read through io_uring
+#if defined(OS_LINUX) && defined(WITH_BOOSTLIB) && \
+    !defined(WITH_TERARK_ZIP) && defined(__NR_io_uring_setup) && \
+    __has_include(<linux/io_uring.h>)
+#define ROCKSDB_FIBER_IO_URING
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/operations.hpp>
+#endif
 
 #include "env/posix_logger.h"
 #include "monitoring/iostats_context_imp.h"
@@ -319,6 +331,7 @@ PosixRandomAccessFile::PosixRandomAccessFile(const std::string& fname, int fd,
       fd_(fd),
       use_direct_io_(options.use_direct_reads),
       use_aio_reads_(options.use_aio_reads),
+      multi_read_queue_depth_(options.multi_read_queue_depth),
       logical_sector_size_(GetLogicalBufferSize(fd_)) {
   assert(!options.use_direct_reads || !options.use_mmap_reads);
   assert(!options.use_mmap_reads || sizeof(void*) < 8);
@@ -328,6 +341,209 @@ PosixRandomAccessFile::~PosixRandomAccessFile() { close(fd_); }
 
 bool PosixRandomAccessFile::use_aio_reads() const { return use_aio_reads_; }
 
+#ifdef ROCKSDB_FIBER_IO_URING
+namespace {
+// The reads of all fibers of a thread go through one io_uring. A fiber
+// submits its read and yields until one of the fibers reaps the completion,
+// so a thread keeps as many reads in flight as it runs fibers. The ring is
+// used through raw syscalls, liburing isn't needed at build time (see also
+// env/libaio_fix.h). Unlike Linux AIO, buffered reads don't block in submit
+class FiberIoUring {
+ public:
+  static constexpr unsigned kEntries = 256;
+  // Yield rounds without any completion before the thread blocks in the
+  // kernel, bounds the spinning when all fibers wait for reads
+  static constexpr unsigned kMaxIdleYields = 64;
+
+  FiberIoUring()
+      : ring_fd_(-1),
+        sq_ring_(MAP_FAILED),
+        cq_ring_(MAP_FAILED),
+        sqes_(static_cast<struct io_uring_sqe*>(MAP_FAILED)),
+        inflight_(0) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof p);
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, kEntries, &p));
+    if (ring_fd_ < 0) {
+      return;
+    }
+    sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+      return;
+    }
+    if (!single_mmap) {
+      cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+      if (cq_ring_ == MAP_FAILED) {
+        return;
+      }
+    }
+    sqes_size_ = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe*>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      return;
+    }
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_entries_ = p.sq_entries;
+    char* cq = static_cast<char*>(single_mmap ? sq_ring_ : cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+    cq_entries_ = p.cq_entries;
+  }
+
+  ~FiberIoUring() {
+    assert(inflight_ == 0);
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+  }
+
+  bool ok() const { return sqes_ != MAP_FAILED; }
+
+  // Same contract as pread(), parks the calling fiber until the read is done
+  ssize_t Read(int fd, char* buf, size_t n, off_t offset) {
+    Request req;
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = n;
+    unsigned tail = *sq_tail_;
+    if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_ ||
+        inflight_ >= cq_entries_) {
+      return pread(fd, buf, n, offset);
+    }
+    unsigned index = tail & sq_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof *sqe);
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&iov);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(offset);
+    sqe->user_data = reinterpret_cast<uint64_t>(&req);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    int r;
+    do {
+      r = Enter(1, 0, 0);
+    } while (r < 0 && errno == EINTR);
+    if (__atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == tail) {
+      // The kernel didn't take the entry, either failed or consumed nothing
+      // (r == 0). Nobody else submits on this ring, so take it back
+      __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+      return pread(fd, buf, n, offset);
+    }
+    ++inflight_;
+    unsigned idle_yields = 0;
+    while (!req.done) {
+      if (Reap() > 0) {
+        idle_yields = 0;
+      } else if (++idle_yields < kMaxIdleYields) {
+        boost::this_fiber::yield();
+      } else {
+        Enter(0, 1, IORING_ENTER_GETEVENTS);
+        idle_yields = 0;
+      }
+    }
+    if (req.res < 0) {
+      errno = -req.res;
+      return -1;
+    }
+    return req.res;
+  }
+
+ private:
+  struct Request {
+    bool done = false;
+    int32_t res = 0;
+  };
+
+  int Enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit,
+                                    min_complete, flags, nullptr, 0));
+  }
+
+  // Hand the completions to their fibers, return how many were reaped
+  size_t Reap() {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    size_t reaped = 0;
+    for (; head != tail; ++head, ++reaped) {
+      struct io_uring_cqe* cqe = &cqes_[head & cq_mask_];
+      Request* req = reinterpret_cast<Request*>(cqe->user_data);
+      req->res = cqe->res;
+      req->done = true;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    inflight_ -= reaped;
+    return reaped;
+  }
+
+  int ring_fd_;
+  void* sq_ring_;
+  void* cq_ring_;
+  size_t sq_ring_size_;
+  size_t cq_ring_size_;
+  size_t sqes_size_;
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned* sq_array_;
+  unsigned sq_mask_;
+  unsigned sq_entries_;
+  struct io_uring_sqe* sqes_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned cq_mask_;
+  unsigned cq_entries_;
+  struct io_uring_cqe* cqes_;
+  size_t inflight_;
+};
+
+// pread() for fibers. Reads from the main context of a thread, e.g. plain
+// Get() calls, have no fiber to overlap with and stay synchronous
+ssize_t FiberRead(int fd, char* buf, size_t n, off_t offset) {
+  static thread_local std::unique_ptr<FiberIoUring> ring;
+  static thread_local bool ring_unavailable = false;
+  if (ring_unavailable || boost::fibers::context::active()->is_context(
+                              boost::fibers::type::main_context)) {
+    return pread(fd, buf, n, offset);
+  }
+  if (ring == nullptr) {
+    ring.reset(new FiberIoUring());
+    if (!ring->ok()) {
+      ring.reset();
+      ring_unavailable = true;
+      return pread(fd, buf, n, offset);
+    }
+  }
+  return ring->Read(fd, buf, n, offset);
+}
+}  // namespace
+#endif  // ROCKSDB_FIBER_IO_URING
+
 static Status PosixFsRead(uint64_t offset, size_t n, Slice* result,
                           char* scratch, int fd_, const std::string& filename_,
                           bool use_aio_reads_, bool use_direct_io_,
@@ -337,13 +553,15 @@ static Status PosixFsRead(uint64_t offset, size_t n, Slice* result,
   size_t left = n;
   char* ptr = scratch;
   while (left > 0) {
-    // Disable AIO read if terark-zip is NOT used.
-#ifndef WITH_TERARK_ZIP
+    // Disable AIO read if neither terark-zip nor fiber io_uring is used.
+#if !defined(WITH_TERARK_ZIP) && !defined(ROCKSDB_FIBER_IO_URING)
     use_aio_reads_ = false;
 #endif
     if (use_aio_reads_) {
 #ifdef WITH_TERARK_ZIP
       r = terark::fiber_aio_read(fd_, ptr, left, static_cast<off_t>(offset));
+#elif defined(ROCKSDB_FIBER_IO_URING)
+      r = FiberRead(fd_, ptr, left, static_cast<off_t>(offset));
 #endif
     } else {
       r = pread(fd_, ptr, left, static_cast<off_t>(offset));
@@ -386,6 +604,178 @@ Status PosixRandomAccessFile::Read(uint64_t offset, size_t n, Slice* result,
                      use_direct_io_, GetRequiredBufferAlignment());
 }
 
+#ifdef OS_LINUX
+namespace {
+// Linux AIO through raw syscalls, so libaio-dev isn't needed at build time
+// (see also env/libaio_fix.h)
+class AioContext {
+ public:
+  explicit AioContext(size_t capacity) : ctx_(0), capacity_(0) {
+    if (syscall(__NR_io_setup, static_cast<unsigned>(capacity), &ctx_) == 0) {
+      capacity_ = capacity;
+    }
+  }
+
+  ~AioContext() {
+    if (capacity_ > 0) {
+      syscall(__NR_io_destroy, ctx_);
+    }
+  }
+
+  bool ok() const { return capacity_ > 0; }
+  size_t capacity() const { return capacity_; }
+
+  int Submit(size_t n, struct iocb** iocbs) {
+    return static_cast<int>(
+        syscall(__NR_io_submit, ctx_, static_cast<long>(n), iocbs));
+  }
+
+  int GetEvents(size_t min_nr, size_t nr, struct io_event* events) {
+    return static_cast<int>(syscall(__NR_io_getevents, ctx_,
+                                    static_cast<long>(min_nr),
+                                    static_cast<long>(nr), events, nullptr));
+  }
+
+  // Most files can't cancel a read, the read then completes as usual
+  void Cancel(struct iocb* iocb) {
+    struct io_event event;
+    syscall(__NR_io_cancel, ctx_, iocb, &event);
+  }
+
+ private:
+  aio_context_t ctx_;
+  size_t capacity_;
+};
+
+thread_local std::unique_ptr<AioContext> thread_aio;
+
+// io_setup() is expensive, every thread keeps one context and grows it to
+// the deepest queue asked for. Return nullptr if the kernel refuses AIO.
+AioContext* GetThreadLocalAioContext(size_t queue_depth) {
+  static thread_local bool aio_unavailable = false;
+  if (aio_unavailable) {
+    return nullptr;
+  }
+  if (thread_aio == nullptr || thread_aio->capacity() < queue_depth) {
+    thread_aio.reset(new AioContext(queue_depth));
+    if (!thread_aio->ok()) {
+      thread_aio.reset();
+      aio_unavailable = true;
+    }
+  }
+  return thread_aio.get();
+}
+
+// io_destroy() blocks until every read of the context is done, after that
+// no buffer is owned by the kernel any more
+void ResetThreadLocalAioContext() { thread_aio.reset(); }
+}  // namespace
+#endif
+
+Status PosixRandomAccessFile::MultiRead(FSReadRequest* reqs, size_t num_reqs) {
+  assert(reqs != nullptr);
+#ifdef OS_LINUX
+  AioContext* aio = nullptr;
+  if (multi_read_queue_depth_ > 1 && num_reqs > 1) {
+    aio = GetThreadLocalAioContext(multi_read_queue_depth_);
+  }
+  if (aio != nullptr) {
+    const size_t queue_depth = std::min(multi_read_queue_depth_, num_reqs);
+    std::vector<struct iocb> iocbs(queue_depth);
+    std::vector<struct iocb*> iocb_ptrs(queue_depth);
+    std::vector<struct io_event> events(queue_depth);
+    for (size_t begin = 0; begin < num_reqs; begin += queue_depth) {
+      size_t n = std::min(queue_depth, num_reqs - begin);
+      for (size_t i = 0; i < n; ++i) {
+        FSReadRequest& req = reqs[begin + i];
+        assert(req.scratch != nullptr);
+        struct iocb& cb = iocbs[i];
+        memset(&cb, 0, sizeof cb);
+        cb.aio_data = begin + i;
+        cb.aio_lio_opcode = IOCB_CMD_PREAD;
+        cb.aio_fildes = static_cast<uint32_t>(fd_);
+        cb.aio_buf = reinterpret_cast<uint64_t>(req.scratch);
+        cb.aio_nbytes = req.len;
+        cb.aio_offset = static_cast<int64_t>(req.offset);
+        iocb_ptrs[i] = &cb;
+      }
+      // Requests the kernel refused are read with pread below
+      size_t submitted = 0;
+      while (submitted < n) {
+        int r = aio->Submit(n - submitted, iocb_ptrs.data() + submitted);
+        if (r <= 0) {
+          if (r < 0 && errno == EINTR) {
+            continue;
+          }
+          break;
+        }
+        submitted += r;
+      }
+      for (size_t i = submitted; i < n; ++i) {
+        FSReadRequest& req = reqs[begin + i];
+        req.status = Read(req.offset, req.len, &req.result, req.scratch);
+      }
+      // Buffers of in-flight reads belong to the kernel, reap all of them
+      // before returning
+      std::vector<bool> reaped_reqs(n, false);
+      size_t reaped = 0;
+      while (reaped < submitted) {
+        int r = aio->GetEvents(1, submitted - reaped, events.data());
+        if (r < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          Status s = IOError("While io_getevents", filename_, errno);
+          for (size_t i = 0; i < submitted; ++i) {
+            if (!reaped_reqs[i]) {
+              aio->Cancel(&iocbs[i]);
+              reqs[begin + i].status = s;
+              reqs[begin + i].result = Slice(reqs[begin + i].scratch, 0);
+            }
+          }
+          ResetThreadLocalAioContext();
+          return s;
+        }
+        for (int j = 0; j < r; ++j) {
+          reaped_reqs[events[j].data - begin] = true;
+          FSReadRequest& req = reqs[events[j].data];
+          int64_t res = events[j].res;
+          if (res < 0) {
+            req.status = IOError("While AIO pread offset " +
+                                     ToString(req.offset) + " len " +
+                                     ToString(req.len),
+                                 filename_, static_cast<int>(-res));
+            req.result = Slice(req.scratch, 0);
+          } else if (!use_direct_io_ && res > 0 &&
+                     static_cast<size_t>(res) < req.len) {
+            // Short read, finish it with pread which stops at end of file.
+            // A short direct read always hits the end of file.
+            Slice rest;
+            req.status = Read(req.offset + res, req.len - res, &rest,
+                              req.scratch + res);
+            req.result = Slice(req.scratch, res + rest.size());
+          } else {
+            req.status = Status::OK();
+            req.result = Slice(req.scratch, static_cast<size_t>(res));
+          }
+        }
+        reaped += r;
+      }
+    }
+    return Status::OK();
+  }
+#endif
+  return RandomAccessFile::MultiRead(reqs, num_reqs);
+}
+
+size_t PosixRandomAccessFile::GetMultiReadQueueDepth() const {
+#ifdef OS_LINUX
+  return std::max<size_t>(multi_read_queue_depth_, 1);
+#else
+  return 1;
+#endif
+}
+
 Status PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
   Status s;
   if (!use_direct_io_) {
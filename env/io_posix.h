@@ -85,6 +85,7 @@ class PosixRandomAccessFile : public RandomAccessFile {
   int fd_;
   bool use_direct_io_;
   bool use_aio_reads_;
+  size_t multi_read_queue_depth_;
   size_t logical_sector_size_;
 
  public:
@@ -97,6 +98,11 @@ class PosixRandomAccessFile : public RandomAccessFile {
 
   virtual Status Prefetch(uint64_t offset, size_t n) override;
 
+  // Submits up to multi_read_queue_depth reads at a time through Linux AIO
+  virtual Status MultiRead(FSReadRequest* reqs, size_t num_reqs) override;
+
+  virtual size_t GetMultiReadQueueDepth() const override;
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
@@ -22,6 +22,7 @@ class ValueExtractor;
 enum CompressionType : unsigned char;
 class TablePropertiesCollectorFactory;
 class TableFactory;
+class WriteBufferManager;
 struct Options;
 
 enum CompactionStyle : char {
@@ -580,6 +581,17 @@ struct AdvancedColumnFamilyOptions {
   // independently if the process crashes later and tries to recover.
   std::shared_ptr<AtomicFlushGroup> atomic_flush_group;
 
+  // If set, memtables of this column family reserve their memory from this
+  // budget node instead of DBOptions::write_buffer_manager. The node has to
+  // descend from DBOptions::write_buffer_manager, e.g.
+  //   WriteBufferManager(64 << 20, group, "cf1", 2)
+  // with group = WriteBufferManager(256 << 20, db_write_buffer_manager,
+  // "group1"). A column family is flushed when its node or any node above it
+  // runs full.
+  //
+  // Default: nullptr
+  std::shared_ptr<WriteBufferManager> cf_write_buffer_manager;
+
   // Block-based table related options are moved to BlockBasedTableOptions.
   // Related options that were originally here but now moved include:
   //   no_block_cache
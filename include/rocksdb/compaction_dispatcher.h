@@ -45,6 +45,10 @@ class RemoteCompactionDispatcher : public CompactionDispatcher {
     virtual ~Worker();
     virtual std::string GenerateOutputFileName(size_t file_index) = 0;
     std::string DoCompaction(Slice data);
+    // Run DoCompaction for each request read from input_fd until EOF, write
+    // each result to output_fd. Requests and results are framed as a fixed64
+    // length followed by the payload. Used by long-lived pool workers.
+    Status Serve(int input_fd, int output_fd);
     static void DebugSerializeCheckResult(Slice data);
 
    protected:
@@ -56,4 +60,10 @@ class RemoteCompactionDispatcher : public CompactionDispatcher {
 extern std::shared_ptr<CompactionDispatcher> NewCommandLineCompactionDispatcher(
     std::string cmd);
 
+// Like NewCommandLineCompactionDispatcher, but cmd starts a long-lived worker
+// which calls Worker::Serve on its stdin/stdout, at most max_workers of them
+// run concurrently. A worker which fails is killed and respawned on demand.
+extern std::shared_ptr<CompactionDispatcher> NewWorkerPoolCompactionDispatcher(
+    std::string cmd, size_t max_workers);
+
 }  // namespace TERARKDB_NAMESPACE
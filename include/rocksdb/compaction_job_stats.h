@@ -90,5 +90,18 @@ struct CompactionJobStats {
 
   // number of single-deletes which meet something other than a put
   uint64_t num_single_del_mismatch;
+
+  // Following counters are only populated by garbage collections
+
+  // the number of parallel sub-jobs the garbage collection was split into.
+  size_t num_gc_sub_jobs;
+
+  // the input blob bytes and the elapsed time of the garbage collections,
+  // kept apart from the totals above so that Add() can recompute the rate.
+  uint64_t gc_input_bytes;
+  uint64_t gc_elapsed_micros;
+
+  // input blob bytes the garbage collection processed per second.
+  uint64_t gc_input_bytes_per_second;
 };
 }  // namespace TERARKDB_NAMESPACE
@@ -650,6 +650,11 @@ class DB {
     //      live data in bytes.
     static const std::string kEstimateLiveDataSize;
 
+    //  "rocksdb.num-inheritance-entries" - returns the number of ancestor
+    //      file numbers kept in the inheritance of live ssts, so value
+    //      indexes pointing at GC-ed blob ssts still resolve.
+    static const std::string kNumInheritanceEntries;
+
     //  "rocksdb.min-log-number-to-keep" - return the minimum log number of the
     //      log files that should be kept.
     static const std::string kMinLogNumberToKeep;
@@ -708,6 +713,17 @@ class DB {
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
+
+    //  "rocksdb.adaptive-blob-size" - returns a multi-line string with the
+    //      blob size compactions use for each output level, followed by the
+    //      value size histogram it is picked from.
+    static const std::string kAdaptiveBlobSize;
+
+    //  "rocksdb.write-buffer-manager-stats" - returns a multi-line string
+    //      with the memory usage, limit, weight, share and flush count of
+    //      every node of the write buffer budget tree the column family
+    //      belongs to.
+    static const std::string kWriteBufferManagerStats;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -1295,6 +1311,17 @@ class DB {
   virtual Status EndTrace() {
     return Status::NotSupported("EndTrace() is not implemented.");
   }
+
+  // Trace block cache accesses. Use EndBlockCacheTrace() to stop tracing.
+  virtual Status StartBlockCacheTrace(
+      const TraceOptions& /*options*/,
+      std::unique_ptr<TraceWriter>&& /*trace_writer*/) {
+    return Status::NotSupported("StartBlockCacheTrace() is not implemented.");
+  }
+
+  virtual Status EndBlockCacheTrace() {
+    return Status::NotSupported("EndBlockCacheTrace() is not implemented.");
+  }
 #endif  // ROCKSDB_LITE
 
   // Needed for StackableDB
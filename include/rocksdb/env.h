@@ -101,6 +101,12 @@ struct EnvOptions {
 
   bool use_aio_reads = false;
 
+  // Max number of reads RandomAccessFile::MultiRead() keeps in flight
+  // through Linux AIO. 0 or 1 serves the reads one pread at a time.
+  // AIO only overlaps reads with use_direct_reads, buffered reads complete
+  // inside io_submit.
+  size_t multi_read_queue_depth = 0;
+
   // Allows OS to incrementally sync files to disk while they are being
   // written, in the background. Issue one request for every bytes_per_sync
   // written. 0 turns it off.
@@ -737,6 +743,10 @@ class RandomAccessFile {
 
   virtual bool use_aio_reads() const { return false; }
 
+  // Number of MultiRead() requests served in parallel, 1 if they are served
+  // one by one. Callers may split a large read into this many requests.
+  virtual size_t GetMultiReadQueueDepth() const { return 1; }
+
   virtual bool is_mmap_open() const { return false; }
 
   // Use the returned alignment value to allocate
@@ -1509,6 +1519,9 @@ class RandomAccessFileWrapper : public RandomAccessFile {
   void Hint(AccessPattern pattern) override { target_->Hint(pattern); }
   bool use_direct_io() const override { return target_->use_direct_io(); }
   bool use_aio_reads() const override { return target_->use_aio_reads(); }
+  size_t GetMultiReadQueueDepth() const override {
+    return target_->GetMultiReadQueueDepth();
+  }
   bool is_mmap_open() const override { return target_->is_mmap_open(); }
   size_t GetRequiredBufferAlignment() const override {
     return target_->GetRequiredBufferAlignment();
@@ -48,6 +48,7 @@ class Logger;
 class MergeOperator;
 class Snapshot;
 class MemTableRepFactory;
+class PersistentCache;
 class RateLimiter;
 class Slice;
 class Statistics;
@@ -81,7 +82,14 @@ enum CompressionType : unsigned char {
   kDisableCompressionOption = 0xff,
 };
 
-enum WriteBufferFlushPri : unsigned char { kFlushOldest, kFlushLargest };
+// kFlushMostEfficient flushes the memtable freeing the most memory per flush
+// cost, from the budget nodes most above their weighted share first (see
+// WriteBufferManager).
+enum WriteBufferFlushPri : unsigned char {
+  kFlushOldest,
+  kFlushLargest,
+  kFlushMostEfficient
+};
 
 // Sst purpose
 enum SstPurpose {
@@ -302,6 +310,17 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // Default: 0 (init from DBOptions::max_subcompactions.)
   uint32_t max_subcompactions = 8;
 
+  // Split a flush into at most max_flush_partitions non-overlapping key
+  // ranges and build them concurrently, each into its own level 0 file.
+  // The extra partitions run in the flush thread pool (Env::HIGH), the flush
+  // thread builds whatever no pool thread picked up.
+  // Flushes of memtables with range deletions are never split.
+  // All partitions of one flush together count as one file for the level 0
+  // compaction, slowdown and stop triggers.
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t max_flush_partitions = 1;
+
   // Don't separate Value if value.size < blob_size
   // Set size_t(-1) to disable Key Value separation
   // valid [8 , size_t(-1)]
@@ -332,6 +351,56 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // 0 to 1
   double maintainer_job_ratio = 0.1;
 
+  // Flush separated values into log ssts and write only their value indexes
+  // into the L0 sst. Log ssts are built without a second pass, so values are
+  // separated on flush even if the table builder needs one. Garbage
+  // collection folds log ssts into regular blob ssts later.
+  // No effect if blob_size is size_t(-1)
+  //
+  // Dynamically changeable through SetOptions() API
+  bool enable_log_sst_flush = false;
+
+  // Let compaction pick the separation threshold of each output level from
+  // the value size histogram collected from recently written ssts, instead
+  // of using blob_size for every level. blob_size is kept as the lower bound
+  // of the picked threshold, and flush and GC still use blob_size.
+  // No effect if blob_size is size_t(-1)
+  //
+  // Dynamically changeable through SetOptions() API
+  bool enable_adaptive_blob_size = false;
+
+  // Trade-off between write amplification and point read cost used by
+  // adaptive blob size. 1 only weighs the bytes rewritten by compactions
+  // (separate as much as possible), 0 only weighs the reads that have to
+  // fetch a separated value (separate nothing above blob_size)
+  // valid [0 , 1]
+  //
+  // Dynamically changeable through SetOptions() API
+  double adaptive_blob_size_write_weight = 0.5;
+
+  // Bits per key of the bloom filter built for each map sst element linking
+  // more than one sst. A point lookup that misses it skips every linked sst
+  // instead of probing their filters one by one. Building it reads the keys
+  // of the linked ssts in the element range, so a map compaction reads up to
+  // max_compaction_bytes more; elements beyond that go without a filter. The
+  // reads are charged to rate_limiter if it limits reads.
+  // Map ssts with element filters can't be read by versions without this
+  // option, so a DB that ever had it set can't be downgraded until those map
+  // ssts are compacted away.
+  // 0 to disable
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t map_element_filter_bits_per_key = 0;
+
+  // Keep the location of a separated value inside its blob sst in the value
+  // index, so that reading the value skips the index of the blob sst.
+  // Value indexes with a location can't be read by versions without this
+  // option, so a DB that ever had it set can't be downgraded. Turning it off
+  // stops writing locations, the existing ones stay until compacted.
+  //
+  // Dynamically changeable through SetOptions() API
+  bool enable_blob_value_location = false;
+
   // This is a factory that provides TableFactory objects.
   // Default: a block-based table factory that provides a default
   // implementation of TableBuilder and TableReader with default
@@ -666,6 +735,33 @@ struct DBOptions {
   //
   size_t prepare_log_writer_num = 1;
 
+  // Number of WAL streams written side by side for each log number. Stream 0
+  // is the regular log file; every extra stream lives in its own file next to
+  // it. Writers pick a stream by the CPU core they run on, and the members of
+  // a parallel write group append their batches to their own stream instead
+  // of handing everything to the group leader, so WAL encoding and CRC work is
+  // spread over several cores. Each record carries the global sequence of its
+  // first key and recovery merges the streams of a log back into sequence
+  // order.
+  //
+  // Sync writes and write groups that cannot be applied to the memtables in
+  // parallel still go to stream 0. Since the streams are flushed on their own,
+  // a crash may keep a record of one stream while losing an earlier record of
+  // another. Recovery stops at the first gap in the sequences of a log and
+  // handles it like a corrupted record according to wal_recovery_mode, so
+  // writes with WriteOptions::disableWAL, which leave such gaps, are rejected.
+  // External file ingestion that assigns a global sequence number switches
+  // to a new log first, since that sequence has no WAL record either.
+  // Extra streams are ignored by GetUpdatesSince(), RepairDB() and secondary
+  // instances, and are not copied by checkpoints or backups of live WALs, so
+  // flush before taking either.
+  //
+  // Sanitized to 1 unless allow_concurrent_memtable_write is set and
+  // enable_pipelined_write, two_write_queues, manual_wal_flush,
+  // recycle_log_file_num and WAL archival are all off.
+  // Default: 1
+  size_t wal_streams = 1;
+
   // manifest file is rolled over on reaching this limit.
   // The older manifest file be deleted.
   // The default value is 1GB so that the manifest file can grow, but not
@@ -737,9 +833,22 @@ struct DBOptions {
   bool skip_log_error_on_recovery = false;
 
   // use_direct_reads should be set together
-  // since aio on non-direct-io is really synchronous on linux
+  // since aio on non-direct-io is really synchronous on linux.
+  // Builds with boost fibers but without terark-zip read through io_uring
+  // instead, there reads issued from a fiber, e.g. by DB::GetAsync() or
+  // MultiGet() with aio_concurrency, park the fiber until the read is done
+  // for buffered reads as well.
   bool use_aio_reads = false;
 
+  // Max number of reads a RandomAccessFile::MultiRead() call keeps in flight
+  // through Linux AIO. Large readahead, e.g. compaction_readahead_size, is
+  // split into this many reads. 0 or 1 serves reads one pread at a time.
+  // Reads only overlap with use_direct_reads, buffered AIO reads complete
+  // synchronously on linux.
+  //
+  // Default: 0
+  size_t multi_read_queue_depth = 0;
+
   // if not zero, dump rocksdb.stats to LOG every stats_dump_period_sec
   //
   // Default: 600 (10 min)
@@ -989,6 +1098,17 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // Number of threads DB::Open starts to replay the WAL alongside the
+  // opening thread. With 1 or more, one thread reads and checksums the
+  // records of each log ahead of the replay, buffering up to 32MB. With 2 or
+  // more and allow_concurrent_memtable_write set, the other threads insert
+  // write batches into the memtables in groups with the opening thread;
+  // merges, allow_2pc and seq_per_batch still replay one batch at a time.
+  // The threads are started with port::Thread for the replay only, they
+  // don't come from the Env thread pools.
+  // Default: 0 (replay on the opening thread only)
+  size_t wal_recovery_threads = 0;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -998,6 +1118,34 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   std::shared_ptr<Cache> row_cache = nullptr;
 
+  // A global cache for separated values, keyed by the blob file number,
+  // sequence and user key of the value, so entries survive the compactions
+  // that only rewrite map ssts or key ssts. A hit skips the blob file read.
+  // Default: nullptr (disabled)
+  // Not supported in ROCKSDB_LITE mode!
+  std::shared_ptr<Cache> blob_cache = nullptr;
+
+  // A persistent cache tier for separated values, e.g. on a local SSD when
+  // the blob ssts sit on slower or remote storage. Values missed by
+  // blob_cache are looked up here before being fetched from the blob ssts.
+  // Entries are keyed by blob file number, sequence and user key, so the
+  // cache must not be shared with other DBs or used as the persistent cache
+  // of a table factory.
+  // Default: nullptr (disabled)
+  // Not supported in ROCKSDB_LITE mode!
+  std::shared_ptr<PersistentCache> blob_persistent_cache = nullptr;
+
+  // Separated values larger than this are not admitted to
+  // blob_persistent_cache.
+  // Default: 1MB
+  uint64_t blob_persistent_cache_max_value_size = 1 << 20;
+
+  // A separated value is admitted to blob_persistent_cache once it has been
+  // fetched from the blob ssts this many times. The fetch counts are
+  // approximate and decay over time, 1 admits every fetched value.
+  // Default: 2
+  uint32_t blob_persistent_cache_admission_fetches = 2;
+
   std::shared_ptr<MetricsReporterFactory> metrics_reporter_factory = nullptr;
 
 #ifndef ROCKSDB_LITE
@@ -1244,9 +1392,24 @@ struct ReadOptions {
   // Default: false
   bool ignore_range_deletions;
 
-  // now only used by MultiGet
+  // Number of fibers of the calling thread MultiGet and DB::GetAsync() run
+  // their reads on
   int aio_concurrency;
 
+  // If true, MultiGet resolves the value index of every key first, then reads
+  // the separated values grouped by blob file, in key order inside each file.
+  // Only used by MultiGet
+  // Default: true
+  bool batch_separated_fetch;
+
+  // If non-zero, an iterator reads the separated values of each blob file
+  // through a read-ahead iterator of the given size, instead of one random
+  // read per value. Useful for range scans over large values, since values
+  // are usually stored in key order inside a blob file.
+  // Only used by iterators
+  // Default: 0
+  size_t blob_readahead_size;
+
   // A callback to determine whether relevant keys for this scan exist in a
   // given table based on the table's properties. The callback is passed the
   // properties of each table during iteration. If the callback returns false,
@@ -1255,6 +1418,18 @@ struct ReadOptions {
   // Default: empty (every table will be scanned)
   std::function<bool(const TableProperties&)> table_filter;
 
+  // A predicate over the value meta of each value an iterator is about to
+  // return. If it returns false, the key is skipped as if it were deleted.
+  // The value meta of a separated value is read from its value index, so
+  // skipped values are never fetched from the blob sst. The value meta of an
+  // inline value is extracted by the column family's
+  // value_meta_extractor_factory, and is empty if there is none. Values
+  // produced by merge operands are not filtered.
+  // Only used by iterators
+  // Default: empty (no value is filtered)
+  std::function<bool(const Slice& user_key, const Slice& value_meta)>
+      value_meta_filter;
+
   // Needed to support differential snapshots. Has 2 effects:
   // 1) Iterator will skip all internal keys with seqnum < iter_start_seqnum
   // 2) if this param > 0 iterator will return INTERNAL keys instead of
@@ -1458,6 +1633,11 @@ struct TraceOptions {
   // To avoid the trace file size grows large than the storage space,
   // user can set the max trace file size in Bytes. Default is 64GB
   uint64_t max_trace_file_size = uint64_t{64} * 1024 * 1024 * 1024;
+  // Specify trace sampling option, i.e. capture one per how many requests.
+  // Only used by block cache tracing, which samples by block key so that a
+  // traced block keeps its complete access history. Default to 1 (capture
+  // every request).
+  uint64_t sampling_frequency = 1;
 };
 
 }  // namespace TERARKDB_NAMESPACE
@@ -67,6 +67,19 @@ struct PerfContext {
   uint64_t get_read_bytes;       // bytes for vals returned by Get
   uint64_t multiget_read_bytes;  // bytes for vals returned by MultiGet
   uint64_t iter_read_bytes;      // bytes for keys/vals decoded by iterator
+  // bytes read from blob files by iterators with
+  // ReadOptions::blob_readahead_size set
+  uint64_t blob_prefetch_read_bytes;
+  // bytes of separated values those iterators got from the read-ahead
+  uint64_t blob_prefetch_used_bytes;
+
+  uint64_t dependence_map_lookup_count;  // value index and map sst resolving
+  uint64_t map_sst_hop_count;            // map sst links followed by Get
+  uint64_t separate_value_fetch_count;   // values fetched from blob ssts
+  uint64_t separate_value_fetch_bytes;   // bytes of values from blob ssts
+  uint64_t separate_value_fetch_time;    // total nanos spent on blob fetches
+  uint64_t value_meta_filtered_count;    // keys skipped by value_meta_filter
+  uint64_t blob_fetch_avoided_count;     // skipped keys with separated value
 
   // total number of internal keys skipped over during iteration.
   // There are several reasons for it:
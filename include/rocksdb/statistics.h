@@ -258,6 +258,39 @@ enum Tickers : uint32_t {
   GC_TOUCH_FILES,
   GC_SKIP_GET_BY_SEQ,
   GC_SKIP_GET_BY_FILE,
+
+  // Separated value resolution on the read path.
+  // # of dependence map lookups to resolve a value index or a map sst link.
+  READ_DEPENDENCE_MAP_LOOKUP,
+  // # of map sst links followed by point lookups.
+  READ_MAP_SST_HOPS,
+  // # of separated values fetched from blob ssts.
+  SEPARATE_VALUE_FETCH,
+  // # of bytes of separated values fetched from blob ssts.
+  SEPARATE_VALUE_FETCH_BYTES,
+  // # of value indexes whose blob sst or value could not be found.
+  SEPARATE_VALUE_MISSING,
+
+  // # of keys skipped by iterators because ReadOptions::value_meta_filter
+  // rejected their value meta.
+  ITER_VALUE_META_FILTERED,
+  // # of those keys whose value was separated, i.e. blob fetches avoided.
+  ITER_BLOB_FETCH_AVOIDED,
+
+  // Blob cache, see DBOptions::blob_cache.
+  BLOB_CACHE_HIT,
+  BLOB_CACHE_MISS,
+  // Blob persistent cache, see DBOptions::blob_persistent_cache.
+  BLOB_PERSISTENT_CACHE_HIT,
+  BLOB_PERSISTENT_CACHE_MISS,
+  // # of separated values admitted to the blob persistent cache.
+  BLOB_PERSISTENT_CACHE_ADD,
+  // # of separated values read at the location recorded in their value
+  // index, skipping the index search of the blob sst.
+  SEPARATE_VALUE_LOCATION_HIT,
+  // # of map sst elements skipped by point lookups because their filter
+  // excludes the key, each saving a probe of every linked sst.
+  MAP_ELEMENT_FILTER_USEFUL,
   TICKER_ENUM_MAX
 };
 
@@ -320,6 +353,10 @@ enum Histograms : uint32_t {
   PICK_GARBAGE_COLLECTION_TIME,
   INSTALL_SUPER_VERSION_TIME,
   BUILD_VERSION_TIME,
+  // Time spent fetching separated values from blob ssts.
+  SEPARATE_VALUE_FETCH_MICROS,
+  // Size of separated values fetched from blob ssts.
+  SEPARATE_VALUE_SIZE,
 
   HISTOGRAM_ENUM_MAX,
 };
@@ -532,6 +532,10 @@ class TableFactory
 
   // Return if table builder need second pass iter
   virtual bool IsBuilderNeedSecondPass() const { return false; }
+
+  // Return if this factory can build log ssts, which are written in a single
+  // pass while flushing separated values
+  virtual bool IsLogSstSupported() const { return !IsBuilderNeedSecondPass(); }
 };
 
 #ifndef ROCKSDB_LITE
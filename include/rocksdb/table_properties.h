@@ -71,6 +71,7 @@ struct TablePropertiesNames {
   static const std::string kInheritanceTree;
   static const std::string kEarliestTimeBeginCompact;
   static const std::string kLatestTimeEndCompact;
+  static const std::string kValueSizeHistogram;
 };
 
 extern const std::string kPropertiesBlock;
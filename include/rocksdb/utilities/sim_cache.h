@@ -39,6 +39,15 @@ extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
                                              size_t sim_capacity,
                                              int num_shard_bits);
 
+// Same as above, but the simulated cache is the user provided `sim_cache`
+// rather than an LRU cache of `sim_capacity` bytes, so that other eviction
+// policies (e.g. LIRS or CLOCK) can be simulated. `sim_cache` keeps its own
+// sharding. `cache` may be nullptr, in which case the SimCache only keeps
+// keys, never holds any value and reports zero capacity and usage.
+// Returns nullptr if `sim_cache` is nullptr.
+extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> sim_cache,
+                                             std::shared_ptr<Cache> cache);
+
 class SimCache : public Cache {
  public:
   SimCache() {}
@@ -14,12 +14,21 @@
 
 #include <atomic>
 #include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/terark_namespace.h"
 
 namespace TERARKDB_NAMESPACE {
 
+// Budgets form a tree, e.g. DB > group of column families > column family.
+// Memory reserved by a node is reserved from all its ancestors as well, and
+// a node runs full on its own buffer size regardless of its ancestors. When
+// a node runs full, DBOptions::write_buffer_flush_pri = kFlushMostEfficient
+// flushes from the descendants holding the most memory relative to their
+// weight among their siblings first, see ShareRatio().
 class WriteBufferManager {
  public:
   // _buffer_size = 0 indicates no limit. Memory won't be capped.
@@ -28,13 +37,27 @@ class WriteBufferManager {
   // the memory allocated to the cache. It can be used even if _buffer_size = 0.
   explicit WriteBufferManager(size_t _buffer_size,
                               std::shared_ptr<Cache> cache = {});
+
+  // A budget node below `parent`, for a column family see
+  // ColumnFamilyOptions::cf_write_buffer_manager. _buffer_size = 0 leaves the
+  // node without a limit of its own. Memory is costed to the cache of the
+  // root only. `weight` is the share of the parent budget the node is entitled
+  // to, relative to the weights of its siblings.
+  WriteBufferManager(size_t _buffer_size,
+                     std::shared_ptr<WriteBufferManager> parent,
+                     std::string name, uint32_t weight = 1);
   ~WriteBufferManager();
 
   bool enabled() const { return buffer_size_ != 0; }
 
   bool cost_to_cache() const { return cache_rep_ != nullptr; }
 
-  // Only valid if enabled()
+  // Whether memtables have to report their memory here
+  bool tracks_memory() const {
+    return enabled() || cost_to_cache() || parent_ != nullptr;
+  }
+
+  // Only valid if tracks_memory()
   size_t memory_usage() const {
     return memory_used_.load(std::memory_order_relaxed);
   }
@@ -43,8 +66,19 @@ class WriteBufferManager {
   }
   size_t buffer_size() const { return buffer_size_; }
 
-  // Should only be called from write thread
+  WriteBufferManager* parent() const { return parent_.get(); }
+  const std::string& name() const { return name_; }
+  uint32_t weight() const { return weight_; }
+
+  // Should only be called from write thread. True if this node or any of its
+  // descendants runs full
   bool ShouldFlush() const {
+    return ExceedsBudget() ||
+           descendants_exceeding_.load(std::memory_order_relaxed) > 0;
+  }
+
+  // True if this node itself runs full
+  bool ExceedsBudget() const {
     if (enabled()) {
       if (mutable_memtable_memory_usage() > mutable_limit_) {
         return true;
@@ -60,29 +94,52 @@ class WriteBufferManager {
     return false;
   }
 
+  // Memory held by this node divided by its weighted share of the memory held
+  // by its parent, multiplied up to the root. Above 1 the node holds more
+  // than its share.
+  double ShareRatio() const;
+
+  // Counts a flush triggered because this node ran full
+  void RecordFlush() { flush_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  // One line per node of the subtree below and including this node
+  void GetStats(std::string* value) const;
+
   void ReserveMem(size_t mem) {
     if (cache_rep_ != nullptr) {
       ReserveMemWithCache(mem);
-    } else if (enabled()) {
+    } else if (tracks_memory()) {
       memory_used_.fetch_add(mem, std::memory_order_relaxed);
     }
-    if (enabled()) {
+    if (tracks_memory()) {
       memory_active_.fetch_add(mem, std::memory_order_relaxed);
     }
+    if (parent_ != nullptr) {
+      parent_->ReserveMem(mem);
+    }
+    UpdateBudgetState();
   }
   // We are in the process of freeing `mem` bytes, so it is not considered
   // when checking the soft limit.
   void ScheduleFreeMem(size_t mem) {
-    if (enabled()) {
+    if (tracks_memory()) {
       memory_active_.fetch_sub(mem, std::memory_order_relaxed);
     }
+    if (parent_ != nullptr) {
+      parent_->ScheduleFreeMem(mem);
+    }
+    UpdateBudgetState();
   }
   void FreeMem(size_t mem) {
     if (cache_rep_ != nullptr) {
       FreeMemWithCache(mem);
-    } else if (enabled()) {
+    } else if (tracks_memory()) {
       memory_used_.fetch_sub(mem, std::memory_order_relaxed);
     }
+    if (parent_ != nullptr) {
+      parent_->FreeMem(mem);
+    }
+    UpdateBudgetState();
   }
 
  private:
@@ -94,9 +151,38 @@ class WriteBufferManager {
   struct CacheRep;
   std::unique_ptr<CacheRep> cache_rep_;
 
+  const std::shared_ptr<WriteBufferManager> parent_;
+  const std::string name_;
+  const uint32_t weight_;
+  // Sum of the weights of the children
+  std::atomic<uint64_t> children_weight_;
+  // Last ExceedsBudget() seen by UpdateBudgetState()
+  std::atomic<bool> exceeds_budget_;
+  // Number of descendants whose exceeds_budget_ is set
+  std::atomic<int64_t> descendants_exceeding_;
+  std::atomic<uint64_t> flush_count_;
+  mutable std::mutex children_mutex_;
+  std::vector<const WriteBufferManager*> children_;
+
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
 
+  // Keeps descendants_exceeding_ of the ancestors up to date. Racing updates
+  // may leave the state stale until the next reservation of this node, which
+  // only delays a flush by one write.
+  void UpdateBudgetState() {
+    if (parent_ == nullptr || !enabled()) {
+      return;
+    }
+    bool exceeds = ExceedsBudget();
+    if (exceeds_budget_.load(std::memory_order_relaxed) != exceeds &&
+        exceeds_budget_.exchange(exceeds, std::memory_order_relaxed) !=
+            exceeds) {
+      PropagateBudgetState(exceeds ? 1 : -1);
+    }
+  }
+  void PropagateBudgetState(int64_t delta);
+
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
   WriteBufferManager& operator=(const WriteBufferManager&) = delete;
@@ -3476,8 +3476,36 @@ class TickerTypeJni {
         return 0x63;
       case TERARKDB_NAMESPACE::Tickers::GC_SKIP_GET_BY_FILE:
         return 0x64;
-      case TERARKDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
+      case TERARKDB_NAMESPACE::Tickers::READ_DEPENDENCE_MAP_LOOKUP:
         return 0x65;
+      case TERARKDB_NAMESPACE::Tickers::READ_MAP_SST_HOPS:
+        return 0x66;
+      case TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_FETCH:
+        return 0x67;
+      case TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_FETCH_BYTES:
+        return 0x68;
+      case TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_MISSING:
+        return 0x69;
+      case TERARKDB_NAMESPACE::Tickers::ITER_VALUE_META_FILTERED:
+        return 0x6A;
+      case TERARKDB_NAMESPACE::Tickers::ITER_BLOB_FETCH_AVOIDED:
+        return 0x6B;
+      case TERARKDB_NAMESPACE::Tickers::BLOB_CACHE_HIT:
+        return 0x6C;
+      case TERARKDB_NAMESPACE::Tickers::BLOB_CACHE_MISS:
+        return 0x6D;
+      case TERARKDB_NAMESPACE::Tickers::BLOB_PERSISTENT_CACHE_HIT:
+        return 0x6E;
+      case TERARKDB_NAMESPACE::Tickers::BLOB_PERSISTENT_CACHE_MISS:
+        return 0x6F;
+      case TERARKDB_NAMESPACE::Tickers::BLOB_PERSISTENT_CACHE_ADD:
+        return 0x70;
+      case TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_LOCATION_HIT:
+        return 0x71;
+      case TERARKDB_NAMESPACE::Tickers::MAP_ELEMENT_FILTER_USEFUL:
+        return 0x72;
+      case TERARKDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
+        return 0x73;
 
       default:
         // undefined/default
@@ -3692,6 +3720,34 @@ class TickerTypeJni {
       case 0x64:
         return TERARKDB_NAMESPACE::Tickers::GC_SKIP_GET_BY_FILE;
       case 0x65:
+        return TERARKDB_NAMESPACE::Tickers::READ_DEPENDENCE_MAP_LOOKUP;
+      case 0x66:
+        return TERARKDB_NAMESPACE::Tickers::READ_MAP_SST_HOPS;
+      case 0x67:
+        return TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_FETCH;
+      case 0x68:
+        return TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_FETCH_BYTES;
+      case 0x69:
+        return TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_MISSING;
+      case 0x6A:
+        return TERARKDB_NAMESPACE::Tickers::ITER_VALUE_META_FILTERED;
+      case 0x6B:
+        return TERARKDB_NAMESPACE::Tickers::ITER_BLOB_FETCH_AVOIDED;
+      case 0x6C:
+        return TERARKDB_NAMESPACE::Tickers::BLOB_CACHE_HIT;
+      case 0x6D:
+        return TERARKDB_NAMESPACE::Tickers::BLOB_CACHE_MISS;
+      case 0x6E:
+        return TERARKDB_NAMESPACE::Tickers::BLOB_PERSISTENT_CACHE_HIT;
+      case 0x6F:
+        return TERARKDB_NAMESPACE::Tickers::BLOB_PERSISTENT_CACHE_MISS;
+      case 0x70:
+        return TERARKDB_NAMESPACE::Tickers::BLOB_PERSISTENT_CACHE_ADD;
+      case 0x71:
+        return TERARKDB_NAMESPACE::Tickers::SEPARATE_VALUE_LOCATION_HIT;
+      case 0x72:
+        return TERARKDB_NAMESPACE::Tickers::MAP_ELEMENT_FILTER_USEFUL;
+      case 0x73:
         return TERARKDB_NAMESPACE::Tickers::TICKER_ENUM_MAX;
 
       default:
@@ -3781,8 +3837,12 @@ class HistogramTypeJni {
         return 0x22;
       case TERARKDB_NAMESPACE::Histograms::BUILD_VERSION_TIME:
         return 0x23;
-      case TERARKDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX:
+      case TERARKDB_NAMESPACE::Histograms::SEPARATE_VALUE_FETCH_MICROS:
         return 0x24;
+      case TERARKDB_NAMESPACE::Histograms::SEPARATE_VALUE_SIZE:
+        return 0x25;
+      case TERARKDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX:
+        return 0x26;
 
       default:
         // undefined/default
@@ -3868,6 +3928,10 @@ class HistogramTypeJni {
       case 0x23:
         return TERARKDB_NAMESPACE::Histograms::BUILD_VERSION_TIME;
       case 0x24:
+        return TERARKDB_NAMESPACE::Histograms::SEPARATE_VALUE_FETCH_MICROS;
+      case 0x25:
+        return TERARKDB_NAMESPACE::Histograms::SEPARATE_VALUE_SIZE;
+      case 0x26:
         return TERARKDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX;
 
       default:
@@ -492,7 +492,80 @@ public enum TickerType {
 
     SKIP_GC_GET_BY_FILE((byte) 0x64),
 
-    TICKER_ENUM_MAX((byte) 0x65);
+    /**
+     * Number of dependence map lookups on the read path.
+     */
+    READ_DEPENDENCE_MAP_LOOKUP((byte) 0x65),
+
+    /**
+     * Number of map sst links followed by point lookups.
+     */
+    READ_MAP_SST_HOPS((byte) 0x66),
+
+    /**
+     * Number of separated values fetched from blob ssts.
+     */
+    SEPARATE_VALUE_FETCH((byte) 0x67),
+
+    /**
+     * Number of bytes of separated values fetched from blob ssts.
+     */
+    SEPARATE_VALUE_FETCH_BYTES((byte) 0x68),
+
+    /**
+     * Number of separated values that could not be found.
+     */
+    SEPARATE_VALUE_MISSING((byte) 0x69),
+
+    /**
+     * Number of keys skipped by iterators because of the value meta filter.
+     */
+    ITER_VALUE_META_FILTERED((byte) 0x6A),
+
+    /**
+     * Number of separated values skipped by the value meta filter without
+     * being fetched.
+     */
+    ITER_BLOB_FETCH_AVOIDED((byte) 0x6B),
+
+    /**
+     * Number of separated values served from the blob cache.
+     */
+    BLOB_CACHE_HIT((byte) 0x6C),
+
+    /**
+     * Number of separated values not found in the blob cache.
+     */
+    BLOB_CACHE_MISS((byte) 0x6D),
+
+    /**
+     * Number of separated values served from the blob persistent cache.
+     */
+    BLOB_PERSISTENT_CACHE_HIT((byte) 0x6E),
+
+    /**
+     * Number of separated values not found in the blob persistent cache.
+     */
+    BLOB_PERSISTENT_CACHE_MISS((byte) 0x6F),
+
+    /**
+     * Number of separated values admitted to the blob persistent cache.
+     */
+    BLOB_PERSISTENT_CACHE_ADD((byte) 0x70),
+
+    /**
+     * Number of separated values read at the location recorded in their
+     * value index.
+     */
+    SEPARATE_VALUE_LOCATION_HIT((byte) 0x71),
+
+    /**
+     * # of map sst elements skipped by point lookups because their filter
+     * excludes the key.
+     */
+    MAP_ELEMENT_FILTER_USEFUL((byte) 0x72),
+
+    TICKER_ENUM_MAX((byte) 0x73);
 
 
     private final byte value;
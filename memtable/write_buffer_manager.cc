@@ -9,6 +9,9 @@
 
 #include "rocksdb/write_buffer_manager.h"
 
+#include <inttypes.h>
+
+#include <algorithm>
 #include <mutex>
 
 #include "rocksdb/terark_namespace.h"
@@ -57,7 +60,12 @@ WriteBufferManager::WriteBufferManager(size_t _buffer_size,
       mutable_limit_(buffer_size_ * 7 / 8),
       memory_used_(0),
       memory_active_(0),
-      cache_rep_(nullptr) {
+      cache_rep_(nullptr),
+      weight_(1),
+      children_weight_(0),
+      exceeds_budget_(false),
+      descendants_exceeding_(0),
+      flush_count_(0) {
 #ifndef ROCKSDB_LITE
   if (cache) {
     // Construct the cache key using the pointer to this.
@@ -68,7 +76,39 @@ WriteBufferManager::WriteBufferManager(size_t _buffer_size,
 #endif  // ROCKSDB_LITE
 }
 
+WriteBufferManager::WriteBufferManager(
+    size_t _buffer_size, std::shared_ptr<WriteBufferManager> parent,
+    std::string name, uint32_t weight)
+    : buffer_size_(_buffer_size),
+      mutable_limit_(buffer_size_ * 7 / 8),
+      memory_used_(0),
+      memory_active_(0),
+      cache_rep_(nullptr),
+      parent_(std::move(parent)),
+      name_(std::move(name)),
+      weight_(std::max<uint32_t>(weight, 1)),
+      children_weight_(0),
+      exceeds_budget_(false),
+      descendants_exceeding_(0),
+      flush_count_(0) {
+  if (parent_ != nullptr) {
+    parent_->children_weight_.fetch_add(weight_, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(parent_->children_mutex_);
+    parent_->children_.push_back(this);
+  }
+}
+
 WriteBufferManager::~WriteBufferManager() {
+  assert(children_.empty());
+  if (parent_ != nullptr) {
+    if (exceeds_budget_.load(std::memory_order_relaxed)) {
+      PropagateBudgetState(-1);
+    }
+    parent_->children_weight_.fetch_sub(weight_, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(parent_->children_mutex_);
+    auto& siblings = parent_->children_;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+  }
 #ifndef ROCKSDB_LITE
   if (cache_rep_) {
     for (auto* handle : cache_rep_->dummy_handles_) {
@@ -78,16 +118,67 @@ WriteBufferManager::~WriteBufferManager() {
 #endif  // ROCKSDB_LITE
 }
 
+void WriteBufferManager::PropagateBudgetState(int64_t delta) {
+  for (auto p = parent_.get(); p != nullptr; p = p->parent_.get()) {
+    p->descendants_exceeding_.fetch_add(delta, std::memory_order_relaxed);
+  }
+}
+
+double WriteBufferManager::ShareRatio() const {
+  double ratio = 1;
+  for (auto node = this; node->parent_ != nullptr;
+       node = node->parent_.get()) {
+    size_t parent_usage = node->parent_->memory_usage();
+    uint64_t total_weight =
+        node->parent_->children_weight_.load(std::memory_order_relaxed);
+    if (parent_usage == 0 || total_weight == 0) {
+      continue;
+    }
+    double share = double(parent_usage) * node->weight_ / total_weight;
+    ratio *= node->memory_usage() / share;
+  }
+  return ratio;
+}
+
+void WriteBufferManager::GetStats(std::string* value) const {
+  char buf[256];
+  std::vector<std::pair<const WriteBufferManager*, int>> stack{{this, 0}};
+  while (!stack.empty()) {
+    auto node = stack.back().first;
+    int depth = stack.back().second;
+    stack.pop_back();
+    snprintf(buf, sizeof(buf),
+             "%*s%s: usage %" PRIu64 " mutable %" PRIu64 " limit %" PRIu64
+             " weight %" PRIu32 " share %.2f flushes %" PRIu64 "%s\n",
+             depth * 2, "", node->name_.empty() ? "(root)" : node->name_.c_str(),
+             uint64_t(node->memory_usage()),
+             uint64_t(node->mutable_memtable_memory_usage()),
+             uint64_t(node->buffer_size_), node->weight_, node->ShareRatio(),
+             node->flush_count_.load(std::memory_order_relaxed),
+             node->ExceedsBudget() ? " full" : "");
+    value->append(buf);
+    std::lock_guard<std::mutex> lock(node->children_mutex_);
+    for (auto it = node->children_.rbegin(); it != node->children_.rend();
+         ++it) {
+      stack.emplace_back(*it, depth + 1);
+    }
+  }
+}
+
 // Should only be called from write thread
 void WriteBufferManager::ReserveMemWithCache(size_t mem) {
 #ifndef ROCKSDB_LITE
   assert(cache_rep_ != nullptr);
-  // Use a mutex to protect various data structures. Can be optimized to a
-  // lock-free solution if it ends up with a performance bottleneck.
+  // Dummy entries are 1MB each, so most reservations fit into what is
+  // already costed to the cache and don't need the mutex.
+  size_t new_mem_used =
+      memory_used_.fetch_add(mem, std::memory_order_relaxed) + mem;
+  if (new_mem_used <= cache_rep_->cache_allocated_size_.load(
+                          std::memory_order_relaxed)) {
+    return;
+  }
   std::lock_guard<std::mutex> lock(cache_rep_->cache_mutex_);
-
-  size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) + mem;
-  memory_used_.store(new_mem_used, std::memory_order_relaxed);
+  new_mem_used = memory_used_.load(std::memory_order_relaxed);
   while (new_mem_used > cache_rep_->cache_allocated_size_) {
     // Expand size by at least 1MB.
     // Add a dummy record to the cache
@@ -105,11 +196,16 @@ void WriteBufferManager::ReserveMemWithCache(size_t mem) {
 void WriteBufferManager::FreeMemWithCache(size_t mem) {
 #ifndef ROCKSDB_LITE
   assert(cache_rep_ != nullptr);
-  // Use a mutex to protect various data structures. Can be optimized to a
-  // lock-free solution if it ends up with a performance bottleneck.
+  size_t new_mem_used =
+      memory_used_.fetch_sub(mem, std::memory_order_relaxed) - mem;
+  size_t allocated_size =
+      cache_rep_->cache_allocated_size_.load(std::memory_order_relaxed);
+  if (new_mem_used >= allocated_size / 4 * 3 ||
+      allocated_size - kSizeDummyEntry <= new_mem_used) {
+    return;
+  }
   std::lock_guard<std::mutex> lock(cache_rep_->cache_mutex_);
-  size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) - mem;
-  memory_used_.store(new_mem_used, std::memory_order_relaxed);
+  new_mem_used = memory_used_.load(std::memory_order_relaxed);
   // Gradually shrink memory costed in the block cache if the actual
   // usage is less than 3/4 of what we reserve from the block cache.
   // We do this because:
@@ -144,6 +144,83 @@ TEST_F(WriteBufferManagerTest, NoCapCacheCost) {
   ASSERT_GE(cache->GetPinnedUsage(), 1024 * 1024);
   ASSERT_LT(cache->GetPinnedUsage(), 1024 * 1024 + 10000);
 }
+
+TEST_F(WriteBufferManagerTest, Hierarchy) {
+  // DB of 10MB > group of 6MB > cf1 of 4MB with weight 3 and cf2 of weight 1
+  std::shared_ptr<WriteBufferManager> db(
+      new WriteBufferManager(10 * 1024 * 1024));
+  std::shared_ptr<WriteBufferManager> group(
+      new WriteBufferManager(6 * 1024 * 1024, db, "group"));
+  std::unique_ptr<WriteBufferManager> cf1(
+      new WriteBufferManager(4 * 1024 * 1024, group, "cf1", 3));
+  std::unique_ptr<WriteBufferManager> cf2(
+      new WriteBufferManager(0, group, "cf2"));
+  ASSERT_TRUE(cf2->tracks_memory());
+
+  cf1->ReserveMem(2 * 1024 * 1024);
+  cf2->ReserveMem(2 * 1024 * 1024);
+  ASSERT_EQ(4U * 1024 * 1024, group->memory_usage());
+  ASSERT_EQ(4U * 1024 * 1024, db->memory_usage());
+  ASSERT_FALSE(db->ShouldFlush());
+  // cf1 holds 2/3 of its share of the group, cf2 twice its share
+  ASSERT_NEAR(2.0 / 3, cf1->ShareRatio(), 0.01);
+  ASSERT_NEAR(2.0, cf2->ShareRatio(), 0.01);
+
+  // cf1 runs full on its own budget, the DB sees it
+  cf1->ReserveMem(2 * 1024 * 1024);
+  ASSERT_TRUE(cf1->ExceedsBudget());
+  ASSERT_TRUE(group->ExceedsBudget());
+  ASSERT_FALSE(db->ExceedsBudget());
+  ASSERT_TRUE(db->ShouldFlush());
+  ASSERT_TRUE(group->ShouldFlush());
+  ASSERT_FALSE(cf2->ShouldFlush());
+
+  // Flushing cf1 releases the pressure everywhere
+  cf1->ScheduleFreeMem(4 * 1024 * 1024);
+  ASSERT_FALSE(db->ShouldFlush());
+  cf1->FreeMem(4 * 1024 * 1024);
+  ASSERT_EQ(2U * 1024 * 1024, db->memory_usage());
+  ASSERT_FALSE(db->ShouldFlush());
+
+  cf1->RecordFlush();
+  std::string stats;
+  db->GetStats(&stats);
+  ASSERT_NE(std::string::npos, stats.find("(root): usage 2097152"));
+  ASSERT_NE(std::string::npos, stats.find("\n  group: usage 2097152"));
+  ASSERT_NE(std::string::npos, stats.find("\n    cf1: usage 0"));
+  ASSERT_NE(std::string::npos, stats.find("flushes 1"));
+
+  // cf2 has no limit of its own, but fills up the group
+  cf2->ReserveMem(5 * 1024 * 1024);
+  ASSERT_FALSE(cf2->ExceedsBudget());
+  ASSERT_TRUE(group->ExceedsBudget());
+  ASSERT_TRUE(db->ShouldFlush());
+  cf2->ScheduleFreeMem(7 * 1024 * 1024);
+  cf2->FreeMem(7 * 1024 * 1024);
+  ASSERT_FALSE(db->ShouldFlush());
+  cf1.reset();
+  cf2.reset();
+  ASSERT_EQ(0U, db->memory_usage());
+  ASSERT_NEAR(1.0, group->ShareRatio(), 0.01);
+}
+
+TEST_F(WriteBufferManagerTest, HierarchyCacheCost) {
+  std::shared_ptr<Cache> cache = NewLRUCache(1024 * 1024 * 1024, 4);
+  std::shared_ptr<WriteBufferManager> db(
+      new WriteBufferManager(50 * 1024 * 1024, cache));
+  std::unique_ptr<WriteBufferManager> cf(
+      new WriteBufferManager(0, db, "cf"));
+
+  // Memory of the child is costed to the cache of the root
+  cf->ReserveMem(1536 * 1024);
+  ASSERT_GE(cache->GetPinnedUsage(), 2 * 1024 * 1024);
+  ASSERT_LT(cache->GetPinnedUsage(), 2 * 1024 * 1024 + 10000);
+  cf->ReserveMem(256 * 1024);
+  ASSERT_LT(cache->GetPinnedUsage(), 2 * 1024 * 1024 + 10000);
+
+  cf->FreeMem(1792 * 1024);
+  ASSERT_LT(cache->GetPinnedUsage(), 1024 * 1024 + 10000);
+}
 #endif  // ROCKSDB_LITE
 }  // namespace TERARKDB_NAMESPACE
 
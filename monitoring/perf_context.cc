@@ -52,6 +52,15 @@ void PerfContext::Reset() {
   get_read_bytes = 0;
   multiget_read_bytes = 0;
   iter_read_bytes = 0;
+  blob_prefetch_read_bytes = 0;
+  blob_prefetch_used_bytes = 0;
+  dependence_map_lookup_count = 0;
+  map_sst_hop_count = 0;
+  separate_value_fetch_count = 0;
+  separate_value_fetch_bytes = 0;
+  separate_value_fetch_time = 0;
+  value_meta_filtered_count = 0;
+  blob_fetch_avoided_count = 0;
   internal_key_skipped_count = 0;
   internal_delete_skipped_count = 0;
   internal_recent_skipped_count = 0;
@@ -159,6 +168,15 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(get_read_bytes);
   PERF_CONTEXT_OUTPUT(multiget_read_bytes);
   PERF_CONTEXT_OUTPUT(iter_read_bytes);
+  PERF_CONTEXT_OUTPUT(blob_prefetch_read_bytes);
+  PERF_CONTEXT_OUTPUT(blob_prefetch_used_bytes);
+  PERF_CONTEXT_OUTPUT(dependence_map_lookup_count);
+  PERF_CONTEXT_OUTPUT(map_sst_hop_count);
+  PERF_CONTEXT_OUTPUT(separate_value_fetch_count);
+  PERF_CONTEXT_OUTPUT(separate_value_fetch_bytes);
+  PERF_CONTEXT_OUTPUT(separate_value_fetch_time);
+  PERF_CONTEXT_OUTPUT(value_meta_filtered_count);
+  PERF_CONTEXT_OUTPUT(blob_fetch_avoided_count);
   PERF_CONTEXT_OUTPUT(internal_key_skipped_count);
   PERF_CONTEXT_OUTPUT(internal_delete_skipped_count);
   PERF_CONTEXT_OUTPUT(internal_recent_skipped_count);
@@ -139,6 +139,20 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {GC_TOUCH_FILES, "rocksdb.num.gc.touch_files"},
     {GC_SKIP_GET_BY_SEQ, "rocksdb.num.gc.skip_by_seqno"},
     {GC_SKIP_GET_BY_FILE, "rocksdb.num.gc.skip_by_file_meta"},
+    {READ_DEPENDENCE_MAP_LOOKUP, "rocksdb.read.dependence.map.lookup"},
+    {READ_MAP_SST_HOPS, "rocksdb.read.map.sst.hops"},
+    {SEPARATE_VALUE_FETCH, "rocksdb.separate.value.fetch"},
+    {SEPARATE_VALUE_FETCH_BYTES, "rocksdb.separate.value.fetch.bytes"},
+    {SEPARATE_VALUE_MISSING, "rocksdb.separate.value.missing"},
+    {ITER_VALUE_META_FILTERED, "rocksdb.iter.value.meta.filtered"},
+    {ITER_BLOB_FETCH_AVOIDED, "rocksdb.iter.blob.fetch.avoided"},
+    {BLOB_CACHE_HIT, "rocksdb.blob.cache.hit"},
+    {BLOB_CACHE_MISS, "rocksdb.blob.cache.miss"},
+    {BLOB_PERSISTENT_CACHE_HIT, "rocksdb.blob.persistent.cache.hit"},
+    {BLOB_PERSISTENT_CACHE_MISS, "rocksdb.blob.persistent.cache.miss"},
+    {BLOB_PERSISTENT_CACHE_ADD, "rocksdb.blob.persistent.cache.add"},
+    {SEPARATE_VALUE_LOCATION_HIT, "rocksdb.separate.value.location.hit"},
+    {MAP_ELEMENT_FILTER_USEFUL, "rocksdb.map.element.filter.useful"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -178,6 +192,8 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {PICK_GARBAGE_COLLECTION_TIME, "rocksdb.pick.gc.micros"},
     {INSTALL_SUPER_VERSION_TIME, "rocksdb.install.super.version.micros"},
     {BUILD_VERSION_TIME, "rocksdb.build.version.micros"},
+    {SEPARATE_VALUE_FETCH_MICROS, "rocksdb.separate.value.fetch.micros"},
+    {SEPARATE_VALUE_SIZE, "rocksdb.separate.value.size"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
@@ -57,6 +57,7 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       db_paths(db_options.db_paths),
       memtable_factory(cf_options.memtable_factory.get()),
       atomic_flush_group(cf_options.atomic_flush_group.get()),
+      cf_write_buffer_manager(cf_options.cf_write_buffer_manager.get()),
       table_factory(cf_options.table_factory.get()),
       table_properties_collector_factories(
           cf_options.table_properties_collector_factories),
@@ -82,6 +83,12 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       preserve_deletes(db_options.preserve_deletes),
       listeners(db_options.listeners),
       row_cache(db_options.row_cache),
+      blob_cache(db_options.blob_cache),
+      blob_persistent_cache(db_options.blob_persistent_cache),
+      blob_persistent_cache_max_value_size(
+          db_options.blob_persistent_cache_max_value_size),
+      blob_persistent_cache_admission_fetches(
+          db_options.blob_persistent_cache_admission_fetches),
       memtable_insert_with_hint_prefix_extractor(
           cf_options.memtable_insert_with_hint_prefix_extractor.get()),
       cf_paths(cf_options.cf_paths) {
@@ -92,6 +99,10 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       int_tbl_prop_collector_factories_for_blob->emplace_back(
           new UserKeyTablePropertiesCollectorFactory(f));
     }
+    if (cf_options.enable_adaptive_blob_size) {
+      int_tbl_prop_collector_factories_for_blob->emplace_back(
+          NewValueSizeHistogramCollectorFactory());
+    }
   }
 }
 
@@ -164,6 +175,10 @@ void MutableCFOptions::RefreshDerivedOptions(
         NewTtlIntTblPropCollectorFactory(ioptions.ttl_extractor_factory,
                                          ttl_gc_ratio, ttl_max_scan_gap));
   }
+  if (enable_adaptive_blob_size) {
+    int_tbl_prop_collector_factories->emplace_back(
+        NewValueSizeHistogramCollectorFactory());
+  }
 }
 
 void MutableCFOptions::Dump(Logger* log) const {
@@ -194,6 +209,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  disable_auto_compactions);
   ROCKS_LOG_INFO(log, "                       max_subcompactions: %u",
                  max_subcompactions);
+  ROCKS_LOG_INFO(log, "                     max_flush_partitions: %u",
+                 max_flush_partitions);
   ROCKS_LOG_INFO(log, "                                blob_size: %zd",
                  blob_size);
   ROCKS_LOG_INFO(log, "                     blob_large_key_ratio: %f",
@@ -208,6 +225,16 @@ void MutableCFOptions::Dump(Logger* log) const {
                  max_dependence_blob_overlap);
   ROCKS_LOG_INFO(log, "                     maintainer_job_ratio: %f",
                  maintainer_job_ratio);
+  ROCKS_LOG_INFO(log, "                     enable_log_sst_flush: %d",
+                 enable_log_sst_flush);
+  ROCKS_LOG_INFO(log, "                enable_adaptive_blob_size: %d",
+                 enable_adaptive_blob_size);
+  ROCKS_LOG_INFO(log, "          adaptive_blob_size_write_weight: %f",
+                 adaptive_blob_size_write_weight);
+  ROCKS_LOG_INFO(log, "          map_element_filter_bits_per_key: %u",
+                 map_element_filter_bits_per_key);
+  ROCKS_LOG_INFO(log, "               enable_blob_value_location: %d",
+                 enable_blob_value_location);
   ROCKS_LOG_INFO(log, "      soft_pending_compaction_bytes_limit: %" PRIu64,
                  soft_pending_compaction_bytes_limit);
   ROCKS_LOG_INFO(log, "      hard_pending_compaction_bytes_limit: %" PRIu64,
@@ -292,6 +319,7 @@ MutableCFOptions::MutableCFOptions(const ColumnFamilyOptions& options, Env* env)
       prefix_extractor(options.prefix_extractor),
       disable_auto_compactions(options.disable_auto_compactions),
       max_subcompactions(options.max_subcompactions),
+      max_flush_partitions(options.max_flush_partitions),
       blob_size(options.blob_size),
       blob_large_key_ratio(options.blob_large_key_ratio),
       blob_gc_ratio(options.blob_gc_ratio),
@@ -299,6 +327,11 @@ MutableCFOptions::MutableCFOptions(const ColumnFamilyOptions& options, Env* env)
       blob_file_defragment_size(options.blob_file_defragment_size),
       max_dependence_blob_overlap(options.max_dependence_blob_overlap),
       maintainer_job_ratio(options.maintainer_job_ratio),
+      enable_log_sst_flush(options.enable_log_sst_flush),
+      enable_adaptive_blob_size(options.enable_adaptive_blob_size),
+      adaptive_blob_size_write_weight(options.adaptive_blob_size_write_weight),
+      map_element_filter_bits_per_key(options.map_element_filter_bits_per_key),
+      enable_blob_value_location(options.enable_blob_value_location),
       soft_pending_compaction_bytes_limit(
           options.soft_pending_compaction_bytes_limit),
       hard_pending_compaction_bytes_limit(
@@ -337,6 +370,10 @@ MutableCFOptions::MutableCFOptions(const ColumnFamilyOptions& options, Env* env)
         NewTtlIntTblPropCollectorFactory(options.ttl_extractor_factory.get(),
                                          ttl_gc_ratio, ttl_max_scan_gap));
   }
+  if (enable_adaptive_blob_size) {
+    int_tbl_prop_collector_factories->emplace_back(
+        NewValueSizeHistogramCollectorFactory());
+  }
 }
 
 MutableCFOptions::MutableCFOptions(const Options& options)
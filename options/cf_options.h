@@ -84,6 +84,8 @@ struct ImmutableCFOptions {
 
   AtomicFlushGroup* atomic_flush_group;
 
+  WriteBufferManager* cf_write_buffer_manager;
+
   TableFactory* table_factory;
 
   Options::TablePropertiesCollectorFactories
@@ -129,6 +131,14 @@ struct ImmutableCFOptions {
 
   std::shared_ptr<Cache> row_cache;
 
+  std::shared_ptr<Cache> blob_cache;
+
+  std::shared_ptr<PersistentCache> blob_persistent_cache;
+
+  uint64_t blob_persistent_cache_max_value_size;
+
+  uint32_t blob_persistent_cache_admission_fetches;
+
   const SliceTransform* memtable_insert_with_hint_prefix_extractor;
 
   std::vector<DbPath> cf_paths;
@@ -156,6 +166,7 @@ struct MutableCFOptions {
         prefix_extractor(nullptr),
         disable_auto_compactions(false),
         max_subcompactions(0),
+        max_flush_partitions(1),
         blob_size(0),
         blob_large_key_ratio(0),
         blob_gc_ratio(0),
@@ -163,6 +174,11 @@ struct MutableCFOptions {
         blob_file_defragment_size(0),
         max_dependence_blob_overlap(0),
         maintainer_job_ratio(0),
+        enable_log_sst_flush(false),
+        enable_adaptive_blob_size(false),
+        adaptive_blob_size_write_weight(0),
+        map_element_filter_bits_per_key(0),
+        enable_blob_value_location(false),
         soft_pending_compaction_bytes_limit(0),
         hard_pending_compaction_bytes_limit(0),
         level0_file_num_compaction_trigger(0),
@@ -217,6 +233,7 @@ struct MutableCFOptions {
   // Compaction related options
   bool disable_auto_compactions;
   uint32_t max_subcompactions;
+  uint32_t max_flush_partitions;
   size_t blob_size;
   double blob_large_key_ratio;
   double blob_gc_ratio;
@@ -224,6 +241,11 @@ struct MutableCFOptions {
   uint64_t blob_file_defragment_size;
   size_t max_dependence_blob_overlap;
   double maintainer_job_ratio;
+  bool enable_log_sst_flush;
+  bool enable_adaptive_blob_size;
+  double adaptive_blob_size_write_weight;
+  uint32_t map_element_filter_bits_per_key;
+  bool enable_blob_value_location;
   uint64_t soft_pending_compaction_bytes_limit;
   uint64_t hard_pending_compaction_bytes_limit;
   int level0_file_num_compaction_trigger;
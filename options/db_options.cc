@@ -15,6 +15,7 @@
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/env.h"
+#include "rocksdb/persistent_cache.h"
 #include "rocksdb/sst_file_manager.h"
 #include "rocksdb/terark_namespace.h"
 #include "rocksdb/wal_filter.h"
@@ -46,6 +47,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       keep_log_file_num(options.keep_log_file_num),
       recycle_log_file_num(options.recycle_log_file_num),
       prepare_log_writer_num(options.prepare_log_writer_num),
+      wal_streams(options.wal_streams),
       max_manifest_file_size(options.max_manifest_file_size),
       max_manifest_edit_count(options.max_manifest_edit_count),
       table_cache_numshardbits(options.table_cache_numshardbits),
@@ -58,6 +60,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       use_direct_io_for_flush_and_compaction(
           options.use_direct_io_for_flush_and_compaction),
       use_aio_reads(options.use_aio_reads),
+      multi_read_queue_depth(options.multi_read_queue_depth),
       allow_fallocate(options.allow_fallocate),
       is_fd_close_on_exec(options.is_fd_close_on_exec),
       advise_random_on_open(options.advise_random_on_open),
@@ -80,8 +83,15 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       write_thread_slow_yield_usec(options.write_thread_slow_yield_usec),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
+      wal_recovery_threads(options.wal_recovery_threads),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      blob_cache(options.blob_cache),
+      blob_persistent_cache(options.blob_persistent_cache),
+      blob_persistent_cache_max_value_size(
+          options.blob_persistent_cache_max_value_size),
+      blob_persistent_cache_admission_fetches(
+          options.blob_persistent_cache_admission_fetches),
 #ifndef ROCKSDB_LITE
       wal_filter(options.wal_filter),
 #endif  // ROCKSDB_LITE
@@ -135,6 +145,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, "                 Options.prepare_log_writer_num: %" ROCKSDB_PRIszt,
       prepare_log_writer_num);
+  ROCKS_LOG_HEADER(
+      log, "                            Options.wal_streams: %" ROCKSDB_PRIszt,
+      wal_streams);
   ROCKS_LOG_HEADER(log, "                        Options.allow_fallocate: %d",
                    allow_fallocate);
   ROCKS_LOG_HEADER(log, "                       Options.allow_mmap_reads: %d",
@@ -149,6 +162,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    use_direct_io_for_flush_and_compaction);
   ROCKS_LOG_HEADER(log, "                          Options.use_aio_reads: %d",
                    use_aio_reads);
+  ROCKS_LOG_HEADER(
+      log, "                 Options.multi_read_queue_depth: %" ROCKSDB_PRIszt,
+      multi_read_queue_depth);
   ROCKS_LOG_HEADER(log, "         Options.create_missing_column_families: %d",
                    create_missing_column_families);
   ROCKS_LOG_HEADER(log, "                             Options.db_log_dir: %s",
@@ -207,6 +223,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       sst_file_manager ? sst_file_manager->GetDeleteRateBytesPerSecond() : 0);
   ROCKS_LOG_HEADER(log, "                      Options.wal_recovery_mode: %d",
                    int(wal_recovery_mode));
+  ROCKS_LOG_HEADER(
+      log, "                   Options.wal_recovery_threads: %" ROCKSDB_PRIszt,
+      wal_recovery_threads);
   ROCKS_LOG_HEADER(log, "                 Options.enable_thread_tracking: %d",
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
@@ -229,6 +248,24 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  if (blob_cache) {
+    ROCKS_LOG_HEADER(log,
+                     "                             Options.blob_cache: %zu",
+                     blob_cache->GetCapacity());
+  } else {
+    ROCKS_LOG_HEADER(log,
+                     "                             Options.blob_cache: None");
+  }
+  ROCKS_LOG_HEADER(log, "                  Options.blob_persistent_cache: %s",
+                   blob_persistent_cache
+                       ? blob_persistent_cache->GetPrintableOptions().c_str()
+                       : "None");
+  ROCKS_LOG_HEADER(
+      log, "   Options.blob_persistent_cache_max_value_size: %" PRIu64,
+      blob_persistent_cache_max_value_size);
+  ROCKS_LOG_HEADER(
+      log, "Options.blob_persistent_cache_admission_fetches: %" PRIu32,
+      blob_persistent_cache_admission_fetches);
 #ifndef ROCKSDB_LITE
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
@@ -42,6 +42,7 @@ struct ImmutableDBOptions {
   size_t keep_log_file_num;
   size_t recycle_log_file_num;
   size_t prepare_log_writer_num;
+  size_t wal_streams;
   uint64_t max_manifest_file_size;
   uint64_t max_manifest_edit_count;
   int table_cache_numshardbits;
@@ -53,6 +54,7 @@ struct ImmutableDBOptions {
   bool use_direct_reads;
   bool use_direct_io_for_flush_and_compaction;
   bool use_aio_reads;
+  size_t multi_read_queue_depth;
   bool allow_fallocate;
   bool is_fd_close_on_exec;
   bool advise_random_on_open;
@@ -73,8 +75,13 @@ struct ImmutableDBOptions {
   uint64_t write_thread_slow_yield_usec;
   bool skip_stats_update_on_db_open;
   WALRecoveryMode wal_recovery_mode;
+  size_t wal_recovery_threads;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  std::shared_ptr<Cache> blob_cache;
+  std::shared_ptr<PersistentCache> blob_persistent_cache;
+  uint64_t blob_persistent_cache_max_value_size;
+  uint32_t blob_persistent_cache_admission_fetches;
 #ifndef ROCKSDB_LITE
   WalFilter* wal_filter;
 #endif  // ROCKSDB_LITE
@@ -31,6 +31,7 @@
 #include "rocksdb/table.h"
 #include "rocksdb/terark_namespace.h"
 #include "rocksdb/wal_filter.h"
+#include "rocksdb/write_buffer_manager.h"
 #include "table/block_based_table_factory.h"
 #include "util/compression.h"
 
@@ -151,6 +152,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                    memtable_factory->Name());
   ROCKS_LOG_HEADER(log, "      Options.atomic_flush_group: %012" PRIXPTR,
                    uintptr_t(atomic_flush_group.get()));
+  ROCKS_LOG_HEADER(log, " Options.cf_write_buffer_manager: %s",
+                   cf_write_buffer_manager
+                       ? cf_write_buffer_manager->name().c_str()
+                       : "None");
   ROCKS_LOG_HEADER(log, "           Options.table_factory: %s",
                    table_factory->Name());
   ROCKS_LOG_HEADER(log, "           table_factory options: %s",
@@ -263,6 +268,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                    disable_auto_compactions);
   ROCKS_LOG_HEADER(log, "                     Options.max_subcompactions: %u",
                    max_subcompactions);
+  ROCKS_LOG_HEADER(log, "                   Options.max_flush_partitions: %u",
+                   max_flush_partitions);
   ROCKS_LOG_HEADER(log, "                              Options.blob_size: %zd",
                    blob_size);
   ROCKS_LOG_HEADER(log, "                   Options.blob_large_key_ratio: %f",
@@ -279,6 +286,16 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                    max_dependence_blob_overlap);
   ROCKS_LOG_HEADER(log, "                   Options.maintainer_job_ratio: %f",
                    maintainer_job_ratio);
+  ROCKS_LOG_HEADER(log, "                   Options.enable_log_sst_flush: %d",
+                   enable_log_sst_flush);
+  ROCKS_LOG_HEADER(log, "              Options.enable_adaptive_blob_size: %d",
+                   enable_adaptive_blob_size);
+  ROCKS_LOG_HEADER(log, "        Options.adaptive_blob_size_write_weight: %f",
+                   adaptive_blob_size_write_weight);
+  ROCKS_LOG_HEADER(log, "        Options.map_element_filter_bits_per_key: %u",
+                   map_element_filter_bits_per_key);
+  ROCKS_LOG_HEADER(log, "             Options.enable_blob_value_location: %d",
+                   enable_blob_value_location);
   ROCKS_LOG_HEADER(log, "                           Options.ttl_gc_ratio: %f",
                    ttl_gc_ratio);
   ROCKS_LOG_HEADER(log, "                       Options.ttl_max_scan_gap: %zd",
@@ -584,6 +601,8 @@ ReadOptions::ReadOptions()
       background_purge_on_iterator_cleanup(false),
       ignore_range_deletions(false),
       aio_concurrency(32),
+      batch_separated_fetch(true),
+      blob_readahead_size(0),
       iter_start_seqnum(0) {}
 
 ReadOptions::ReadOptions(bool cksum, bool cache)
@@ -602,6 +621,8 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       background_purge_on_iterator_cleanup(false),
       ignore_range_deletions(false),
       aio_concurrency(32),
+      batch_separated_fetch(true),
+      blob_readahead_size(0),
       iter_start_seqnum(0) {}
 
 }  // namespace TERARKDB_NAMESPACE
@@ -70,6 +70,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.keep_log_file_num = immutable_db_options.keep_log_file_num;
   options.recycle_log_file_num = immutable_db_options.recycle_log_file_num;
   options.prepare_log_writer_num = immutable_db_options.prepare_log_writer_num;
+  options.wal_streams = immutable_db_options.wal_streams;
   options.max_manifest_file_size = immutable_db_options.max_manifest_file_size;
   options.max_manifest_edit_count =
       immutable_db_options.max_manifest_edit_count;
@@ -85,6 +86,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.use_direct_io_for_flush_and_compaction =
       immutable_db_options.use_direct_io_for_flush_and_compaction;
   options.use_aio_reads = immutable_db_options.use_aio_reads;
+  options.multi_read_queue_depth = immutable_db_options.multi_read_queue_depth;
   options.allow_fallocate = immutable_db_options.allow_fallocate;
   options.is_fd_close_on_exec = immutable_db_options.is_fd_close_on_exec;
   options.stats_dump_period_sec = mutable_db_options.stats_dump_period_sec;
@@ -124,8 +126,15 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.skip_stats_update_on_db_open =
       immutable_db_options.skip_stats_update_on_db_open;
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
+  options.wal_recovery_threads = immutable_db_options.wal_recovery_threads;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.blob_cache = immutable_db_options.blob_cache;
+  options.blob_persistent_cache = immutable_db_options.blob_persistent_cache;
+  options.blob_persistent_cache_max_value_size =
+      immutable_db_options.blob_persistent_cache_max_value_size;
+  options.blob_persistent_cache_admission_fetches =
+      immutable_db_options.blob_persistent_cache_admission_fetches;
 #ifndef ROCKSDB_LITE
   options.wal_filter = immutable_db_options.wal_filter;
 #endif  // ROCKSDB_LITE
@@ -175,6 +184,15 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.max_dependence_blob_overlap =
       mutable_cf_options.max_dependence_blob_overlap;
   cf_opts.maintainer_job_ratio = mutable_cf_options.maintainer_job_ratio;
+  cf_opts.enable_log_sst_flush = mutable_cf_options.enable_log_sst_flush;
+  cf_opts.enable_adaptive_blob_size =
+      mutable_cf_options.enable_adaptive_blob_size;
+  cf_opts.adaptive_blob_size_write_weight =
+      mutable_cf_options.adaptive_blob_size_write_weight;
+  cf_opts.map_element_filter_bits_per_key =
+      mutable_cf_options.map_element_filter_bits_per_key;
+  cf_opts.enable_blob_value_location =
+      mutable_cf_options.enable_blob_value_location;
   cf_opts.optimize_filters_for_hits =
       mutable_cf_options.optimize_filters_for_hits;
   cf_opts.optimize_range_deletion = mutable_cf_options.optimize_range_deletion;
@@ -212,6 +230,7 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.report_bg_io_stats = mutable_cf_options.report_bg_io_stats;
   cf_opts.compression = mutable_cf_options.compression;
   cf_opts.max_subcompactions = mutable_cf_options.max_subcompactions;
+  cf_opts.max_flush_partitions = mutable_cf_options.max_flush_partitions;
 
   cf_opts.table_factory = options.table_factory;
   // TODO(yhchiang): find some way to handle the following derived options
@@ -234,7 +253,9 @@ std::map<CompactionPri, std::string> OptionsHelper::compaction_pri_to_string = {
 
 std::map<WriteBufferFlushPri, std::string>
     OptionsHelper::write_buffer_flush_pri_to_string = {
-        {kFlushOldest, "kFlushOldest"}, {kFlushLargest, "kFlushLargest"}};
+        {kFlushOldest, "kFlushOldest"},
+        {kFlushLargest, "kFlushLargest"},
+        {kFlushMostEfficient, "kFlushMostEfficient"}};
 
 std::map<CompactionStopStyle, std::string>
     OptionsHelper::compaction_stop_style_to_string = {
@@ -1513,6 +1534,8 @@ std::unordered_map<std::string, OptionTypeInfo>
          // not yet supported
           Env* env;
           std::shared_ptr<Cache> row_cache;
+          std::shared_ptr<Cache> blob_cache;
+          std::shared_ptr<PersistentCache> blob_persistent_cache;
           std::shared_ptr<DeleteScheduler> delete_scheduler;
           std::shared_ptr<Logger> info_log;
           std::shared_ptr<RateLimiter> rate_limiter;
@@ -1523,6 +1546,12 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"advise_random_on_open",
          {offsetof(struct DBOptions, advise_random_on_open),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"blob_persistent_cache_max_value_size",
+         {offsetof(struct DBOptions, blob_persistent_cache_max_value_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
+        {"blob_persistent_cache_admission_fetches",
+         {offsetof(struct DBOptions, blob_persistent_cache_admission_fetches),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
         {"allow_mmap_populate",
          {offsetof(struct DBOptions, allow_mmap_populate), OptionType::kBoolean,
           OptionVerificationType::kNormal, false, 0}},
@@ -1547,6 +1576,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"use_aio_reads",
          {offsetof(struct DBOptions, use_aio_reads), OptionType::kBoolean,
           OptionVerificationType::kNormal, false, 0}},
+        {"multi_read_queue_depth",
+         {offsetof(struct DBOptions, multi_read_queue_depth),
+          OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
         {"allow_2pc",
          {offsetof(struct DBOptions, allow_2pc), OptionType::kBoolean,
           OptionVerificationType::kNormal, false, 0}},
@@ -1645,6 +1677,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"prepare_log_writer_num",
          {offsetof(struct DBOptions, prepare_log_writer_num),
           OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
+        {"wal_streams",
+         {offsetof(struct DBOptions, wal_streams), OptionType::kSizeT,
+          OptionVerificationType::kNormal, false, 0}},
         {"log_file_time_to_roll",
          {offsetof(struct DBOptions, log_file_time_to_roll), OptionType::kSizeT,
           OptionVerificationType::kNormal, false, 0}},
@@ -1725,6 +1760,9 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, wal_recovery_mode),
           OptionType::kWALRecoveryMode, OptionVerificationType::kNormal, false,
           0}},
+        {"wal_recovery_threads",
+         {offsetof(struct DBOptions, wal_recovery_threads), OptionType::kSizeT,
+          OptionVerificationType::kNormal, false, 0}},
         {"enable_write_thread_adaptive_yield",
          {offsetof(struct DBOptions, enable_write_thread_adaptive_yield),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -1818,7 +1856,9 @@ std::unordered_map<std::string, CompactionPri>
 
 std::unordered_map<std::string, WriteBufferFlushPri>
     OptionsHelper::write_buffer_flush_pri_string_map = {
-        {"kFlushOldest", kFlushOldest}, {"kFlushLargest", kFlushLargest}};
+        {"kFlushOldest", kFlushOldest},
+        {"kFlushLargest", kFlushLargest},
+        {"kFlushMostEfficient", kFlushMostEfficient}};
 
 std::unordered_map<std::string, WALRecoveryMode>
     OptionsHelper::wal_recovery_mode_string_map = {
@@ -1913,6 +1953,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offset_of(&ColumnFamilyOptions::max_subcompactions),
           OptionType::kUInt32T, OptionVerificationType::kNormal, true,
           offsetof(struct MutableCFOptions, max_subcompactions)}},
+        {"max_flush_partitions",
+         {offset_of(&ColumnFamilyOptions::max_flush_partitions),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, max_flush_partitions)}},
         {"blob_size",
          {offset_of(&ColumnFamilyOptions::blob_size), OptionType::kSizeT,
           OptionVerificationType::kNormal, true,
@@ -1941,6 +1985,26 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offset_of(&ColumnFamilyOptions::maintainer_job_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal, true,
           offsetof(struct MutableCFOptions, maintainer_job_ratio)}},
+        {"enable_log_sst_flush",
+         {offset_of(&ColumnFamilyOptions::enable_log_sst_flush),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, enable_log_sst_flush)}},
+        {"enable_adaptive_blob_size",
+         {offset_of(&ColumnFamilyOptions::enable_adaptive_blob_size),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, enable_adaptive_blob_size)}},
+        {"adaptive_blob_size_write_weight",
+         {offset_of(&ColumnFamilyOptions::adaptive_blob_size_write_weight),
+          OptionType::kDouble, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, adaptive_blob_size_write_weight)}},
+        {"map_element_filter_bits_per_key",
+         {offset_of(&ColumnFamilyOptions::map_element_filter_bits_per_key),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, map_element_filter_bits_per_key)}},
+        {"enable_blob_value_location",
+         {offset_of(&ColumnFamilyOptions::enable_blob_value_location),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, enable_blob_value_location)}},
         {"filter_deletes",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated, true,
           0}},
@@ -200,6 +200,9 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
       {offsetof(struct DBOptions, listeners),
        sizeof(std::vector<std::shared_ptr<EventListener>>)},
       {offsetof(struct DBOptions, row_cache), sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, blob_cache), sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, blob_persistent_cache),
+       sizeof(std::shared_ptr<PersistentCache>)},
       {offsetof(struct DBOptions, metrics_reporter_factory),
        sizeof(std::shared_ptr<MetricsReporterFactory>)},
       {offsetof(struct DBOptions, wal_filter), sizeof(const WalFilter*)},
@@ -241,6 +244,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "table_cache_numshardbits=28;"
                              "max_open_files=72;"
                              "max_file_opening_threads=35;"
+                             "blob_persistent_cache_max_value_size=65536;"
+                             "blob_persistent_cache_admission_fetches=3;"
                              "max_background_jobs=8;"
                              "base_background_compactions=3;"
                              "max_background_compactions=33;"
@@ -258,6 +263,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "db_log_dir=path/to/db_log_dir;"
                              "skip_log_error_on_recovery=true;"
                              "use_aio_reads=true;"
+                             "multi_read_queue_depth=32;"
                              "writable_file_max_buffer_size=1048576;"
                              "paranoid_checks=true;"
                              "is_fd_close_on_exec=false;"
@@ -265,6 +271,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "enable_thread_tracking=false;"
                              "recycle_log_file_num=0;"
                              "prepare_log_writer_num=0;"
+                             "wal_streams=2;"
+                             "wal_recovery_threads=3;"
                              "create_missing_column_families=true;"
                              "log_file_time_to_roll=3097;"
                              "max_background_flushes=35;"
@@ -352,6 +360,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<MemTableRepFactory>)},
       {offset_of(&ColumnFamilyOptions::atomic_flush_group),
        sizeof(std::shared_ptr<AtomicFlushGroup>)},
+      {offset_of(&ColumnFamilyOptions::cf_write_buffer_manager),
+       sizeof(std::shared_ptr<WriteBufferManager>)},
       {offset_of(&ColumnFamilyOptions::table_properties_collector_factories),
        sizeof(ColumnFamilyOptions::TablePropertiesCollectorFactories)},
       {offset_of(&ColumnFamilyOptions::comparator), sizeof(Comparator*)},
@@ -421,6 +431,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
   ASSERT_OK(GetColumnFamilyOptionsFromString(
       *options,
       "max_subcompactions=1;"
+      "max_flush_partitions=1;"
       "compaction_filter_factory=mpudlojcujCompactionFilterFactory;"
       "table_factory=PlainTable;"
       "prefix_extractor=rocksdb.CappedPrefix.13;"
@@ -474,6 +485,11 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "blob_file_defragment_size=0;"
       "max_dependence_blob_overlap=1024;"
       "maintainer_job_ratio=0.1;"
+      "enable_log_sst_flush=false;"
+      "enable_adaptive_blob_size=false;"
+      "adaptive_blob_size_write_weight=0.5;"
+      "map_element_filter_bits_per_key=10;"
+      "enable_blob_value_location=false;"
       "optimize_filters_for_hits=false;"
       "optimize_range_deletion=false;"
       "report_bg_io_stats=true;"
@@ -147,6 +147,7 @@ LIB_SOURCES =                                                   \
   table/terark_zip_table.cc                                     \
   table/two_level_iterator.cc                                   \
   tools/dump/db_dump_tool.cc                                    \
+  trace_replay/block_cache_tracer.cc                            \
   util/arena.cc                                                 \
   util/auto_roll_logger.cc                                      \
   util/bloom.cc                                                 \
@@ -190,6 +191,7 @@ LIB_SOURCES =                                                   \
   utilities/checkpoint/checkpoint_impl.cc                       \
   utilities/compaction_filters/remove_emptyvalue_compactionfilter.cc    \
   utilities/console/anet.cc                                     \
+  utilities/console/executor_db_impl.cc                         \
   utilities/console/executor_mem_impl.cc                        \
   utilities/console/resp_machine.cc                             \
   utilities/console/server.cc                                   \
@@ -222,6 +224,7 @@ LIB_SOURCES =                                                   \
   utilities/persistent_cache/persistent_cache_tier.cc           \
   utilities/persistent_cache/volatile_tier_impl.cc              \
   utilities/redis/redis_lists.cc                                \
+  utilities/simulator_cache/cache_simulator.cc                  \
   utilities/simulator_cache/sim_cache.cc                        \
   utilities/spatialdb/spatial_db.cc                             \
   utilities/table_properties_collectors/compact_on_deletion_collector.cc \
@@ -260,6 +263,7 @@ TOOL_LIB_SOURCES =                                              \
   tools/sst_dump_tool.cc                                        \
 
 ANALYZER_LIB_SOURCES = \
+  tools/block_cache_trace_analyzer.cc                           \
   tools/trace_analyzer_tool.cc                                  \
 
 MOCK_LIB_SOURCES = \
@@ -288,10 +292,13 @@ MAIN_SOURCES =                                                          \
   cache/cache_test.cc                                                   \
   db/column_family_test.cc                                              \
   db/compact_files_test.cc                                              \
+  db/compaction_dispatcher_test.cc                                      \
   db/compaction_iterator_test.cc                                        \
   db/compaction_job_stats_test.cc                                       \
   db/compaction_job_test.cc                                             \
   db/compaction_picker_test.cc                                          \
+  db/compaction_worker_codec_bench.cc                                   \
+  db/compaction_worker_context_test.cc                                  \
   db/comparator_db_test.cc                                              \
   db/corruption_test.cc                                                 \
   db/cuckoo_table_db_test.cc                                            \
@@ -397,6 +404,7 @@ MAIN_SOURCES =                                                          \
   table/terark_zip_table_reader.cc                                      \
   table/terark_zip_table.cc                                             \
   third-party/gtest-1.7.0/fused-src/gtest/gtest-all.cc                  \
+  tools/block_cache_trace_analyzer_test.cc                              \
   tools/db_bench.cc                                                     \
   tools/db_bench_tool_test.cc                                           \
   tools/db_sanity_test.cc                                               \
@@ -429,6 +437,7 @@ MAIN_SOURCES =                                                          \
   utilities/checkpoint/checkpoint_test.cc                               \
   utilities/column_aware_encoding_exp.cc                                \
   utilities/column_aware_encoding_test.cc                               \
+  utilities/console/console_bench.cc                                    \
   utilities/date_tiered/date_tiered_test.cc                             \
   utilities/document/document_db_test.cc                                \
   utilities/document/json_document_test.cc                              \
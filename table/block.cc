@@ -377,6 +377,21 @@ void IndexBlockIter::Seek(const Slice& target) {
   }
 }
 
+bool IndexBlockIter::SeekToEntry(uint32_t index, uint64_t num_entries,
+                                 const Slice& target) {
+  PERF_TIMER_GUARD(block_seek_nanos);
+  if (data_ == nullptr || prefix_index_ != nullptr ||
+      num_restarts_ != num_entries || index >= num_restarts_) {
+    return false;
+  }
+  Slice seek_key = target;
+  if (!key_includes_seq_) {
+    seek_key = ExtractUserKey(target);
+  }
+  SeekToRestartPoint(index);
+  return ParseNextIndexKey() && Compare(key_, seek_key) >= 0;
+}
+
 void DataBlockIter::SeekForPrev(const Slice& target) {
   PERF_TIMER_GUARD(block_seek_nanos);
   Slice seek_key = target;
@@ -532,6 +532,12 @@ class IndexBlockIter final : public BlockIter<BlockHandle> {
 
   virtual void Seek(const Slice& target) override;
 
+  // Position at the index-th entry of a block holding num_entries entries,
+  // without searching. Only possible when every entry is a restart point.
+  // Return false, leaving the position undefined, if that's not the case or
+  // the entry lies before target.
+  bool SeekToEntry(uint32_t index, uint64_t num_entries, const Slice& target);
+
   virtual void SeekForPrev(const Slice&) override {
     assert(false);
     current_ = restarts_;
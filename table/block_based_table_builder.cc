@@ -968,6 +968,11 @@ uint64_t BlockBasedTableBuilder::NumEntries() const {
 
 uint64_t BlockBasedTableBuilder::FileSize() const { return rep_->offset; }
 
+uint64_t BlockBasedTableBuilder::LastEntryLocation() const {
+  // The entry sits in the pending data block, it takes the next ordinal
+  return rep_->props.num_data_blocks;
+}
+
 bool BlockBasedTableBuilder::NeedCompact() const {
   for (const auto& collector : rep_->table_properties_collectors) {
     if (collector->NeedCompact()) {
@@ -765,7 +765,8 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
                              const bool skip_filters, const int level,
                              const bool immortal_table,
                              const SequenceNumber largest_seqno,
-                             TailPrefetchStats* tail_prefetch_stats) {
+                             TailPrefetchStats* tail_prefetch_stats,
+                             BlockCacheTracer* const block_cache_tracer) {
   table_reader->reset();
 
   Footer footer;
@@ -983,6 +984,7 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   }
 
   rep->file_number = file_number;
+  rep->block_cache_tracer = block_cache_tracer;
 
   // Read the range del meta block
   bool found_range_del_block;
@@ -1045,6 +1047,7 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   // Always prefetch index and filter for level 0
   if (table_options.cache_index_and_filter_blocks) {
     assert(table_options.block_cache != nullptr);
+    BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
     if (prefetch_index) {
       // Hack: Call NewIndexIterator() to implicitly add index to the
       // block_cache
@@ -1055,7 +1058,9 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
           need_upper_bound_check;
       std::unique_ptr<InternalIteratorBase<BlockHandle>> iter(
           new_table->NewIndexIterator(ReadOptions(), disable_prefix_seek,
-                                      nullptr, &index_entry));
+                                      nullptr, &index_entry,
+                                      nullptr /* get_context */,
+                                      &lookup_context));
       s = iter->status();
       if (s.ok()) {
         // This is the first call to NewIndexIterator() since we're in Open().
@@ -1074,8 +1079,9 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
     if (s.ok() && prefetch_filter) {
       // Hack: Call GetFilter() to implicitly add filter to the block_cache
-      auto filter_entry =
-          new_table->GetFilter(rep->table_prefix_extractor.get());
+      auto filter_entry = new_table->GetFilter(
+          rep->table_prefix_extractor.get(), nullptr /* prefetch_buffer */,
+          false /* no_io */, nullptr /* get_context */, &lookup_context);
       if (filter_entry.value != nullptr && prefetch_all) {
         filter_entry.value->CacheDependencies(
             pin_all, rep->table_prefix_extractor.get());
@@ -1531,17 +1537,19 @@ FilterBlockReader* BlockBasedTable::ReadFilter(
 
 BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     const SliceTransform* prefix_extractor, FilePrefetchBuffer* prefetch_buffer,
-    bool no_io, GetContext* get_context) const {
+    bool no_io, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context) const {
   const BlockHandle& filter_blk_handle = rep_->filter_handle;
   const bool is_a_filter_partition = true;
   return GetFilter(prefetch_buffer, filter_blk_handle, !is_a_filter_partition,
-                   no_io, get_context, prefix_extractor);
+                   no_io, get_context, prefix_extractor, lookup_context);
 }
 
 BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     FilePrefetchBuffer* prefetch_buffer, const BlockHandle& filter_blk_handle,
     const bool is_a_filter_partition, bool no_io, GetContext* get_context,
-    const SliceTransform* prefix_extractor) const {
+    const SliceTransform* prefix_extractor,
+    BlockCacheLookupContext* lookup_context) const {
   // If cache_index_and_filter_blocks is false, filter should be pre-populated.
   // We will return rep_->filter anyway. rep_->filter can be nullptr if filter
   // read fails at Open() time. We don't want to reload again since it will
@@ -1576,6 +1584,7 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
       get_context ? &get_context->get_context_stats_.num_cache_filter_hit
                   : nullptr,
       statistics, get_context);
+  const bool is_cache_hit = cache_handle != nullptr;
 
   FilterBlockReader* filter = nullptr;
   if (cache_handle != nullptr) {
@@ -1583,6 +1592,9 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
         reinterpret_cast<FilterBlockReader*>(block_cache->Value(cache_handle));
   } else if (no_io) {
     // Do not invoke any io.
+    TraceBlockAccess(rep_, key, TraceType::kBlockTraceFilterBlock,
+                     0 /* block_size */, 0 /* num_keys */, is_cache_hit,
+                     no_io, lookup_context);
     return CachableEntry<FilterBlockReader>();
   } else {
     filter = ReadFilter(prefetch_buffer, filter_blk_handle,
@@ -1615,6 +1627,9 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     }
   }
 
+  TraceBlockAccess(rep_, key, TraceType::kBlockTraceFilterBlock,
+                   filter != nullptr ? filter->ApproximateMemoryUsage() : 0,
+                   0 /* num_keys */, is_cache_hit, no_io, lookup_context);
   return {filter, cache_handle};
 }
 
@@ -1623,7 +1638,7 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
 InternalIteratorBase<BlockHandle>* BlockBasedTable::NewIndexIterator(
     const ReadOptions& read_options, bool disable_prefix_seek,
     IndexBlockIter* input_iter, CachableEntry<IndexReader>* index_entry,
-    GetContext* get_context) {
+    GetContext* get_context, BlockCacheLookupContext* lookup_context) {
   // index reader has already been pre-populated.
   if (rep_->index_reader) {
     // We don't return pinned datat from index blocks, so no need
@@ -1657,8 +1672,12 @@ InternalIteratorBase<BlockHandle>* BlockBasedTable::NewIndexIterator(
       get_context ? &get_context->get_context_stats_.num_cache_index_hit
                   : nullptr,
       statistics, get_context);
+  const bool is_cache_hit = cache_handle != nullptr;
 
   if (cache_handle == nullptr && no_io) {
+    TraceBlockAccess(rep_, key, TraceType::kBlockTraceIndexBlock,
+                     0 /* block_size */, 0 /* num_keys */, is_cache_hit,
+                     no_io, lookup_context);
     if (input_iter != nullptr) {
       input_iter->Invalidate(Status::Incomplete("no blocking io"));
       return input_iter;
@@ -1717,6 +1736,9 @@ InternalIteratorBase<BlockHandle>* BlockBasedTable::NewIndexIterator(
   }
 
   assert(cache_handle);
+  TraceBlockAccess(rep_, key, TraceType::kBlockTraceIndexBlock,
+                   index_reader->ApproximateMemoryUsage(), 0 /* num_keys */,
+                   is_cache_hit, no_io, lookup_context);
   // We don't return pinned datat from index blocks, so no need
   // to set `block_contents_pinned`.
   auto* iter = index_reader->NewIterator(
@@ -1742,7 +1764,8 @@ TBlockIter* BlockBasedTable::NewDataBlockIterator(
     Rep* rep, const ReadOptions& ro, const BlockHandle& handle,
     TBlockIter* input_iter, bool is_index, bool key_includes_seq,
     bool index_key_is_full, GetContext* get_context, Status s,
-    FilePrefetchBuffer* prefetch_buffer) {
+    FilePrefetchBuffer* prefetch_buffer,
+    BlockCacheLookupContext* lookup_context) {
   PERF_TIMER_GUARD(new_table_block_iter_nanos);
 
   const bool no_io = (ro.read_tier == kBlockCacheTier);
@@ -1755,7 +1778,7 @@ TBlockIter* BlockBasedTable::NewDataBlockIterator(
     }
     s = MaybeReadBlockAndLoadToCache(prefetch_buffer, rep, ro, handle,
                                      compression_dict, &block, is_index,
-                                     get_context);
+                                     get_context, lookup_context);
   }
 
   TBlockIter* iter;
@@ -1852,7 +1875,8 @@ TBlockIter* BlockBasedTable::NewDataBlockIterator(
 Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
     FilePrefetchBuffer* prefetch_buffer, Rep* rep, const ReadOptions& ro,
     const BlockHandle& handle, Slice compression_dict,
-    CachableEntry<Block>* block_entry, bool is_index, GetContext* get_context) {
+    CachableEntry<Block>* block_entry, bool is_index, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context) {
   assert(block_entry != nullptr);
   const bool no_io = (ro.read_tier == kBlockCacheTier);
   Cache* block_cache = rep->table_options.block_cache.get();
@@ -1887,6 +1911,7 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
                               rep, ro, block_entry, compression_dict,
                               rep->table_options.read_amp_bytes_per_bit,
                               is_index, get_context);
+    const bool is_cache_hit = block_entry->value != nullptr;
 
     // Can't find the block from the cache. If I/O is allowed, read from the
     // file.
@@ -1926,11 +1951,57 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
             get_context);
       }
     }
+
+    if (block_cache != nullptr) {
+      uint64_t usage = 0;
+      uint64_t num_keys = 0;
+      if (block_entry->value != nullptr) {
+        usage = block_entry->value->ApproximateMemoryUsage();
+        if (!is_index) {
+          num_keys = rep->table_options.block_restart_interval *
+                     block_entry->value->NumRestarts();
+        }
+      }
+      TraceBlockAccess(rep, key,
+                       is_index ? TraceType::kBlockTraceIndexBlock
+                                : TraceType::kBlockTraceDataBlock,
+                       usage, num_keys, is_cache_hit, no_io || !ro.fill_cache,
+                       lookup_context);
+    }
   }
   assert(s.ok() || block_entry->value == nullptr);
   return s;
 }
 
+void BlockBasedTable::TraceBlockAccess(Rep* rep, const Slice& block_key,
+                                       TraceType block_type,
+                                       uint64_t block_size, uint64_t num_keys,
+                                       bool is_cache_hit, bool no_insert,
+                                       BlockCacheLookupContext* lookup_context) {
+  if (lookup_context == nullptr || !rep->is_block_cache_tracing()) {
+    return;
+  }
+  if (BlockCacheTraceHelper::ShouldTraceReferencedKey(block_type,
+                                                      lookup_context->caller)) {
+    // Defer the record to Get(), which knows the referenced key and whether
+    // it exists in the block. Copy the block key since it lives on our stack.
+    lookup_context->FillLookupContext(is_cache_hit, no_insert, block_type,
+                                      block_size, block_key.ToString(),
+                                      num_keys);
+    return;
+  }
+  // The block key and the column family name are passed as slices to avoid
+  // copying them into the record.
+  BlockCacheTraceRecord access_record(
+      rep->ioptions.env->NowMicros(), "" /* block_key */, block_type,
+      block_size, rep->cf_id_for_tracing(), "" /* cf_name */,
+      rep->level_for_tracing(), rep->file_number, lookup_context->caller,
+      is_cache_hit, no_insert);
+  rep->block_cache_tracer->WriteBlockAccess(access_record, block_key,
+                                            rep->cf_name_for_tracing(),
+                                            Slice() /* referenced_key */);
+}
+
 BlockBasedTable::PartitionedIndexIteratorState::PartitionedIndexIteratorState(
     BlockBasedTable* table,
     std::unordered_map<uint64_t, CachableEntry<Block>>* block_map,
@@ -2258,10 +2329,13 @@ void BlockBasedTableIteratorBase<TBlockIter, TValue>::InitDataBlock() {
     }
 
     Status s;
+    BlockCacheLookupContext lookup_context{
+        for_compaction_ ? TableReaderCaller::kCompaction
+                        : TableReaderCaller::kUserIterator};
     BlockBasedTable::NewDataBlockIterator<TBlockIter>(
         rep, read_options_, data_block_handle, &block_iter_, is_index_,
         key_includes_seq_, index_key_is_full_,
-        /* get_context */ nullptr, s, prefetch_buffer_.get());
+        /* get_context */ nullptr, s, prefetch_buffer_.get(), &lookup_context);
     block_iter_points_to_real_block_ = true;
   }
 }
@@ -2335,13 +2409,18 @@ InternalIterator* BlockBasedTable::NewIterator(
   bool need_upper_bound_check =
       PrefixExtractorChanged(&rep_->table_properties_base, prefix_extractor);
   const bool kIsNotIndex = false;
+  BlockCacheLookupContext lookup_context{
+      for_compaction ? TableReaderCaller::kCompaction
+                     : TableReaderCaller::kUserIterator};
   if (arena == nullptr) {
     return new BlockBasedTableIterator<DataBlockIter, LazyBuffer>(
         this, read_options, rep_->internal_comparator,
         NewIndexIterator(
             read_options,
             need_upper_bound_check &&
-                rep_->index_type == BlockBasedTableOptions::kHashSearch),
+                rep_->index_type == BlockBasedTableOptions::kHashSearch,
+            nullptr /* input_iter */, nullptr /* index_entry */,
+            nullptr /* get_context */, &lookup_context),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
         need_upper_bound_check, prefix_extractor, kIsNotIndex,
@@ -2351,7 +2430,9 @@ InternalIterator* BlockBasedTable::NewIterator(
         sizeof(BlockBasedTableIterator<DataBlockIter, LazyBuffer>));
     return new (mem) BlockBasedTableIterator<DataBlockIter, LazyBuffer>(
         this, read_options, rep_->internal_comparator,
-        NewIndexIterator(read_options, need_upper_bound_check),
+        NewIndexIterator(read_options, need_upper_bound_check,
+                         nullptr /* input_iter */, nullptr /* index_entry */,
+                         nullptr /* get_context */, &lookup_context),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
         need_upper_bound_check, prefix_extractor, kIsNotIndex,
@@ -2405,14 +2486,30 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
                             GetContext* get_context,
                             const SliceTransform* prefix_extractor,
                             bool skip_filters) {
+  return GetImpl(read_options, key, get_context, prefix_extractor,
+                 skip_filters, SeparateHelper::kNoLocation);
+}
+
+Status BlockBasedTable::GetAtLocation(const ReadOptions& read_options,
+                                      const Slice& key, uint64_t location,
+                                      GetContext* get_context) {
+  return GetImpl(read_options, key, get_context, nullptr,
+                 true /* skip_filters */, location);
+}
+
+Status BlockBasedTable::GetImpl(const ReadOptions& read_options,
+                                const Slice& key, GetContext* get_context,
+                                const SliceTransform* prefix_extractor,
+                                bool skip_filters, uint64_t location) {
   assert(key.size() >= 8);  // key must be internal key
   Status s;
   const bool no_io = read_options.read_tier == kBlockCacheTier;
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kUserGet};
   CachableEntry<FilterBlockReader> filter_entry;
   if (!skip_filters) {
-    filter_entry =
-        GetFilter(prefix_extractor, /*prefetch_buffer*/ nullptr,
-                  read_options.read_tier == kBlockCacheTier, get_context);
+    filter_entry = GetFilter(prefix_extractor, /*prefetch_buffer*/ nullptr,
+                             read_options.read_tier == kBlockCacheTier,
+                             get_context, &lookup_context);
   }
   FilterBlockReader* filter = filter_entry.value;
 
@@ -2433,7 +2530,8 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
     }
     auto iiter =
         NewIndexIterator(read_options, need_upper_bound_check, &iiter_on_stack,
-                         /* index_entry */ nullptr, get_context);
+                         /* index_entry */ nullptr, get_context,
+                         &lookup_context);
     std::unique_ptr<InternalIteratorBase<BlockHandle>> iiter_unique_ptr;
     if (iiter != &iiter_on_stack) {
       iiter_unique_ptr.reset(iiter);
@@ -2441,7 +2539,19 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
 
     bool matched = false;  // if such user key mathced a key in SST
     bool done = false;
-    for (iiter->Seek(key); iiter->Valid() && !done; iiter->Next()) {
+    // The location is the ordinal of the data block, which addresses the
+    // index entry directly when the index is a plain binary search block
+    if (location == SeparateHelper::kNoLocation || iiter != &iiter_on_stack ||
+        rep_->index_type != BlockBasedTableOptions::kBinarySearch ||
+        rep_->table_properties == nullptr || location > port::kMaxUint32 ||
+        !iiter_on_stack.SeekToEntry(
+            static_cast<uint32_t>(location),
+            rep_->table_properties->num_data_blocks, key)) {
+      iiter->Seek(key);
+    } else {
+      RecordTick(rep_->ioptions.statistics, SEPARATE_VALUE_LOCATION_HIT);
+    }
+    for (; iiter->Valid() && !done; iiter->Next()) {
       BlockHandle handle = iiter->value();
 
       bool not_exist_in_filter =
@@ -2458,9 +2568,38 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
         break;
       } else {
         DataBlockIter biter;
+        BlockCacheLookupContext lookup_data_block_context{
+            TableReaderCaller::kUserGet};
+        bool does_referenced_key_exist = false;
+        uint64_t referenced_data_size = 0;
+        // The data block access was only recorded in the lookup context, write
+        // it once we know whether the referenced key exists in the block.
+        auto trace_data_block_access = [&]() {
+          if (!rep_->is_block_cache_tracing() ||
+              lookup_data_block_context.block_type !=
+                  TraceType::kBlockTraceDataBlock) {
+            return;
+          }
+          BlockCacheTraceRecord access_record(
+              rep_->ioptions.env->NowMicros(), "" /* block_key */,
+              TraceType::kBlockTraceDataBlock,
+              lookup_data_block_context.block_size, rep_->cf_id_for_tracing(),
+              "" /* cf_name */, rep_->level_for_tracing(), rep_->file_number,
+              lookup_data_block_context.caller,
+              lookup_data_block_context.is_cache_hit,
+              lookup_data_block_context.no_insert, "" /* referenced_key */,
+              referenced_data_size,
+              lookup_data_block_context.num_keys_in_block,
+              does_referenced_key_exist);
+          rep_->block_cache_tracer->WriteBlockAccess(
+              access_record, lookup_data_block_context.block_key,
+              rep_->cf_name_for_tracing(), ExtractUserKey(key));
+        };
         NewDataBlockIterator<DataBlockIter>(
             rep_, read_options, iiter->value(), &biter, false,
-            true /* key_includes_seq */, get_context);
+            true /* key_includes_seq */, true /* index_key_is_full */,
+            nullptr /* get_context */, Status(), nullptr /* prefetch_buffer */,
+            &lookup_data_block_context);
 
         if (read_options.read_tier == kBlockCacheTier &&
             biter.status().IsIncomplete()) {
@@ -2481,6 +2620,7 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
           // the end of the block, i.e. cannot be in the following blocks
           // either. In this case, the seek_key cannot be found, so we break
           // from the top level for-loop.
+          trace_data_block_access();
           break;
         }
 
@@ -2525,11 +2665,16 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
                              {reinterpret_cast<uint64_t>(&biter)},
                              biter.value(), rep_->file_number),
                   &matched)) {
+            if (get_context->State() == GetContext::GetState::kFound) {
+              does_referenced_key_exist = true;
+              referenced_data_size = biter.key().size() + biter.value().size();
+            }
             done = true;
             break;
           }
         }
         s = biter.status();
+        trace_data_block_access();
       }
       if (done) {
         // Avoid the extra Next which is expensive in two-level indexes
@@ -2613,6 +2758,132 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   return Status::OK();
 }
 
+Status BlockBasedTable::PrefetchForKeys(const ReadOptions& read_options,
+                                        const Slice* keys, size_t num_keys) {
+  // Adjacent blocks are merged into requests up to this size
+  const uint64_t kMaxMergedReadSize = 256 << 10;
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  if (num_keys < 2 || block_cache == nullptr || !read_options.fill_cache ||
+      read_options.read_tier == kBlockCacheTier) {
+    return Status::OK();
+  }
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kUserMultiGet};
+  IndexBlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(read_options, false, &iiter_on_stack,
+                                /* index_entry */ nullptr,
+                                /* get_context */ nullptr, &lookup_context);
+  std::unique_ptr<InternalIteratorBase<BlockHandle>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // Data blocks of the keys missing from the block cache
+  std::vector<BlockHandle> handles;
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  for (size_t i = 0; i < num_keys; ++i) {
+    iiter->Seek(keys[i]);
+    if (!iiter->Valid()) {
+      break;
+    }
+    BlockHandle handle = iiter->value();
+    Slice key = GetCacheKey(rep_->cache_key_prefix,
+                            rep_->cache_key_prefix_size, handle, cache_key);
+    Cache::Handle* cache_handle = block_cache->Lookup(key);
+    if (cache_handle != nullptr) {
+      block_cache->Release(cache_handle);
+    } else {
+      handles.emplace_back(handle);
+    }
+  }
+  if (!iiter->status().ok()) {
+    return iiter->status();
+  }
+  std::sort(handles.begin(), handles.end(),
+            [](const BlockHandle& l, const BlockHandle& r) {
+              return l.offset() < r.offset();
+            });
+  handles.erase(std::unique(handles.begin(), handles.end(),
+                            [](const BlockHandle& l, const BlockHandle& r) {
+                              return l.offset() == r.offset();
+                            }),
+                handles.end());
+  if (handles.size() < 2) {
+    // Nothing to batch, leave the read to Get()
+    return Status::OK();
+  }
+  size_t num_blocks = handles.size();
+  TEST_SYNC_POINT_CALLBACK("BlockBasedTable::PrefetchForKeys:Read",
+                           &num_blocks);
+
+  // handles[run_begin[k], run_begin[k + 1]) are served by reqs[k]
+  std::vector<FSReadRequest> reqs;
+  std::vector<size_t> run_begin;
+  for (size_t i = 0; i < handles.size();) {
+    uint64_t offset = handles[i].offset();
+    uint64_t end = offset + handles[i].size() + kBlockTrailerSize;
+    run_begin.emplace_back(i);
+    for (++i; i < handles.size() && handles[i].offset() == end &&
+              end + handles[i].size() + kBlockTrailerSize - offset <=
+                  kMaxMergedReadSize;
+         ++i) {
+      end += handles[i].size() + kBlockTrailerSize;
+    }
+    FSReadRequest req;
+    req.offset = offset;
+    req.len = static_cast<size_t>(end - offset);
+    reqs.emplace_back(std::move(req));
+  }
+  run_begin.emplace_back(handles.size());
+  std::vector<FilePrefetchBuffer> buffers(reqs.size());
+  for (size_t k = 0; k < reqs.size(); ++k) {
+    reqs[k].scratch = buffers[k].PrepareBuffer(reqs[k].offset, reqs[k].len);
+  }
+  Status s;
+  {
+    PERF_TIMER_GUARD(block_read_time);
+    s = rep_->file->MultiRead(reqs.data(), reqs.size());
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  PERF_COUNTER_ADD(block_read_count, handles.size());
+
+  // Checksum, uncompress and insert the blocks like a read of Get() would,
+  // the prefetch buffers stand in for the file
+  Slice compression_dict;
+  if (rep_->compression_dict_block) {
+    compression_dict = rep_->compression_dict_block->data;
+  }
+  for (size_t k = 0; k < reqs.size(); ++k) {
+    auto& req = reqs[k];
+    if (!req.status.ok()) {
+      s = req.status;
+      continue;
+    }
+    if (req.result.data() != req.scratch) {
+      memmove(req.scratch, req.result.data(), req.result.size());
+    }
+    buffers[k].Filled(req.result.size());
+    PERF_COUNTER_ADD(block_read_byte, req.result.size());
+    for (size_t i = run_begin[k]; i < run_begin[k + 1]; ++i) {
+      CachableEntry<Block> block;
+      Status block_s = MaybeReadBlockAndLoadToCache(
+          &buffers[k], rep_, read_options, handles[i], compression_dict,
+          &block, false /* is_index */, nullptr /* get_context */,
+          &lookup_context);
+      if (block.cache_handle != nullptr) {
+        block.Release(block_cache);
+      } else {
+        delete block.value;
+      }
+      if (!block_s.ok()) {
+        s = block_s;
+      }
+    }
+  }
+  return s;
+}
+
 Status BlockBasedTable::VerifyChecksum() {
   Status s;
   // Check Meta blocks
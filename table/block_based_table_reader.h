@@ -33,6 +33,7 @@
 #include "table/table_properties_internal.h"
 #include "table/table_reader.h"
 #include "table/two_level_iterator.h"
+#include "trace_replay/block_cache_tracer.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
 
@@ -99,7 +100,8 @@ class BlockBasedTable : public TableReader {
                      bool skip_filters = false, int level = -1,
                      const bool immortal_table = false,
                      const SequenceNumber largest_seqno = 0,
-                     TailPrefetchStats* tail_prefetch_stats = nullptr);
+                     TailPrefetchStats* tail_prefetch_stats = nullptr,
+                     BlockCacheTracer* const block_cache_tracer = nullptr);
 
   bool PrefixMayMatch(const Slice& internal_key,
                       const ReadOptions& read_options,
@@ -124,11 +126,20 @@ class BlockBasedTable : public TableReader {
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // Jump to the data block whose ordinal is location, then scan like Get()
+  Status GetAtLocation(const ReadOptions& readOptions, const Slice& key,
+                       uint64_t location, GetContext* get_context) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
   Status Prefetch(const Slice* begin, const Slice* end) override;
 
+  // Read the data blocks of keys missing from the block cache together,
+  // adjacent blocks are merged into one request
+  Status PrefetchForKeys(const ReadOptions& read_options, const Slice* keys,
+                         size_t num_keys) override;
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -238,7 +249,8 @@ class BlockBasedTable : public TableReader {
       TBlockIter* input_iter = nullptr, bool is_index = false,
       bool key_includes_seq = true, bool index_key_is_full = true,
       GetContext* get_context = nullptr, Status s = Status(),
-      FilePrefetchBuffer* prefetch_buffer = nullptr);
+      FilePrefetchBuffer* prefetch_buffer = nullptr,
+      BlockCacheLookupContext* lookup_context = nullptr);
 
   class PartitionedIndexIteratorState;
 
@@ -252,6 +264,13 @@ class BlockBasedTable : public TableReader {
   friend class MockedBlockBasedTable;
   static std::atomic<uint64_t> next_cache_key_id_;
 
+  // Shared by Get() and GetAtLocation(), location is the ordinal of the
+  // data block to start from, or SeparateHelper::kNoLocation to search
+  Status GetImpl(const ReadOptions& readOptions, const Slice& key,
+                 GetContext* get_context,
+                 const SliceTransform* prefix_extractor, bool skip_filters,
+                 uint64_t location);
+
   // If block cache enabled (compressed or uncompressed), looks for the block
   // identified by handle in (1) uncompressed cache, (2) compressed cache, and
   // then (3) file. If found, inserts into the cache(s) that were searched
@@ -265,7 +284,17 @@ class BlockBasedTable : public TableReader {
       FilePrefetchBuffer* prefetch_buffer, Rep* rep, const ReadOptions& ro,
       const BlockHandle& handle, Slice compression_dict,
       CachableEntry<Block>* block_entry, bool is_index = false,
-      GetContext* get_context = nullptr);
+      GetContext* get_context = nullptr,
+      BlockCacheLookupContext* lookup_context = nullptr);
+
+  // Write the access on a block to the block cache tracer of `rep`. Accesses
+  // on data blocks by user Get are only recorded in `lookup_context`, Get
+  // writes them once it knows whether the referenced key is in the block.
+  static void TraceBlockAccess(Rep* rep, const Slice& block_key,
+                               TraceType block_type, uint64_t block_size,
+                               uint64_t num_keys, bool is_cache_hit,
+                               bool no_insert,
+                               BlockCacheLookupContext* lookup_context);
 
   // For the following two functions:
   // if `no_io == true`, we will not try to read filter/index from sst file
@@ -273,11 +302,13 @@ class BlockBasedTable : public TableReader {
   CachableEntry<FilterBlockReader> GetFilter(
       const SliceTransform* prefix_extractor = nullptr,
       FilePrefetchBuffer* prefetch_buffer = nullptr, bool no_io = false,
-      GetContext* get_context = nullptr) const;
+      GetContext* get_context = nullptr,
+      BlockCacheLookupContext* lookup_context = nullptr) const;
   virtual CachableEntry<FilterBlockReader> GetFilter(
       FilePrefetchBuffer* prefetch_buffer, const BlockHandle& filter_blk_handle,
       const bool is_a_filter_partition, bool no_io, GetContext* get_context,
-      const SliceTransform* prefix_extractor = nullptr) const;
+      const SliceTransform* prefix_extractor = nullptr,
+      BlockCacheLookupContext* lookup_context = nullptr) const;
 
   // Get the iterator from the index reader.
   // If input_iter is not set, return new Iterator
@@ -293,7 +324,8 @@ class BlockBasedTable : public TableReader {
       const ReadOptions& read_options, bool need_upper_bound_check = false,
       IndexBlockIter* input_iter = nullptr,
       CachableEntry<IndexReader>* index_entry = nullptr,
-      GetContext* get_context = nullptr);
+      GetContext* get_context = nullptr,
+      BlockCacheLookupContext* lookup_context = nullptr);
 
   // Read block cache from block caches (if set): block_cache and
   // block_cache_compressed.
@@ -538,9 +570,31 @@ struct BlockBasedTable::Rep {
   bool closed = false;
   const bool immortal_table;
 
+  BlockCacheTracer* block_cache_tracer = nullptr;
+
   SequenceNumber get_global_seqno(bool is_index) const {
     return is_index ? kDisableGlobalSequenceNumber : global_seqno;
   }
+
+  bool is_block_cache_tracing() const {
+    return block_cache_tracer != nullptr &&
+           block_cache_tracer->is_tracing_enabled();
+  }
+
+  uint64_t cf_id_for_tracing() const {
+    return table_properties
+               ? table_properties->column_family_id
+               : TablePropertiesCollectorFactory::Context::kUnknownColumnFamily;
+  }
+
+  Slice cf_name_for_tracing() const {
+    return table_properties ? table_properties->column_family_name
+                            : BlockCacheTraceHelper::kUnknownColumnFamilyName;
+  }
+
+  uint32_t level_for_tracing() const {
+    return level >= 0 ? static_cast<uint32_t>(level) : UINT32_MAX;
+  }
 };
 
 template <class TBlockIter, typename TValue = LazyBuffer>
@@ -14,6 +14,7 @@
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/terark_namespace.h"
+#include "util/coding.h"
 #include "util/util.h"
 
 namespace TERARKDB_NAMESPACE {
@@ -57,7 +58,9 @@ GetContext::GetContext(const Comparator* ucmp,
       min_seq_type_(0),
       callback_(callback),
       is_index_(false),
-      is_finished_(false) {
+      is_finished_(false),
+      defer_separated_fetch_(false),
+      row_cache_entry_(nullptr) {
   if (seq_) {
     *seq_ = kMaxSequenceNumber;
   }
@@ -145,6 +148,29 @@ void GetContext::ReportCounters() {
   }
 }
 
+void GetContext::EncodeRowCacheEntry(const ParsedInternalKey& parsed_key,
+                                     const LazyBuffer& value) {
+  switch (parsed_key.type) {
+    case kTypeValue:
+    case kTypeValueIndex:
+      // Value indexes are cached as is, the blob cache keeps their values
+      if (!value.fetch().ok()) {
+        return;
+      }
+      row_cache_entry_->push_back(static_cast<char>(parsed_key.type));
+      PutVarint64(row_cache_entry_, parsed_key.sequence);
+      row_cache_entry_->append(value.data(), value.size());
+      break;
+    case kTypeDeletion:
+    case kTypeSingleDeletion:
+      row_cache_entry_->push_back(static_cast<char>(parsed_key.type));
+      PutVarint64(row_cache_entry_, parsed_key.sequence);
+      break;
+    default:
+      break;
+  }
+}
+
 bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
                            LazyBuffer&& value, bool* matched) {
   assert(matched);
@@ -170,6 +196,11 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
       }
     }
 
+    if (row_cache_entry_ != nullptr) {
+      EncodeRowCacheEntry(parsed_key, value);
+      row_cache_entry_ = nullptr;
+    }
+
     auto type = parsed_key.type;
     // Key matches. Process it
     if ((type == kTypeValue || type == kTypeMerge || type == kTypeValueIndex ||
@@ -203,6 +234,13 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
         }
         value = separate_helper_->TransToCombined(user_key_,
                                                   parsed_key.sequence, value);
+        if (defer_separated_fetch_ && kNotFound == state_ &&
+            LIKELY(lazy_val_ != nullptr)) {
+          // Leave the blob fetch to the caller, it will batch them
+          state_ = kFound;
+          *lazy_val_ = std::move(value);
+          return Finish();
+        }
         FALLTHROUGH_INTENDED;
       case kTypeValue:
         assert(state_ == kNotFound || state_ == kMerge);
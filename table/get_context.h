@@ -86,11 +86,31 @@ class GetContext {
 
   bool is_finished() const { return is_finished_; }
 
+  // If set, a separated value found before any merge operand is handed back
+  // to the caller unfetched, so that the blob reads of several lookups can be
+  // issued together (see DBImpl::MultiGet)
+  void SetDeferSeparatedFetch(bool defer) { defer_separated_fetch_ = defer; }
+
   void SetMinSequenceAndType(uint64_t min_seq_type) {
     min_seq_type_ = min_seq_type;
   }
   uint64_t GetMinSequenceAndType() const { return min_seq_type_; }
 
+  // A table lookup can be served from the row cache if nothing but the table
+  // decides which of its entries is visible. Lookups without a separate
+  // helper read the blob ssts, whose values are left to the blob cache
+  bool RowCacheable() const {
+    return min_seq_type_ == 0 && callback_ == nullptr &&
+           separate_helper_ != nullptr;
+  }
+
+  // If set, the first entry SaveValue matches is encoded into
+  // *row_cache_entry for TableCache to insert into the row cache. Entries
+  // that can't be replayed on their own (merge operands) leave it empty
+  void SetRowCacheEntry(std::string* row_cache_entry) {
+    row_cache_entry_ = row_cache_entry;
+  }
+
   bool CheckCallback(SequenceNumber seq) {
     if (callback_) {
       return callback_->IsVisible(seq);
@@ -101,6 +121,9 @@ class GetContext {
   void ReportCounters();
 
  private:
+  void EncodeRowCacheEntry(const ParsedInternalKey& parsed_key,
+                           const LazyBuffer& value);
+
   const Comparator* ucmp_;
   const MergeOperator* merge_operator_;
   // the merge operations encountered;
@@ -125,6 +148,8 @@ class GetContext {
   bool sample_;
   bool is_index_;
   bool is_finished_;
+  bool defer_separated_fetch_;
+  std::string* row_cache_entry_;
 };
 
 }  // namespace TERARKDB_NAMESPACE
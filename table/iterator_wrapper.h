@@ -130,7 +130,10 @@ class CombinedInternalIterator : public InternalIterator {
   bool Valid() const override { return iter_->Valid(); }
   Slice key() const override { return iter_->key(); }
   LazyBuffer value() const override;
-  LazyBuffer value(const Slice& user_key, std::string* meta) const;
+  // Also hands out the value meta and, when the value index still points
+  // to the sst holding the value, the location of the value in that sst
+  LazyBuffer value(const Slice& user_key, std::string* meta,
+                   uint64_t* location = nullptr) const;
   Status status() const override { return iter_->status(); }
   void Next() override { iter_->Next(); }
   void Prev() override { iter_->Prev(); }
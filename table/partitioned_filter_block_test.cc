@@ -31,7 +31,8 @@ class MockedBlockBasedTable : public BlockBasedTable {
   virtual CachableEntry<FilterBlockReader> GetFilter(
       FilePrefetchBuffer*, const BlockHandle& filter_blk_handle,
       const bool /* unused */, bool /* unused */, GetContext* /* unused */,
-      const SliceTransform* prefix_extractor) const override {
+      const SliceTransform* prefix_extractor,
+      BlockCacheLookupContext* /* unused */) const override {
     Slice slice = slices[filter_blk_handle.offset()];
     auto obj = new FullFilterBlockReader(
         prefix_extractor, true, BlockContents(slice),
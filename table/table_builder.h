@@ -26,6 +26,7 @@
 
 namespace TERARKDB_NAMESPACE {
 
+class BlockCacheTracer;
 class Slice;
 class Status;
 struct TablePropertyCache;
@@ -73,6 +74,9 @@ struct TableReaderOptions {
   uint64_t file_number;
   // largest seqno in the table
   SequenceNumber largest_seqno;
+  // Receives block cache accesses of the table while a block cache trace is
+  // running, nullptr to never trace them
+  BlockCacheTracer* block_cache_tracer = nullptr;
 };
 
 struct TableBuilderOptions {
@@ -183,6 +187,13 @@ class TableBuilder {
   // Finish() call, returns the size of the final generated file.
   virtual uint64_t FileSize() const = 0;
 
+  // Where the entry of the last Add() lives in the table, handed back to
+  // TableReader::GetAtLocation() to skip the key search. Return
+  // SeparateHelper::kNoLocation if the table doesn't support it.
+  virtual uint64_t LastEntryLocation() const {
+    return SeparateHelper::kNoLocation;
+  }
+
   // If the user defined table properties collector suggest the file to
   // be further compacted.
   virtual bool NeedCompact() const { return false; }
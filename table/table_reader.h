@@ -92,6 +92,15 @@ class TableReader {
                      const SliceTransform* prefix_extractor,
                      bool skip_filters = false) = 0;
 
+  // Like Get() without filters, starting from the location handed out by
+  // TableBuilder::LastEntryLocation() when the key was added. Tables which
+  // can't use the location fall back to Get()
+  virtual Status GetAtLocation(const ReadOptions& readOptions,
+                               const Slice& key, uint64_t /*location*/,
+                               GetContext* get_context) {
+    return Get(readOptions, key, get_context, nullptr, true);
+  }
+
   // Logic same as for(it->Seek(begin); it->Valid() && callback(*it); ++it) {}
   // Specialization for performance
   virtual void RangeScan(const Slice* begin,
@@ -111,6 +120,14 @@ class TableReader {
     return Status::OK();
   }
 
+  // Load the blocks holding keys (sorted internal keys) into the block cache,
+  // reading the missing ones with one MultiRead. Only a hint for a following
+  // batch of Get(), the default implementation is NOOP.
+  virtual Status PrefetchForKeys(const ReadOptions& /*read_options*/,
+                                 const Slice* /*keys*/, size_t /*num_keys*/) {
+    return Status::OK();
+  }
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* /*out_file*/,
                            const SliceTransform* /*prefix_extractor*/) {
@@ -191,6 +191,12 @@ class TerarkZipTableFactory : public TableFactory, boost::noncopyable {
     return fallback_factory_->IsBuilderNeedSecondPass();
   }
 
+  bool IsLogSstSupported() const override {
+    // Log ssts are always built by fallback factory
+    return fallback_factory_ != nullptr &&
+           !fallback_factory_->IsBuilderNeedSecondPass();
+  }
+
   LruReadonlyCache* cache() const { return cache_.get(); }
 
   Status GetOptionString(std::string* opt_string,
@@ -395,7 +395,8 @@ TableBuilder* TerarkZipTableFactory::NewTableBuilder(
     g_lastTime = g_pf.now();
   }
   if (fallback_factory_) {
-    if (curlevel >= 0 && curlevel < minlevel) {
+    if ((curlevel >= 0 && curlevel < minlevel) ||
+        table_builder_options.sst_purpose == kLogSst) {
       nth_new_fallback_table_++;
       TableBuilder* tb = fallback_factory_->NewTableBuilder(
           table_builder_options, column_family_id, file);
@@ -15,6 +15,8 @@
 #include "table/meta_blocks.h"
 #include "table/sst_file_writer_collectors.h"
 #include "table/terark_zip_common.h"
+#include "trace_replay/block_cache_tracer.h"
+#include "util/coding.h"
 #include "util/util.h"
 
 #ifndef _MSC_VER
@@ -541,6 +543,9 @@ class TerarkZipTableIterator : public TerarkZipTableIndexIterator,
         value_buffer.resize_no_init(mulnum_size);
         *reinterpret_cast<size_t*>(value_buffer.data()) = 1;
         subReader_->GetRecordAppend(recId, cache_offsets_);
+        subReader_->TraceRecordAccess(recId, value_buffer.size() - mulnum_size,
+                                      TableReaderCaller::kUserIterator,
+                                      Slice());
       } catch (const std::exception& ex) {  // crc checksum error
         SetIterInvalid();
         status_ = Status::Corruption(
@@ -852,6 +857,39 @@ TerarkZipTableReaderBase::GetTableProperties() const {
   }
 }
 
+void TerarkZipTableReaderBase::TraceRecordAccess(
+    size_t subIndex, size_t recId, uint64_t size, TableReaderCaller caller,
+    const Slice& referenced_key) const {
+  BlockCacheTracer* tracer = table_reader_options_.block_cache_tracer;
+  if (tracer == nullptr || !tracer->is_tracing_enabled()) {
+    return;
+  }
+  // A record is the unit the user space cache loads, so it is traced as a
+  // data block keyed by (file number, sub reader, record id).
+  char block_key[kMaxVarint64Length * 3];
+  char* end = EncodeVarint64(block_key, FileNumber());
+  end = EncodeVarint64(end, subIndex);
+  end = EncodeVarint64(end, recId);
+  uint64_t cf_id =
+      table_properties_
+          ? table_properties_->column_family_id
+          : TablePropertiesCollectorFactory::Context::kUnknownColumnFamily;
+  Slice cf_name = table_properties_
+                      ? Slice(table_properties_->column_family_name)
+                      : Slice(BlockCacheTraceHelper::kUnknownColumnFamilyName);
+  int level = table_reader_options_.level;
+  BlockCacheTraceRecord access_record(
+      table_reader_options_.ioptions.env->NowMicros(), "" /* block_key */,
+      TraceType::kBlockTraceDataBlock, size, cf_id, "" /* cf_name */,
+      level >= 0 ? static_cast<uint32_t>(level) : UINT32_MAX, FileNumber(),
+      caller, false /* is_cache_hit */, false /* no_insert */,
+      "" /* referenced_key */, size /* referenced_data_size */,
+      1 /* num_keys_in_block */, !referenced_key.empty());
+  tracer->WriteBlockAccess(
+      access_record, Slice(block_key, static_cast<size_t>(end - block_key)),
+      cf_name, referenced_key);
+}
+
 void TerarkZipTableReaderBase::MmapColdize(const void* addr, size_t len) {
   if (file_data_.size() > 0) {
     file_->file()->InvalidateCache((char*)addr - file_data_.data(), len);
@@ -891,6 +929,16 @@ void TerarkZipSubReader::GetRecordAppend(
     store_->get_record_append(recId, co);
 }
 
+void TerarkZipSubReader::TraceRecordAccess(size_t recId, uint64_t size,
+                                           TableReaderCaller caller,
+                                           const Slice& referenced_key) const {
+  // Only records read through the user space cache are block cache accesses.
+  if (storeUsePread_ && cache_ != nullptr && table_reader_ != nullptr) {
+    table_reader_->TraceRecordAccess(subIndex_, recId, size, caller,
+                                     referenced_key);
+  }
+}
+
 Status TerarkZipSubReader::Get(SequenceNumber global_seqno,
                                const ReadOptions& /*ro*/, const Slice& ikey,
                                GetContext* get_context, int flag) const {
@@ -912,6 +960,12 @@ Status TerarkZipSubReader::Get(SequenceNumber global_seqno,
   bool matched;
   auto ctx_buffer = g_tctx->alloc();
   auto& buf = ctx_buffer.get();
+  auto get_record_append = [&]() {
+    size_t old_size = buf.size();
+    GetRecordAppend(recId, &buf);
+    TraceRecordAccess(recId, buf.size() - old_size, TableReaderCaller::kUserGet,
+                      user_key);
+  };
   auto set_value = [&](const ParsedInternalKey& k, Slice v) {
     assert(k.type != kTypeMerge);
     static constexpr size_t pin_size = 8192;
@@ -933,7 +987,7 @@ Status TerarkZipSubReader::Get(SequenceNumber global_seqno,
     case ZipValueType::kZeroSeq:
       buf.erase_all();
       try {
-        GetRecordAppend(recId, &buf);
+        get_record_append();
       } catch (const std::exception& ex) {
         return Status::Corruption("TerarkZipTableReader::Get()", ex.what());
       }
@@ -943,7 +997,7 @@ Status TerarkZipSubReader::Get(SequenceNumber global_seqno,
     case ZipValueType::kValue: {  // should be a kTypeValue, the normal case
       buf.erase_all();
       try {
-        GetRecordAppend(recId, &buf);
+        get_record_append();
       } catch (const std::exception& ex) {
         return Status::Corruption("TerarkZipTableReader::Get()", ex.what());
       }
@@ -959,7 +1013,7 @@ Status TerarkZipSubReader::Get(SequenceNumber global_seqno,
       buf.erase_all();
       buf.reserve(sizeof(SequenceNumber));
       try {
-        GetRecordAppend(recId, &buf);
+        get_record_append();
       } catch (const std::exception& ex) {
         return Status::Corruption("TerarkZipTableReader::Get()", ex.what());
       }
@@ -973,7 +1027,7 @@ Status TerarkZipSubReader::Get(SequenceNumber global_seqno,
     case ZipValueType::kMulti: {  // more than one value
       buf.resize_no_init(sizeof(uint32_t));
       try {
-        GetRecordAppend(recId, &buf);
+        get_record_append();
       } catch (const std::exception& ex) {
         return Status::Corruption("TerarkZipTableReader::Get()", ex.what());
       }
@@ -1159,6 +1213,7 @@ Status TerarkZipTableReader::Open(RandomAccessFileReader* file,
         (byte_t*)file_data.data() + indexSize + storeSize, recNum);
   }
   subReader_.subIndex_ = 0;
+  subReader_.table_reader_ = this;
   subReader_.storeFD_ = file_->file()->FileDescriptor();
   subReader_.storeFileObj_ = file_->file();
   subReader_.storeOffset_ = indexSize;
@@ -1426,7 +1481,8 @@ Status TerarkZipTableMultiReader::SubIndex::Init(
     fstring offsetMemory, const byte_t* baseAddress,
     AbstractBlobStore::Dictionary dict, int minPreadLen,
     RandomAccessFile* fileObj, LruReadonlyCache* cache, uint64_t file_number,
-    bool warmUpIndexOnOpen, bool reverse) {
+    bool warmUpIndexOnOpen, bool reverse,
+    const TerarkZipTableReaderBase* table_reader) {
   TerarkZipMultiOffsetInfo offsetInfo;
   if (!offsetInfo.risk_set_memory(offsetMemory.data(), offsetMemory.size())) {
     return Status::Corruption("bad offset block");
@@ -1450,6 +1506,7 @@ Status TerarkZipTableMultiReader::SubIndex::Init(
       auto& part = subReader_.back();
       auto& curr = offsetInfo.offset_[i];
       part.subIndex_ = i;
+      part.table_reader_ = table_reader;
       part.storeFileObj_ = fileObj;
       part.storeFD_ = fileFD;
       part.rawReaderOffset_ = offset;
@@ -1709,7 +1766,7 @@ Status TerarkZipTableMultiReader::Open(RandomAccessFileReader* file,
           : getVerifyDict(dict),
       tzto_.minPreadLen, file_->file(), table_factory_->cache(),
       table_reader_options_.file_number, tzto_.warmUpIndexOnOpen,
-      isReverseBytewiseOrder_);
+      isReverseBytewiseOrder_, this);
   if (!s.ok()) {
     return s;
   }
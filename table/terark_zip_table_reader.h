@@ -23,6 +23,7 @@
 #include "table/block.h"
 #include "table/table_builder.h"
 #include "table/table_reader.h"
+#include "table/table_reader_caller.h"
 #include "table/terark_zip_internal.h"
 #include "table/terark_zip_table.h"
 #include "util/arena.h"
@@ -67,6 +68,12 @@ class TerarkZipTableReaderBase : public TableReader, boost::noncopyable {
 
   std::shared_ptr<const TableProperties> GetTableProperties() const override;
 
+  // Write the access on record `recId` of sub reader `subIndex`, which was
+  // read through the user space cache, to the block cache tracer.
+  void TraceRecordAccess(size_t subIndex, size_t recId, uint64_t size,
+                         TableReaderCaller caller,
+                         const Slice& referenced_key) const;
+
   void MmapColdize(const void* addr, size_t len);
   void MmapColdize(terark::fstring mem) { MmapColdize(mem.data(), mem.size()); }
   template <class Vec>
@@ -143,6 +150,7 @@ struct TerarkZipSubReader {
   unique_ptr<terark::AbstractBlobStore> store_;
   bitfield_array<2> type_;
   uint64_t file_number_;
+  const TerarkZipTableReaderBase* table_reader_ = nullptr;
 
   enum {
     FlagNone = 0,
@@ -153,6 +161,8 @@ struct TerarkZipSubReader {
 
   void GetRecordAppend(size_t recId, valvec<byte_t>* tbuf) const;
   void GetRecordAppend(size_t recId, terark::BlobStore::CacheOffsets*) const;
+  void TraceRecordAccess(size_t recId, uint64_t size, TableReaderCaller caller,
+                         const Slice& referenced_key) const;
 
   Status Get(SequenceNumber, const ReadOptions&, const Slice& key, GetContext*,
              int flag) const;
@@ -268,7 +278,8 @@ class TerarkZipTableMultiReader : public TerarkZipTableReaderBase {
     Status Init(fstring offsetMemory, const byte_t* baseAddress,
                 terark::AbstractBlobStore::Dictionary dict, int minPreadLen,
                 RandomAccessFile* fileObj, LruReadonlyCache* cache,
-                uint64_t file_number, bool warmUpIndexOnOpen, bool reverse);
+                uint64_t file_number, bool warmUpIndexOnOpen, bool reverse,
+                const TerarkZipTableReaderBase* table_reader);
 
     size_t GetSubCount() const;
     const TerarkZipSubReader* GetSubReader(size_t i) const;
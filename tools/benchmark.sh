@@ -4,7 +4,7 @@
 if [ $# -ne 1 ]; then
   echo -n "./benchmark.sh [bulkload/fillseq/overwrite/filluniquerandom/"
   echo    "readrandom/readwhilewriting/readwhilemerging/updaterandom/"
-  echo    "mergerandom/randomtransaction/compact]"
+  echo    "mergerandom/randomtransaction/compact/writescaling/mapfilter]"
   exit 0
 fi
 
@@ -52,6 +52,10 @@ cache_size=${CACHE_SIZE:-$((1 * G))}
 compression_max_dict_bytes=${COMPRESSION_MAX_DICT_BYTES:-0}
 compression_type=${COMPRESSION_TYPE:-snappy}
 duration=${DURATION:-0}
+# Only for writescaling
+wal_streams=${WAL_STREAMS:-8}
+# Only for mapfilter
+map_filter_bits=${MAP_FILTER_BITS:-10}
 
 num_keys=${NUM_KEYS:-$((1 * G))}
 key_size=${KEY_SIZE:-20}
@@ -357,6 +361,67 @@ function run_filluniquerandom {
   summarize_result $output_dir/benchmark_filluniquerandom.log filluniquerandom filluniquerandom
 }
 
+function run_writescaling {
+  # Unsynced random writes from 8 to 64 threads, first with a single WAL stream
+  # and then with $wal_streams of them. Extra WAL streams are only used by
+  # parallel memtable writes, so pipelined writes are turned off for both.
+  for streams in 1 $wal_streams; do
+    for threads in 8 16 32 64; do
+      echo "Load $num_keys keys randomly with $threads threads and $streams WAL streams"
+      out_name="benchmark_writescaling.t${threads}.w${streams}.log"
+      cmd="./db_bench --benchmarks=fillrandom \
+           --use_existing_db=0 \
+           --sync=0 \
+           $params_w \
+           --num=$(( num_keys / threads )) \
+           --threads=$threads \
+           --allow_concurrent_memtable_write=1 \
+           --enable_pipelined_write=0 \
+           --wal_streams=$streams \
+           --seed=$( date +%s ) \
+           2>&1 | tee -a $output_dir/${out_name}"
+      echo $cmd | tee $output_dir/${out_name}
+      eval $cmd
+      summarize_result $output_dir/${out_name} writescaling.t${threads}.w${streams} fillrandom
+    done
+  done
+}
+
+function run_mapfilter {
+  # Random reads of a lazily compacted DB, first with plain map ssts and then
+  # with map element filters of $map_filter_bits bits per key. About a third
+  # of the keys read were never written, and the hops each miss takes through
+  # map sst links are reported next to the throughput.
+  for bits in 0 $map_filter_bits; do
+    echo "Load $num_keys keys randomly with map element filters of $bits bits"
+    out_name="benchmark_mapfilter.b${bits}.log"
+    cmd="./db_bench --benchmarks=fillrandom \
+         --use_existing_db=0 \
+         --sync=0 \
+         $params_w \
+         --threads=1 \
+         --enable_lazy_compaction=1 \
+         --map_element_filter_bits_per_key=$bits \
+         --seed=$( date +%s ) \
+         2>&1 | tee -a $output_dir/${out_name}"
+    echo $cmd | tee $output_dir/${out_name}
+    eval $cmd
+    echo "Reading $num_keys random keys with map element filters of $bits bits"
+    cmd="./db_bench --benchmarks=readrandom \
+         --use_existing_db=1 \
+         $params_w \
+         --threads=$num_threads \
+         --enable_lazy_compaction=1 \
+         --map_element_filter_bits_per_key=$bits \
+         --perf_level=2 \
+         --seed=$( date +%s ) \
+         2>&1 | tee -a $output_dir/${out_name}"
+    echo $cmd | tee -a $output_dir/${out_name}
+    eval $cmd
+    summarize_result $output_dir/${out_name} mapfilter.b${bits} readrandom
+  done
+}
+
 function run_readrandom {
   echo "Reading $num_keys random keys"
   out_name="benchmark_readrandom.t${num_threads}.log"
@@ -494,6 +559,10 @@ for job in ${jobs[@]}; do
     run_randomtransaction
   elif [ $job = universal_compaction ]; then
     run_univ_compaction
+  elif [ $job = writescaling ]; then
+    run_writescaling
+  elif [ $job = mapfilter ]; then
+    run_mapfilter
   elif [ $job = debug ]; then
     num_keys=1000; # debug
     echo "Setting num_keys to $num_keys"
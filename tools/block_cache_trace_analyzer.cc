@@ -0,0 +1,892 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+#ifdef GFLAGS
+#include "tools/block_cache_trace_analyzer.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "monitoring/histogram.h"
+#include "port/port.h"
+#include "rocksdb/terark_namespace.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/gflags_compat.h"
+#include "util/string_util.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+
+DEFINE_string(block_cache_trace_path, "", "The trace file path.");
+DEFINE_string(
+    block_cache_sim_config_path, "",
+    "The config file path. One cache configuration per line. The format of a "
+    "cache configuration is "
+    "cache_name,num_shard_bits,cache_capacity_1,...,cache_capacity_N. "
+    "cache_name is lru, lru_priority, lirs or clock. cache_capacity can be "
+    "xK, xM or xG where x is a positive number.");
+DEFINE_int32(block_cache_trace_downsample_ratio, 1,
+             "The trace collected accesses on one in every "
+             "block_cache_trace_downsample_ratio blocks. We scale "
+             "down the simulated cache size by this ratio.");
+DEFINE_bool(print_block_size_stats, false,
+            "Print block size distribution and the distribution break down by "
+            "block type and column family.");
+DEFINE_bool(print_access_count_stats, false,
+            "Print access count distribution and the distribution break down "
+            "by block type and column family.");
+DEFINE_bool(print_data_block_access_count_stats, false,
+            "Print data block accesses by user Get and Multi-Get.");
+DEFINE_int32(cache_sim_warmup_seconds, 0,
+             "The number of seconds to warmup simulated caches. The hit/miss "
+             "counters are reset after the warmup completes.");
+DEFINE_string(
+    block_cache_analysis_result_dir, "",
+    "The directory that saves block cache analysis results, i.e. the miss "
+    "ratio curves, access timelines, reuse distances and reuse intervals.");
+DEFINE_string(
+    timeline_labels, "",
+    "Group the number of accesses per block per second using these labels. "
+    "Possible labels are a combination of the following: cf (column family), "
+    "sst, level, bt (block type), caller, block. For example, label \"cf_bt\" "
+    "means the number of acccess per second is grouped by unique pairs of "
+    "\"cf_bt\". A label \"all\" contains the aggregated number of accesses per "
+    "second across all possible labels.");
+DEFINE_string(reuse_distance_labels, "",
+              "Group the reuse distance of a block using these labels. Reuse "
+              "distance is defined as the cumulated size of unique blocks read "
+              "between two consecutive accesses on the same block. The caller "
+              "label is ignored.");
+DEFINE_string(
+    reuse_distance_buckets, "",
+    "Group blocks by their reuse distances given these buckets. For "
+    "example, if 'reuse_distance_buckets' is '1K,1M,1G', we will "
+    "create four buckets. The first three buckets contain the number of "
+    "blocks with reuse distance less than 1KB, between 1K and 1M, between 1M "
+    "and 1G, respectively. The last bucket contains the number of blocks with "
+    "reuse distance larger than 1G. ");
+DEFINE_string(reuse_interval_labels, "",
+              "Group the reuse interval of a block using these labels. Reuse "
+              "interval is defined as the time between two consecutive "
+              "accesses on the same block. The caller label is ignored.");
+DEFINE_string(
+    reuse_interval_buckets, "",
+    "Group blocks by their reuse interval given these buckets. For "
+    "example, if 'reuse_interval_buckets' is '1,10,100', we will "
+    "create four buckets. The first three buckets contain the number of "
+    "blocks with reuse interval less than 1 second, between 1 second and 10 "
+    "seconds, between 10 seconds and 100 seconds, respectively. The last "
+    "bucket contains the number of blocks with reuse interval longer than 100 "
+    "seconds.");
+
+namespace TERARKDB_NAMESPACE {
+
+namespace {
+
+const std::string kMissRatioCurveFileName = "mrc";
+const std::string kGroupbyBlock = "block";
+const std::string kGroupbyColumnFamily = "cf";
+const std::string kGroupbySSTFile = "sst";
+const std::string kGroupbyBlockType = "bt";
+const std::string kGroupbyCaller = "caller";
+const std::string kGroupbyLevel = "level";
+const std::string kGroupbyAll = "all";
+const std::set<std::string> kGroupbyLabels{
+    kGroupbyBlock, kGroupbyColumnFamily, kGroupbySSTFile, kGroupbyLevel,
+    kGroupbyBlockType, kGroupbyCaller, kGroupbyAll};
+
+std::string block_type_to_string(TraceType type) {
+  switch (type) {
+    case kBlockTraceFilterBlock:
+      return "Filter";
+    case kBlockTraceDataBlock:
+      return "Data";
+    case kBlockTraceIndexBlock:
+      return "Index";
+    case kBlockTraceRangeDeletionBlock:
+      return "RangeDeletion";
+    case kBlockTraceUncompressionDictBlock:
+      return "UncompressionDict";
+    default:
+      break;
+  }
+  // This cannot happen.
+  return "InvalidType";
+}
+
+std::string caller_to_string(TableReaderCaller caller) {
+  switch (caller) {
+    case kUserGet:
+      return "Get";
+    case kUserMultiGet:
+      return "MultiGet";
+    case kUserIterator:
+      return "Iterator";
+    case kUserApproximateSize:
+      return "ApproximateSize";
+    case kUserVerifyChecksum:
+      return "VerifyChecksum";
+    case kSSTDumpTool:
+      return "SSTDumpTool";
+    case kExternalSSTIngestion:
+      return "ExternalSSTIngestion";
+    case kRepair:
+      return "Repair";
+    case kPrefetch:
+      return "Prefetch";
+    case kCompaction:
+      return "Compaction";
+    case kCompactionRefill:
+      return "CompactionRefill";
+    case kFlush:
+      return "Flush";
+    case kSSTFileReader:
+      return "SSTFileReader";
+    case kUncategorized:
+      return "Uncategorized";
+    default:
+      break;
+  }
+  // This cannot happen.
+  return "InvalidCaller";
+}
+
+const char kBreakLine[] =
+    "***************************************************************\n";
+
+void print_break_lines(uint32_t num_break_lines) {
+  for (uint32_t i = 0; i < num_break_lines; i++) {
+    fprintf(stdout, kBreakLine);
+  }
+}
+
+double percent(uint64_t numerator, uint64_t denomenator) {
+  if (denomenator == 0) {
+    return -1;
+  }
+  return static_cast<double>(numerator * 100.0 / denomenator);
+}
+
+std::vector<uint64_t> parse_buckets(const std::string& bucket_str) {
+  std::vector<uint64_t> buckets;
+  std::stringstream ss(bucket_str);
+  while (ss.good()) {
+    std::string bucket;
+    getline(ss, bucket, ',');
+    buckets.push_back(ParseUint64(bucket));
+  }
+  buckets.push_back(port::kMaxUint64);
+  return buckets;
+}
+
+std::vector<CacheConfiguration> parse_cache_config_file(
+    const std::string& config_path) {
+  std::ifstream file(config_path);
+  if (!file.is_open()) {
+    return {};
+  }
+  std::vector<CacheConfiguration> configs;
+  std::string line;
+  while (getline(file, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    CacheConfiguration cache_config;
+    std::stringstream ss(line);
+    std::vector<std::string> config_strs;
+    while (ss.good()) {
+      std::string substr;
+      getline(ss, substr, ',');
+      config_strs.push_back(substr);
+    }
+    // Sanity checks.
+    if (config_strs.size() < 3) {
+      fprintf(stderr, "Invalid cache simulator configuration %s\n",
+              line.c_str());
+      exit(1);
+    }
+    cache_config.cache_name = config_strs[0];
+    cache_config.num_shard_bits = ParseUint32(config_strs[1]);
+    for (uint32_t i = 2; i < config_strs.size(); i++) {
+      uint64_t capacity = ParseUint64(config_strs[i]);
+      if (capacity == 0) {
+        fprintf(stderr, "Invalid cache capacity %s, %s\n",
+                config_strs[i].c_str(), line.c_str());
+        exit(1);
+      }
+      cache_config.cache_capacities.push_back(capacity);
+    }
+    configs.push_back(cache_config);
+  }
+  file.close();
+  return configs;
+}
+
+std::vector<std::string> split_labels(const std::string& label_strs) {
+  std::vector<std::string> labels;
+  std::stringstream ss(label_strs);
+  while (ss.good()) {
+    std::string label_str;
+    getline(ss, label_str, ',');
+    if (!label_str.empty()) {
+      labels.push_back(label_str);
+    }
+  }
+  return labels;
+}
+
+}  // namespace
+
+BlockCacheTraceAnalyzer::BlockCacheTraceAnalyzer(
+    const std::string& trace_file_path, const std::string& output_dir,
+    std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator)
+    : env_(TERARKDB_NAMESPACE::Env::Default()),
+      trace_file_path_(trace_file_path),
+      output_dir_(output_dir),
+      cache_simulator_(std::move(cache_simulator)) {}
+
+std::set<std::string> BlockCacheTraceAnalyzer::ParseLabelStr(
+    const std::string& label_str) const {
+  std::stringstream ss(label_str);
+  std::set<std::string> labels;
+  // label_str is in the form of "label1_label2_label3", e.g., cf_bt.
+  while (ss.good()) {
+    std::string label_name;
+    getline(ss, label_name, '_');
+    if (kGroupbyLabels.find(label_name) == kGroupbyLabels.end()) {
+      // Unknown label name.
+      fprintf(stderr, "Unknown label name %s, label string %s\n",
+              label_name.c_str(), label_str.c_str());
+      return {};
+    }
+    labels.insert(label_name);
+  }
+  return labels;
+}
+
+std::string BlockCacheTraceAnalyzer::BuildLabel(
+    const std::set<std::string>& labels, const std::string& cf_name,
+    uint64_t fd, uint32_t level, TraceType type, TableReaderCaller caller,
+    uint64_t block_id) const {
+  std::vector<std::string> label_values;
+  // Keep the label values in a fixed order regardless of the order they were
+  // given in.
+  if (labels.find(kGroupbyColumnFamily) != labels.end()) {
+    label_values.push_back(cf_name);
+  }
+  if (labels.find(kGroupbySSTFile) != labels.end()) {
+    label_values.push_back(std::to_string(fd));
+  }
+  if (labels.find(kGroupbyLevel) != labels.end()) {
+    label_values.push_back(std::to_string(level));
+  }
+  if (labels.find(kGroupbyBlockType) != labels.end()) {
+    label_values.push_back(block_type_to_string(type));
+  }
+  if (labels.find(kGroupbyCaller) != labels.end() &&
+      caller != kMaxBlockCacheLookupCaller) {
+    label_values.push_back(caller_to_string(caller));
+  }
+  if (labels.find(kGroupbyBlock) != labels.end()) {
+    label_values.push_back(std::to_string(block_id));
+  }
+  if (label_values.empty()) {
+    return kGroupbyAll;
+  }
+  std::string label = label_values[0];
+  for (size_t i = 1; i < label_values.size(); i++) {
+    label += "-" + label_values[i];
+  }
+  return label;
+}
+
+void BlockCacheTraceAnalyzer::TraverseBlocks(
+    std::function<void(const std::string& /*cf_name*/, uint64_t /*fd*/,
+                       uint32_t /*level*/, TraceType /*block_type*/,
+                       const std::string& /*block_key*/,
+                       uint64_t /*block_key_id*/,
+                       const BlockAccessInfo& /*block_access_info*/)>
+        block_callback) const {
+  for (auto const& cf_aggregates : cf_aggregates_map_) {
+    // Stats per column family.
+    const std::string& cf_name = cf_aggregates.first;
+    for (auto const& file_aggregates : cf_aggregates.second.fd_aggregates_map) {
+      // Stats per SST file.
+      const uint64_t fd = file_aggregates.first;
+      const uint32_t level = file_aggregates.second.level;
+      for (auto const& block_type_aggregates :
+           file_aggregates.second.block_type_aggregates_map) {
+        // Stats per block type.
+        const TraceType type = block_type_aggregates.first;
+        for (auto const& block_access_info :
+             block_type_aggregates.second.block_access_info_map) {
+          // Stats per block.
+          block_callback(cf_name, fd, level, type, block_access_info.first,
+                         block_access_info.second.block_id,
+                         block_access_info.second);
+        }
+      }
+    }
+  }
+}
+
+void BlockCacheTraceAnalyzer::WriteMissRatioCurves() const {
+  if (!cache_simulator_ || output_dir_.empty()) {
+    return;
+  }
+  const std::string output_miss_ratio_curve_path =
+      output_dir_ + "/" + kMissRatioCurveFileName;
+  std::ofstream out(output_miss_ratio_curve_path);
+  if (!out.is_open()) {
+    return;
+  }
+  // Write header.
+  const std::string header =
+      "cache_name,num_shard_bits,capacity,miss_ratio,total_accesses";
+  out << header << std::endl;
+  for (auto const& config_caches : cache_simulator_->sim_caches()) {
+    const CacheConfiguration& config = config_caches.first;
+    for (uint32_t i = 0; i < config.cache_capacities.size(); i++) {
+      double miss_ratio = config_caches.second[i]->miss_ratio();
+      // Write the body.
+      out << config.cache_name;
+      out << ",";
+      out << config.num_shard_bits;
+      out << ",";
+      out << config.cache_capacities[i];
+      out << ",";
+      out << std::fixed << std::setprecision(4) << miss_ratio;
+      out << ",";
+      out << config_caches.second[i]->total_accesses();
+      out << std::endl;
+    }
+  }
+  out.close();
+}
+
+void BlockCacheTraceAnalyzer::WriteAccessTimeline(
+    const std::string& label_str) const {
+  std::set<std::string> labels = ParseLabelStr(label_str);
+  if (labels.empty() || output_dir_.empty()) {
+    return;
+  }
+  uint64_t start_time = port::kMaxUint64;
+  uint64_t end_time = 0;
+  std::map<std::string, std::map<uint64_t, uint64_t>> label_access_timeline;
+  auto block_callback = [&](const std::string& cf_name, uint64_t fd,
+                            uint32_t level, TraceType type,
+                            const std::string& /*block_key*/, uint64_t block_id,
+                            const BlockAccessInfo& block) {
+    for (auto const& timeline : block.caller_num_accesses_timeline) {
+      const TableReaderCaller caller = timeline.first;
+      const std::string label =
+          BuildLabel(labels, cf_name, fd, level, type, caller, block_id);
+      for (auto const& naccess : timeline.second) {
+        const uint64_t timestamp = naccess.first;
+        const uint64_t num = naccess.second;
+        label_access_timeline[label][timestamp] += num;
+        start_time = std::min(start_time, timestamp);
+        end_time = std::max(end_time, timestamp);
+      }
+    }
+  };
+  TraverseBlocks(block_callback);
+
+  // We have label_access_timeline now. Write them into a file.
+  const std::string output_path =
+      output_dir_ + "/" + label_str + "_access_timeline";
+  std::ofstream out(output_path);
+  if (!out.is_open()) {
+    return;
+  }
+  std::string header("time");
+  for (auto const& label : label_access_timeline) {
+    header += ",";
+    header += label.first;
+  }
+  out << header << std::endl;
+  std::string row;
+  for (uint64_t now = start_time; now <= end_time; now++) {
+    row = std::to_string(now);
+    for (auto const& label : label_access_timeline) {
+      auto it = label.second.find(now);
+      row += ",";
+      if (it != label.second.end()) {
+        row += std::to_string(it->second);
+      } else {
+        row += "0";
+      }
+    }
+    out << row << std::endl;
+  }
+  out.close();
+}
+
+void BlockCacheTraceAnalyzer::WriteReuseCounts(
+    const std::string& label_str, const std::string& file_suffix,
+    const std::vector<uint64_t>& buckets,
+    const std::function<const std::map<uint64_t, uint64_t>&(
+        const BlockAccessInfo&)>& counts) const {
+  std::set<std::string> labels = ParseLabelStr(label_str);
+  if (labels.empty() || output_dir_.empty() || buckets.empty()) {
+    return;
+  }
+  std::map<std::string, std::map<uint64_t, uint64_t>> label_bucket_num_reuses;
+  uint64_t total_num_reuses = 0;
+  auto block_callback = [&](const std::string& cf_name, uint64_t fd,
+                            uint32_t level, TraceType type,
+                            const std::string& /*block_key*/, uint64_t block_id,
+                            const BlockAccessInfo& block) {
+    const std::string label = BuildLabel(labels, cf_name, fd, level, type,
+                                         kMaxBlockCacheLookupCaller, block_id);
+    auto& bucket_num_reuses = label_bucket_num_reuses[label];
+    if (bucket_num_reuses.empty()) {
+      // The first time we encounter this label.
+      for (auto const& bucket : buckets) {
+        bucket_num_reuses[bucket] = 0;
+      }
+    }
+    for (auto const& reuse : counts(block)) {
+      // A reuse falls into the first bucket whose bound is larger than it, the
+      // last bucket is unbounded.
+      auto it = bucket_num_reuses.upper_bound(reuse.first);
+      if (it == bucket_num_reuses.end()) {
+        it = std::prev(bucket_num_reuses.end());
+      }
+      it->second += reuse.second;
+      total_num_reuses += reuse.second;
+    }
+  };
+  TraverseBlocks(block_callback);
+
+  const std::string output_path = output_dir_ + "/" + label_str + file_suffix;
+  std::ofstream out(output_path);
+  if (!out.is_open()) {
+    return;
+  }
+  std::string header("bucket");
+  for (auto const& label_it : label_bucket_num_reuses) {
+    header += ",";
+    header += label_it.first;
+  }
+  out << header << std::endl;
+  // Absolute number of reuses per bucket.
+  for (auto const& bucket : buckets) {
+    std::string row(std::to_string(bucket));
+    for (auto const& label_it : label_bucket_num_reuses) {
+      row += ",";
+      row += std::to_string(label_it.second.at(bucket));
+    }
+    out << row << std::endl;
+  }
+  // Percentage of all reuses per bucket.
+  for (auto const& bucket : buckets) {
+    std::string row(std::to_string(bucket));
+    for (auto const& label_it : label_bucket_num_reuses) {
+      row += ",";
+      row += std::to_string(
+          percent(label_it.second.at(bucket), total_num_reuses));
+    }
+    out << row << std::endl;
+  }
+  out.close();
+}
+
+void BlockCacheTraceAnalyzer::WriteReuseDistance(
+    const std::string& label_str,
+    const std::vector<uint64_t>& distance_buckets) const {
+  WriteReuseCounts(label_str, "_reuse_distance", distance_buckets,
+                   [](const BlockAccessInfo& block)
+                       -> const std::map<uint64_t, uint64_t>& {
+                     return block.reuse_distance_count;
+                   });
+}
+
+void BlockCacheTraceAnalyzer::WriteReuseInterval(
+    const std::string& label_str,
+    const std::vector<uint64_t>& time_buckets) const {
+  WriteReuseCounts(label_str, "_reuse_interval", time_buckets,
+                   [](const BlockAccessInfo& block)
+                       -> const std::map<uint64_t, uint64_t>& {
+                     return block.reuse_interval_count;
+                   });
+}
+
+bool BlockCacheTraceAnalyzer::ComputeReuseDistance(
+    const BlockCacheTraceRecord& access, uint64_t* reuse_distance) {
+  // Fenwick tree positions are 1-based.
+  const uint64_t seq = ++access_sequence_;
+  if (seq >= reuse_distance_tree_.size()) {
+    // Grow the tree and rebuild it from the latest access of every block.
+    size_t new_size = std::max<size_t>(reuse_distance_tree_.size() * 2, 1024);
+    reuse_distance_tree_.assign(new_size, 0);
+    for (auto const& last_access : block_last_access_) {
+      for (uint64_t i = last_access.second.first; i < new_size; i += i & -i) {
+        reuse_distance_tree_[i] += last_access.second.second;
+      }
+    }
+  }
+  auto add = [this](uint64_t pos, uint64_t delta) {
+    for (; pos < reuse_distance_tree_.size(); pos += pos & -pos) {
+      reuse_distance_tree_[pos] += delta;
+    }
+  };
+  auto prefix_sum = [this](uint64_t pos) {
+    uint64_t sum = 0;
+    for (; pos > 0; pos -= pos & -pos) {
+      sum += reuse_distance_tree_[pos];
+    }
+    return sum;
+  };
+  bool reused = false;
+  auto& last_access = block_last_access_[access.block_key];
+  if (last_access.first != 0) {
+    // Unique bytes of the blocks whose latest access lies strictly between
+    // the two accesses of this block.
+    *reuse_distance = prefix_sum(seq - 1) - prefix_sum(last_access.first);
+    // Unsigned wrap-around cancels out the previous contribution.
+    add(last_access.first, 0 - last_access.second);
+    reused = true;
+  }
+  add(seq, access.block_size);
+  last_access = std::make_pair(seq, access.block_size);
+  return reused;
+}
+
+void BlockCacheTraceAnalyzer::RecordAccess(
+    const BlockCacheTraceRecord& access) {
+  ColumnFamilyAccessInfoAggregate& cf_aggr = cf_aggregates_map_[access.cf_name];
+  SSTFileAccessInfoAggregate& file_aggr =
+      cf_aggr.fd_aggregates_map[access.sst_fd_number];
+  file_aggr.level = access.level;
+  BlockTypeAccessInfoAggregate& block_type_aggr =
+      file_aggr.block_type_aggregates_map[access.block_type];
+  BlockAccessInfo& block_access_info =
+      block_type_aggr.block_access_info_map[access.block_key];
+  if (block_access_info.num_accesses == 0) {
+    block_access_info.block_id = next_block_id_++;
+  }
+  uint64_t reuse_distance = 0;
+  if (ComputeReuseDistance(access, &reuse_distance)) {
+    block_access_info.reuse_distance_count[reuse_distance] += 1;
+  }
+  block_access_info.AddAccess(access);
+}
+
+Status BlockCacheTraceAnalyzer::Analyze() {
+  std::unique_ptr<TraceReader> trace_reader;
+  Status s =
+      NewFileTraceReader(env_, EnvOptions(), trace_file_path_, &trace_reader);
+  if (!s.ok()) {
+    return s;
+  }
+  BlockCacheTraceReader reader(std::move(trace_reader));
+  s = reader.ReadHeader(&header_);
+  if (!s.ok()) {
+    return s;
+  }
+  while (s.ok()) {
+    BlockCacheTraceRecord access;
+    s = reader.ReadAccess(&access);
+    if (!s.ok()) {
+      return s;
+    }
+    RecordAccess(access);
+    if (cache_simulator_) {
+      cache_simulator_->Access(access);
+    }
+  }
+  return Status::OK();
+}
+
+void BlockCacheTraceAnalyzer::PrintBlockSizeStats() const {
+  HistogramStat bs_stats;
+  std::map<TraceType, HistogramStat> bt_stats_map;
+  std::map<std::string, std::map<TraceType, HistogramStat>> cf_bt_stats_map;
+  auto block_callback = [&](const std::string& cf_name, uint64_t /*fd*/,
+                            uint32_t /*level*/, TraceType type,
+                            const std::string& /*block_key*/,
+                            uint64_t /*block_id*/,
+                            const BlockAccessInfo& block) {
+    if (block.block_size == 0) {
+      // Block size may be 0 when 1) compaction observes a cache miss and
+      // does not insert the missing block into the cache again. 2)
+      // fetching filter blocks in SST files at the last level.
+      return;
+    }
+    bs_stats.Add(block.block_size);
+    bt_stats_map[type].Add(block.block_size);
+    cf_bt_stats_map[cf_name][type].Add(block.block_size);
+  };
+  TraverseBlocks(block_callback);
+  fprintf(stdout, "Block size stats: \n%s", bs_stats.ToString().c_str());
+  for (auto const& bt_stats : bt_stats_map) {
+    print_break_lines(/*num_break_lines=*/1);
+    fprintf(stdout, "Block size stats for block type %s: \n%s",
+            block_type_to_string(bt_stats.first).c_str(),
+            bt_stats.second.ToString().c_str());
+  }
+  for (auto const& cf_bt_stats : cf_bt_stats_map) {
+    const std::string& cf_name = cf_bt_stats.first;
+    for (auto const& bt_stats : cf_bt_stats.second) {
+      print_break_lines(/*num_break_lines=*/1);
+      fprintf(stdout,
+              "Block size stats for column family %s and block type %s: \n%s",
+              cf_name.c_str(), block_type_to_string(bt_stats.first).c_str(),
+              bt_stats.second.ToString().c_str());
+    }
+  }
+}
+
+void BlockCacheTraceAnalyzer::PrintAccessCountStats() const {
+  HistogramStat access_stats;
+  std::map<TraceType, HistogramStat> bt_stats_map;
+  std::map<std::string, std::map<TraceType, HistogramStat>> cf_bt_stats_map;
+  auto block_callback = [&](const std::string& cf_name, uint64_t /*fd*/,
+                            uint32_t /*level*/, TraceType type,
+                            const std::string& /*block_key*/,
+                            uint64_t /*block_id*/,
+                            const BlockAccessInfo& block) {
+    access_stats.Add(block.num_accesses);
+    bt_stats_map[type].Add(block.num_accesses);
+    cf_bt_stats_map[cf_name][type].Add(block.num_accesses);
+  };
+  TraverseBlocks(block_callback);
+  fprintf(stdout, "Block access count stats: \n%s",
+          access_stats.ToString().c_str());
+  for (auto const& bt_stats : bt_stats_map) {
+    print_break_lines(/*num_break_lines=*/1);
+    fprintf(stdout, "Block access count stats for block type %s: \n%s",
+            block_type_to_string(bt_stats.first).c_str(),
+            bt_stats.second.ToString().c_str());
+  }
+  for (auto const& cf_bt_stats : cf_bt_stats_map) {
+    const std::string& cf_name = cf_bt_stats.first;
+    for (auto const& bt_stats : cf_bt_stats.second) {
+      print_break_lines(/*num_break_lines=*/1);
+      fprintf(stdout,
+              "Block access count stats for column family %s and block type "
+              "%s: \n%s",
+              cf_name.c_str(), block_type_to_string(bt_stats.first).c_str(),
+              bt_stats.second.ToString().c_str());
+    }
+  }
+}
+
+void BlockCacheTraceAnalyzer::PrintDataBlockAccessStats() const {
+  HistogramStat existing_keys_stats;
+  std::map<std::string, HistogramStat> cf_existing_keys_stats_map;
+  HistogramStat non_existing_keys_stats;
+  std::map<std::string, HistogramStat> cf_non_existing_keys_stats_map;
+  HistogramStat block_access_stats;
+  std::map<std::string, HistogramStat> cf_block_access_info;
+  auto block_callback = [&](const std::string& cf_name, uint64_t /*fd*/,
+                            uint32_t /*level*/, TraceType type,
+                            const std::string& /*block_key*/,
+                            uint64_t /*block_id*/,
+                            const BlockAccessInfo& block) {
+    if (type != kBlockTraceDataBlock || block.num_keys == 0) {
+      return;
+    }
+    // Use four decimal points.
+    uint64_t percent_referenced_for_existing_keys = (uint64_t)(
+        ((double)block.key_num_access_map.size() / (double)block.num_keys) *
+        10000.0);
+    uint64_t percent_referenced_for_non_existing_keys =
+        (uint64_t)(((double)block.non_exist_key_num_access_map.size() /
+                    (double)block.num_keys) *
+                   10000.0);
+    uint64_t percent_accesses_for_existing_keys =
+        (uint64_t)(((double)block.num_referenced_key_exist_in_block /
+                    (double)block.num_accesses) *
+                   10000.0);
+    existing_keys_stats.Add(percent_referenced_for_existing_keys);
+    cf_existing_keys_stats_map[cf_name].Add(
+        percent_referenced_for_existing_keys);
+    non_existing_keys_stats.Add(percent_referenced_for_non_existing_keys);
+    cf_non_existing_keys_stats_map[cf_name].Add(
+        percent_referenced_for_non_existing_keys);
+    block_access_stats.Add(percent_accesses_for_existing_keys);
+    cf_block_access_info[cf_name].Add(percent_accesses_for_existing_keys);
+  };
+  TraverseBlocks(block_callback);
+  fprintf(stdout,
+          "Histogram on the number of referenced keys existing in a block over "
+          "the total number of keys in a block: \n%s",
+          existing_keys_stats.ToString().c_str());
+  for (auto const& cf_stats : cf_existing_keys_stats_map) {
+    print_break_lines(/*num_break_lines=*/1);
+    fprintf(stdout, "Break down by column family %s: \n%s",
+            cf_stats.first.c_str(), cf_stats.second.ToString().c_str());
+  }
+  print_break_lines(/*num_break_lines=*/1);
+  fprintf(
+      stdout,
+      "Histogram on the number of referenced keys DO NOT exist in a block over "
+      "the total number of keys in a block: \n%s",
+      non_existing_keys_stats.ToString().c_str());
+  for (auto const& cf_stats : cf_non_existing_keys_stats_map) {
+    print_break_lines(/*num_break_lines=*/1);
+    fprintf(stdout, "Break down by column family %s: \n%s",
+            cf_stats.first.c_str(), cf_stats.second.ToString().c_str());
+  }
+  print_break_lines(/*num_break_lines=*/1);
+  fprintf(stdout,
+          "Histogram on the number of accesses on keys exist in a block over "
+          "the total number of accesses in a block: \n%s",
+          block_access_stats.ToString().c_str());
+  for (auto const& cf_stats : cf_block_access_info) {
+    print_break_lines(/*num_break_lines=*/1);
+    fprintf(stdout, "Break down by column family %s: \n%s",
+            cf_stats.first.c_str(), cf_stats.second.ToString().c_str());
+  }
+}
+
+void BlockCacheTraceAnalyzer::PrintStatsSummary() const {
+  uint64_t total_num_files = 0;
+  uint64_t total_num_blocks = 0;
+  uint64_t total_num_accesses = 0;
+  std::map<TraceType, uint64_t> bt_num_blocks_map;
+  std::map<TableReaderCaller, uint64_t> caller_num_access_map;
+  std::map<TableReaderCaller, std::map<TraceType, uint64_t>>
+      caller_bt_num_access_map;
+  std::map<TableReaderCaller, std::map<uint32_t, uint64_t>>
+      caller_level_num_access_map;
+  std::set<std::pair<std::string, uint64_t>> files;
+  auto block_callback = [&](const std::string& cf_name, uint64_t fd,
+                            uint32_t level, TraceType type,
+                            const std::string& /*block_key*/,
+                            uint64_t /*block_id*/,
+                            const BlockAccessInfo& block) {
+    files.emplace(cf_name, fd);
+    total_num_blocks++;
+    total_num_accesses += block.num_accesses;
+    bt_num_blocks_map[type]++;
+    for (auto const& caller_num : block.caller_num_access_map) {
+      caller_num_access_map[caller_num.first] += caller_num.second;
+      caller_bt_num_access_map[caller_num.first][type] += caller_num.second;
+      caller_level_num_access_map[caller_num.first][level] += caller_num.second;
+    }
+  };
+  TraverseBlocks(block_callback);
+  total_num_files = files.size();
+
+  fprintf(stdout,
+          "Number of files: %" PRIu64 " Number of blocks: %" PRIu64
+          " Number of accesses: %" PRIu64 "\n",
+          total_num_files, total_num_blocks, total_num_accesses);
+  for (auto const& block_type : bt_num_blocks_map) {
+    fprintf(stdout, "Number of %s blocks: %" PRIu64 " Percent: %.2f\n",
+            block_type_to_string(block_type.first).c_str(), block_type.second,
+            percent(block_type.second, total_num_blocks));
+  }
+  for (auto const& caller : caller_num_access_map) {
+    print_break_lines(/*num_break_lines=*/1);
+    const std::string caller_str = caller_to_string(caller.first);
+    fprintf(stdout, "Caller %s: Number of accesses %" PRIu64 " Percent: %.2f\n",
+            caller_str.c_str(), caller.second,
+            percent(caller.second, total_num_accesses));
+    fprintf(stdout, "Caller %s: Number of accesses per level break down\n",
+            caller_str.c_str());
+    for (auto const& naccess_level :
+         caller_level_num_access_map[caller.first]) {
+      fprintf(stdout,
+              "\t Level %" PRIu32 ": Number of accesses: %" PRIu64
+              " Percent: %.2f\n",
+              naccess_level.first, naccess_level.second,
+              percent(naccess_level.second, caller.second));
+    }
+    fprintf(stdout, "Caller %s: Number of accesses per block type break down\n",
+            caller_str.c_str());
+    for (auto const& naccess_type : caller_bt_num_access_map[caller.first]) {
+      fprintf(stdout,
+              "\t Block Type %s: Number of accesses: %" PRIu64
+              " Percent: %.2f\n",
+              block_type_to_string(naccess_type.first).c_str(),
+              naccess_type.second, percent(naccess_type.second, caller.second));
+    }
+  }
+  print_break_lines(/*num_break_lines=*/1);
+}
+
+int block_cache_trace_analyzer_tool(int argc, char** argv) {
+  ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_block_cache_trace_path.empty()) {
+    fprintf(stderr, "block cache trace path is empty\n");
+    return 1;
+  }
+  uint64_t warmup_seconds =
+      FLAGS_cache_sim_warmup_seconds > 0 ? FLAGS_cache_sim_warmup_seconds : 0;
+  uint32_t downsample_ratio = FLAGS_block_cache_trace_downsample_ratio > 0
+                                  ? FLAGS_block_cache_trace_downsample_ratio
+                                  : 1;
+  std::vector<CacheConfiguration> cache_configs =
+      parse_cache_config_file(FLAGS_block_cache_sim_config_path);
+  std::unique_ptr<BlockCacheTraceSimulator> cache_simulator;
+  if (!cache_configs.empty()) {
+    cache_simulator.reset(new BlockCacheTraceSimulator(
+        warmup_seconds, downsample_ratio, cache_configs));
+    Status s = cache_simulator->InitializeCaches();
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot initialize cache simulators %s\n",
+              s.ToString().c_str());
+      return 1;
+    }
+  }
+  BlockCacheTraceAnalyzer analyzer(FLAGS_block_cache_trace_path,
+                                   FLAGS_block_cache_analysis_result_dir,
+                                   std::move(cache_simulator));
+  Status s = analyzer.Analyze();
+  if (!s.IsIncomplete()) {
+    // Read all traces.
+    fprintf(stderr, "Cannot process the trace %s\n", s.ToString().c_str());
+    return 1;
+  }
+  fprintf(stdout, "Status: %s\n", s.ToString().c_str());
+  analyzer.PrintStatsSummary();
+  if (FLAGS_print_access_count_stats) {
+    print_break_lines(/*num_break_lines=*/3);
+    analyzer.PrintAccessCountStats();
+  }
+  if (FLAGS_print_block_size_stats) {
+    print_break_lines(/*num_break_lines=*/3);
+    analyzer.PrintBlockSizeStats();
+  }
+  if (FLAGS_print_data_block_access_count_stats) {
+    print_break_lines(/*num_break_lines=*/3);
+    analyzer.PrintDataBlockAccessStats();
+  }
+  print_break_lines(/*num_break_lines=*/3);
+  analyzer.WriteMissRatioCurves();
+
+  for (auto const& label : split_labels(FLAGS_timeline_labels)) {
+    analyzer.WriteAccessTimeline(label);
+  }
+  if (!FLAGS_reuse_distance_labels.empty() &&
+      !FLAGS_reuse_distance_buckets.empty()) {
+    std::vector<uint64_t> buckets = parse_buckets(FLAGS_reuse_distance_buckets);
+    for (auto const& label : split_labels(FLAGS_reuse_distance_labels)) {
+      analyzer.WriteReuseDistance(label, buckets);
+    }
+  }
+  if (!FLAGS_reuse_interval_labels.empty() &&
+      !FLAGS_reuse_interval_buckets.empty()) {
+    std::vector<uint64_t> buckets = parse_buckets(FLAGS_reuse_interval_buckets);
+    for (auto const& label : split_labels(FLAGS_reuse_interval_labels)) {
+      analyzer.WriteReuseInterval(label, buckets);
+    }
+  }
+  return 0;
+}
+
+}  // namespace TERARKDB_NAMESPACE
+
+#endif  // GFLAGS
+#endif  // ROCKSDB_LITE
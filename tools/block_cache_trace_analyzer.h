@@ -0,0 +1,225 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <functional>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/terark_namespace.h"
+#include "trace_replay/block_cache_tracer.h"
+#include "utilities/simulator_cache/cache_simulator.h"
+
+namespace TERARKDB_NAMESPACE {
+
+// Statistics of a block.
+struct BlockAccessInfo {
+  uint64_t block_id = 0;
+  uint64_t num_accesses = 0;
+  uint64_t block_size = 0;
+  uint64_t first_access_time = 0;
+  uint64_t last_access_time = 0;
+  uint64_t num_keys = 0;
+  std::map<std::string, uint64_t>
+      key_num_access_map;  // for keys exist in this block.
+  std::map<std::string, uint64_t>
+      non_exist_key_num_access_map;  // for keys do not exist in this block.
+  uint64_t num_referenced_key_exist_in_block = 0;
+  std::map<TableReaderCaller, uint64_t> caller_num_access_map;
+  // caller:timestamp(in seconds):number_of_accesses. This is used for
+  // the access timeline of a block.
+  std::map<TableReaderCaller, std::map<uint64_t, uint64_t>>
+      caller_num_accesses_timeline;
+  // Number of unique bytes accessed between two accesses of this block, and
+  // how many times it was observed.
+  std::map<uint64_t, uint64_t> reuse_distance_count;
+  // Seconds elapsed between two accesses of this block, and how many times it
+  // was observed.
+  std::map<uint64_t, uint64_t> reuse_interval_count;
+
+  void AddAccess(const BlockCacheTraceRecord& access) {
+    if (first_access_time == 0) {
+      first_access_time = access.access_timestamp;
+    } else {
+      uint64_t interval =
+          (access.access_timestamp - last_access_time) / kMicrosInSecond;
+      reuse_interval_count[interval] += 1;
+    }
+    last_access_time = access.access_timestamp;
+    block_size = access.block_size;
+    caller_num_access_map[access.caller]++;
+    num_accesses++;
+    caller_num_accesses_timeline[access.caller]
+                                [access.access_timestamp / kMicrosInSecond]++;
+    if (BlockCacheTraceHelper::ShouldTraceReferencedKey(access.block_type,
+                                                        access.caller)) {
+      num_keys = access.num_keys_in_block;
+      if (access.referenced_key_exist_in_block == Boolean::kTrue) {
+        key_num_access_map[access.referenced_key]++;
+        num_referenced_key_exist_in_block++;
+      } else {
+        non_exist_key_num_access_map[access.referenced_key]++;
+      }
+    }
+  }
+};
+
+// Aggregates stats of a block given a block type.
+struct BlockTypeAccessInfoAggregate {
+  std::map<std::string, BlockAccessInfo> block_access_info_map;
+};
+
+// Aggregates BlockTypeAggregate given a SST file.
+struct SSTFileAccessInfoAggregate {
+  uint32_t level;
+  std::map<TraceType, BlockTypeAccessInfoAggregate> block_type_aggregates_map;
+};
+
+// Aggregates SSTFileAggregate given a column family.
+struct ColumnFamilyAccessInfoAggregate {
+  std::map<uint64_t, SSTFileAccessInfoAggregate> fd_aggregates_map;
+};
+
+// Replays a block cache trace, aggregates the accesses per column family, SST
+// file, block type and block, and optionally feeds every access to a
+// BlockCacheTraceSimulator to compute miss ratio curves.
+class BlockCacheTraceAnalyzer {
+ public:
+  BlockCacheTraceAnalyzer(
+      const std::string& trace_file_path, const std::string& output_dir,
+      std::unique_ptr<BlockCacheTraceSimulator>&& cache_simulator);
+  ~BlockCacheTraceAnalyzer() = default;
+  // No copy and move.
+  BlockCacheTraceAnalyzer(const BlockCacheTraceAnalyzer&) = delete;
+  BlockCacheTraceAnalyzer& operator=(const BlockCacheTraceAnalyzer&) = delete;
+  BlockCacheTraceAnalyzer(BlockCacheTraceAnalyzer&&) = delete;
+  BlockCacheTraceAnalyzer& operator=(BlockCacheTraceAnalyzer&&) = delete;
+
+  // Read all access records in the given trace_file, maintains the stats of
+  // a block, and aggregates the information by block type, sst file, and
+  // column family. Subsequently, the caller may call Print* functions to print
+  // statistics.
+  Status Analyze();
+
+  // Print a summary of statistics of the trace, e.g.,
+  // Number of files: 2 Number of blocks: 50 Number of accesses: 50
+  // Number of Index blocks: 10
+  // Number of Filter blocks: 10
+  // Number of Data blocks: 10
+  // Number of UncompressionDict blocks: 10
+  // Number of RangeDeletion blocks: 10
+  // ***************************************************************
+  // Caller Get: Number of accesses 10
+  // Caller Get: Number of accesses per level break down
+  //          Level 0: Number of accesses: 10
+  // Caller Get: Number of accesses per block type break down
+  //          Block Type Index: Number of accesses: 2
+  //          Block Type Filter: Number of accesses: 2
+  //          Block Type Data: Number of accesses: 2
+  //          Block Type UncompressionDict: Number of accesses: 2
+  //          Block Type RangeDeletion: Number of accesses: 2
+  void PrintStatsSummary() const;
+
+  // Print block size distribution and the distribution break down by block type
+  // and column family.
+  void PrintBlockSizeStats() const;
+
+  // Print access count distribution and the distribution break down by block
+  // type and column family.
+  void PrintAccessCountStats() const;
+
+  // Print data block accesses by user Get and Multi-Get.
+  // It prints out 1) A histogram on the percentage of keys accessed in a data
+  // block break down by if a referenced key exists in the data block andthe
+  // histogram break down by column family. 2) A histogram on the percentage of
+  // accesses on keys exist in a data block and its break down by column family.
+  void PrintDataBlockAccessStats() const;
+
+  // Write the miss ratio curves of the simulated caches in csv to
+  // <output_dir>/mrc, one row per (cache, capacity).
+  void WriteMissRatioCurves() const;
+
+  // Write the access timeline into a csv file named
+  // <output_dir>/<label_str>_access_timeline. A row per second from the first
+  // to the last access, with one column per distinct label value.
+  void WriteAccessTimeline(const std::string& label) const;
+
+  // Write the reuse distance into a csv file named
+  // <output_dir>/<label_str>_reuse_distance. The reuse distance of an access
+  // is the number of unique bytes accessed since the last access on the same
+  // block. The first rows hold the number of reuses falling into each bucket
+  // and the rows that follow hold their percentage of all reuses.
+  void WriteReuseDistance(const std::string& label_str,
+                          const std::vector<uint64_t>& distance_buckets) const;
+
+  // Write the reuse interval, in seconds, into a csv file named
+  // <output_dir>/<label_str>_reuse_interval, in the same layout as the reuse
+  // distance.
+  void WriteReuseInterval(const std::string& label_str,
+                          const std::vector<uint64_t>& time_buckets) const;
+
+  const std::map<std::string, ColumnFamilyAccessInfoAggregate>&
+  TEST_cf_aggregates_map() const {
+    return cf_aggregates_map_;
+  }
+
+ private:
+  std::set<std::string> ParseLabelStr(const std::string& label_str) const;
+
+  std::string BuildLabel(const std::set<std::string>& labels,
+                         const std::string& cf_name, uint64_t fd,
+                         uint32_t level, TraceType type,
+                         TableReaderCaller caller, uint64_t block_id) const;
+
+  void TraverseBlocks(
+      std::function<void(const std::string& /*cf_name*/, uint64_t /*fd*/,
+                         uint32_t /*level*/, TraceType /*block_type*/,
+                         const std::string& /*block_key*/,
+                         uint64_t /*block_key_id*/,
+                         const BlockAccessInfo& /*block_access_info*/)>
+          block_callback) const;
+
+  void WriteReuseCounts(
+      const std::string& label_str, const std::string& file_suffix,
+      const std::vector<uint64_t>& buckets,
+      const std::function<const std::map<uint64_t, uint64_t>&(
+          const BlockAccessInfo&)>& counts) const;
+
+  // Computes the number of unique bytes accessed since the previous access on
+  // the block of `access`. Returns false on the first access of a block.
+  bool ComputeReuseDistance(const BlockCacheTraceRecord& access,
+                            uint64_t* reuse_distance);
+
+  void RecordAccess(const BlockCacheTraceRecord& access);
+
+  TERARKDB_NAMESPACE::Env* env_;
+  const std::string trace_file_path_;
+  const std::string output_dir_;
+
+  BlockCacheTraceHeader header_;
+  std::unique_ptr<BlockCacheTraceSimulator> cache_simulator_;
+  std::map<std::string, ColumnFamilyAccessInfoAggregate> cf_aggregates_map_;
+
+  // Reuse distances are computed with a Fenwick tree indexed by access
+  // sequence number: each block contributes its size at the sequence number of
+  // its latest access, so the unique bytes accessed between two accesses of a
+  // block is a prefix sum difference.
+  uint64_t access_sequence_ = 0;
+  std::vector<uint64_t> reuse_distance_tree_;
+  std::unordered_map<std::string, std::pair<uint64_t, uint64_t>>
+      block_last_access_;  // block key -> (sequence, size)
+  uint64_t next_block_id_ = 0;
+};
+
+int block_cache_trace_analyzer_tool(int argc, char** argv);
+
+}  // namespace TERARKDB_NAMESPACE
+
+#endif  // ROCKSDB_LITE
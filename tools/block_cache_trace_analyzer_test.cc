@@ -22,10 +22,11 @@ int main() {
 #include "rocksdb/status.h"
 #include "rocksdb/terark_namespace.h"
 #include "rocksdb/trace_reader_writer.h"
-#include "test_util/testharness.h"
-#include "test_util/testutil.h"
 #include "tools/block_cache_trace_analyzer.h"
 #include "trace_replay/block_cache_tracer.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
 
 namespace TERARKDB_NAMESPACE {
 
@@ -98,6 +98,7 @@ DEFINE_string(
     "multifillunique,"
     "overwrite,"
     "readrandom,"
+    "readrandomasync,"
     "newiterator,"
     "newiteratorwhilewriting,"
     "seekrandom,"
@@ -152,7 +153,15 @@ DEFINE_string(
     "\treadtocache   -- 1 thread reading database sequentially\n"
     "\treadreverse   -- read N times in reverse order\n"
     "\treadrandom    -- read N times in random order\n"
+    "\treadrandomasync -- same as readrandom, but every thread keeps "
+    "aio_concurrency GetAsync calls in flight. Use with --use_aio_reads to "
+    "compare the per thread throughput against readrandom\n"
     "\treadmissing   -- read N missing keys in random order\n"
+    "\tmultireadrandom       -- MultiGet batch_size keys in random "
+    "order, separated values are fetched grouped by blob file\n"
+    "\tmultireadrandomunbatched -- same as multireadrandom, but every "
+    "separated value is fetched on its own. Use with --histogram and "
+    "--blob_size to compare the latency percentiles\n"
     "\treadwhilewriting      -- 1 writer, N threads doing random "
     "reads\n"
     "\treadwhilemerging      -- 1 merger, N threads doing random "
@@ -380,6 +389,11 @@ DEFINE_uint64(subcompactions, 1,
 static const bool FLAGS_subcompactions_dummy __attribute__((__unused__)) =
     RegisterFlagValidator(&FLAGS_subcompactions, &ValidateUint32Range);
 
+DEFINE_uint64(flush_partitions, 1,
+              "Maximum number of key ranges to divide a flush into.");
+static const bool FLAGS_flush_partitions_dummy __attribute__((__unused__)) =
+    RegisterFlagValidator(&FLAGS_flush_partitions, &ValidateUint32Range);
+
 DEFINE_int32(max_background_flushes,
              TERARKDB_NAMESPACE::Options().max_background_flushes,
              "The maximum number of concurrent background flushes"
@@ -514,6 +528,10 @@ DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
 
+DEFINE_int64(blob_cache_size, 0,
+             "Number of bytes to use as a cache of separated values"
+             " (0 = disabled).");
+
 DEFINE_int32(open_files, TERARKDB_NAMESPACE::Options().max_open_files,
              "Maximum number of files to keep open at the same time"
              " (use default if == 0)");
@@ -823,6 +841,13 @@ DEFINE_int32(table_cache_numshardbits, 4, "");
 
 DEFINE_uint64(prepare_log_writer_num, 1, "");
 
+DEFINE_uint64(wal_streams, TERARKDB_NAMESPACE::Options().wal_streams,
+              "Number of WAL streams written side by side per log file");
+
+DEFINE_uint64(wal_recovery_threads,
+              TERARKDB_NAMESPACE::Options().wal_recovery_threads,
+              "Number of threads DB::Open starts to replay the WAL");
+
 #ifndef ROCKSDB_LITE
 DEFINE_string(env_uri, "",
               "URI for registry Env lookup. Mutually exclusive"
@@ -985,6 +1010,23 @@ DEFINE_uint64(max_dependence_blob_overlap, 0, "Max dependence blob overlap");
 
 DEFINE_uint64(maintainer_job_ratio, 0.1, "Maintainer job ratio");
 
+DEFINE_bool(enable_log_sst_flush, false,
+            "Flush separated values into log ssts");
+
+DEFINE_bool(enable_adaptive_blob_size, false,
+            "Pick the separation threshold of each output level from value "
+            "size histograms");
+
+DEFINE_double(adaptive_blob_size_write_weight, 0.5,
+              "Write amplification weight of adaptive blob size, [0, 1]");
+
+DEFINE_uint64(map_element_filter_bits_per_key, 0,
+              "Bloom filter bits per key of map sst elements linking more "
+              "than one sst, 0 to disable");
+static const bool FLAGS_map_element_filter_bits_per_key_dummy
+    __attribute__((__unused__)) = RegisterFlagValidator(
+        &FLAGS_map_element_filter_bits_per_key, &ValidateUint32Range);
+
 DEFINE_uint64(wal_ttl_seconds, 0, "Set the TTL for the WAL Files in seconds.");
 DEFINE_uint64(wal_size_limit_MB, 0,
               "Set the size limit for the WAL Files"
@@ -1008,6 +1050,14 @@ DEFINE_bool(
 DEFINE_bool(use_aio_reads, TERARKDB_NAMESPACE::Options().use_aio_reads,
             "Use aio_read+fiber for reading data");
 
+DEFINE_int32(aio_concurrency, 16,
+             "Number of fibers a thread runs GetAsync on in readrandomasync");
+
+DEFINE_uint64(multi_read_queue_depth,
+              TERARKDB_NAMESPACE::Options().multi_read_queue_depth,
+              "Max reads a MultiRead keeps in flight through Linux AIO, large "
+              "readahead is split into this many reads");
+
 DEFINE_bool(advise_random_on_open,
             TERARKDB_NAMESPACE::Options().advise_random_on_open,
             "Advise random access on table file open");
@@ -2706,12 +2756,18 @@ class Benchmark {
         method = &Benchmark::ReadReverse;
       } else if (name == "readrandom") {
         method = &Benchmark::ReadRandom;
+      } else if (name == "readrandomasync") {
+        method = &Benchmark::ReadRandomAsync;
       } else if (name == "readrandomfast") {
         method = &Benchmark::ReadRandomFast;
       } else if (name == "multireadrandom") {
         fprintf(stderr, "entries_per_batch = %" PRIi64 "\n",
                 entries_per_batch_);
         method = &Benchmark::MultiReadRandom;
+      } else if (name == "multireadrandomunbatched") {
+        fprintf(stderr, "entries_per_batch = %" PRIi64 "\n",
+                entries_per_batch_);
+        method = &Benchmark::MultiReadRandomUnbatched;
       } else if (name == "readmissing") {
         ++key_size_;
         method = &Benchmark::ReadRandom;
@@ -3255,6 +3311,8 @@ class Benchmark {
     options.max_background_jobs = FLAGS_max_background_jobs;
     options.max_background_compactions = FLAGS_max_background_compactions;
     options.max_subcompactions = static_cast<uint32_t>(FLAGS_subcompactions);
+    options.max_flush_partitions =
+        static_cast<uint32_t>(FLAGS_flush_partitions);
     options.max_background_flushes = FLAGS_max_background_flushes;
     options.compaction_style = FLAGS_compaction_style_e;
     options.compaction_pri = FLAGS_compaction_pri_e;
@@ -3264,6 +3322,8 @@ class Benchmark {
     options.use_direct_io_for_flush_and_compaction =
         FLAGS_use_direct_io_for_flush_and_compaction;
     options.use_aio_reads = FLAGS_use_aio_reads;
+    options.multi_read_queue_depth =
+        static_cast<size_t>(FLAGS_multi_read_queue_depth);
     options.zenfs_gc_ratio = FLAGS_zenfs_gc_ratio;
     if (FLAGS_prefix_size != 0) {
       options.prefix_extractor.reset(
@@ -3554,6 +3614,8 @@ class Benchmark {
     options.rate_limit_delay_max_milliseconds =
         FLAGS_rate_limit_delay_max_milliseconds;
     options.prepare_log_writer_num = FLAGS_prepare_log_writer_num;
+    options.wal_streams = FLAGS_wal_streams;
+    options.wal_recovery_threads = FLAGS_wal_recovery_threads;
     options.table_cache_numshardbits = FLAGS_table_cache_numshardbits;
     options.max_compaction_bytes = FLAGS_max_compaction_bytes;
     options.disable_auto_compactions = FLAGS_disable_auto_compactions;
@@ -3565,6 +3627,12 @@ class Benchmark {
     options.blob_file_defragment_size = FLAGS_blob_file_defragment_size;
     options.max_dependence_blob_overlap = FLAGS_max_dependence_blob_overlap;
     options.maintainer_job_ratio = FLAGS_maintainer_job_ratio;
+    options.enable_log_sst_flush = FLAGS_enable_log_sst_flush;
+    options.enable_adaptive_blob_size = FLAGS_enable_adaptive_blob_size;
+    options.adaptive_blob_size_write_weight =
+        FLAGS_adaptive_blob_size_write_weight;
+    options.map_element_filter_bits_per_key =
+        static_cast<uint32_t>(FLAGS_map_element_filter_bits_per_key);
     options.optimize_filters_for_hits = FLAGS_optimize_filters_for_hits;
     options.optimize_range_deletion = FLAGS_optimize_range_deletion;
 
@@ -3663,6 +3731,14 @@ class Benchmark {
         options.row_cache = NewLRUCache(FLAGS_row_cache_size);
       }
     }
+    if (FLAGS_blob_cache_size) {
+      if (FLAGS_cache_numshardbits >= 1) {
+        options.blob_cache =
+            NewLRUCache(FLAGS_blob_cache_size, FLAGS_cache_numshardbits);
+      } else {
+        options.blob_cache = NewLRUCache(FLAGS_blob_cache_size);
+      }
+    }
     if (FLAGS_enable_io_prio) {
       FLAGS_env->LowerThreadPoolIOPriority(Env::LOW);
       FLAGS_env->LowerThreadPoolIOPriority(Env::HIGH);
@@ -4495,6 +4571,9 @@ class Benchmark {
     std::unique_ptr<const char[]> key_guard;
     Slice key = AllocateKey(&key_guard);
     LazyBuffer lazy_val;
+    // Map sst links followed by missed reads, the read amplification a map
+    // element filter saves
+    uint64_t miss_hops = 0;
 
     Duration duration(FLAGS_duration, reads_);
     while (!duration.Done(1)) {
@@ -4505,6 +4584,7 @@ class Benchmark {
       int64_t key_rand = GetRandomKey(&thread->rand);
       GenerateKeyFromInt(key_rand, FLAGS_num, &key, -1);
       read++;
+      uint64_t hops = get_perf_context()->map_sst_hop_count;
       Status s;
       if (FLAGS_num_column_families > 1) {
         s = db_with_cfh->db->Get(options, db_with_cfh->GetCfh(key_rand), key,
@@ -4520,6 +4600,8 @@ class Benchmark {
       } else if (!s.IsNotFound()) {
         fprintf(stderr, "Get returned an error: %s\n", s.ToString().c_str());
         abort();
+      } else {
+        miss_hops += get_perf_context()->map_sst_hop_count - hops;
       }
 
       if (thread->shared->read_rate_limiter.get() != nullptr &&
@@ -4539,18 +4621,88 @@ class Benchmark {
     thread->stats.AddMessage(msg);
 
     if (FLAGS_perf_level > TERARKDB_NAMESPACE::PerfLevel::kDisable) {
+      if (read > found) {
+        snprintf(msg, sizeof(msg), "(%.2f map sst hops per missed read)\n",
+                 static_cast<double>(miss_hops) / (read - found));
+        thread->stats.AddMessage(msg);
+      }
       thread->stats.AddMessage(std::string("PERF_CONTEXT:\n") +
                                get_perf_context()->ToString());
     }
   }
 
+  // Same as ReadRandom, but the reads run on aio_concurrency fibers of the
+  // calling thread, a fiber parks on a block or blob read and the thread goes
+  // on with the next Get
+  void ReadRandomAsync(ThreadState* thread) {
+#ifdef WITH_BOOSTLIB
+    int64_t read = 0;
+    int64_t found = 0;
+    int64_t bytes = 0;
+    ReadOptions options(FLAGS_verify_checksum, true);
+    options.aio_concurrency = FLAGS_aio_concurrency;
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+
+    Duration duration(FLAGS_duration, reads_);
+    while (!duration.Done(1)) {
+      DBWithColumnFamilies* db_with_cfh = SelectDBWithCfh(thread);
+      int64_t key_rand = GetRandomKey(&thread->rand);
+      GenerateKeyFromInt(key_rand, FLAGS_num, &key, -1);
+      read++;
+      ColumnFamilyHandle* cfh = FLAGS_num_column_families > 1
+                                    ? db_with_cfh->GetCfh(key_rand)
+                                    : db_with_cfh->db->DefaultColumnFamily();
+      db_with_cfh->db->GetAsync(
+          options, cfh, key.ToString(),
+          [&, db_with_cfh](Status&& s, std::string&& k, std::string* value) {
+            if (s.ok()) {
+              found++;
+              bytes += k.size() + value->size();
+            } else if (!s.IsNotFound()) {
+              fprintf(stderr, "GetAsync returned an error: %s\n",
+                      s.ToString().c_str());
+              abort();
+            }
+            thread->stats.FinishedOps(db_with_cfh, db_with_cfh->db, 1, kRead);
+          });
+
+      if (thread->shared->read_rate_limiter.get() != nullptr &&
+          read % 256 == 255) {
+        thread->shared->read_rate_limiter->Request(
+            256, Env::IO_HIGH, nullptr /* stats */, RateLimiter::OpType::kRead);
+      }
+    }
+    DB::WaitAsync();
+
+    char msg[100];
+    snprintf(msg, sizeof(msg), "(%" PRIu64 " of %" PRIu64 " found)\n", found,
+             read);
+
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(msg);
+#else
+    fprintf(stderr, "readrandomasync needs WITH_BOOSTLIB, run readrandom\n");
+    ReadRandom(thread);
+#endif  // WITH_BOOSTLIB
+  }
+
+  void MultiReadRandom(ThreadState* thread) {
+    MultiReadRandomImpl(thread, true /* batch_separated_fetch */);
+  }
+
+  void MultiReadRandomUnbatched(ThreadState* thread) {
+    MultiReadRandomImpl(thread, false /* batch_separated_fetch */);
+  }
+
   // Calls MultiGet over a list of keys from a random distribution.
   // Returns the total number of keys found.
-  void MultiReadRandom(ThreadState* thread) {
+  void MultiReadRandomImpl(ThreadState* thread, bool batch_separated_fetch) {
     int64_t read = 0;
     int64_t num_multireads = 0;
     int64_t found = 0;
     ReadOptions options(FLAGS_verify_checksum, true);
+    options.batch_separated_fetch = batch_separated_fetch;
     std::vector<Slice> keys;
     std::vector<std::unique_ptr<const char[]>> key_guards;
     std::vector<std::string> values(entries_per_batch_);
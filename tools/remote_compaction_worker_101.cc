@@ -2,8 +2,12 @@
 // Created by leipeng on 2019-09-26.
 //
 
+#include <rocksdb/compaction_dispatcher.h>
 #include <rocksdb/db.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <terark/util/linebuf.hpp>
@@ -11,9 +15,11 @@
 
 class MyWorker : public TERARKDB_NAMESPACE::RemoteCompactionDispatcher::Worker {
   std::string GenerateOutputFileName(size_t file_index) override {
-    // make a file name
+    // make a file name, unique across the jobs served by this process
+    static std::atomic<uint64_t> name_seq{0};
     std::ostringstream oss;
-    oss << "Worker-" << std::this_thread::get_id() << "-" << file_index;
+    oss << "Worker-" << getpid() << "-" << std::this_thread::get_id() << "-"
+        << ++name_seq << "-" << file_index;
     return oss.str();
   }
 
@@ -21,7 +27,7 @@ class MyWorker : public TERARKDB_NAMESPACE::RemoteCompactionDispatcher::Worker {
   using TERARKDB_NAMESPACE::RemoteCompactionDispatcher::Worker::Worker;
 };
 
-int main() {
+int main(int argc, char** argv) {
   TERARKDB_NAMESPACE::EnvOptions env_options;
   MyWorker worker(env_options, TERARKDB_NAMESPACE::Env::Default());
 
@@ -35,6 +41,21 @@ int main() {
   // worker.RegistTablePropertiesCollectorFactory(
   //    std::shared_ptr<TablePropertiesCollectorFactory>);
 
+  if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+    // Long-lived pool worker, results go to the original stdout, anything
+    // else printed to stdout is sent to stderr
+    int result_fd = dup(1);
+    if (result_fd < 0 || dup2(2, 1) < 0) {
+      return 1;
+    }
+    auto s = worker.Serve(0, result_fd);
+    if (!s.ok()) {
+      fprintf(stderr, "Serve: %s\n", s.ToString().c_str());
+      return 1;
+    }
+    return 0;
+  }
+
   terark::LineBuf buf;
   buf.read_all(stdin);
   std::cout << worker.DoCompaction(TERARKDB_NAMESPACE::Slice(buf.p, buf.n));
@@ -45,3 +66,7 @@ int main() {
 // ----------------------------------------------
 // env TerarkZipTable_localTempDir=/tmp remote_compaction_worker_101
 // ----------------------------------------------
+// with TerarkDB_compactionWorkerPoolSize set, the command line should be:
+// ----------------------------------------------
+// env TerarkZipTable_localTempDir=/tmp remote_compaction_worker_101 --serve
+// ----------------------------------------------
@@ -5,7 +5,7 @@
 
 #include "trace_replay/block_cache_tracer.h"
 
-#include "db/db_impl/db_impl.h"
+#include "rocksdb/db.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/terark_namespace.h"
 #include "util/coding.h"
@@ -24,7 +24,7 @@ bool ShouldTrace(const Slice& block_key, const TraceOptions& trace_options) {
   }
   // We use spatial downsampling so that we have a complete access history for a
   // block.
-  const uint64_t hash = GetSliceNPHash64(block_key);
+  const uint64_t hash = GetSliceHash(block_key);
   return hash % trace_options.sampling_frequency == 0;
 }
 }  // namespace
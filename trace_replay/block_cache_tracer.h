@@ -12,6 +12,7 @@
 #include "rocksdb/options.h"
 #include "rocksdb/terark_namespace.h"
 #include "rocksdb/trace_reader_writer.h"
+#include "table/table_reader_caller.h"
 #include "util/trace_replay.h"
 
 namespace TERARKDB_NAMESPACE {
@@ -19,24 +20,19 @@ namespace TERARKDB_NAMESPACE {
 extern const uint64_t kMicrosInSecond;
 
 // Lookup context for tracing block cache accesses.
-// We trace block accesses at five places:
+// We trace block accesses at four places:
 // 1. BlockBasedTable::GetFilter
-// 2. BlockBasedTable::GetUncompressedDict.
-// 3. BlockBasedTable::MaybeReadAndLoadToCache. (To trace access on data, index,
-//    and range deletion block.)
+// 2. BlockBasedTable::NewIndexIterator
+// 3. BlockBasedTable::MaybeReadBlockAndLoadToCache. (To trace access on data
+//    and index blocks.)
 // 4. BlockBasedTable::Get. (To trace the referenced key and whether the
 //    referenced key exists in a fetched data block.)
-// 5. BlockBasedTable::MultiGet. (To trace the referenced key and whether the
-//    referenced key exists in a fetched data block.)
+// TerarkZipSubReader additionally traces every record it reads through its
+// LruReadonlyCache as a data block access.
 // The context is created at:
 // 1. BlockBasedTable::Get. (kUserGet)
-// 2. BlockBasedTable::MultiGet. (kUserMGet)
-// 3. BlockBasedTable::NewIterator. (either kUserIterator, kCompaction, or
-//    external SST ingestion calls this function.)
-// 4. BlockBasedTable::Open. (kPrefetch)
-// 5. Index/Filter::CacheDependencies. (kPrefetch)
-// 6. BlockBasedTable::ApproximateOffsetOf. (kCompaction or
-// kUserApproximateSize).
+// 2. BlockBasedTable::NewIterator. (either kUserIterator or kCompaction)
+// 3. BlockBasedTable::Open. (kPrefetch)
 struct BlockCacheLookupContext {
   BlockCacheLookupContext(const TableReaderCaller& _caller) : caller(_caller) {}
   const TableReaderCaller caller;
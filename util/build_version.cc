@@ -0,0 +1,4 @@
+#include "build_version.h"
+const char* rocksdb_build_git_sha = "rocksdb_build_git_sha:@a796812a4e9e6a997affd619546281a837df3676@";
+const char* rocksdb_build_git_date = "rocksdb_build_git_date:@2026/10/16 23:34:18@";
+const char* rocksdb_build_compile_date = __DATE__;
@@ -42,6 +42,11 @@ void CompactionJobStats::Reset() {
 
   num_single_del_fallthru = 0;
   num_single_del_mismatch = 0;
+
+  num_gc_sub_jobs = 0;
+  gc_input_bytes = 0;
+  gc_elapsed_micros = 0;
+  gc_input_bytes_per_second = 0;
 }
 
 void CompactionJobStats::Add(const CompactionJobStats& stats) {
@@ -74,6 +79,13 @@ void CompactionJobStats::Add(const CompactionJobStats& stats) {
 
   num_single_del_fallthru += stats.num_single_del_fallthru;
   num_single_del_mismatch += stats.num_single_del_mismatch;
+
+  num_gc_sub_jobs += stats.num_gc_sub_jobs;
+  gc_input_bytes += stats.gc_input_bytes;
+  gc_elapsed_micros += stats.gc_elapsed_micros;
+  // A rate does not add up, recompute it from the sums
+  gc_input_bytes_per_second =
+      gc_elapsed_micros == 0 ? 0 : gc_input_bytes * 1000000 / gc_elapsed_micros;
 }
 
 #else
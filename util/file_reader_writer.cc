@@ -218,6 +218,62 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status RandomAccessFileReader::MultiRead(FSReadRequest* reqs,
+                                         size_t num_reqs) const {
+  bool batched = GetMultiReadQueueDepth() > 1;
+  if (batched && use_direct_io()) {
+    size_t alignment = file_->GetRequiredBufferAlignment();
+    for (size_t i = 0; batched && i < num_reqs; ++i) {
+      batched = reqs[i].offset % alignment == 0 &&
+                reqs[i].len % alignment == 0 &&
+                reinterpret_cast<uintptr_t>(reqs[i].scratch) % alignment == 0;
+    }
+  }
+  if (!batched) {
+    // Read() takes care of rate limiting and direct IO alignment
+    for (size_t i = 0; i < num_reqs; ++i) {
+      FSReadRequest& req = reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+  Status s;
+  uint64_t elapsed = 0;
+  {
+    StopWatch sw(env_, stats_, hist_type_,
+                 (stats_ != nullptr) ? &elapsed : nullptr, true /*overwrite*/,
+                 true /*delay_enabled*/);
+    IOSTATS_TIMER_GUARD(read_nanos);
+#ifndef ROCKSDB_LITE
+    FileOperationInfo::TimePoint start_ts;
+    if (ShouldNotifyListeners()) {
+      start_ts = std::chrono::system_clock::now();
+    }
+#endif
+    s = file_->MultiRead(reqs, num_reqs);
+#ifndef ROCKSDB_LITE
+    if (ShouldNotifyListeners()) {
+      auto finish_ts = std::chrono::system_clock::now();
+      for (size_t i = 0; i < num_reqs; ++i) {
+        NotifyOnFileReadFinish(reqs[i].offset, reqs[i].result.size(),
+                               start_ts, finish_ts, s.ok() ? reqs[i].status : s);
+      }
+    }
+#endif
+    if (s.ok()) {
+      for (size_t i = 0; i < num_reqs; ++i) {
+        if (reqs[i].status.ok()) {
+          IOSTATS_ADD_IF_POSITIVE(bytes_read, reqs[i].result.size());
+        }
+      }
+    }
+  }
+  if (stats_ != nullptr && file_read_hist_ != nullptr) {
+    file_read_hist_->Add(elapsed);
+  }
+  return s;
+}
+
 Status WritableFileWriter::Append(const Slice& data) {
   const char* src = data.data();
   size_t left = data.size();
@@ -815,6 +871,8 @@ class MemoryRandomAccessFile : public RandomAccessFile {
 };
 }  // namespace
 
+constexpr size_t FilePrefetchBuffer::kMinMultiReadSize;
+
 Status FilePrefetchBuffer::Prefetch(RandomAccessFileReader* reader,
                                     uint64_t offset, size_t n) {
   size_t alignment = reader->file()->GetRequiredBufferAlignment();
@@ -875,17 +933,64 @@ Status FilePrefetchBuffer::Prefetch(RandomAccessFileReader* reader,
                       static_cast<size_t>(chunk_len));
   }
 
-  Slice result;
-  s = reader->Read(rounddown_offset + chunk_len,
-                   static_cast<size_t>(roundup_len - chunk_len), &result,
-                   buffer_.BufferStart() + chunk_len);
+  uint64_t read_offset = rounddown_offset + chunk_len;
+  size_t read_len = static_cast<size_t>(roundup_len - chunk_len);
+  char* read_buf = buffer_.BufferStart() + chunk_len;
+  size_t queue_depth = reader->GetMultiReadQueueDepth();
+  size_t result_size = 0;
+  if (queue_depth > 1 && read_len >= 2 * kMinMultiReadSize) {
+    // Split a large read so the device serves the pieces in parallel
+    size_t piece_len = Roundup(
+        std::max(kMinMultiReadSize, (read_len + queue_depth - 1) / queue_depth),
+        alignment);
+    std::vector<FSReadRequest> reqs;
+    for (size_t pos = 0; pos < read_len; pos += piece_len) {
+      FSReadRequest req;
+      req.offset = read_offset + pos;
+      req.len = std::min(piece_len, read_len - pos);
+      req.scratch = read_buf + pos;
+      reqs.emplace_back(std::move(req));
+    }
+    s = reader->MultiRead(reqs.data(), reqs.size());
+    // Keep the contiguous prefix, a short piece means end of file
+    for (size_t i = 0; s.ok() && i < reqs.size(); ++i) {
+      auto& req = reqs[i];
+      s = req.status;
+      if (!s.ok()) {
+        break;
+      }
+      if (req.result.data() != req.scratch) {
+        memmove(req.scratch, req.result.data(), req.result.size());
+      }
+      result_size += req.result.size();
+      if (req.result.size() < req.len) {
+        break;
+      }
+    }
+  } else {
+    Slice result;
+    s = reader->Read(read_offset, read_len, &result, read_buf);
+    result_size = result.size();
+  }
   if (s.ok()) {
     buffer_offset_ = rounddown_offset;
-    buffer_.Size(static_cast<size_t>(chunk_len) + result.size());
+    buffer_.Size(static_cast<size_t>(chunk_len) + result_size);
   }
   return s;
 }
 
+char* FilePrefetchBuffer::PrepareBuffer(uint64_t offset, size_t n) {
+  if (buffer_.Alignment() == 0) {
+    buffer_.Alignment(kDefaultPageSize);
+  }
+  if (buffer_.Capacity() < n) {
+    buffer_.AllocateNewBuffer(n);
+  }
+  buffer_offset_ = offset;
+  buffer_.Size(0);
+  return buffer_.BufferStart();
+}
+
 bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
                                           Slice* result) {
   if (track_min_offset_ && offset < min_offset_read_) {
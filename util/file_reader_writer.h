@@ -113,6 +113,19 @@ class RandomAccessFileReader {
 
   Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const;
 
+  // Read reqs[0..num_reqs-1] with one RandomAccessFile::MultiRead() call.
+  // Every req.scratch must hold req.len bytes. Falls back to Read() per
+  // request if the reads are rate limited or not aligned for direct IO.
+  Status MultiRead(FSReadRequest* reqs, size_t num_reqs) const;
+
+  // Number of reads MultiRead() serves in parallel
+  size_t GetMultiReadQueueDepth() const {
+    if (for_compaction_ && rate_limiter_ != nullptr) {
+      return 1;
+    }
+    return file_->GetMultiReadQueueDepth();
+  }
+
   Status Prefetch(uint64_t offset, size_t n) const {
     return file_->Prefetch(offset, n);
   }
@@ -276,6 +289,16 @@ class FilePrefetchBuffer {
   Status Prefetch(RandomAccessFileReader* reader, uint64_t offset, size_t n);
   bool TryReadFromCache(uint64_t offset, size_t n, Slice* result);
 
+  // Let a read issued elsewhere fill the buffer, e.g. one request of a
+  // RandomAccessFileReader::MultiRead(). Returns room for n bytes at offset,
+  // Filled() takes the number of bytes actually read.
+  char* PrepareBuffer(uint64_t offset, size_t n);
+  void Filled(size_t n) { buffer_.Size(n); }
+
+  // Prefetch() splits reads into pieces no smaller than this when the file
+  // serves MultiRead() in parallel
+  static constexpr size_t kMinMultiReadSize = 64 * 1024;
+
   // The minimum `offset` ever passed to TryReadFromCache(). Only be tracked
   // if track_min_offset = true.
   size_t min_offset_read() const { return min_offset_read_; }
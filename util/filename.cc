@@ -74,6 +74,14 @@ std::string LogFileName(const std::string& name, uint64_t number) {
   return MakeFileName(name, number, "log");
 }
 
+std::string LogStreamFileName(const std::string& name, uint64_t number,
+                              size_t stream) {
+  assert(number > 0 && stream > 0);
+  char buf[32];
+  snprintf(buf, sizeof(buf), "log.%" ROCKSDB_PRIszt, stream);
+  return MakeFileName(name, number, buf);
+}
+
 std::string ArchivalDirectory(const std::string& dir) {
   return dir + "/" + ARCHIVAL_DIR;
 }
@@ -334,6 +342,14 @@ bool ParseFileName(const std::string& fname, uint64_t* number,
       }
     } else if (archive_dir_found) {
       return false;  // Archive dir can contain only log files
+    } else if (suffix.starts_with("log.")) {
+      uint64_t stream;
+      suffix.remove_prefix(strlen("log."));
+      if (!ConsumeDecimalNumber(&suffix, &stream) || !suffix.empty() ||
+          stream == 0) {
+        return false;
+      }
+      *type = kWalStreamFile;
     } else if (suffix == Slice(kRocksDbTFileExt) ||
                suffix == Slice(kLevelDbTFileExt)) {
       *type = kTableFile;
@@ -41,7 +41,8 @@ enum FileType {
   kMetaDatabase,
   kIdentityFile,
   kOptionsFile,
-  kSocketFile
+  kSocketFile,
+  kWalStreamFile  // An extra stream of a log file, see DBOptions::wal_streams
 };
 
 // Return the name of the log file with the specified number
@@ -49,6 +50,11 @@ enum FileType {
 // "dbname".
 extern std::string LogFileName(const std::string& dbname, uint64_t number);
 
+// Return the name of the extra stream `stream` (> 0) of the log file with the
+// specified number. The result will be prefixed with "dbname".
+extern std::string LogStreamFileName(const std::string& dbname, uint64_t number,
+                                     size_t stream);
+
 static const std::string ARCHIVAL_DIR = "archive";
 
 extern std::string ArchivalDirectory(const std::string& dbname);
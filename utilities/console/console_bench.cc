@@ -0,0 +1,314 @@
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "monitoring/histogram.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using namespace TERARKDB_NAMESPACE;
+
+DEFINE_string(db, "/tmp/console_bench",
+              "DB opened by the benchmark, its console serves on "
+              "<db>/CONSOLE if built with TERARKDB_ENABLE_CONSOLE. Ignored "
+              "if -server is set");
+
+DEFINE_bool(destroy_db, true, "Destroy -db before opening it");
+
+DEFINE_string(server, "",
+              "host:port of a running console to benchmark, e.g. "
+              "127.0.0.1:6379");
+
+DEFINE_int32(connections, 16, "Number of client connections");
+
+DEFINE_int32(pipeline, 16, "Commands sent per round trip on a connection");
+
+DEFINE_int64(ops_per_connection, 100000, "Commands sent by each connection");
+
+DEFINE_int64(num_keys, 100000, "Number of distinct keys");
+
+DEFINE_int32(value_size, 100, "Size of the values");
+
+DEFINE_int32(read_percent, 80, "Percentage of read commands");
+
+DEFINE_int32(keys_per_command, 1,
+             "Keys per command, use MGET/MSET instead of GET/SET if > 1");
+
+DEFINE_bool(preload, true, "Write every key before the benchmark");
+
+DEFINE_int32(seed, 301, "Random seed");
+
+namespace {
+
+int Connect() {
+  int fd;
+  if (FLAGS_server.empty()) {
+    std::string path = FLAGS_db + "/CONSOLE";
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 &&
+        connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) !=
+            0) {
+      close(fd);
+      fd = -1;
+    }
+  } else {
+    auto colon = FLAGS_server.rfind(':');
+    if (colon == std::string::npos) {
+      return -1;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(
+        atoi(FLAGS_server.c_str() + colon + 1)));
+    if (inet_pton(AF_INET, FLAGS_server.substr(0, colon).c_str(),
+                  &addr.sin_addr) != 1) {
+      return -1;
+    }
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 &&
+        connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) !=
+            0) {
+      close(fd);
+      fd = -1;
+    }
+    if (fd >= 0) {
+      int yes = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+  }
+  return fd;
+}
+
+// Length of the first complete reply in buf, 0 if incomplete
+size_t ReplyLength(const char* buf, size_t n) {
+  auto eol = static_cast<const char*>(memchr(buf, '\n', n));
+  if (eol == nullptr) {
+    return 0;
+  }
+  size_t len = eol - buf + 1;
+  switch (buf[0]) {
+    case '$': {
+      long long bulk_len = strtoll(buf + 1, nullptr, 10);
+      if (bulk_len < 0) {
+        return len;
+      }
+      len += bulk_len + 2;
+      return len <= n ? len : 0;
+    }
+    case '*': {
+      long long count = strtoll(buf + 1, nullptr, 10);
+      for (long long i = 0; i < count; ++i) {
+        size_t element_len = ReplyLength(buf + len, n - len);
+        if (element_len == 0) {
+          return 0;
+        }
+        len += element_len;
+      }
+      return len;
+    }
+    default:
+      return len;
+  }
+}
+
+void AppendCommand(std::string* buf, const std::vector<std::string>& argv) {
+  buf->append("*" + std::to_string(argv.size()) + "\r\n");
+  for (auto& arg : argv) {
+    buf->append("$" + std::to_string(arg.size()) + "\r\n");
+    buf->append(arg);
+    buf->append("\r\n");
+  }
+}
+
+std::string Key(int64_t k) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "key%016" PRId64, k);
+  return buf;
+}
+
+struct ConnectionStats {
+  HistogramImpl latency;
+  uint64_t ops = 0;
+  uint64_t errors = 0;
+  std::string failure;
+};
+
+void RunConnection(int index, ConnectionStats* stats) {
+  Env* env = Env::Default();
+  int fd = Connect();
+  if (fd < 0) {
+    stats->failure = std::string("connect: ") + strerror(errno);
+    return;
+  }
+  Random64 rnd(FLAGS_seed + index);
+  const std::string value(FLAGS_value_size, 'v');
+  std::string request, response;
+  std::vector<std::string> argv;
+  char buf[64 << 10];
+
+  for (int64_t done = 0; done < FLAGS_ops_per_connection;) {
+    int64_t n = std::min<int64_t>(FLAGS_pipeline,
+                                  FLAGS_ops_per_connection - done);
+    request.clear();
+    for (int64_t i = 0; i < n; ++i) {
+      bool read = static_cast<int>(rnd.Uniform(100)) < FLAGS_read_percent;
+      argv.clear();
+      if (FLAGS_keys_per_command > 1) {
+        argv.emplace_back(read ? "MGET" : "MSET");
+      } else {
+        argv.emplace_back(read ? "GET" : "SET");
+      }
+      for (int k = 0; k < FLAGS_keys_per_command; ++k) {
+        argv.emplace_back(Key(rnd.Uniform(FLAGS_num_keys)));
+        if (!read) {
+          argv.emplace_back(value);
+        }
+      }
+      AppendCommand(&request, argv);
+    }
+
+    uint64_t start = env->NowMicros();
+    for (size_t sent = 0; sent < request.size();) {
+      ssize_t r = write(fd, request.data() + sent, request.size() - sent);
+      if (r <= 0) {
+        stats->failure = std::string("write: ") + strerror(errno);
+        close(fd);
+        return;
+      }
+      sent += r;
+    }
+    for (int64_t replies = 0; replies < n;) {
+      size_t len = ReplyLength(response.data(), response.size());
+      if (len == 0) {
+        ssize_t r = read(fd, buf, sizeof(buf));
+        if (r <= 0) {
+          stats->failure = "connection closed by the server";
+          close(fd);
+          return;
+        }
+        response.append(buf, r);
+        continue;
+      }
+      if (response[0] == '-') {
+        ++stats->errors;
+      }
+      response.erase(0, len);
+      ++replies;
+    }
+    uint64_t elapsed = env->NowMicros() - start;
+    for (int64_t i = 0; i < n; ++i) {
+      stats->latency.Add(elapsed);
+    }
+    done += n;
+    stats->ops += n;
+  }
+  close(fd);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ParseCommandLineFlags(&argc, &argv, true);
+  Env* env = Env::Default();
+
+  std::unique_ptr<DB> db;
+  if (FLAGS_server.empty()) {
+    Options options;
+    options.create_if_missing = true;
+    if (FLAGS_destroy_db) {
+      DestroyDB(FLAGS_db, options);
+    }
+    DB* db_ptr = nullptr;
+    Status s = DB::Open(options, FLAGS_db, &db_ptr);
+    if (!s.ok()) {
+      fprintf(stderr, "Open %s: %s\n", FLAGS_db.c_str(), s.ToString().c_str());
+      return 1;
+    }
+    db.reset(db_ptr);
+    if (FLAGS_preload) {
+      const std::string value(FLAGS_value_size, 'v');
+      for (int64_t k = 0; k < FLAGS_num_keys; ++k) {
+        db->Put(WriteOptions(), Key(k), value);
+      }
+    }
+    // The console starts in the background
+    for (int i = 0; i < 100; ++i) {
+      int fd = Connect();
+      if (fd >= 0) {
+        close(fd);
+        break;
+      }
+      env->SleepForMicroseconds(50000);
+    }
+  }
+
+  printf("Connections         : %d\n", FLAGS_connections);
+  printf("Pipeline            : %d\n", FLAGS_pipeline);
+  printf("Ops per connection  : %" PRId64 "\n", FLAGS_ops_per_connection);
+  printf("Keys per command    : %d\n", FLAGS_keys_per_command);
+  printf("Read percentage     : %d%%\n", FLAGS_read_percent);
+  printf("Value size          : %d\n", FLAGS_value_size);
+  printf("----------------------------\n");
+
+  std::vector<ConnectionStats> stats(FLAGS_connections);
+  std::vector<std::thread> threads;
+  uint64_t start = env->NowMicros();
+  for (int i = 0; i < FLAGS_connections; ++i) {
+    threads.emplace_back(RunConnection, i, &stats[i]);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  double elapsed = (env->NowMicros() - start) * 1e-6;
+
+  HistogramImpl latency;
+  uint64_t ops = 0, errors = 0;
+  for (auto& s : stats) {
+    if (!s.failure.empty()) {
+      fprintf(stderr, "Connection failed: %s\n", s.failure.c_str());
+    }
+    latency.Merge(s.latency);
+    ops += s.ops;
+    errors += s.errors;
+  }
+  printf("Complete in %.3f s; ops/s = %.0f; errors = %" PRIu64 "\n", elapsed,
+         ops / elapsed, errors);
+  printf("Latency of a command (us):\n%s\n", latency.ToString().c_str());
+  return ops == 0 ? 1 : 0;
+}
+
+#endif  // GFLAGS
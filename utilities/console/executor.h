@@ -26,6 +26,8 @@ class Executor {
 };
 
 std::unique_ptr<Executor> OpenExecutorMem(TERARKDB_NAMESPACE::DBImpl* db);
+
+std::unique_ptr<Executor> OpenExecutorDB(TERARKDB_NAMESPACE::DBImpl* db);
 }  // namespace cheapis
 
 #endif  // CHEAPIS_EXECUTOR_H
\ No newline at end of file
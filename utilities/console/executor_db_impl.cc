@@ -0,0 +1,343 @@
+#include <condition_variable>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <strings.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "db/db_impl.h"
+#include "executor.h"
+#include "rocksdb/write_batch.h"
+#include "string_view.hpp"
+#include "util.h"
+#include "util/autovector.h"
+
+namespace cheapis {
+using namespace TERARKDB_NAMESPACE;
+
+constexpr size_t kNumWorkers = 4;
+constexpr long long kDefaultScanCount = 10;
+constexpr long long kMaxScanCount = 10000;
+
+// Runs the commands on the default column family of the DB. Commands are
+// handed to a pool of worker threads so that a slow read doesn't stall the
+// event loop. The commands a client pipelined are run as one batch: adjacent
+// writes go into one WriteBatch and adjacent reads into one MultiGet. A
+// client has at most one batch running, so its replies keep their order.
+class ExecutorDBImpl final : public Executor {
+ private:
+  struct Task {
+    autovector<std::string> argv;
+    Client* c;
+    int fd;
+  };
+
+  struct Batch {
+    Client* c;
+    int fd;
+    std::vector<Task> tasks;
+    std::string output;
+  };
+
+ public:
+  explicit ExecutorDBImpl(DBImpl* db) : db_(db) {
+    for (size_t i = 0; i < kNumWorkers; ++i) {
+      workers_.emplace_back([this] { WorkerMain(); });
+    }
+  }
+
+  ~ExecutorDBImpl() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closing_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void Submit(const autovector<nonstd::string_view>& argv, Client* c,
+              int fd) override {
+    tasks_.emplace_back();
+    Task& task = tasks_.back();
+    for (const auto& arg : argv) {
+      task.argv.emplace_back(arg);
+    }
+    task.c = c;
+    task.fd = fd;
+  }
+
+  void Execute(size_t n, long /* curr_time */, EventLoop<Client>* el) override {
+    Complete(el);
+    Dispatch(n, el);
+  }
+
+  size_t GetTaskCount() const override { return tasks_.size(); }
+
+ private:
+  // Called by the event loop, hand up to n queued commands to the workers
+  void Dispatch(size_t n, EventLoop<Client>* el) {
+    std::vector<std::unique_ptr<Batch>> batches;
+    std::unordered_map<Client*, Batch*> batched;
+    std::deque<Task> remaining;
+    for (size_t i = 0; !tasks_.empty(); tasks_.pop_front(), ++i) {
+      Task& task = tasks_.front();
+      Client* c = task.c;
+      if (c->close) {
+        if (--c->ref_count == 0) {
+          el->Release(task.fd);
+        }
+        continue;
+      }
+      if (i >= n || (c->busy && batched.count(c) == 0)) {
+        // Wait for the running batch of this client
+        remaining.emplace_back(std::move(task));
+        continue;
+      }
+      if (!c->busy) {
+        c->busy = true;
+        batches.emplace_back(new Batch{c, task.fd, {}, {}});
+        batched.emplace(c, batches.back().get());
+      }
+      batched[c]->tasks.emplace_back(std::move(task));
+    }
+    tasks_.swap(remaining);
+    if (batches.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& batch : batches) {
+        pending_.emplace_back(std::move(batch));
+      }
+    }
+    cv_.notify_all();
+  }
+
+  // Called by the event loop, send the replies of the finished batches
+  void Complete(EventLoop<Client>* el) {
+    std::deque<std::unique_ptr<Batch>> finished;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished.swap(finished_);
+    }
+    for (auto& batch : finished) {
+      Client* c = batch->c;
+      int fd = batch->fd;
+      c->busy = false;
+      c->ref_count -= static_cast<unsigned int>(batch->tasks.size());
+      if (c->close) {
+        if (c->ref_count == 0) {
+          el->Release(fd);
+        }
+        continue;
+      }
+
+      bool blocked = !c->output.empty();
+      c->output.append(batch->output);
+      if (!blocked) {
+        ssize_t nwrite = write(fd, c->output.data(), c->output.size());
+        if (nwrite > 0) {
+          c->output.assign(c->output.data() + nwrite,
+                           c->output.size() - nwrite);
+        }
+        if (!c->output.empty()) {
+          el->AddEvent(fd, kWritable);
+        }
+      }
+    }
+  }
+
+  void WorkerMain() {
+    while (true) {
+      std::unique_ptr<Batch> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return closing_ || !pending_.empty(); });
+        if (closing_) {
+          return;
+        }
+        batch = std::move(pending_.front());
+        pending_.pop_front();
+      }
+      Run(batch.get());
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_.emplace_back(std::move(batch));
+    }
+  }
+
+  void Run(Batch* batch) {
+    std::string* out = &batch->output;
+
+    // Adjacent GET/MGET share one MultiGet
+    struct Read {
+      size_t begin, end;
+      bool multi;
+    };
+    std::vector<Read> reads;
+    std::vector<Slice> read_keys;
+    auto flush_reads = [&] {
+      if (reads.empty()) {
+        return;
+      }
+      std::vector<std::string> values;
+      DB* db = db_;
+      auto statuses = db->MultiGet(ReadOptions(), read_keys, &values);
+      for (auto& read : reads) {
+        if (read.multi) {
+          RespMachine::AppendArrayLength(
+              out, static_cast<long long>(read.end - read.begin));
+        }
+        for (size_t i = read.begin; i < read.end; ++i) {
+          if (statuses[i].ok()) {
+            RespMachine::AppendBulkString(out, values[i]);
+          } else if (!statuses[i].IsNotFound()) {
+            RespMachine::AppendError(out, statuses[i].ToString());
+          } else if (read.multi) {
+            RespMachine::AppendNullBulkString(out);
+          } else {
+            RespMachine::AppendNullArray(out);
+          }
+        }
+      }
+      reads.clear();
+      read_keys.clear();
+    };
+
+    // Adjacent SET/MSET/DEL share one WriteBatch
+    WriteBatch write_batch;
+    size_t num_writes = 0;
+    auto flush_writes = [&] {
+      if (num_writes == 0) {
+        return;
+      }
+      auto s = db_->Write(WriteOptions(), &write_batch);
+      for (size_t i = 0; i < num_writes; ++i) {
+        if (s.ok()) {
+          RespMachine::AppendSimpleString(out, "OK");
+        } else {
+          RespMachine::AppendError(out, s.ToString());
+        }
+      }
+      write_batch.Clear();
+      num_writes = 0;
+    };
+
+    for (auto& task : batch->tasks) {
+      auto& argv = task.argv;
+      if ((argv[0] == "GET" && argv.size() == 2) ||
+          (argv[0] == "MGET" && argv.size() >= 2)) {
+        flush_writes();
+        reads.emplace_back(
+            Read{read_keys.size(), read_keys.size() + argv.size() - 1,
+                 argv[0] == "MGET"});
+        for (size_t i = 1; i < argv.size(); ++i) {
+          read_keys.emplace_back(argv[i]);
+        }
+      } else if ((argv[0] == "SET" && argv.size() == 3) ||
+                 (argv[0] == "MSET" && argv.size() >= 3 &&
+                  argv.size() % 2 == 1)) {
+        flush_reads();
+        for (size_t i = 1; i < argv.size(); i += 2) {
+          write_batch.Put(argv[i], argv[i + 1]);
+        }
+        ++num_writes;
+      } else if (argv[0] == "DEL" && argv.size() == 2) {
+        flush_reads();
+        write_batch.Delete(argv[1]);
+        ++num_writes;
+      } else {
+        flush_reads();
+        flush_writes();
+        RunCommand(argv, out);
+      }
+    }
+    flush_reads();
+    flush_writes();
+  }
+
+  void RunCommand(const autovector<std::string>& argv, std::string* out) {
+    if (argv[0] == "SCAN" && (argv.size() == 2 || argv.size() == 4)) {
+      Scan(argv, out);
+    } else if (argv[0] == "TERARKDB_OPS_FULL_COMPACT" && argv.size() == 1) {
+      CompactRangeOptions cro{};
+      cro.exclusive_manual_compaction = false;
+      auto s = db_->CompactRange(cro, nullptr, nullptr);
+      if (s.ok()) {
+        RespMachine::AppendSimpleString(out, "OK");
+      } else {
+        RespMachine::AppendError(
+            out, "Cannot do full compaction. Error message: " + s.ToString());
+      }
+    } else if (argv[0] == "PING" && argv.size() == 1) {
+      RespMachine::AppendSimpleString(out, "PONG");
+    } else {
+      RespMachine::AppendError(out, "Unsupported Command");
+    }
+  }
+
+  // SCAN cursor [COUNT count]
+  // The cursor is the hex encoded key to resume from, "0" starts a new scan
+  // and is returned when the scan is done.
+  void Scan(const autovector<std::string>& argv, std::string* out) {
+    long long count = kDefaultScanCount;
+    if (argv.size() == 4) {
+      if (strcasecmp(argv[2].c_str(), "COUNT") != 0 ||
+          !string2ll(argv[3].data(), argv[3].size(), &count) || count <= 0) {
+        RespMachine::AppendError(out, "Invalid SCAN option");
+        return;
+      }
+      count = std::min(count, kMaxScanCount);
+    }
+    std::string start;
+    if (argv[1] != "0" && !Slice(argv[1]).DecodeHex(&start)) {
+      RespMachine::AppendError(out, "Invalid SCAN cursor");
+      return;
+    }
+
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    if (start.empty()) {
+      iter->SeekToFirst();
+    } else {
+      iter->Seek(start);
+    }
+    std::vector<std::string> keys;
+    for (; iter->Valid() && keys.size() < static_cast<size_t>(count);
+         iter->Next()) {
+      keys.emplace_back(iter->key().ToString());
+    }
+    if (!iter->status().ok()) {
+      RespMachine::AppendError(out, iter->status().ToString());
+      return;
+    }
+    RespMachine::AppendArrayLength(out, 2);
+    if (iter->Valid()) {
+      RespMachine::AppendBulkString(out, iter->key().ToString(true /* hex */));
+    } else {
+      RespMachine::AppendBulkString(out, "0", 1);
+    }
+    RespMachine::AppendArrayLength(out, static_cast<long long>(keys.size()));
+    for (auto& key : keys) {
+      RespMachine::AppendBulkString(out, key);
+    }
+  }
+
+  // Owned by the event loop
+  std::deque<Task> tasks_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<Batch>> pending_;
+  std::deque<std::unique_ptr<Batch>> finished_;
+  bool closing_ = false;
+  std::vector<std::thread> workers_;
+  DBImpl* db_;
+};
+
+std::unique_ptr<Executor> OpenExecutorDB(DBImpl* db) {
+  return std::make_unique<ExecutorDBImpl>(db);
+}
+}  // namespace cheapis
@@ -122,8 +122,9 @@ static void WriteToClient(int fd, Client *c, long curr_time,
 
 static void ExecuteTasks(Executor *executor, long curr_time,
                          EventLoop<Client> *el) {
-  size_t plan = (executor->GetTaskCount() + 1) / 2;
-  executor->Execute(plan, curr_time, el);
+  // The executor runs the commands on its own threads, hand over everything
+  // so that pipelined commands are batched together
+  executor->Execute(executor->GetTaskCount(), curr_time, el);
 }
 
 static void ServerCron(long *last_cron_time, long curr_time,
@@ -156,7 +157,7 @@ int ServerMain(ServerRunner *runner, TERARKDB_NAMESPACE::DBImpl *db,
   }
   EventLoop<Client> el(el_fd);
 
-  auto executor = OpenExecutorMem(db);
+  auto executor = OpenExecutorDB(db);
   if (executor == nullptr) {
     ROCKS_LOG_ERROR(log, "Failed creating the executor");
     return 1;
@@ -33,6 +33,8 @@ struct Client {
   unsigned int ref_count = 0;
   unsigned int consume_len = 0;
   bool close = false;
+  // A batch of its commands is running on the executor's workers
+  bool busy = false;
 
   explicit Client(long last_mod_time = -1) : last_mod_time(last_mod_time) {}
 };
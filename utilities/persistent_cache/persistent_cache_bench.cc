@@ -17,7 +17,9 @@ int main() { fprintf(stderr, "Please install gflags to run tools\n"); }
 
 #include "monitoring/histogram.h"
 #include "port/port.h"
+#include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/terark_namespace.h"
 #include "table/block_builder.h"
 #include "util/gflags_compat.h"
@@ -41,6 +43,12 @@ DEFINE_string(cache_type, "block_cache",
               "Cache type. (block_cache, volatile, tiered)");
 DEFINE_bool(benchmark, false, "Benchmark mode");
 DEFINE_int32(volatile_cache_pct, 10, "Percentage of cache in memory tier.");
+DEFINE_bool(blob_fetch, false,
+            "Measure Get latency of separated values served by the cache as "
+            "DBOptions::blob_persistent_cache, instead of raw cache lookups");
+DEFINE_string(db_path, "/tmp/microbench/blobdb",
+              "Path for the DB of the blob fetch benchmark");
+DEFINE_int32(blob_num_keys, 100000, "Keys of the blob fetch benchmark");
 
 namespace TERARKDB_NAMESPACE {
 
@@ -300,6 +308,135 @@ class CacheTierBenchmark {
   mutable Stats stats_;                         // Stats
 };
 
+//
+// Blob fetch benchmark driver
+//
+// Loads FLAGS_blob_num_keys separated values of FLAGS_iosize bytes into a DB
+// whose blob_persistent_cache is the cache under test, warms the cache up and
+// then measures the latency of Get from FLAGS_nthread_read threads. The key
+// ssts stay in the block cache, so the latency is dominated by the blob fetch
+class BlobFetchBenchmark {
+ public:
+  explicit BlobFetchBenchmark(std::shared_ptr<PersistentCacheTier>&& cache)
+      : cache_(cache) {
+    Options options;
+    options.create_if_missing = true;
+    options.blob_size = 64;  // separate every value
+    options.blob_persistent_cache = cache_;
+    options.blob_persistent_cache_max_value_size = FLAGS_iosize;
+    options.blob_persistent_cache_admission_fetches = 1;
+    options.statistics = CreateDBStatistics();
+    statistics_ = options.statistics;
+    DestroyDB(FLAGS_db_path, options);
+    DB* db = nullptr;
+    Status s = DB::Open(options, FLAGS_db_path, &db);
+    if (!s.ok()) {
+      fprintf(stderr, "Error opening db %s\n", s.ToString().c_str());
+      abort();
+    }
+    db_.reset(db);
+
+    fprintf(stdout, "Loading\n");
+    Load();
+    fprintf(stdout, "Warming up\n");
+    for (int i = 0; i < FLAGS_blob_num_keys; ++i) {
+      ReadKey(i);
+    }
+    cache_->TEST_Flush();
+    stats_.Clear();
+    statistics_->Reset();
+
+    std::list<port::Thread> threads;
+    for (int i = 0; i < FLAGS_nthread_read; ++i) {
+      threads.emplace_back([this] {
+        while (!quit_) {
+          ReadKey(random() % FLAGS_blob_num_keys);
+        }
+      });
+    }
+    StopWatchNano t(Env::Default(), /*auto_start=*/true);
+    size_t sec = 0;
+    while (!quit_) {
+      sec = t.ElapsedNanos() / 1000000000ULL;
+      quit_ = sec > size_t(FLAGS_nsec);
+      /* sleep override */ sleep(1);
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+    PrintStats(sec);
+    db_.reset();
+    cache_->Close();
+  }
+
+ private:
+  void Load() {
+    std::string value(FLAGS_iosize, 'v');
+    for (int i = 0; i < FLAGS_blob_num_keys; ++i) {
+      Status s = db_->Put(WriteOptions(), Key(i), value);
+      assert(s.ok());
+    }
+    Status s = db_->Flush(FlushOptions());
+    assert(s.ok());
+    (void)s;
+  }
+
+  void ReadKey(uint64_t i) {
+    std::string value;
+    StopWatchNano timer(Env::Default(), /*auto_start=*/true);
+    Status s = db_->Get(ReadOptions(), Key(i), &value);
+    stats_.read_latency_.Add(timer.ElapsedNanos() / 1000);
+    if (!s.ok()) {
+      fprintf(stderr, "%s\n", s.ToString().c_str());
+    }
+    assert(s.ok());
+    assert(value.size() == size_t(FLAGS_iosize));
+    stats_.bytes_read_.Add(value.size());
+  }
+
+  std::string Key(uint64_t i) {
+    char buf[32];
+    snprintf(buf, sizeof buf, "%016" PRIu64, i);
+    return buf;
+  }
+
+  void PrintStats(const size_t sec) {
+    std::ostringstream msg;
+    msg << "Test stats" << std::endl
+        << "* Elapsed: " << sec << " s" << std::endl
+        << "* Get Latency:" << std::endl
+        << stats_.read_latency_.ToString() << std::endl
+        << "* Bytes read:" << std::endl
+        << stats_.bytes_read_.ToString() << std::endl
+        << "* Blob persistent cache hit: "
+        << statistics_->getTickerCount(BLOB_PERSISTENT_CACHE_HIT) << std::endl
+        << "* Blob persistent cache miss: "
+        << statistics_->getTickerCount(BLOB_PERSISTENT_CACHE_MISS)
+        << std::endl
+        << "* Blob sst fetches: "
+        << statistics_->getTickerCount(SEPARATE_VALUE_FETCH) << std::endl
+        << "Cache stats:" << std::endl
+        << cache_->PrintStats() << std::endl;
+    fprintf(stderr, "%s\n", msg.str().c_str());
+  }
+
+  struct Stats {
+    void Clear() {
+      bytes_read_.Clear();
+      read_latency_.Clear();
+    }
+
+    HistogramImpl bytes_read_;
+    HistogramImpl read_latency_;
+  };
+
+  std::shared_ptr<PersistentCacheTier> cache_;  // cache implementation
+  std::shared_ptr<Statistics> statistics_;
+  std::unique_ptr<DB> db_;
+  std::atomic<bool> quit_{false};  // Quit thread ?
+  mutable Stats stats_;            // Stats
+};
+
 }  // namespace TERARKDB_NAMESPACE
 
 //
@@ -324,7 +461,8 @@ int main(int argc, char** argv) {
       << std::endl
       << "* cache_type=" << FLAGS_cache_type << std::endl
       << "* benchmark=" << FLAGS_benchmark << std::endl
-      << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl;
+      << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl
+      << "* blob_fetch=" << FLAGS_blob_fetch << std::endl;
 
   fprintf(stderr, "%s\n", msg.str().c_str());
 
@@ -348,6 +486,12 @@ int main(int argc, char** argv) {
     abort();
   }
 
+  if (FLAGS_blob_fetch) {
+    std::unique_ptr<TERARKDB_NAMESPACE::BlobFetchBenchmark> benchmark(
+        new TERARKDB_NAMESPACE::BlobFetchBenchmark(std::move(cache)));
+    return 0;
+  }
+
   std::unique_ptr<TERARKDB_NAMESPACE::CacheTierBenchmark> benchmark(
       new TERARKDB_NAMESPACE::CacheTierBenchmark(std::move(cache)));
 
@@ -468,6 +468,49 @@ TEST_F(PersistentCacheDBTest, TieredCacheTest) {
 }
 #endif
 
+// test separated values with a volatile blob persistent cache
+TEST_F(PersistentCacheDBTest, BlobPersistentCacheTest) {
+  auto pcache = std::make_shared<VolatileCacheTier>();
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.blob_size = 32;  // turn on kv separation
+  options.statistics = TERARKDB_NAMESPACE::CreateDBStatistics();
+  options.blob_persistent_cache = pcache;
+  options.blob_persistent_cache_max_value_size = 256;
+  options.blob_persistent_cache_admission_fetches = 2;
+  DestroyAndReopen(options);
+
+  auto value_of = [](int i) { return Key(i) + std::string(100, 'a' + i % 26); };
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(Put(Key(i), value_of(i)));
+  }
+  // Too large to be admitted
+  ASSERT_OK(Put(Key(10), std::string(1000, 'z')));
+  ASSERT_OK(Flush());
+
+  // Values are admitted on the second fetch
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_EQ(value_of(i), Get(Key(i)));
+    }
+    ASSERT_EQ(std::string(1000, 'z'), Get(Key(10)));
+  }
+  ASSERT_EQ(10U, TestGetTickerCount(options, BLOB_PERSISTENT_CACHE_ADD));
+  ASSERT_EQ(10U, TestGetTickerCount(options, BLOB_PERSISTENT_CACHE_HIT));
+  ASSERT_EQ(23U, TestGetTickerCount(options, BLOB_PERSISTENT_CACHE_MISS));
+  ASSERT_EQ(23U, TestGetTickerCount(options, SEPARATE_VALUE_FETCH));
+
+  // The cache outlives the DB
+  Reopen(options);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(value_of(i), Get(Key(i)));
+  }
+  ASSERT_EQ(20U, TestGetTickerCount(options, BLOB_PERSISTENT_CACHE_HIT));
+
+  pcache->Close();
+}
+
 }  // namespace TERARKDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -157,19 +157,27 @@ class SimCacheImpl : public SimCache {
   // test_capacity for key only cache
   SimCacheImpl(std::shared_ptr<Cache> cache, size_t sim_capacity,
                int num_shard_bits)
+      : SimCacheImpl(NewLRUCache(sim_capacity, num_shard_bits), cache) {}
+
+  // sim_cache for key only cache, cache may be nullptr
+  SimCacheImpl(std::shared_ptr<Cache> sim_cache, std::shared_ptr<Cache> cache)
       : cache_(cache),
-        key_only_cache_(NewLRUCache(sim_capacity, num_shard_bits)),
+        key_only_cache_(sim_cache),
         miss_times_(0),
         hit_times_(0),
         stats_(nullptr) {}
 
   virtual ~SimCacheImpl() {}
   virtual void SetCapacity(size_t capacity) override {
-    cache_->SetCapacity(capacity);
+    if (cache_) {
+      cache_->SetCapacity(capacity);
+    }
   }
 
   virtual void SetStrictCapacityLimit(bool strict_capacity_limit) override {
-    cache_->SetStrictCapacityLimit(strict_capacity_limit);
+    if (cache_) {
+      cache_->SetStrictCapacityLimit(strict_capacity_limit);
+    }
   }
 
   virtual Status Insert(const Slice& key, void* value, size_t charge,
@@ -190,7 +198,9 @@ class SimCacheImpl : public SimCache {
     }
 
     cache_activity_logger_.ReportAdd(key, charge);
-
+    if (!cache_) {
+      return Status::OK();
+    }
     return cache_->Insert(key, value, charge, deleter, handle, priority);
   }
 
@@ -206,54 +216,76 @@ class SimCacheImpl : public SimCache {
     }
 
     cache_activity_logger_.ReportLookup(key);
-
+    if (!cache_) {
+      return nullptr;
+    }
     return cache_->Lookup(key, stats);
   }
 
-  virtual bool Ref(Handle* handle) override { return cache_->Ref(handle); }
+  // Without a real cache Lookup() and Insert() never hand out a handle
+
+  virtual bool Ref(Handle* handle) override {
+    return cache_ ? cache_->Ref(handle) : false;
+  }
 
   virtual bool Release(Handle* handle, bool force_erase = false) override {
-    return cache_->Release(handle, force_erase);
+    return cache_ ? cache_->Release(handle, force_erase) : false;
   }
 
   virtual void Erase(const Slice& key) override {
-    cache_->Erase(key);
+    if (cache_) {
+      cache_->Erase(key);
+    }
     key_only_cache_->Erase(key);
   }
 
-  virtual void* Value(Handle* handle) override { return cache_->Value(handle); }
+  virtual void* Value(Handle* handle) override {
+    return cache_ ? cache_->Value(handle) : nullptr;
+  }
 
-  virtual uint64_t NewId() override { return cache_->NewId(); }
+  virtual uint64_t NewId() override {
+    return cache_ ? cache_->NewId() : key_only_cache_->NewId();
+  }
 
-  virtual size_t GetCapacity() const override { return cache_->GetCapacity(); }
+  virtual size_t GetCapacity() const override {
+    return cache_ ? cache_->GetCapacity() : 0;
+  }
 
   virtual bool HasStrictCapacityLimit() const override {
-    return cache_->HasStrictCapacityLimit();
+    return cache_ ? cache_->HasStrictCapacityLimit() : false;
   }
 
-  virtual size_t GetUsage() const override { return cache_->GetUsage(); }
+  virtual size_t GetUsage() const override {
+    return cache_ ? cache_->GetUsage() : 0;
+  }
 
   virtual size_t GetUsage(Handle* handle) const override {
-    return cache_->GetUsage(handle);
+    return cache_ ? cache_->GetUsage(handle) : 0;
   }
 
   virtual size_t GetPinnedUsage() const override {
-    return cache_->GetPinnedUsage();
+    return cache_ ? cache_->GetPinnedUsage() : 0;
   }
 
   virtual void DisownData() override {
-    cache_->DisownData();
+    if (cache_) {
+      cache_->DisownData();
+    }
     key_only_cache_->DisownData();
   }
 
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override {
     // only apply to _cache since key_only_cache doesn't hold value
-    cache_->ApplyToAllCacheEntries(callback, thread_safe);
+    if (cache_) {
+      cache_->ApplyToAllCacheEntries(callback, thread_safe);
+    }
   }
 
   virtual void EraseUnRefEntries() override {
-    cache_->EraseUnRefEntries();
+    if (cache_) {
+      cache_->EraseUnRefEntries();
+    }
     key_only_cache_->EraseUnRefEntries();
   }
 
@@ -297,8 +329,10 @@ class SimCacheImpl : public SimCache {
   virtual std::string GetPrintableOptions() const override {
     std::string ret;
     ret.reserve(20000);
-    ret.append("    cache_options:\n");
-    ret.append(cache_->GetPrintableOptions());
+    if (cache_) {
+      ret.append("    cache_options:\n");
+      ret.append(cache_->GetPrintableOptions());
+    }
     ret.append("    sim_cache_options:\n");
     ret.append(key_only_cache_->GetPrintableOptions());
     return ret;
@@ -344,4 +378,12 @@ std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
   return std::make_shared<SimCacheImpl>(cache, sim_capacity, num_shard_bits);
 }
 
+std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> sim_cache,
+                                      std::shared_ptr<Cache> cache) {
+  if (sim_cache == nullptr) {
+    return nullptr;
+  }
+  return std::make_shared<SimCacheImpl>(sim_cache, cache);
+}
+
 }  // end namespace TERARKDB_NAMESPACE
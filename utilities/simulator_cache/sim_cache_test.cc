@@ -213,6 +213,42 @@ TEST_F(SimCacheTest, SimCacheLogging) {
   ASSERT_GT(fsize, max_size - 100);
 }
 
+TEST_F(SimCacheTest, SimCacheWithoutRealCache) {
+  ASSERT_EQ(nullptr, NewSimCache(nullptr, nullptr));
+  std::shared_ptr<SimCache> sim_cache =
+      NewSimCache(NewLRUCache(20000, 0), /*cache=*/nullptr);
+  ASSERT_NE(nullptr, sim_cache);
+
+  // Only keys are kept, no handle or value is ever handed out
+  Cache::Handle* handle = nullptr;
+  ASSERT_OK(sim_cache->Insert("key", nullptr, 100, nullptr, &handle));
+  ASSERT_EQ(nullptr, handle);
+  ASSERT_EQ(nullptr, sim_cache->Lookup("key"));
+  ASSERT_EQ(nullptr, sim_cache->Lookup("other"));
+  ASSERT_EQ(1, sim_cache->get_hit_counter());
+  ASSERT_EQ(1, sim_cache->get_miss_counter());
+  ASSERT_EQ(100, sim_cache->GetSimUsage());
+
+  ASSERT_NE(sim_cache->NewId(), sim_cache->NewId());
+  sim_cache->SetCapacity(1000);
+  sim_cache->SetStrictCapacityLimit(true);
+  ASSERT_EQ(0, sim_cache->GetCapacity());
+  ASSERT_FALSE(sim_cache->HasStrictCapacityLimit());
+  ASSERT_EQ(0, sim_cache->GetUsage());
+  ASSERT_EQ(0, sim_cache->GetPinnedUsage());
+  static size_t num_entries;
+  num_entries = 0;
+  sim_cache->ApplyToAllCacheEntries(
+      [](void* /*value*/, size_t /*charge*/) { ++num_entries; }, true);
+  ASSERT_EQ(0, num_entries);
+  ASSERT_NE(std::string::npos,
+            sim_cache->GetPrintableOptions().find("sim_cache_options"));
+
+  sim_cache->Erase("key");
+  sim_cache->EraseUnRefEntries();
+  ASSERT_EQ(0, sim_cache->GetSimUsage());
+}
+
 }  // namespace TERARKDB_NAMESPACE
 
 int main(int argc, char** argv) {